@@ -35,6 +35,9 @@
 
 extern void *make_Plugin_ASTC();
 extern void *make_Plugin_BoxFilter();
+extern void *make_Plugin_KaiserFilter();
+extern void *make_Plugin_LanczosFilter();
+extern void *make_Plugin_MitchellFilter();
 extern void *make_Plugin_DDS();
 extern void *make_Plugin_EXR();
 extern void *make_Plugin_KTX();
@@ -87,6 +90,9 @@ int main(int argc,  char* argv[])
 #endif
 
     g_pluginManager.registerStaticPlugin("FILTERS","BOXFILTER", make_Plugin_BoxFilter);
+    g_pluginManager.registerStaticPlugin("FILTERS","KAISERFILTER", make_Plugin_KaiserFilter);
+    g_pluginManager.registerStaticPlugin("FILTERS","LANCZOSFILTER", make_Plugin_LanczosFilter);
+    g_pluginManager.registerStaticPlugin("FILTERS","MITCHELLFILTER", make_Plugin_MitchellFilter);
     g_pluginManager.getPluginList("\\Plugins");
 
 #ifdef USE_QT_IMAGELOAD
@@ -174,9 +174,21 @@ AMDCompress CLI Tool
     ///
     /// \section codecCompressionSpeed -CompressionSpeed [value]
     ///
-    /// The trade-off between compression speed & quality, default is set to fast; this value is ignored for BC6H and BC7 (for BC7 the compression speed depends on Quaility and Performance settings)
+    /// The trade-off between compression speed & quality, default is set to fast; this value is ignored for BC7 (for BC7 the compression speed depends on Quaility and Performance settings)
+    /// For BC6H a value of 1 ranks the 32 two region shapes with a fast estimate and only encodes the best 8, a value of 2 only encodes the best 2 and restricts the block modes to 1 and 11
     /// Value of 0 (default) sets Highest quality mode, value of 1 sets slightly lower quality but much faster compression mode, value of 2 sets slightly lower quality but much, much faster compression mode 
     ///
+    /// \section codecRefinementEffort -RefinementEffort [value]
+    ///
+    /// Used for DXT1 to DXT5 (BC1 to BC3) only. Search effort of the normal speed colour encoder, from 0.0 (fastest) to 1.0 (best), default 0.5.
+    /// It sets the ramp search steps, the number of axis refits and the number of refinement passes, and the refinement stops as soon as a pass
+    /// no longer lowers the error. -Quality also sets it when -RefinementEffort is not given.\n
+    /// To measure the speed and quality of a level on your own textures, compress with -performance to get the compression time, decompress the
+    /// result and compare it with the source using -analysis, which writes the MSE and PSNR to Analysis_Result.xml:\n
+    /// CompressonatorCLI.exe -fd BC1 -CompressionSpeed 0 -RefinementEffort 0.2 -performance image.bmp result.dds\n
+    /// CompressonatorCLI.exe result.dds result.bmp\n
+    /// CompressonatorCLI.exe -analysis image.bmp result.bmp\n
+    ///
     /// \section codecNumThreads -NumThreads [value]
     ///
     /// Number of threads to initialize for BC6H or BC7 encoding. Value can be from 1 to 128, default set to 8;
@@ -212,6 +224,28 @@ AMDCompress CLI Tool
     /// Mode to set BC7 to encode blocks using any of 8 different block modes in order to obtain the highest quality. Default set to 0xCF,
     /// You can combine the bits to test for which modes produce the best image quality.\n 
     ///
+    /// \section codecPartitionCandidates -PartitionCandidates [value]
+    ///
+    /// Used for BC7 only. All partitions of modes 0, 1, 2, 3 and 7 are ranked with a fast principal axis error estimate and only the best
+    /// candidates are fully encoded. Value can be from 1 to 64, the default of 0 derives the number of candidates from Quality
+    /// (all partitions are encoded at Quality 0.7 and above).\n
+    ///
+    /// \section codecTargetMSE -TargetMSE [value]
+    ///
+    /// Used for BC7 only. Turns on the adaptive search: the mode, partition and shake search of a block stops as soon as its mean square error
+    /// per channel is at or below value, so flat blocks finish early and only the blocks above the target get the full search set by Quality.
+    /// Default is 0 (off). With -performance the average work per block is reported.\n
+    ///
+    /// \section codecTargetPSNR -TargetPSNR [value]
+    ///
+    /// Used for BC7 only. Same as -TargetMSE with the error target given as a PSNR in dB, for example 45.\n
+    ///
+    /// \section codecAutoModeMask -AutoModeMask [value]
+    ///
+    /// Used for BC7 only. With a value of 1 about one block in 16 is first encoded with the modes of -ModeMask, and only the modes that are chosen
+    /// for at least 1 in 32 of those blocks are kept for the full encode (mode 6 is kept when -ModeMask allows it). Textures under 256 blocks keep -ModeMask.
+    /// With -performance the mode mask used and the estimated time saved are reported.\n
+    ///
     /// \section codecSigned -Signed [value]
     ///
     /// Used for BC6H only, Default BC6H format disables use of a sign bit in the 16-bit floating point channels, with a value set to 1 BC6H format will use a sign bit; Value of 1 turns the option 0n, 0 turns the option off 
@@ -234,6 +268,8 @@ AMDCompress CLI Tool
     ///
     /// \section codecperformance -performance
     /// Shows various performance statistics 
+    /// The time taken to generate the MIP levels is shown on its own line. The box filter picks its row kernels from the CPU features, so
+    /// running the same conversion with -CPUFeatureMask 0 (C kernels), 0x3 (SSE2) and the default (all features) compares them on one machine.\n
     ///
     /// \section codecnoprogress -noprogress
     ///
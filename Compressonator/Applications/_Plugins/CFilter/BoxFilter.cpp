@@ -33,6 +33,21 @@
 #include "MIPS.h"
 #include "Compressonator.h"
 #include "Texture.h"
+#include "SRGB.h"
+#include "HalfFloat.h"
+#include <process.h>
+
+#ifdef USE_SSE
+#include <emmintrin.h>
+#endif // USE_SSE
+#ifdef USE_AVX2
+#include <immintrin.h>
+#endif // USE_AVX2
+
+// The rows of a level are shared between up to BOXFILTER_MAX_THREADS threads, each
+// with at least BOXFILTER_MIN_THREAD_TEXELS destination texels so small levels stay on one thread
+#define BOXFILTER_MAX_THREADS          64
+#define BOXFILTER_MIN_THREAD_TEXELS    (64 * 1024)
 
 CMIPS *CMips;
 
@@ -75,6 +90,7 @@ int Plugin_BoxFilter::TC_PluginGetVersion(TC_PluginVersion* pPluginVersion)
 }
 
 //nMinSize : The size in pixels used to determine how many mip levels to generate. Once all dimensions are less than or equal to nMinSize your mipper should generate no more mip levels.
+//The new levels follow the last level the MipSet already has, so a chain can also be extended a level at a time.
 int Plugin_BoxFilter::TC_GenerateMIPLevels(MipSet *pMipSet, int nMinSize)
 {
     assert(pMipSet);
@@ -82,8 +98,33 @@ int Plugin_BoxFilter::TC_GenerateMIPLevels(MipSet *pMipSet, int nMinSize)
 
     
     int nPrevMipLevels = pMipSet->m_nMipLevels;
-    int nWidth = pMipSet->m_nWidth;
-    int nHeight = pMipSet->m_nHeight;
+    MipLevel* pLastMipLevel = CMips->GetMipLevel(pMipSet, nPrevMipLevels-1);
+    int nWidth = pLastMipLevel->m_nWidth;
+    int nHeight = pLastMipLevel->m_nHeight;
+
+    int nChannels;
+    switch(pMipSet->m_TextureDataType)
+    {
+        case TDT_XRGB:
+        case TDT_ARGB:
+        case TDT_NORMAL_MAP:    nChannels = 4; break;
+        case TDT_RG:            nChannels = 2; break;
+        case TDT_R:             nChannels = 1; break;
+        default:                return PE_Unknown;
+    }
+
+    void (*pGenerateMipLevel)(MipLevel*, MipLevel*, MipLevel*, int);
+    switch(pMipSet->m_ChannelFormat)
+    {
+        case CF_8bit:
+            // sRGB encoded 8 bit levels are averaged in linear light
+            pGenerateMipLevel = ((pMipSet->m_Flags & MS_FLAG_sRGB) && nChannels == 4) ? GenerateMipLevelSRGB : GenerateMipLevel;
+            break;
+        case CF_16bit:      pGenerateMipLevel = GenerateMipLevel16;     break;
+        case CF_Float16:    pGenerateMipLevel = GenerateMipLevel16F;    break;
+        case CF_Float32:    pGenerateMipLevel = GenerateMipLevel32F;    break;
+        default:            return PE_Unknown;
+    }
 
     while(nWidth > nMinSize && nHeight > nMinSize)
     {
@@ -116,27 +157,18 @@ int Plugin_BoxFilter::TC_GenerateMIPLevels(MipSet *pMipSet, int nMinSize)
             assert(pThisMipLevel->m_pbData);
             if(pMipSet->m_TextureType != TT_VolumeTexture)
             {
-                if(pMipSet->m_ChannelFormat == CF_8bit)
-                    GenerateMipLevel(pThisMipLevel, CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice));
-                else if(pMipSet->m_ChannelFormat == CF_Float32)
-                    GenerateMipLevel32F(pThisMipLevel, CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice));
+                pGenerateMipLevel(pThisMipLevel, CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice), NULL, nChannels);
             }
             else
             {
                 if(MaxFacesOrSlices(pMipSet, nCurMipLevel-1) > 1)
                 {
                     //prev miplevel had 2 or more slices, so avg together slices
-                    if(pMipSet->m_ChannelFormat == CF_8bit)
-                        GenerateMipLevel(pThisMipLevel,  CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2), CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2+1));
-                    else if(pMipSet->m_ChannelFormat == CF_Float32)
-                        GenerateMipLevel32F(pThisMipLevel,  CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2), CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2+1));
+                    pGenerateMipLevel(pThisMipLevel,  CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2), CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2+1), nChannels);
                 }
                 else
                 {
-                    if(pMipSet->m_ChannelFormat == CF_8bit)
-                        GenerateMipLevel(pThisMipLevel, CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice));
-                    else if(pMipSet->m_ChannelFormat == CF_Float32)
-                        GenerateMipLevel32F(pThisMipLevel, CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice));
+                    pGenerateMipLevel(pThisMipLevel, CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice), NULL, nChannels);
                 }
             }
         }
@@ -161,201 +193,570 @@ int Plugin_BoxFilter::TC_GenerateMIPLevels(MipSet *pMipSet, int nMinSize)
     return PE_OK;
 }
 
-void GenerateMipLevel(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo)
+//
+// Row kernels. Each destination texel averages 2x2 texels of a pair of source rows,
+// or of two pairs for volume textures where the second pair is from the next slice.
+// pSrc holds nSrcRows rows (2 or 4), bDiffWidths is false when the source level is a
+// single texel wide and that texel is used twice. The SIMD kernels give the same
+// results as the C kernels: the 8 bit sums are exact and the float sums are added in
+// the same order. The linear kernels decode the sRGB colour channels with a lookup,
+// average them as floats and encode the result, alpha is averaged as in BoxFilterRow8.
+// 16 bit texels are averaged like 8 bit ones and half floats like floats, with the
+// sum rounded to the nearest half. Texels have nChannels channels, the SIMD kernels
+// leave anything but 4 to the C kernels and sRGB levels always have 4.
+//
+typedef void (*BoxFilterRowProc)(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths);
+
+typedef struct
 {
-    assert(pCurMipLevel);
-    assert(pPrevMipLevelOne);
+    BoxFilterRowProc    pRow8;
+    BoxFilterRowProc    pRow8Linear;
+    BoxFilterRowProc    pRow16;
+    BoxFilterRowProc    pRow16F;
+    BoxFilterRowProc    pRow32F;
+} BoxFilterKernels;
 
-    if(pCurMipLevel && pPrevMipLevelOne)
+static void BoxFilterRow8(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    BYTE* pOut = pDst;
+    int nSecond = bDiffWidths ? nChannels : 0;
+    int nShift = (nSrcRows == 2) ? 2 : 3;
+    for(int x=0; x<nWidth; x++)
     {
-        if(!pPrevMipLevelTwo)
+        for(int i=0; i<nChannels; i++)
         {
-            bool bDiffHeights = pCurMipLevel->m_nHeight != pPrevMipLevelOne->m_nHeight;
-            bool bDiffWidths = pCurMipLevel->m_nWidth != pPrevMipLevelOne->m_nWidth;
-            COLOR *pDst = pCurMipLevel->m_pcData;
-            for(int y=0; y<pCurMipLevel->m_nHeight; y++)
+            int nSum = nSrcRows;    // Rounding
+            for(int r=0; r<nSrcRows; r++)
             {
-                COLOR *pSrc = pPrevMipLevelOne->m_pcData + (2 * y * pPrevMipLevelOne->m_nWidth);
-                COLOR *pSrc2;
-                if(bDiffHeights)
-                {
-                    pSrc2 = pSrc+pPrevMipLevelOne->m_nWidth;
-                }
-                else
-                {
-                    //if no change in height, then use same line as source
-                    pSrc2 = pSrc;
-                }
-                for(int x=0; x<pCurMipLevel->m_nWidth; x++, pSrc+=2, pSrc2+=2)
-                {
-                    COLOR c1, c2, c3, c4;
-                    c1 = *pSrc;
-                    c3 = *pSrc2;
-                    if(bDiffWidths)
-                    {
-                        c2 = pSrc[1];
-                        c4 = pSrc2[1];
-                    }
-                    else
-                    {
-                        c2 = *pSrc;
-                        c4 = *pSrc2;
-                    }
-                    for(int i=0; i<4 ;i++)
-                        c1.rgba[i] = static_cast<BYTE>((c1.rgba[i] + c2.rgba[i] + c3.rgba[i] + c4.rgba[i]+2)/4);
-                    *pDst++= c1;
-                }
+                BYTE* pRow = pSrc[r] + 2 * nChannels * x;
+                nSum += pRow[i] + pRow[nSecond + i];
             }
+            *pOut++ = static_cast<BYTE>(nSum >> nShift);
         }
-        else
-        {//working with volume texture, avg both slices together as well as 4 corners
-            bool bDiffHeights = pCurMipLevel->m_nHeight != pPrevMipLevelOne->m_nHeight;
-            bool bDiffWidths = pCurMipLevel->m_nWidth != pPrevMipLevelOne->m_nWidth;
-            //don't need to check that either height or width is diff, b/c slices are diff
-            COLOR *pDst = pCurMipLevel->m_pcData;
-            for(int y=0; y<pCurMipLevel->m_nHeight; y++)
+    }
+}
+
+static void BoxFilterRow8Linear(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    COLOR* pOut = (COLOR*)pDst;
+    UNREFERENCED_PARAMETER(nChannels);
+    int nSecond = bDiffWidths ? 1 : 0;
+    int nShift = (nSrcRows == 2) ? 2 : 3;
+    float fScale = 1.f / (nSrcRows * 2);
+    for(int x=0; x<nWidth; x++)
+    {
+        for(int i=0; i<3; i++)
+        {
+            float fSum = 0.f;
+            for(int r=0; r<nSrcRows; r++)
             {
-                COLOR *pSrc, *pSrc2, *pOtherSrc, *pOtherSrc2;
-                pSrc = pPrevMipLevelOne->m_pcData + (2 * y * pPrevMipLevelOne->m_nWidth);
-                pOtherSrc = pPrevMipLevelTwo->m_pcData + (2 * y * pPrevMipLevelTwo->m_nWidth);
-                if(bDiffHeights)
-                {
-                    //point to next line, same column
-                    pSrc2 = pSrc + pPrevMipLevelOne->m_nWidth;
-                    pOtherSrc2 = pOtherSrc + pPrevMipLevelTwo->m_nWidth;
-                }
-                else
-                {
-                    //if no change in height, then use same line as source
-                    pSrc2 = pSrc;
-                    pOtherSrc2 = pOtherSrc;
-                }
-                for(int x=0; x<pCurMipLevel->m_nWidth; x++, pSrc+=2, pSrc2+=2, pOtherSrc+=2, pOtherSrc2+=2)
-                {
-                    COLOR c1, c2, c3, c4, c5, c6, c7, c8;
-                    c1 = *pSrc;
-                    c3 = *pSrc2;
-                    c5 = *pOtherSrc;
-                    c7 = *pOtherSrc2;
-                    if(bDiffWidths)
-                    {
-                        c2 = pSrc[1];
-                        c4 = pSrc2[1];
-                        c6 = pOtherSrc[1];
-                        c8 = pOtherSrc2[1];
-                    }
-                    else
-                    {
-                        c2 = *pSrc;
-                        c4 = *pSrc2;
-                        c6 = *pOtherSrc;
-                        c8 = *pOtherSrc2;
-                    }
-                    for(int i=0; i<4; i++)
-                    {
-                        c1.rgba[i] = static_cast<BYTE>(((int)c1.rgba[i] + c2.rgba[i] + c3.rgba[i] + c4.rgba[i] + c5.rgba[i] + c6.rgba[i] + c7.rgba[i] + c8.rgba[i]+4)/8);
-                    }
-                    *pDst++= c1;
-                }
+                COLOR* pRow = (COLOR*)pSrc[r] + 2 * x;
+                fSum += g_fSRGBToLinear[pRow[0].rgba[i]];
+                fSum += g_fSRGBToLinear[pRow[nSecond].rgba[i]];
             }
+            pOut[x].rgba[i] = LinearToSRGB(fSum * fScale);
         }
+
+        int nSum = nSrcRows;
+        for(int r=0; r<nSrcRows; r++)
+        {
+            COLOR* pRow = (COLOR*)pSrc[r] + 2 * x;
+            nSum += pRow[0].rgba[3] + pRow[nSecond].rgba[3];
+        }
+        pOut[x].rgba[3] = static_cast<BYTE>(nSum >> nShift);
     }
 }
 
-void GenerateMipLevel32F(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo)
+static void BoxFilterRow16(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
 {
-    assert(pCurMipLevel);
-    assert(pPrevMipLevelOne);
+    WORD* pOut = (WORD*)pDst;
+    int nSecond = bDiffWidths ? nChannels : 0;
+    int nShift = (nSrcRows == 2) ? 2 : 3;
+    for(int x=0; x<nWidth; x++)
+    {
+        for(int i=0; i<nChannels; i++)
+        {
+            DWORD dwSum = nSrcRows;    // Rounding
+            for(int r=0; r<nSrcRows; r++)
+            {
+                WORD* pRow = (WORD*)pSrc[r] + 2 * nChannels * x;
+                dwSum += pRow[i] + pRow[nSecond + i];
+            }
+            *pOut++ = static_cast<WORD>(dwSum >> nShift);
+        }
+    }
+}
 
-    if(pCurMipLevel && pPrevMipLevelOne)
+static void BoxFilterRow16F(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    WORD* pOut = (WORD*)pDst;
+    int nSecond = bDiffWidths ? nChannels : 0;
+    float fCount = (float)(nSrcRows * 2);
+    for(int x=0; x<nWidth; x++)
     {
-        if(!pPrevMipLevelTwo)
+        for(int i=0; i<nChannels; i++)
         {
-            bool bDiffHeights = pCurMipLevel->m_nHeight != pPrevMipLevelOne->m_nHeight;
-            bool bDiffWidths = pCurMipLevel->m_nWidth != pPrevMipLevelOne->m_nWidth;
-            assert(bDiffHeights || bDiffWidths);
-            float *pDst = pCurMipLevel->m_pfData;
-            for(int y=0; y<pCurMipLevel->m_nHeight; y++)
+            float fSum = 0.f;
+            for(int r=0; r<nSrcRows; r++)
             {
-                float *pSrc = pPrevMipLevelOne->m_pfData + (2 * y * pPrevMipLevelOne->m_nWidth * 4);
-                float *pSrc2;
-                if(bDiffHeights)
-                {
-                    pSrc2 = pSrc + (pPrevMipLevelOne->m_nWidth * 4);
-                }
-                else
-                {
-                    //if no change in height, then use same line as source
-                    pSrc2 = pSrc;
-                }
-                for(int x=0; x<pCurMipLevel->m_nWidth; x++, pSrc+=8, pSrc2+=8)
-                {
-                    float c1[4], c2[4], c3[4], c4[4];
-                    memcpy(c1, pSrc, sizeof(c1));
-                    memcpy(c3, pSrc2, sizeof(c3));
-                    if(bDiffWidths)
-                    {
-                        memcpy(c2, pSrc+4, sizeof(c2));
-                        memcpy(c4, pSrc2+4, sizeof(c4));
-                    }
-                    else
-                    {
-                        memcpy(c2, pSrc, sizeof(c2));
-                        memcpy(c4, pSrc2, sizeof(c4));
-                    }
-                    for(int i=0; i<4 ;i++)
-                        *pDst++= (c1[i] + c2[i] + c3[i] + c4[i])/4.f;
-                }
+                WORD* pRow = (WORD*)pSrc[r] + 2 * nChannels * x;
+                fSum = (r == 0) ? HalfToFloat(pRow[i]) : fSum + HalfToFloat(pRow[i]);
+                fSum += HalfToFloat(pRow[nSecond + i]);
             }
+            *pOut++ = FloatToHalf(fSum / fCount);
         }
-        else
-        {//working with volume texture, avg both slices together as well as 4 corners
-            bool bDiffHeights = pCurMipLevel->m_nHeight != pPrevMipLevelOne->m_nHeight;
-            bool bDiffWidths = pCurMipLevel->m_nWidth != pPrevMipLevelOne->m_nWidth;
-            //don't need to check that either height or width is diff, b/c slices are diff
-            float *pDst = pCurMipLevel->m_pfData;
-            for(int y=0; y<pCurMipLevel->m_nHeight; y++)
+    }
+}
+
+static void BoxFilterRow32F(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    float* pOut = (float*)pDst;
+    int nSecond = bDiffWidths ? nChannels : 0;
+    float fCount = (float)(nSrcRows * 2);
+    for(int x=0; x<nWidth; x++)
+    {
+        for(int i=0; i<nChannels; i++)
+        {
+            float fSum = 0.f;
+            for(int r=0; r<nSrcRows; r++)
             {
-                float *pSrc, *pSrc2, *pOtherSrc, *pOtherSrc2;
-                pSrc = pPrevMipLevelOne->m_pfData + (2 * y * pPrevMipLevelOne->m_nWidth * 4);
-                pOtherSrc = pPrevMipLevelTwo->m_pfData + (2 * y * pPrevMipLevelTwo->m_nWidth * 4);
-                if(bDiffHeights)
-                {
-                    //point to next line, same column
-                    pSrc2 = pSrc + (pPrevMipLevelOne->m_nWidth * 4);
-                    pOtherSrc2 = pOtherSrc + (pPrevMipLevelTwo->m_nWidth * 4);
-                }
-                else
-                {
-                    //if no change in height, then use same line as source
-                    pSrc2 = pSrc;
-                    pOtherSrc2 = pOtherSrc;
-                }
-                for(int x=0; x<pCurMipLevel->m_nWidth; x++, pSrc+=8, pSrc2+=8, pOtherSrc+=8, pOtherSrc2+=8)
-                {
-                    float c1[4], c2[4], c3[4], c4[4], c5[4], c6[4], c7[4], c8[4];
-                    memcpy(c1, pSrc, sizeof(c1));
-                    memcpy(c3, pSrc2, sizeof(c3));
-                    memcpy(c5, pOtherSrc, sizeof(c5));
-                    memcpy(c7, pOtherSrc2, sizeof(c7));
-                    if(bDiffWidths)
-                    {
-                        memcpy(c2, pSrc+4, sizeof(c2));
-                        memcpy(c4, pSrc2+4, sizeof(c4));
-                        memcpy(c6, pOtherSrc+4, sizeof(c6));
-                        memcpy(c8, pOtherSrc2+4, sizeof(c8));
-                    }
-                    else
-                    {
-                        memcpy(c2, pSrc, sizeof(c2));
-                        memcpy(c4, pSrc2, sizeof(c4));
-                        memcpy(c6, pOtherSrc, sizeof(c6));
-                        memcpy(c8, pOtherSrc2, sizeof(c8));
-                    }
-                    for(int i=0; i<4; i++)
-                        *pDst++= (c1[i] + c2[i] + c3[i] + c4[i] + c5[i] + c6[i] + c7[i] + c8[i])/8.f;
-                }
+                float* pRow = (float*)pSrc[r] + 2 * nChannels * x;
+                fSum = (r == 0) ? pRow[i] : fSum + pRow[i];
+                fSum += pRow[nSecond + i];
             }
+            *pOut++ = fSum / fCount;
+        }
+    }
+}
+
+// Runs the C kernel on the texels from nFirst on, left over by a SIMD kernel
+static void BoxFilterRowTail(BoxFilterRowProc pRowProc, DWORD dwTexelSize, BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, int nFirst)
+{
+    if(nFirst >= nWidth)
+        return;
+
+    BYTE* pTailSrc[4];
+    for(int r=0; r<nSrcRows; r++)
+        pTailSrc[r] = pSrc[r] + 2 * nFirst * dwTexelSize;
+    pRowProc(pDst + nFirst * dwTexelSize, pTailSrc, nSrcRows, nWidth - nFirst, nChannels, true);
+}
+
+#ifdef USE_SSE
+// 4 destination texels from 8 source texels of each row, summed in 16 bit lanes
+static void BoxFilterRow8SSE2(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    if(!bDiffWidths || nChannels != 4)
+    {
+        BoxFilterRow8(pDst, pSrc, nSrcRows, nWidth, nChannels, bDiffWidths);
+        return;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16((short)nSrcRows);
+    const __m128i shift = _mm_cvtsi32_si128((nSrcRows == 2) ? 2 : 3);
+
+    int x = 0;
+    for(; x + 4 <= nWidth; x += 4)
+    {
+        __m128i sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+        for(int r=0; r<nSrcRows; r++)
+        {
+            const __m128i* pRow = (const __m128i*)(pSrc[r] + 2 * x * sizeof(COLOR));
+            __m128i a = _mm_loadu_si128(pRow);
+            __m128i b = _mm_loadu_si128(pRow + 1);
+            sum0 = _mm_add_epi16(sum0, _mm_unpacklo_epi8(a, zero));
+            sum1 = _mm_add_epi16(sum1, _mm_unpackhi_epi8(a, zero));
+            sum2 = _mm_add_epi16(sum2, _mm_unpacklo_epi8(b, zero));
+            sum3 = _mm_add_epi16(sum3, _mm_unpackhi_epi8(b, zero));
+        }
+
+        // Add the two texels of each horizontal pair
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi64(sum0, sum1), _mm_unpackhi_epi64(sum0, sum1));
+        __m128i hi = _mm_add_epi16(_mm_unpacklo_epi64(sum2, sum3), _mm_unpackhi_epi64(sum2, sum3));
+        lo = _mm_srl_epi16(_mm_add_epi16(lo, round), shift);
+        hi = _mm_srl_epi16(_mm_add_epi16(hi, round), shift);
+        _mm_storeu_si128((__m128i*)(pDst + x * sizeof(COLOR)), _mm_packus_epi16(lo, hi));
+    }
+
+    BoxFilterRowTail(BoxFilterRow8, sizeof(COLOR), pDst, pSrc, nSrcRows, nWidth, nChannels, x);
+}
+
+// 2 destination texels from 4 source texels of each row, summed in 32 bit lanes.
+// SSE2 has no unsigned 32 to 16 bit pack, so the averages are offset into the
+// signed range for _mm_packs_epi32 and back.
+static void BoxFilterRow16SSE2(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    if(!bDiffWidths || nChannels != 4)
+    {
+        BoxFilterRow16(pDst, pSrc, nSrcRows, nWidth, nChannels, bDiffWidths);
+        return;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(nSrcRows);
+    const __m128i shift = _mm_cvtsi32_si128((nSrcRows == 2) ? 2 : 3);
+    const __m128i offset32 = _mm_set1_epi32(0x8000);
+    const __m128i offset16 = _mm_set1_epi16((short)0x8000);
+
+    int x = 0;
+    for(; x + 2 <= nWidth; x += 2)
+    {
+        __m128i sum0 = round, sum1 = round;
+        for(int r=0; r<nSrcRows; r++)
+        {
+            const __m128i* pRow = (const __m128i*)(pSrc[r] + 2 * x * 4 * sizeof(WORD));
+            __m128i a = _mm_loadu_si128(pRow);
+            __m128i b = _mm_loadu_si128(pRow + 1);
+            sum0 = _mm_add_epi32(sum0, _mm_add_epi32(_mm_unpacklo_epi16(a, zero), _mm_unpackhi_epi16(a, zero)));
+            sum1 = _mm_add_epi32(sum1, _mm_add_epi32(_mm_unpacklo_epi16(b, zero), _mm_unpackhi_epi16(b, zero)));
+        }
+        sum0 = _mm_sub_epi32(_mm_srl_epi32(sum0, shift), offset32);
+        sum1 = _mm_sub_epi32(_mm_srl_epi32(sum1, shift), offset32);
+        _mm_storeu_si128((__m128i*)(pDst + x * 4 * sizeof(WORD)), _mm_xor_si128(_mm_packs_epi32(sum0, sum1), offset16));
+    }
+
+    BoxFilterRowTail(BoxFilterRow16, 4 * sizeof(WORD), pDst, pSrc, nSrcRows, nWidth, nChannels, x);
+}
+
+// One destination texel at a time, the channels summed in the order of the C kernel
+static void BoxFilterRow32FSSE2(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    if(!bDiffWidths || nChannels != 4)
+    {
+        BoxFilterRow32F(pDst, pSrc, nSrcRows, nWidth, nChannels, bDiffWidths);
+        return;
+    }
+
+    const __m128 scale = _mm_set1_ps(1.f / (nSrcRows * 2));
+    float* pOut = (float*)pDst;
+    for(int x=0; x<nWidth; x++)
+    {
+        const float* pRow = (const float*)pSrc[0] + 8 * x;
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(pRow), _mm_loadu_ps(pRow + 4));
+        for(int r=1; r<nSrcRows; r++)
+        {
+            pRow = (const float*)pSrc[r] + 8 * x;
+            sum = _mm_add_ps(sum, _mm_loadu_ps(pRow));
+            sum = _mm_add_ps(sum, _mm_loadu_ps(pRow + 4));
+        }
+        _mm_storeu_ps(pOut + 4 * x, _mm_mul_ps(sum, scale));
+    }
+}
+#endif // USE_SSE
+
+#ifdef USE_AVX2
+// 8 destination texels from 16 source texels of each row. The 256 bit unpacks work
+// within each 128 bit lane, so the packed result is put back in order with a permute.
+static void BoxFilterRow8AVX2(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    if(!bDiffWidths || nChannels != 4)
+    {
+        BoxFilterRow8(pDst, pSrc, nSrcRows, nWidth, nChannels, bDiffWidths);
+        return;
+    }
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi16((short)nSrcRows);
+    const __m128i shift = _mm_cvtsi32_si128((nSrcRows == 2) ? 2 : 3);
+
+    int x = 0;
+    for(; x + 8 <= nWidth; x += 8)
+    {
+        __m256i sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+        for(int r=0; r<nSrcRows; r++)
+        {
+            const __m256i* pRow = (const __m256i*)(pSrc[r] + 2 * x * sizeof(COLOR));
+            __m256i a = _mm256_loadu_si256(pRow);
+            __m256i b = _mm256_loadu_si256(pRow + 1);
+            sum0 = _mm256_add_epi16(sum0, _mm256_unpacklo_epi8(a, zero));
+            sum1 = _mm256_add_epi16(sum1, _mm256_unpackhi_epi8(a, zero));
+            sum2 = _mm256_add_epi16(sum2, _mm256_unpacklo_epi8(b, zero));
+            sum3 = _mm256_add_epi16(sum3, _mm256_unpackhi_epi8(b, zero));
+        }
+
+        __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi64(sum0, sum1), _mm256_unpackhi_epi64(sum0, sum1));
+        __m256i hi = _mm256_add_epi16(_mm256_unpacklo_epi64(sum2, sum3), _mm256_unpackhi_epi64(sum2, sum3));
+        lo = _mm256_srl_epi16(_mm256_add_epi16(lo, round), shift);
+        hi = _mm256_srl_epi16(_mm256_add_epi16(hi, round), shift);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)(pDst + x * sizeof(COLOR)), packed);
+    }
+    _mm256_zeroupper();
+
+    BoxFilterRowTail(BoxFilterRow8SSE2, sizeof(COLOR), pDst, pSrc, nSrcRows, nWidth, nChannels, x);
+}
+
+// Two destination texels at a time, the left and right texels of each pair are
+// gathered into separate registers so the sums keep the order of the C kernel
+static void BoxFilterRow32FAVX2(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    if(!bDiffWidths || nChannels != 4)
+    {
+        BoxFilterRow32F(pDst, pSrc, nSrcRows, nWidth, nChannels, bDiffWidths);
+        return;
+    }
+
+    const __m256 scale = _mm256_set1_ps(1.f / (nSrcRows * 2));
+    float* pOut = (float*)pDst;
+    int x = 0;
+    for(; x + 2 <= nWidth; x += 2)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        for(int r=0; r<nSrcRows; r++)
+        {
+            const float* pRow = (const float*)pSrc[r] + 8 * x;
+            __m256 a = _mm256_loadu_ps(pRow);
+            __m256 b = _mm256_loadu_ps(pRow + 8);
+            __m256 left  = _mm256_permute2f128_ps(a, b, 0x20);
+            __m256 right = _mm256_permute2f128_ps(a, b, 0x31);
+            sum = (r == 0) ? _mm256_add_ps(left, right) : _mm256_add_ps(_mm256_add_ps(sum, left), right);
+        }
+        _mm256_storeu_ps(pOut + 4 * x, _mm256_mul_ps(sum, scale));
+    }
+    _mm256_zeroupper();
+
+    BoxFilterRowTail(BoxFilterRow32FSSE2, 4 * sizeof(float), pDst, pSrc, nSrcRows, nWidth, nChannels, x);
+}
+
+// As BoxFilterRow32FAVX2 with the texels converted by F16C, which rounds to nearest even like FloatToHalf
+static void BoxFilterRow16FF16C(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    if(!bDiffWidths || nChannels != 4)
+    {
+        BoxFilterRow16F(pDst, pSrc, nSrcRows, nWidth, nChannels, bDiffWidths);
+        return;
+    }
+
+    const __m256 scale = _mm256_set1_ps(1.f / (nSrcRows * 2));
+    int x = 0;
+    for(; x + 2 <= nWidth; x += 2)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        for(int r=0; r<nSrcRows; r++)
+        {
+            const __m128i* pRow = (const __m128i*)(pSrc[r] + 2 * x * 4 * sizeof(WORD));
+            __m256 a = _mm256_cvtph_ps(_mm_loadu_si128(pRow));
+            __m256 b = _mm256_cvtph_ps(_mm_loadu_si128(pRow + 1));
+            __m256 left  = _mm256_permute2f128_ps(a, b, 0x20);
+            __m256 right = _mm256_permute2f128_ps(a, b, 0x31);
+            sum = (r == 0) ? _mm256_add_ps(left, right) : _mm256_add_ps(_mm256_add_ps(sum, left), right);
+        }
+        _mm_storeu_si128((__m128i*)(pDst + x * 4 * sizeof(WORD)), _mm256_cvtps_ph(_mm256_mul_ps(sum, scale), _MM_FROUND_TO_NEAREST_INT));
+    }
+    _mm256_zeroupper();
+
+    BoxFilterRowTail(BoxFilterRow16F, 4 * sizeof(WORD), pDst, pSrc, nSrcRows, nWidth, nChannels, x);
+}
+
+// Two destination texels at a time. The left and right texels of each pair are widened
+// to 32 bit lanes, the colour lanes decoded with a gather from the lookup table and the
+// alpha lanes converted as they are, so both are summed as floats in the order of the
+// C kernel. The alpha sums are whole numbers and the scale a power of two, so truncating
+// gives the same alpha as the integer average.
+static void BoxFilterRow8LinearAVX2(BYTE* pDst, BYTE* pSrc[4], int nSrcRows, int nWidth, int nChannels, bool bDiffWidths)
+{
+    if(!bDiffWidths)
+    {
+        BoxFilterRow8Linear(pDst, pSrc, nSrcRows, nWidth, nChannels, bDiffWidths);
+        return;
+    }
+
+    const __m256 scale = _mm256_set1_ps(1.f / (nSrcRows * 2));
+    const __m256 round = _mm256_set1_ps((float)nSrcRows);
+    int x = 0;
+    for(; x + 2 <= nWidth; x += 2)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        for(int r=0; r<nSrcRows; r++)
+        {
+            const BYTE* pRow = pSrc[r] + 2 * x * sizeof(COLOR);
+            __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)pRow));
+            __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pRow + 2 * sizeof(COLOR))));
+            __m256i left  = _mm256_permute2x128_si256(a, b, 0x20);
+            __m256i right = _mm256_permute2x128_si256(a, b, 0x31);
+            __m256 fLeft  = _mm256_blend_ps(_mm256_i32gather_ps(g_fSRGBToLinear, left, 4), _mm256_cvtepi32_ps(left), 0x88);
+            __m256 fRight = _mm256_blend_ps(_mm256_i32gather_ps(g_fSRGBToLinear, right, 4), _mm256_cvtepi32_ps(right), 0x88);
+            sum = _mm256_add_ps(_mm256_add_ps(sum, fLeft), fRight);
+        }
+
+        __m256i colour = LinearToSRGBAVX2(_mm256_mul_ps(sum, scale));
+        __m256i alpha = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(sum, round), scale));
+        __m256i codes = _mm256_blend_epi32(colour, alpha, 0x88);
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(codes), _mm256_extracti128_si256(codes, 1));
+        _mm_storel_epi64((__m128i*)(pDst + x * sizeof(COLOR)), _mm_packus_epi16(packed, packed));
+    }
+    _mm256_zeroupper();
+
+    BoxFilterRowTail(BoxFilterRow8Linear, sizeof(COLOR), pDst, pSrc, nSrcRows, nWidth, nChannels, x);
+}
+#endif // USE_AVX2
+
+// Picks the kernels from the CPU features allowed by CMP_SetCPUFeatureMask
+static BoxFilterKernels GetBoxFilterKernels()
+{
+    BoxFilterKernels kernels = {BoxFilterRow8, BoxFilterRow8Linear, BoxFilterRow16, BoxFilterRow16F, BoxFilterRow32F};
+    CMP_DWORD dwCPUFeatures = CMP_GetCPUFeatures();
+#ifdef USE_SSE
+    if(dwCPUFeatures & CMP_CPU_FEATURE_SSE2)
+    {
+        kernels.pRow8       = BoxFilterRow8SSE2;
+        kernels.pRow16      = BoxFilterRow16SSE2;
+        kernels.pRow32F     = BoxFilterRow32FSSE2;
+    }
+#endif // USE_SSE
+#ifdef USE_AVX2
+    if(dwCPUFeatures & CMP_CPU_FEATURE_AVX2)
+    {
+        kernels.pRow8       = BoxFilterRow8AVX2;
+        kernels.pRow8Linear = BoxFilterRow8LinearAVX2;
+        kernels.pRow32F     = BoxFilterRow32FAVX2;
+        if(dwCPUFeatures & CMP_CPU_FEATURE_F16C)
+            kernels.pRow16F = BoxFilterRow16FF16C;
+    }
+#endif // USE_AVX2
+    UNREFERENCED_PARAMETER(dwCPUFeatures);
+    return kernels;
+}
+
+typedef struct
+{
+    BoxFilterRowProc    pRowProc;
+    int                 nChannels;
+    DWORD               dwTexelSize;
+    MipLevel*           pCurMipLevel;
+    MipLevel*           pPrevMipLevelOne;
+    MipLevel*           pPrevMipLevelTwo;
+    int                 nFirstRow;
+    int                 nRows;
+} BoxFilterBand;
+
+static void GenerateMipRows(const BoxFilterBand* pBand)
+{
+    MipLevel* pCurMipLevel = pBand->pCurMipLevel;
+    MipLevel* pPrevMipLevelOne = pBand->pPrevMipLevelOne;
+    MipLevel* pPrevMipLevelTwo = pBand->pPrevMipLevelTwo;
+
+    //if no change in height or width, then use the same line or texel of the source
+    bool bDiffHeights = pCurMipLevel->m_nHeight != pPrevMipLevelOne->m_nHeight;
+    bool bDiffWidths = pCurMipLevel->m_nWidth != pPrevMipLevelOne->m_nWidth;
+    DWORD dwSrcPitch = pPrevMipLevelOne->m_nWidth * pBand->dwTexelSize;
+    DWORD dwDstPitch = pCurMipLevel->m_nWidth * pBand->dwTexelSize;
+    int nSrcRows = pPrevMipLevelTwo ? 4 : 2;
+
+    for(int y=pBand->nFirstRow; y<pBand->nFirstRow + pBand->nRows; y++)
+    {
+        BYTE* pSrc[4];
+        pSrc[0] = pPrevMipLevelOne->m_pbData + (2 * y * dwSrcPitch);
+        pSrc[1] = bDiffHeights ? pSrc[0] + dwSrcPitch : pSrc[0];
+        if(pPrevMipLevelTwo)
+        {
+            //working with volume texture, avg both slices together as well as 4 corners
+            pSrc[2] = pPrevMipLevelTwo->m_pbData + (2 * y * dwSrcPitch);
+            pSrc[3] = bDiffHeights ? pSrc[2] + dwSrcPitch : pSrc[2];
         }
+        pBand->pRowProc(pCurMipLevel->m_pbData + (y * dwDstPitch), pSrc, nSrcRows, pCurMipLevel->m_nWidth, pBand->nChannels, bDiffWidths);
+    }
+}
+
+static unsigned int _stdcall GenerateMipRowsThreadProc(void* param)
+{
+    GenerateMipRows((BoxFilterBand*)param);
+    return 0;
+}
+
+// Splits the rows of the level into bands, the last band is done on the calling thread
+static void GenerateMipLevelRows(BoxFilterRowProc pRowProc, int nChannels, DWORD dwTexelSize, MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo)
+{
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    int nTexels = pCurMipLevel->m_nWidth * pCurMipLevel->m_nHeight;
+    int nThreads = min((int)systemInfo.dwNumberOfProcessors, BOXFILTER_MAX_THREADS);
+    nThreads = max(min(nThreads, min(nTexels / BOXFILTER_MIN_THREAD_TEXELS, pCurMipLevel->m_nHeight)), 1);
+
+    BoxFilterBand bands[BOXFILTER_MAX_THREADS];
+    HANDLE ahThread[BOXFILTER_MAX_THREADS];
+    DWORD dwLiveThreads = 0;
+    int nFirstRow = 0;
+    for(int t=0; t<nThreads; t++)
+    {
+        BoxFilterBand& band = bands[t];
+        band.pRowProc         = pRowProc;
+        band.nChannels        = nChannels;
+        band.dwTexelSize      = dwTexelSize;
+        band.pCurMipLevel     = pCurMipLevel;
+        band.pPrevMipLevelOne = pPrevMipLevelOne;
+        band.pPrevMipLevelTwo = pPrevMipLevelTwo;
+        band.nFirstRow        = nFirstRow;
+        band.nRows            = (pCurMipLevel->m_nHeight - nFirstRow) / (nThreads - t);
+        nFirstRow += band.nRows;
+
+        HANDLE hThread = NULL;
+        if(t + 1 < nThreads)
+            hThread = (HANDLE)_beginthreadex(NULL, 0, GenerateMipRowsThreadProc, &band, 0, NULL);
+        if(hThread)
+            ahThread[dwLiveThreads++] = hThread;
+        else
+            GenerateMipRows(&band);
+    }
+
+    if(dwLiveThreads > 0)
+    {
+        WaitForMultipleObjects(dwLiveThreads, ahThread, TRUE, INFINITE);
+        for(DWORD i=0; i<dwLiveThreads; i++)
+            CloseHandle(ahThread[i]);
+    }
+}
+
+void GenerateMipLevel(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo, int nChannels)
+{
+    assert(pCurMipLevel);
+    assert(pPrevMipLevelOne);
+
+    if(pCurMipLevel && pPrevMipLevelOne)
+        GenerateMipLevelRows(GetBoxFilterKernels().pRow8, nChannels, nChannels * sizeof(BYTE), pCurMipLevel, pPrevMipLevelOne, pPrevMipLevelTwo);
+}
+
+// As GenerateMipLevel for sRGB encoded levels, averaging the colour channels in linear light
+void GenerateMipLevelSRGB(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo, int nChannels)
+{
+    assert(pCurMipLevel);
+    assert(pPrevMipLevelOne);
+    assert(nChannels == 4);
+    UNREFERENCED_PARAMETER(nChannels);
+
+    if(pCurMipLevel && pPrevMipLevelOne)
+    {
+        InitSRGBTables();
+        GenerateMipLevelRows(GetBoxFilterKernels().pRow8Linear, 4, sizeof(COLOR), pCurMipLevel, pPrevMipLevelOne, pPrevMipLevelTwo);
+    }
+}
+
+void GenerateMipLevel16(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo, int nChannels)
+{
+    assert(pCurMipLevel);
+    assert(pPrevMipLevelOne);
+
+    if(pCurMipLevel && pPrevMipLevelOne)
+        GenerateMipLevelRows(GetBoxFilterKernels().pRow16, nChannels, nChannels * sizeof(WORD), pCurMipLevel, pPrevMipLevelOne, pPrevMipLevelTwo);
+}
+
+void GenerateMipLevel16F(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo, int nChannels)
+{
+    assert(pCurMipLevel);
+    assert(pPrevMipLevelOne);
+
+    if(pCurMipLevel && pPrevMipLevelOne)
+        GenerateMipLevelRows(GetBoxFilterKernels().pRow16F, nChannels, nChannels * sizeof(WORD), pCurMipLevel, pPrevMipLevelOne, pPrevMipLevelTwo);
+}
+
+void GenerateMipLevel32F(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo, int nChannels)
+{
+    assert(pCurMipLevel);
+    assert(pPrevMipLevelOne);
+
+    if(pCurMipLevel && pPrevMipLevelOne)
+    {
+        assert(pPrevMipLevelTwo || pCurMipLevel->m_nHeight != pPrevMipLevelOne->m_nHeight || pCurMipLevel->m_nWidth != pPrevMipLevelOne->m_nWidth);
+        GenerateMipLevelRows(GetBoxFilterKernels().pRow32F, nChannels, nChannels * sizeof(float), pCurMipLevel, pPrevMipLevelOne, pPrevMipLevelTwo);
     }
 }
@@ -45,8 +45,11 @@ class Plugin_BoxFilter : public PluginInterface_Filters
 };
 
 
-void GenerateMipLevel(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo = NULL);
-void GenerateMipLevel32F(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo = NULL);
+void GenerateMipLevel(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo = NULL, int nChannels = 4);
+void GenerateMipLevelSRGB(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo = NULL, int nChannels = 4);
+void GenerateMipLevel16(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo = NULL, int nChannels = 4);
+void GenerateMipLevel16F(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo = NULL, int nChannels = 4);
+void GenerateMipLevel32F(MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo = NULL, int nChannels = 4);
 
 extern void *make_Plugin_BoxFIlter();
 
@@ -0,0 +1,100 @@
+//=====================================================================
+// Copyright 2016 (c), Advanced Micro Devices, Inc. All rights reserved.
+//=====================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef _PLUGIN_HALFFLOAT_H
+#define _PLUGIN_HALFFLOAT_H
+
+#include <string.h>
+
+//
+// Conversions between 16 bit half floats and floats for the mip filters, giving the
+// same results as the F16C instructions with round to nearest even
+//
+inline float HalfToFloat(WORD wHalf)
+{
+    DWORD dwSign = (DWORD)(wHalf & 0x8000) << 16;
+    DWORD dwExp = (wHalf >> 10) & 0x1f;
+    DWORD dwMant = wHalf & 0x3ff;
+    DWORD dwBits;
+    if(dwExp == 0x1f)
+        dwBits = dwSign | 0x7f800000 | (dwMant ? 0x400000 | (dwMant << 13) : 0);
+    else if(dwExp != 0)
+        dwBits = dwSign | ((dwExp + 112) << 23) | (dwMant << 13);
+    else if(dwMant == 0)
+        dwBits = dwSign;
+    else
+    {
+        // Denormal, normalize the mantissa
+        DWORD dwNormExp = 113;
+        while(!(dwMant & 0x400))
+        {
+            dwMant <<= 1;
+            dwNormExp--;
+        }
+        dwBits = dwSign | (dwNormExp << 23) | ((dwMant & 0x3ff) << 13);
+    }
+
+    float f;
+    memcpy(&f, &dwBits, sizeof(f));
+    return f;
+}
+
+// Rounds to nearest even, overflows to infinity and keeps NaNs quiet
+inline WORD FloatToHalf(float f)
+{
+    DWORD dwBits;
+    memcpy(&dwBits, &f, sizeof(dwBits));
+    WORD wSign = (WORD)((dwBits >> 16) & 0x8000);
+    DWORD dwAbs = dwBits & 0x7fffffff;
+
+    if(dwAbs > 0x7f800000)
+        return wSign | 0x7e00 | (WORD)((dwAbs >> 13) & 0x3ff);
+    if(dwAbs >= 0x477ff000)
+        return wSign | 0x7c00;
+
+    DWORD dwHalf;
+    DWORD dwRem;
+    DWORD dwHalfway;
+    if(dwAbs >= 0x38800000)
+    {
+        dwHalf = (dwAbs - 0x38000000) >> 13;
+        dwRem = dwAbs & 0x1fff;
+        dwHalfway = 0x1000;
+    }
+    else if(dwAbs > 0x33000000)
+    {
+        DWORD dwMant = (dwAbs & 0x7fffff) | 0x800000;
+        int nShift = 126 - (int)(dwAbs >> 23);
+        dwHalf = dwMant >> nShift;
+        dwRem = dwMant & ((1u << nShift) - 1);
+        dwHalfway = 1u << (nShift - 1);
+    }
+    else
+        return wSign;
+
+    if(dwRem > dwHalfway || (dwRem == dwHalfway && (dwHalf & 1)))
+        dwHalf++;
+    return wSign | (WORD)dwHalf;
+}
+
+#endif
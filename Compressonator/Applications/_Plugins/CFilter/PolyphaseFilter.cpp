@@ -0,0 +1,848 @@
+//=====================================================================
+// Copyright 2016 (c), Advanced Micro Devices, Inc. All rights reserved.
+//=====================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "stdafx.h"
+#include "PolyphaseFilter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include "TC_PluginAPI.h"
+#include "TC_PluginInternal.h"
+#include "MIPS.h"
+#include "Compressonator.h"
+#include "Texture.h"
+#include "SRGB.h"
+#include "HalfFloat.h"
+#include <process.h>
+
+#ifdef USE_SSE
+#include <emmintrin.h>
+#endif // USE_SSE
+#ifdef USE_AVX2
+#include <immintrin.h>
+#endif // USE_AVX2
+
+// Each thread filters at least POLYPHASE_MIN_THREAD_TEXELS destination texels
+#define POLYPHASE_MAX_THREADS          64
+#define POLYPHASE_MIN_THREAD_TEXELS    (16 * 1024)
+
+// A 2:1 reduction needs 4 taps per unit of filter radius, 3:1 for odd sizes needs 6
+#define POLYPHASE_MAX_TAPS             64
+
+#define POLYPHASE_PI                   3.14159265358979323846
+
+// Shared with the box filter in this library, set by TC_PluginSetSharedIO
+extern CMIPS *CMips;
+
+#ifndef BUILD_AS_PLUGIN_DLL
+void *make_Plugin_KaiserFilter()   { return new Plugin_PolyphaseFilter(PF_Kaiser); }
+void *make_Plugin_LanczosFilter()  { return new Plugin_PolyphaseFilter(PF_Lanczos); }
+void *make_Plugin_MitchellFilter() { return new Plugin_PolyphaseFilter(PF_Mitchell); }
+#endif
+
+//
+// Filter functions, x is in destination texels
+//
+static double SincPi(double x)
+{
+    if(fabs(x) < 1e-6)
+        return 1.0;
+    x *= POLYPHASE_PI;
+    return sin(x) / x;
+}
+
+// Zeroth order modified Bessel function of the first kind
+static double Bessel0(double x)
+{
+    double dSum = 1.0;
+    double dTerm = 1.0;
+    double dHalfXSq = x * x * 0.25;
+    for(int k=1; k<64 && dTerm > dSum * 1e-12; k++)
+    {
+        dTerm *= dHalfXSq / (k * k);
+        dSum += dTerm;
+    }
+    return dSum;
+}
+
+static double KaiserFilter(double x)
+{
+    const double dWidth = 3.0;
+    const double dAlpha = 4.0;
+    double t = x / dWidth;
+    if(t * t >= 1.0)
+        return 0.0;
+    return SincPi(x) * Bessel0(dAlpha * sqrt(1.0 - t * t)) / Bessel0(dAlpha);
+}
+
+static double LanczosFilter(double x)
+{
+    x = fabs(x);
+    if(x >= 3.0)
+        return 0.0;
+    return SincPi(x) * SincPi(x / 3.0);
+}
+
+static double MitchellFilter(double x)
+{
+    const double B = 1.0 / 3.0;
+    const double C = 1.0 / 3.0;
+    x = fabs(x);
+    if(x < 1.0)
+        return ((12.0 - 9.0 * B - 6.0 * C) * x * x * x + (-18.0 + 12.0 * B + 6.0 * C) * x * x + (6.0 - 2.0 * B)) / 6.0;
+    if(x < 2.0)
+        return ((-B - 6.0 * C) * x * x * x + (6.0 * B + 30.0 * C) * x * x + (-12.0 * B - 48.0 * C) * x + (8.0 * B + 24.0 * C)) / 6.0;
+    return 0.0;
+}
+
+typedef struct
+{
+    double  dRadius;
+    double  (*pEvaluate)(double x);
+} PolyphaseFilterDesc;
+
+// Indexed by PolyphaseFilterType
+static const PolyphaseFilterDesc g_PolyphaseFilters[] =
+{
+    {3.0, KaiserFilter},
+    {3.0, LanczosFilter},
+    {2.0, MitchellFilter},
+};
+
+//
+// Weight table for one axis of a level. Every destination texel has its own phase:
+// nTaps normalized weights for the consecutive source texels from pFirst on. For a
+// 2:1 reduction all phases are the same, odd sizes give each texel a slightly
+// different phase. The taps may run off the edges of the source by up to nPadLeft
+// and nPadRight texels, which read the edge texel: the horizontal pass pads its
+// source row with copies of the edge texels, the vertical pass clamps the row.
+//
+typedef struct
+{
+    int     nTaps;
+    int     nPadLeft;
+    int     nPadRight;
+    int*    pFirst;
+    float*  pWeight;
+} PolyphaseTable;
+
+static void FreePolyphaseTable(PolyphaseTable* pTable)
+{
+    free(pTable->pFirst);
+    pTable->pFirst = NULL;
+    pTable->pWeight = NULL;
+}
+
+static bool BuildPolyphaseTable(PolyphaseTable* pTable, PolyphaseFilterType filterType, int nSrc, int nDst)
+{
+    const PolyphaseFilterDesc& filter = g_PolyphaseFilters[filterType];
+    double dScale = (double)nSrc / nDst;
+    double dFilterScale = max(dScale, 1.0);
+    double dSupport = filter.dRadius * dFilterScale;
+
+    // Widest footprint of any destination texel
+    int nTaps = 1;
+    for(int x=0; x<nDst; x++)
+    {
+        double dCenter = (x + 0.5) * dScale - 0.5;
+        int nFirst = (int)floor(dCenter - dSupport) + 1;
+        int nLast = (int)ceil(dCenter + dSupport) - 1;
+        nTaps = max(nTaps, nLast - nFirst + 1);
+    }
+    assert(nTaps <= POLYPHASE_MAX_TAPS);
+
+    BYTE* pData = (BYTE*)malloc(nDst * (sizeof(int) + nTaps * sizeof(float)));
+    if(pData == NULL)
+        return false;
+    pTable->nTaps = nTaps;
+    pTable->nPadLeft = 0;
+    pTable->nPadRight = 0;
+    pTable->pFirst = (int*)pData;
+    pTable->pWeight = (float*)(pTable->pFirst + nDst);
+
+    for(int x=0; x<nDst; x++)
+    {
+        double dCenter = (x + 0.5) * dScale - 0.5;
+        int nFirst = (int)floor(dCenter - dSupport) + 1;
+        float* pWeight = pTable->pWeight + x * nTaps;
+
+        double dWeights[POLYPHASE_MAX_TAPS];
+        double dTotal = 0.0;
+        for(int t=0; t<nTaps; t++)
+        {
+            dWeights[t] = filter.pEvaluate((nFirst + t - dCenter) / dFilterScale);
+            dTotal += dWeights[t];
+        }
+        for(int t=0; t<nTaps; t++)
+            pWeight[t] = (float)(dWeights[t] / dTotal);
+        pTable->pFirst[x] = nFirst;
+        pTable->nPadLeft = max(pTable->nPadLeft, -nFirst);
+        pTable->nPadRight = max(pTable->nPadRight, nFirst + nTaps - nSrc);
+    }
+    return true;
+}
+
+//
+// Kernels. The rows are processed as 4 floats per texel whatever the channel count,
+// the horizontal kernel filters a padded source row into a cached row and the
+// vertical kernel combines cached rows. The horizontal kernels add the even and the
+// odd taps as two separate sums, which shortens the chain of dependent adds and
+// lets AVX2 take a pair of taps at a time. The SIMD kernels add in the same order
+// as the C kernels and do not fuse the multiply and add, so all give the same results.
+//
+typedef void (*PolyphaseHorizontalProc)(float* pDst, const float* pSrc, const PolyphaseTable* pTable, int nWidth);
+typedef void (*PolyphaseVerticalProc)(float* pDst, float* pSrc[], const float* pWeight, int nTaps, int nFloats);
+typedef void (*PolyphaseLoadProc)(float* pDst, const BYTE* pSrc, int nTexels);
+typedef void (*PolyphaseStoreProc)(BYTE* pDst, const float* pSrc, int nTexels);
+
+typedef struct
+{
+    PolyphaseHorizontalProc pHorizontal;
+    PolyphaseVerticalProc   pVertical;
+    PolyphaseLoadProc       pLoad8;         // 4 channel 8 bit texels to floats
+    PolyphaseStoreProc      pStore8;        // Floats to 4 channel 8 bit texels
+    PolyphaseLoadProc       pLoad8Linear;   // As pLoad8 with the colour channels decoded from sRGB
+    PolyphaseStoreProc      pStore8Linear;  // As pStore8 with the colour channels encoded to sRGB
+} PolyphaseKernels;
+
+// pSrc starts nPadLeft texels before the first texel of the source row
+static void PolyphaseHorizontal(float* pDst, const float* pSrc, const PolyphaseTable* pTable, int nWidth)
+{
+    int nTaps = pTable->nTaps;
+    const float* pWeight = pTable->pWeight;
+    for(int x=0; x<nWidth; x++, pWeight += nTaps)
+    {
+        const float* pTexels = pSrc + 4 * (pTable->pFirst[x] + pTable->nPadLeft);
+        float fSum[2][4] = {{0.f, 0.f, 0.f, 0.f}, {0.f, 0.f, 0.f, 0.f}};
+        for(int t=0; t<nTaps; t++)
+        {
+            for(int i=0; i<4; i++)
+                fSum[t & 1][i] += pWeight[t] * pTexels[4 * t + i];
+        }
+        for(int i=0; i<4; i++)
+            *pDst++ = fSum[0][i] + fSum[1][i];
+    }
+}
+
+static void PolyphaseVertical(float* pDst, float* pSrc[], const float* pWeight, int nTaps, int nFloats)
+{
+    for(int i=0; i<nFloats; i++)
+    {
+        float fSum = 0.f;
+        for(int t=0; t<nTaps; t++)
+            fSum += pWeight[t] * pSrc[t][i];
+        pDst[i] = fSum;
+    }
+}
+
+static void PolyphaseLoad8(float* pDst, const BYTE* pSrc, int nTexels)
+{
+    for(int i=0; i<nTexels * 4; i++)
+        pDst[i] = (float)pSrc[i];
+}
+
+static void PolyphaseStore8(BYTE* pDst, const float* pSrc, int nTexels)
+{
+    for(int i=0; i<nTexels * 4; i++)
+        pDst[i] = static_cast<BYTE>(min(max(pSrc[i], 0.f), 255.f) + 0.5f);
+}
+
+// Colour channels become linear values from 0 to 1, alpha stays from 0 to 255
+static void PolyphaseLoad8Linear(float* pDst, const BYTE* pSrc, int nTexels)
+{
+    for(int x=0; x<nTexels; x++, pDst += 4, pSrc += 4)
+    {
+        pDst[0] = g_fSRGBToLinear[pSrc[0]];
+        pDst[1] = g_fSRGBToLinear[pSrc[1]];
+        pDst[2] = g_fSRGBToLinear[pSrc[2]];
+        pDst[3] = (float)pSrc[3];
+    }
+}
+
+static void PolyphaseStore8Linear(BYTE* pDst, const float* pSrc, int nTexels)
+{
+    for(int x=0; x<nTexels; x++, pDst += 4, pSrc += 4)
+    {
+        pDst[0] = LinearToSRGB(pSrc[0]);
+        pDst[1] = LinearToSRGB(pSrc[1]);
+        pDst[2] = LinearToSRGB(pSrc[2]);
+        pDst[3] = static_cast<BYTE>(min(max(pSrc[3], 0.f), 255.f) + 0.5f);
+    }
+}
+
+#ifdef USE_SSE
+static void PolyphaseHorizontalSSE2(float* pDst, const float* pSrc, const PolyphaseTable* pTable, int nWidth)
+{
+    int nTaps = pTable->nTaps;
+    const float* pWeight = pTable->pWeight;
+    for(int x=0; x<nWidth; x++, pWeight += nTaps)
+    {
+        const float* pTexels = pSrc + 4 * (pTable->pFirst[x] + pTable->nPadLeft);
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        int t = 0;
+        for(; t + 2 <= nTaps; t += 2)
+        {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(pWeight[t]), _mm_loadu_ps(pTexels + 4 * t)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_set1_ps(pWeight[t + 1]), _mm_loadu_ps(pTexels + 4 * t + 4)));
+        }
+        if(t < nTaps)
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(pWeight[t]), _mm_loadu_ps(pTexels + 4 * t)));
+        _mm_storeu_ps(pDst + 4 * x, _mm_add_ps(sum0, sum1));
+    }
+}
+
+static void PolyphaseVerticalSSE2(float* pDst, float* pSrc[], const float* pWeight, int nTaps, int nFloats)
+{
+    int i = 0;
+    for(; i + 4 <= nFloats; i += 4)
+    {
+        __m128 sum = _mm_setzero_ps();
+        for(int t=0; t<nTaps; t++)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(pWeight[t]), _mm_loadu_ps(pSrc[t] + i)));
+        _mm_storeu_ps(pDst + i, sum);
+    }
+
+    if(i < nFloats)
+    {
+        float* pTail[POLYPHASE_MAX_TAPS];
+        for(int t=0; t<nTaps; t++)
+            pTail[t] = pSrc[t] + i;
+        PolyphaseVertical(pDst + i, pTail, pWeight, nTaps, nFloats - i);
+    }
+}
+
+// 4 texels at a time, widened to 32 bit lanes
+static void PolyphaseLoad8SSE2(float* pDst, const BYTE* pSrc, int nTexels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for(; x + 4 <= nTexels; x += 4)
+    {
+        __m128i texels = _mm_loadu_si128((const __m128i*)(pSrc + 4 * x));
+        __m128i lo = _mm_unpacklo_epi8(texels, zero);
+        __m128i hi = _mm_unpackhi_epi8(texels, zero);
+        _mm_storeu_ps(pDst + 4 * x,      _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_ps(pDst + 4 * x + 4,  _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_ps(pDst + 4 * x + 8,  _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_ps(pDst + 4 * x + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+    }
+    PolyphaseLoad8(pDst + 4 * x, pSrc + 4 * x, nTexels - x);
+}
+
+// Clamped and rounded like PolyphaseStore8, then packed with saturation
+static void PolyphaseStore8SSE2(BYTE* pDst, const float* pSrc, int nTexels)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 limit = _mm_set1_ps(255.f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    int x = 0;
+    for(; x + 4 <= nTexels; x += 4)
+    {
+        __m128i c[4];
+        for(int i=0; i<4; i++)
+        {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSrc + 4 * (x + i)), zero), limit);
+            c[i] = _mm_cvttps_epi32(_mm_add_ps(v, half));
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x), packed);
+    }
+    PolyphaseStore8(pDst + 4 * x, pSrc + 4 * x, nTexels - x);
+}
+#endif // USE_SSE
+
+#ifdef USE_AVX2
+// A pair of taps at a time, the even tap in the low lane and the odd tap in the high lane
+static void PolyphaseHorizontalAVX2(float* pDst, const float* pSrc, const PolyphaseTable* pTable, int nWidth)
+{
+    const __m256i pairIndex = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+    int nTaps = pTable->nTaps;
+    const float* pWeight = pTable->pWeight;
+    for(int x=0; x<nWidth; x++, pWeight += nTaps)
+    {
+        const float* pTexels = pSrc + 4 * (pTable->pFirst[x] + pTable->nPadLeft);
+        __m256 sum = _mm256_setzero_ps();
+        int t = 0;
+        for(; t + 2 <= nTaps; t += 2)
+        {
+            __m128 weights = _mm_castpd_ps(_mm_load_sd((const double*)(pWeight + t)));
+            __m256 weight = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(weights), pairIndex);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(weight, _mm256_loadu_ps(pTexels + 4 * t)));
+        }
+        __m128 sum0 = _mm256_castps256_ps128(sum);
+        __m128 sum1 = _mm256_extractf128_ps(sum, 1);
+        if(t < nTaps)
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(pWeight[t]), _mm_loadu_ps(pTexels + 4 * t)));
+        _mm_storeu_ps(pDst + 4 * x, _mm_add_ps(sum0, sum1));
+    }
+    _mm256_zeroupper();
+}
+
+static void PolyphaseVerticalAVX2(float* pDst, float* pSrc[], const float* pWeight, int nTaps, int nFloats)
+{
+    int i = 0;
+    for(; i + 8 <= nFloats; i += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        for(int t=0; t<nTaps; t++)
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(pWeight[t]), _mm256_loadu_ps(pSrc[t] + i)));
+        _mm256_storeu_ps(pDst + i, sum);
+    }
+    _mm256_zeroupper();
+
+    if(i < nFloats)
+    {
+        float* pTail[POLYPHASE_MAX_TAPS];
+        for(int t=0; t<nTaps; t++)
+            pTail[t] = pSrc[t] + i;
+        PolyphaseVerticalSSE2(pDst + i, pTail, pWeight, nTaps, nFloats - i);
+    }
+}
+
+// 2 texels at a time, the colour lanes gathered from the lookup table
+static void PolyphaseLoad8LinearAVX2(float* pDst, const BYTE* pSrc, int nTexels)
+{
+    int x = 0;
+    for(; x + 2 <= nTexels; x += 2)
+    {
+        __m256i texels = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pSrc + 4 * x)));
+        __m256 linear = _mm256_i32gather_ps(g_fSRGBToLinear, texels, 4);
+        _mm256_storeu_ps(pDst + 4 * x, _mm256_blend_ps(linear, _mm256_cvtepi32_ps(texels), 0x88));
+    }
+    _mm256_zeroupper();
+    PolyphaseLoad8Linear(pDst + 4 * x, pSrc + 4 * x, nTexels - x);
+}
+
+// 4 texels at a time, alpha rounded like PolyphaseStore8
+static void PolyphaseStore8LinearAVX2(BYTE* pDst, const float* pSrc, int nTexels)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 limit = _mm256_set1_ps(255.f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    int x = 0;
+    for(; x + 4 <= nTexels; x += 4)
+    {
+        __m128i c[4];
+        for(int i=0; i<2; i++)
+        {
+            __m256 v = _mm256_loadu_ps(pSrc + 4 * x + 8 * i);
+            __m256i alpha = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_min_ps(_mm256_max_ps(v, zero), limit), half));
+            __m256i codes = _mm256_blend_epi32(LinearToSRGBAVX2(v), alpha, 0x88);
+            c[2 * i]     = _mm256_castsi256_si128(codes);
+            c[2 * i + 1] = _mm256_extracti128_si256(codes, 1);
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x), packed);
+    }
+    _mm256_zeroupper();
+    PolyphaseStore8Linear(pDst + 4 * x, pSrc + 4 * x, nTexels - x);
+}
+#endif // USE_AVX2
+
+// Picks the kernels from the CPU features allowed by CMP_SetCPUFeatureMask
+static PolyphaseKernels GetPolyphaseKernels()
+{
+    PolyphaseKernels kernels = {PolyphaseHorizontal, PolyphaseVertical, PolyphaseLoad8, PolyphaseStore8, PolyphaseLoad8Linear, PolyphaseStore8Linear};
+    CMP_DWORD dwCPUFeatures = CMP_GetCPUFeatures();
+#ifdef USE_SSE
+    if(dwCPUFeatures & CMP_CPU_FEATURE_SSE2)
+    {
+        kernels.pHorizontal = PolyphaseHorizontalSSE2;
+        kernels.pVertical   = PolyphaseVerticalSSE2;
+        kernels.pLoad8      = PolyphaseLoad8SSE2;
+        kernels.pStore8     = PolyphaseStore8SSE2;
+    }
+#endif // USE_SSE
+#ifdef USE_AVX2
+    if(dwCPUFeatures & CMP_CPU_FEATURE_AVX2)
+    {
+        kernels.pHorizontal     = PolyphaseHorizontalAVX2;
+        kernels.pVertical       = PolyphaseVerticalAVX2;
+        kernels.pLoad8Linear    = PolyphaseLoad8LinearAVX2;
+        kernels.pStore8Linear   = PolyphaseStore8LinearAVX2;
+    }
+#endif // USE_AVX2
+    UNREFERENCED_PARAMETER(dwCPUFeatures);
+    return kernels;
+}
+
+//
+// Format conversion of a row between the MipSet and 4 floats per texel
+//
+
+// With bLinear the first three 8 bit channels are sRGB colour, the fourth is alpha
+static void LoadRow(const PolyphaseKernels* pKernels, ChannelFormat channelFormat, int nChannels, bool bLinear, float* pDst, const BYTE* pSrc, int nTexels)
+{
+    if(channelFormat == CF_8bit && nChannels == 4)
+    {
+        if(bLinear)
+            pKernels->pLoad8Linear(pDst, pSrc, nTexels);
+        else
+            pKernels->pLoad8(pDst, pSrc, nTexels);
+        return;
+    }
+
+    for(int x=0; x<nTexels; x++, pDst += 4)
+    {
+        for(int i=0; i<4; i++)
+        {
+            if(i >= nChannels)
+                pDst[i] = 0.f;
+            else if(channelFormat == CF_8bit)
+                pDst[i] = bLinear ? g_fSRGBToLinear[pSrc[x * nChannels + i]] : (float)pSrc[x * nChannels + i];
+            else if(channelFormat == CF_Float16)
+                pDst[i] = HalfToFloat(((const WORD*)pSrc)[x * nChannels + i]);
+            else
+                pDst[i] = ((const float*)pSrc)[x * nChannels + i];
+        }
+    }
+}
+
+static void StoreRow(const PolyphaseKernels* pKernels, ChannelFormat channelFormat, int nChannels, bool bLinear, BYTE* pDst, const float* pSrc, int nTexels)
+{
+    if(channelFormat == CF_8bit && nChannels == 4)
+    {
+        if(bLinear)
+            pKernels->pStore8Linear(pDst, pSrc, nTexels);
+        else
+            pKernels->pStore8(pDst, pSrc, nTexels);
+        return;
+    }
+
+    for(int x=0; x<nTexels; x++, pSrc += 4)
+    {
+        for(int i=0; i<nChannels; i++)
+        {
+            if(channelFormat == CF_8bit && bLinear)
+                pDst[x * nChannels + i] = LinearToSRGB(pSrc[i]);
+            else if(channelFormat == CF_8bit)
+                pDst[x * nChannels + i] = static_cast<BYTE>(min(max(pSrc[i], 0.f), 255.f) + 0.5f);
+            else if(channelFormat == CF_Float16)
+                ((WORD*)pDst)[x * nChannels + i] = FloatToHalf(pSrc[i]);
+            else
+                ((float*)pDst)[x * nChannels + i] = pSrc[i];
+        }
+    }
+}
+
+static DWORD GetTexelSize(ChannelFormat channelFormat, int nChannels)
+{
+    switch(channelFormat)
+    {
+        case CF_8bit:       return nChannels;
+        case CF_Float16:    return nChannels * sizeof(WORD);
+        default:            return nChannels * sizeof(float);
+    }
+}
+
+//
+// Band of destination rows filtered by one thread
+//
+typedef struct
+{
+    const PolyphaseKernels* pKernels;
+    ChannelFormat           channelFormat;
+    int                     nChannels;
+    bool                    bLinear;    // 8 bit sRGB colour filtered in linear light
+    const PolyphaseTable*   pTableX;
+    const PolyphaseTable*   pTableY;
+    MipLevel*               pCurMipLevel;
+    MipLevel*               pPrevMipLevelOne;
+    MipLevel*               pPrevMipLevelTwo;
+    int                     nFirstRow;
+    int                     nRows;
+    float*                  pWork;      // Cache rows, a row for the second slice, then the padded source row
+} PolyphaseBand;
+
+// Floats of working memory a band needs
+static size_t GetBandWorkSize(const PolyphaseTable* pTableX, const PolyphaseTable* pTableY, int nSrcWidth, int nDstWidth)
+{
+    int nLoadWidth = max(pTableX->nPadLeft + nSrcWidth + pTableX->nPadRight, nDstWidth);
+    return ((size_t)(pTableY->nTaps + 1) * nDstWidth + nLoadWidth) * 4;
+}
+
+// Horizontal pass of one source row into a cache row, averaged with the next slice for volumes
+static void FilterSourceRow(const PolyphaseBand* pBand, int nRow, float* pDst, float* pSlice, float* pLoad)
+{
+    const PolyphaseKernels* pKernels = pBand->pKernels;
+    const PolyphaseTable* pTableX = pBand->pTableX;
+    int nSrcWidth = pBand->pPrevMipLevelOne->m_nWidth;
+    int nDstWidth = pBand->pCurMipLevel->m_nWidth;
+    DWORD dwSrcPitch = nSrcWidth * GetTexelSize(pBand->channelFormat, pBand->nChannels);
+    float* pRow = pLoad + 4 * pTableX->nPadLeft;
+
+    MipLevel* pSrcLevels[2] = {pBand->pPrevMipLevelOne, pBand->pPrevMipLevelTwo};
+    for(int s=0; s<2 && pSrcLevels[s]; s++)
+    {
+        const BYTE* pSrc = pSrcLevels[s]->m_pbData + nRow * dwSrcPitch;
+        if(pBand->channelFormat == CF_Float32 && pBand->nChannels == 4)
+            memcpy(pRow, pSrc, nSrcWidth * 4 * sizeof(float));
+        else
+            LoadRow(pKernels, pBand->channelFormat, pBand->nChannels, pBand->bLinear, pRow, pSrc, nSrcWidth);
+
+        for(int x=1; x<=pTableX->nPadLeft; x++)
+            memcpy(pRow - 4 * x, pRow, 4 * sizeof(float));
+        for(int x=0; x<pTableX->nPadRight; x++)
+            memcpy(pRow + 4 * (nSrcWidth + x), pRow + 4 * (nSrcWidth - 1), 4 * sizeof(float));
+
+        pKernels->pHorizontal(s == 0 ? pDst : pSlice, pLoad, pTableX, nDstWidth);
+    }
+
+    if(pBand->pPrevMipLevelTwo)
+    {
+        float* pSlices[2] = {pDst, pSlice};
+        const float fHalves[2] = {0.5f, 0.5f};
+        pKernels->pVertical(pDst, pSlices, fHalves, 2, nDstWidth * 4);
+    }
+}
+
+static void GeneratePolyphaseRows(const PolyphaseBand* pBand)
+{
+    const PolyphaseKernels* pKernels = pBand->pKernels;
+    const PolyphaseTable* pTableY = pBand->pTableY;
+    int nSrcHeight = pBand->pPrevMipLevelOne->m_nHeight;
+    int nDstWidth = pBand->pCurMipLevel->m_nWidth;
+    int nTaps = pTableY->nTaps;
+    DWORD dwDstPitch = nDstWidth * GetTexelSize(pBand->channelFormat, pBand->nChannels);
+    bool bDirect = pBand->channelFormat == CF_Float32 && pBand->nChannels == 4;
+
+    // The taps of a row are a window of consecutive source rows, so a row is kept in
+    // the cache slot given by its unclamped index modulo nTaps until the window moves on
+    float* pCache = pBand->pWork;
+    float* pSlice = pCache + (size_t)nTaps * nDstWidth * 4;
+    float* pLoad = pSlice + nDstWidth * 4;
+    int nCacheRow[POLYPHASE_MAX_TAPS];
+    for(int t=0; t<nTaps; t++)
+        nCacheRow[t] = INT_MIN;
+
+    for(int y=pBand->nFirstRow; y<pBand->nFirstRow + pBand->nRows; y++)
+    {
+        float* pRows[POLYPHASE_MAX_TAPS];
+        int nFirst = pTableY->pFirst[y];
+        for(int t=0; t<nTaps; t++)
+        {
+            int nRow = nFirst + t;
+            int nSlot = ((nRow % nTaps) + nTaps) % nTaps;
+            pRows[t] = pCache + (size_t)nSlot * nDstWidth * 4;
+            if(nCacheRow[nSlot] != nRow)
+            {
+                FilterSourceRow(pBand, min(max(nRow, 0), nSrcHeight - 1), pRows[t], pSlice, pLoad);
+                nCacheRow[nSlot] = nRow;
+            }
+        }
+
+        BYTE* pDst = pBand->pCurMipLevel->m_pbData + y * dwDstPitch;
+        const float* pWeight = pTableY->pWeight + y * nTaps;
+        if(bDirect)
+            pKernels->pVertical((float*)pDst, pRows, pWeight, nTaps, nDstWidth * 4);
+        else
+        {
+            pKernels->pVertical(pLoad, pRows, pWeight, nTaps, nDstWidth * 4);
+            StoreRow(pKernels, pBand->channelFormat, pBand->nChannels, pBand->bLinear, pDst, pLoad, nDstWidth);
+        }
+    }
+}
+
+static unsigned int _stdcall GeneratePolyphaseRowsThreadProc(void* param)
+{
+    GeneratePolyphaseRows((PolyphaseBand*)param);
+    return 0;
+}
+
+// Splits the rows of the level into bands, the last band is done on the calling thread
+static bool GeneratePolyphaseLevel(const PolyphaseKernels* pKernels, ChannelFormat channelFormat, int nChannels, bool bLinear,
+                                   const PolyphaseTable* pTableX, const PolyphaseTable* pTableY,
+                                   MipLevel* pCurMipLevel, MipLevel* pPrevMipLevelOne, MipLevel* pPrevMipLevelTwo)
+{
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    int nTexels = pCurMipLevel->m_nWidth * pCurMipLevel->m_nHeight;
+    int nThreads = min((int)systemInfo.dwNumberOfProcessors, POLYPHASE_MAX_THREADS);
+    nThreads = max(min(nThreads, min(nTexels / POLYPHASE_MIN_THREAD_TEXELS, pCurMipLevel->m_nHeight)), 1);
+
+    size_t nWorkSize = GetBandWorkSize(pTableX, pTableY, pPrevMipLevelOne->m_nWidth, pCurMipLevel->m_nWidth);
+    float* pWork = (float*)malloc(nThreads * nWorkSize * sizeof(float));
+    if(pWork == NULL)
+        return false;
+
+    PolyphaseBand bands[POLYPHASE_MAX_THREADS];
+    HANDLE ahThread[POLYPHASE_MAX_THREADS];
+    DWORD dwLiveThreads = 0;
+    int nFirstRow = 0;
+    for(int t=0; t<nThreads; t++)
+    {
+        PolyphaseBand& band = bands[t];
+        band.pKernels         = pKernels;
+        band.channelFormat    = channelFormat;
+        band.nChannels        = nChannels;
+        band.bLinear          = bLinear;
+        band.pTableX          = pTableX;
+        band.pTableY          = pTableY;
+        band.pCurMipLevel     = pCurMipLevel;
+        band.pPrevMipLevelOne = pPrevMipLevelOne;
+        band.pPrevMipLevelTwo = pPrevMipLevelTwo;
+        band.nFirstRow        = nFirstRow;
+        band.nRows            = (pCurMipLevel->m_nHeight - nFirstRow) / (nThreads - t);
+        band.pWork            = pWork + t * nWorkSize;
+        nFirstRow += band.nRows;
+
+        HANDLE hThread = NULL;
+        if(t + 1 < nThreads)
+            hThread = (HANDLE)_beginthreadex(NULL, 0, GeneratePolyphaseRowsThreadProc, &band, 0, NULL);
+        if(hThread)
+            ahThread[dwLiveThreads++] = hThread;
+        else
+            GeneratePolyphaseRows(&band);
+    }
+
+    if(dwLiveThreads > 0)
+    {
+        WaitForMultipleObjects(dwLiveThreads, ahThread, TRUE, INFINITE);
+        for(DWORD i=0; i<dwLiveThreads; i++)
+            CloseHandle(ahThread[i]);
+    }
+
+    free(pWork);
+    return true;
+}
+
+Plugin_PolyphaseFilter::Plugin_PolyphaseFilter(PolyphaseFilterType filterType)
+{
+    m_FilterType = filterType;
+}
+
+Plugin_PolyphaseFilter::~Plugin_PolyphaseFilter()
+{
+}
+
+int Plugin_PolyphaseFilter::TC_PluginSetSharedIO(void* Shared)
+{
+    if (Shared)
+    {
+        CMips = static_cast<CMIPS *>(Shared);
+        return 0;
+    }
+    return 1;
+}
+
+int Plugin_PolyphaseFilter::TC_PluginGetVersion(TC_PluginVersion* pPluginVersion)
+{
+    pPluginVersion->guid                    = g_GUID_PolyphaseFilter;
+    pPluginVersion->dwAPIVersionMajor       = TC_API_VERSION_MAJOR;
+    pPluginVersion->dwAPIVersionMinor       = TC_API_VERSION_MINOR;
+    pPluginVersion->dwPluginVersionMajor    = TC_POLYPHASEFILTER_VERSION_MAJOR;
+    pPluginVersion->dwPluginVersionMinor    = TC_POLYPHASEFILTER_VERSION_MINOR;
+    return 0;
+}
+
+//nMinSize : The size in pixels used to determine how many mip levels to generate, as for the box filter.
+//The new levels follow the last level the MipSet already has.
+int Plugin_PolyphaseFilter::TC_GenerateMIPLevels(MipSet *pMipSet, int nMinSize)
+{
+    assert(pMipSet);
+    assert(pMipSet->m_nMipLevels);
+
+    if(pMipSet->m_ChannelFormat != CF_8bit && pMipSet->m_ChannelFormat != CF_Float16 && pMipSet->m_ChannelFormat != CF_Float32)
+        return PE_Unknown;
+
+    int nChannels;
+    switch(pMipSet->m_TextureDataType)
+    {
+        case TDT_XRGB:
+        case TDT_ARGB:
+        case TDT_NORMAL_MAP:    nChannels = 4; break;
+        case TDT_RG:            nChannels = 2; break;
+        case TDT_R:             nChannels = 1; break;
+        default:                return PE_Unknown;
+    }
+
+    // sRGB encoded 8 bit levels are filtered in linear light
+    bool bLinear = pMipSet->m_ChannelFormat == CF_8bit && (pMipSet->m_Flags & MS_FLAG_sRGB);
+    if(bLinear)
+        InitSRGBTables();
+
+    PolyphaseKernels kernels = GetPolyphaseKernels();
+    MipLevel* pLastMipLevel = CMips->GetMipLevel(pMipSet, pMipSet->m_nMipLevels-1);
+    int nWidth = pLastMipLevel->m_nWidth;
+    int nHeight = pLastMipLevel->m_nHeight;
+
+    while(nWidth > nMinSize && nHeight > nMinSize)
+    {
+        int nPrevWidth = nWidth;
+        int nPrevHeight = nHeight;
+        nWidth = max(nWidth >> 1, 1);
+        nHeight = max(nHeight >> 1, 1);
+        int nCurMipLevel = pMipSet->m_nMipLevels;
+        bool bVolumeSlices = pMipSet->m_TextureType == TT_VolumeTexture && MaxFacesOrSlices(pMipSet, nCurMipLevel-1) > 1;
+        int maxFacesOrSlices = max((pMipSet->m_TextureType == TT_VolumeTexture) ? (MaxFacesOrSlices(pMipSet, nCurMipLevel-1)>>1) : MaxFacesOrSlices(pMipSet, nCurMipLevel-1), 1);
+
+        // The tables are shared by all the faces or slices of the level
+        PolyphaseTable tableX = {0};
+        PolyphaseTable tableY = {0};
+        if(!BuildPolyphaseTable(&tableX, m_FilterType, nPrevWidth, nWidth) || !BuildPolyphaseTable(&tableY, m_FilterType, nPrevHeight, nHeight))
+        {
+            FreePolyphaseTable(&tableX);
+            return PE_Unknown;
+        }
+
+        int nResult = PE_OK;
+        for(int nFaceOrSlice=0; nFaceOrSlice<maxFacesOrSlices && nResult == PE_OK; nFaceOrSlice++)
+        {
+            MipLevel* pThisMipLevel = CMips->GetMipLevel(pMipSet, nCurMipLevel, nFaceOrSlice);
+            if((pThisMipLevel->m_pbData == NULL || pThisMipLevel->m_nWidth != nWidth || pThisMipLevel->m_nHeight != nHeight)
+               && !CMips->AllocateMipLevelData(pThisMipLevel, nWidth, nHeight, pMipSet->m_ChannelFormat, pMipSet->m_TextureDataType))
+            {
+                nResult = PE_Unknown;
+                break;
+            }
+
+            MipLevel* pPrevMipLevelOne;
+            MipLevel* pPrevMipLevelTwo = NULL;
+            if(bVolumeSlices)
+            {
+                pPrevMipLevelOne = CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2);
+                pPrevMipLevelTwo = CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice*2+1);
+            }
+            else
+                pPrevMipLevelOne = CMips->GetMipLevel(pMipSet, nCurMipLevel-1, nFaceOrSlice);
+            assert(pPrevMipLevelOne->m_pbData);    //prev miplevel ok
+
+            if(!GeneratePolyphaseLevel(&kernels, pMipSet->m_ChannelFormat, nChannels, bLinear, &tableX, &tableY, pThisMipLevel, pPrevMipLevelOne, pPrevMipLevelTwo))
+                nResult = PE_Unknown;
+        }
+
+        FreePolyphaseTable(&tableX);
+        FreePolyphaseTable(&tableY);
+        if(nResult != PE_OK)
+            return nResult;
+
+        ++pMipSet->m_nMipLevels;
+        if (nWidth == 1 || nHeight == 1)
+            break;
+    }
+
+    return PE_OK;
+}
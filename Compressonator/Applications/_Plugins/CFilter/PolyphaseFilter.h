@@ -0,0 +1,69 @@
+//=====================================================================
+// Copyright 2016 (c), Advanced Micro Devices, Inc. All rights reserved.
+//=====================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef _PLUGIN_POLYPHASEFILTER_H
+#define _PLUGIN_POLYPHASEFILTER_H
+
+#include "PluginInterface.h"
+
+// {6C0E8D1A-3B57-4F2C-9E41-5A7D2B8C9F03}
+static const GUID g_GUID_PolyphaseFilter = { 0x6c0e8d1a, 0x3b57, 0x4f2c, { 0x9e, 0x41, 0x5a, 0x7d, 0x2b, 0x8c, 0x9f, 0x03 } };
+
+#define TC_POLYPHASEFILTER_VERSION_MAJOR    1
+#define TC_POLYPHASEFILTER_VERSION_MINOR    0
+
+// Reconstruction filters for the separable mip generator
+typedef enum
+{
+    PF_Kaiser,      // Kaiser windowed sinc, radius 3, alpha 4
+    PF_Lanczos,     // Lanczos 3 lobe windowed sinc
+    PF_Mitchell,    // Mitchell-Netravali cubic, B = C = 1/3
+} PolyphaseFilterType;
+
+//
+// Generates mip levels with a separable filter. Each level is resampled from the
+// previous one with per texel weight tables computed once per level, a horizontal
+// pass into a cache of float rows and a vertical pass that writes the level.
+// Handles 8 bit, 16 bit float and 32 bit float MipSets with 1, 2 or 4 channels,
+// volume textures average each pair of slices after the 2D filter. 8 bit MipSets
+// flagged MS_FLAG_sRGB are filtered in linear light.
+//
+class Plugin_PolyphaseFilter : public PluginInterface_Filters
+{
+    public:
+        Plugin_PolyphaseFilter(PolyphaseFilterType filterType);
+        virtual ~Plugin_PolyphaseFilter();
+
+        int TC_PluginSetSharedIO(void* Shared);
+        int TC_PluginGetVersion(TC_PluginVersion* pPluginVersion);
+        int TC_GenerateMIPLevels(MipSet *pMipSet, int nMinSize);
+
+    private:
+        PolyphaseFilterType m_FilterType;
+};
+
+extern void *make_Plugin_KaiserFilter();
+extern void *make_Plugin_LanczosFilter();
+extern void *make_Plugin_MitchellFilter();
+
+#endif
@@ -0,0 +1,90 @@
+//=====================================================================
+// Copyright 2016 (c), Advanced Micro Devices, Inc. All rights reserved.
+//=====================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "stdafx.h"
+#include "SRGB.h"
+
+#include <math.h>
+#include <float.h>
+
+float   g_fSRGBToLinear[256];
+DWORD   g_dwSRGBBucket[SRGB_BUCKET_COUNT];
+float   g_fSRGBThreshold[257];
+
+static bool g_bSRGBTablesReady = false;
+
+static double SRGBToLinear(double s)
+{
+    return (s <= 0.04045) ? s / 12.92 : pow((s + 0.055) / 1.055, 2.4);
+}
+
+static double LinearToSRGBExact(double l)
+{
+    return (l <= 0.0031308) ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+}
+
+static float NextFloat(float f, int nStep)
+{
+    DWORD dwBits;
+    memcpy(&dwBits, &f, sizeof(dwBits));
+    dwBits += nStep;
+    memcpy(&f, &dwBits, sizeof(f));
+    return f;
+}
+
+void InitSRGBTables()
+{
+    if(g_bSRGBTablesReady)
+        return;
+
+    for(int i=0; i<256; i++)
+        g_fSRGBToLinear[i] = (float)SRGBToLinear(i / 255.0);
+
+    // Smallest float that rounds up to each code, found from the exact threshold
+    // by stepping a few floats either way
+    g_fSRGBThreshold[0] = 0.f;
+    for(int k=1; k<256; k++)
+    {
+        double dCode = k - 0.5;
+        float f = (float)SRGBToLinear(dCode / 255.0);
+        while(LinearToSRGBExact(f) * 255.0 >= dCode)
+            f = NextFloat(f, -1);
+        while(LinearToSRGBExact(f) * 255.0 < dCode)
+            f = NextFloat(f, 1);
+        g_fSRGBThreshold[k] = f;
+    }
+    g_fSRGBThreshold[256] = FLT_MAX;
+
+    DWORD dwCode = 0;
+    for(int i=0; i<SRGB_BUCKET_COUNT; i++)
+    {
+        DWORD dwBits = SRGB_BUCKET_BASE + (i << SRGB_BUCKET_SHIFT);
+        float fStart;
+        memcpy(&fStart, &dwBits, sizeof(fStart));
+        while(dwCode < 255 && g_fSRGBThreshold[dwCode + 1] <= fStart)
+            dwCode++;
+        g_dwSRGBBucket[i] = dwCode;
+    }
+
+    g_bSRGBTablesReady = true;
+}
@@ -0,0 +1,79 @@
+//=====================================================================
+// Copyright 2016 (c), Advanced Micro Devices, Inc. All rights reserved.
+//=====================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef _PLUGIN_SRGB_H
+#define _PLUGIN_SRGB_H
+
+#include <string.h>
+
+#ifdef USE_AVX2
+#include <immintrin.h>
+#endif // USE_AVX2
+
+//
+// Conversions between 8 bit sRGB codes and linear light for the mip filters.
+//
+// Decoding is a lookup in g_fSRGBToLinear. Encoding returns the correctly rounded
+// code of a linear value in two lookups: the floats from 2^-13 to 1 are split into
+// buckets of 2^16 consecutive bit patterns, 128 per power of two, which are narrower
+// than the gap between any two rounding thresholds. g_dwSRGBBucket holds the code at
+// the start of each bucket and one compare with g_fSRGBThreshold, the smallest linear
+// value of each code, steps to the next code if its threshold falls in the bucket.
+// Values below 2^-13 all encode to 0.
+//
+#define SRGB_BUCKET_BASE        0x39000000          // 2^-13
+#define SRGB_BUCKET_SHIFT       16
+#define SRGB_BUCKET_COUNT       ((0x3f800000 - SRGB_BUCKET_BASE) / (1 << SRGB_BUCKET_SHIFT) + 1)
+
+extern float    g_fSRGBToLinear[256];
+extern DWORD    g_dwSRGBBucket[SRGB_BUCKET_COUNT];
+extern float    g_fSRGBThreshold[257];              // [0] is unused, [256] is never reached
+
+// Fills the tables, call before the first conversion
+void InitSRGBTables();
+
+inline BYTE LinearToSRGB(float fLinear)
+{
+    const float fMin = 1.0f / 8192.0f;
+    float f = min(max(fLinear, fMin), 1.0f);
+    DWORD dwBits;
+    memcpy(&dwBits, &f, sizeof(dwBits));
+    DWORD dwCode = g_dwSRGBBucket[(dwBits - SRGB_BUCKET_BASE) >> SRGB_BUCKET_SHIFT];
+    if(f >= g_fSRGBThreshold[dwCode + 1])
+        dwCode++;
+    return static_cast<BYTE>(dwCode);
+}
+
+#ifdef USE_AVX2
+// Codes of 8 linear values as 32 bit lanes, the same as LinearToSRGB
+inline __m256i LinearToSRGBAVX2(__m256 linear)
+{
+    __m256 v = _mm256_min_ps(_mm256_max_ps(linear, _mm256_set1_ps(1.0f / 8192.0f)), _mm256_set1_ps(1.0f));
+    __m256i bucket = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_castps_si256(v), _mm256_set1_epi32(SRGB_BUCKET_BASE)), SRGB_BUCKET_SHIFT);
+    __m256i code = _mm256_i32gather_epi32((const int*)g_dwSRGBBucket, bucket, 4);
+    __m256 threshold = _mm256_i32gather_ps(g_fSRGBThreshold + 1, code, 4);
+    return _mm256_sub_epi32(code, _mm256_castps_si256(_mm256_cmp_ps(v, threshold, _CMP_GE_OQ)));
+}
+#endif // USE_AVX2
+
+#endif
@@ -298,7 +298,7 @@ int Plugin_DDS::TC_PluginFileSaveTexture(const TCHAR* pszFilename, MipSet* pMipS
    FILE* pFile = NULL;
    if(_tfopen_s(&pFile, pszFilename, _T("wb")) != 0 || pFile == NULL)
     {
-        Error(PLUGIN_NAME, EL_Error, IDS_ERROR_FILE_OPEN, pszFilename);
+        DDS_CMips->PrintError("Error [%x]: DDS Plugin Failed to save texture file %s, it may be read only or in use\n",IDS_ERROR_FILE_OPEN,pszFilename);
         return PE_Unknown;
     }
 
@@ -430,10 +430,7 @@ TC_PluginError SaveDDS_DX10(FILE* pFile, const MipSet* pMipSet)
 
     fwrite(&HeaderDDS10, sizeof(HeaderDDS10), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
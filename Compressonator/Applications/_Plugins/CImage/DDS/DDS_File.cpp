@@ -408,10 +408,7 @@ TC_PluginError SaveDDS_ABGR16(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -434,10 +431,7 @@ TC_PluginError SaveDDS_R16(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -460,10 +454,7 @@ TC_PluginError SaveDDS_RG16(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -486,10 +477,7 @@ TC_PluginError SaveDDS_ABGR16F(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -512,10 +500,7 @@ TC_PluginError SaveDDS_R16F(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -538,10 +523,7 @@ TC_PluginError SaveDDS_RG16F(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -564,10 +546,7 @@ TC_PluginError SaveDDS_ABGR32F(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -590,10 +569,7 @@ TC_PluginError SaveDDS_R32F(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -616,10 +592,7 @@ TC_PluginError SaveDDS_RG32F(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -645,10 +618,7 @@ TC_PluginError SaveDDS_FourCC(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -671,10 +641,7 @@ TC_PluginError SaveDDS_G8(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -697,10 +664,7 @@ TC_PluginError SaveDDS_A8(FILE* pFile, const MipSet* pMipSet)
     // Write the data    
     fwrite(&ddsd2, sizeof(DDSD2), 1, pFile);
 
-    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
-    for(int nSlice = 0; nSlice < nSlices; nSlice++)
-        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
-            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+    WriteMipSetData(pFile, pMipSet);
 
     fclose(pFile);
 
@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <limits.h>
+#include <io.h>
 #include "ddraw.h"
 #include "d3d9types.h"
 #include "DDS.h"
@@ -39,6 +40,9 @@
 #include "version.h"
 #include "MIPS.h"
 
+// Compressed payloads from this size up are mapped rather than read, below it a copy is cheaper
+#define DDS_MAP_MIN_SIZE    65536
+
 typedef TC_PluginError (PreLoopFunction)(FILE*& pFile, DDSD2*& pDDSD, MipSet*& pMipSet, void*& extra);
 typedef TC_PluginError (LoopFunction)(FILE*& pFile, DDSD2*& pDDSD, MipSet*& pMipSet, void*& extra, int nMipLevel, int nFaceOrSlice, DWORD dwWidth, DWORD dwHeight);
 typedef TC_PluginError (PostLoopFunction)(FILE*& pFile, DDSD2*& pDDSD, MipSet*& pMipSet, void*& extra);
@@ -263,6 +267,41 @@ TC_PluginError PreLoopFourCC(FILE*& pFile, DDSD2*& pDDSD, MipSet*& pMipSet, void
     return PE_OK;
 }
 
+// Points pMipLevel at nSize bytes from nOffset in a copy-on-write view of the whole file instead of
+// reading them, pages are only copied if the data is written to. The view belongs to the MipSet
+// and is released by FreeMipSet. The file cannot be overwritten while it is mapped, so only
+// MipSets loaded with MS_FLAG_MapFileData are mapped.
+static bool MapMipLevelData(FILE* pFile, MipSet* pMipSet, MipLevel* pMipLevel, DWORD dwWidth, DWORD dwHeight, long nOffset, long nSize)
+{
+    if(!(pMipSet->m_Flags & MS_FLAG_MapFileData) || pMipSet->m_pArenaData || pMipLevel->m_pbData)
+        return false;
+
+    HANDLE hFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(pFile)));
+    if(hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if(hMapping == NULL)
+        return false;
+    BYTE* pbView = reinterpret_cast<BYTE*>(MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0));
+    // The view keeps the mapping open
+    CloseHandle(hMapping);
+    if(pbView == NULL)
+        return false;
+
+    pMipLevel->m_nWidth = dwWidth;
+    pMipLevel->m_nHeight = dwHeight;
+    pMipLevel->m_dwLinearSize = nSize;
+    pMipLevel->m_pbData = pbView + nOffset;
+
+    pMipSet->m_pArenaData = pbView;
+    pMipSet->m_nArenaSize = nOffset + nSize;
+    pMipSet->m_Flags |= MS_FLAG_MappedData;
+
+    fseek(pFile, 0, SEEK_END);
+    return true;
+}
+
 TC_PluginError LoopFourCC(FILE*& pFile, DDSD2*&, MipSet*& pMipSet, void*& /*extra*/, 
                           int nMipLevel, int nFaceOrSlice, DWORD dwWidth, DWORD dwHeight)
 {
@@ -280,6 +319,10 @@ TC_PluginError LoopFourCC(FILE*& pFile, DDSD2*&, MipSet*& pMipSet, void*& /*extr
     long nSize = ftell(pFile) - nCurrPos;
     fseek(pFile, nCurrPos, SEEK_SET);
 
+    // Large block compressed payloads need no conversion, use them straight from the file
+    if(nSize >= DDS_MAP_MIN_SIZE && MapMipLevelData(pFile, pMipSet, pMipLevel, dwWidth, dwHeight, nCurrPos, nSize))
+        return PE_OK;
+
     if(!DDS_CMips->AllocateCompressedMipLevelData(pMipLevel, dwWidth, dwHeight, nSize))
     {
         return PE_Unknown;
@@ -889,6 +932,23 @@ bool SetupDDSD_DX10(DDSD2& ddsd2, const MipSet* pMipSet, bool /*bCompressed*/)
     return true;
 }
 
+// Writes the data of every face and level in file order, in one call when it lies in an arena
+void WriteMipSetData(FILE* pFile, const MipSet* pMipSet)
+{
+    size_t nDataSize;
+    BYTE* pbData = DDS_CMips->GetContiguousMipData(pMipSet, nDataSize);
+    if(pbData)
+    {
+        fwrite(pbData, nDataSize, 1, pFile);
+        return;
+    }
+
+    int nSlices = (pMipSet->m_TextureType == TT_2D) ? 1 : MaxFacesOrSlices(pMipSet, 0);
+    for(int nSlice = 0; nSlice < nSlices; nSlice++)
+        for(int nMipLevel = 0 ; nMipLevel < pMipSet->m_nMipLevels ; nMipLevel++)
+            fwrite(DDS_CMips->GetMipLevel(pMipSet, nMipLevel, nSlice)->m_pbData, DDS_CMips->GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize, 1, pFile);
+}
+
 TC_PluginError PreLoopABGR32(FILE*&, DDSD2*&, MipSet*& pMipSet, void*&)
 {
     pMipSet->m_dwFourCC = 0;
@@ -111,3 +111,4 @@ TC_PluginError LoopR16(FILE*& pFile, DDSD2*& , MipSet*& pMipSet, void*&, int nMi
 TC_PluginError LoopR8(FILE*& pFile, DDSD2*& , MipSet*& pMipSet, void*&,int nMipLevel, int nFaceOrSlice, DWORD dwWidth, DWORD dwHeight);
 bool SetupDDSD(DDSD2& ddsd2, const MipSet* pMipSet, bool bCompressed);
 bool SetupDDSD_DX10(DDSD2& ddsd2, const MipSet* pMipSet, bool bCompressed);
+void WriteMipSetData(FILE* pFile, const MipSet* pMipSet);
@@ -242,6 +242,15 @@ int Plugin_KTX::TC_PluginFileLoadTexture(const TCHAR* pszFilename, CMP_Texture *
         case GL_COMPRESSED_RGB8_ETC2:
             srcTexture->format = CMP_FORMAT_ETC2_RGB;
             break;
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+            srcTexture->format = CMP_FORMAT_ETC2_RGBA;
+            break;
+        case GL_COMPRESSED_R11_EAC:
+            srcTexture->format = CMP_FORMAT_EAC_R11;
+            break;
+        case GL_COMPRESSED_RG11_EAC:
+            srcTexture->format = CMP_FORMAT_EAC_RG11;
+            break;
         case COMPRESSED_FORMAT_DXT5_RxBG:
             srcTexture->format = CMP_FORMAT_DXT5_RxBG;
             break;
@@ -412,6 +421,9 @@ int Plugin_KTX::TC_PluginFileSaveTexture(const TCHAR* pszFilename, CMP_Texture *
     case  CMP_FORMAT_DXT5_xGxR:
     case  CMP_FORMAT_ETC_RGB:
     case  CMP_FORMAT_ETC2_RGB:
+    case  CMP_FORMAT_ETC2_RGBA:
+    case  CMP_FORMAT_EAC_R11:
+    case  CMP_FORMAT_EAC_RG11:
     case  CMP_FORMAT_ASTC:
     case  CMP_FORMAT_GT:
         isCompressed = true;
@@ -490,6 +502,15 @@ int Plugin_KTX::TC_PluginFileSaveTexture(const TCHAR* pszFilename, CMP_Texture *
         case CMP_FORMAT_ETC2_RGB:
             textureinfo.glInternalFormat = GL_COMPRESSED_RGB8_ETC2;
             break;
+        case CMP_FORMAT_ETC2_RGBA:
+            textureinfo.glInternalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+            break;
+        case CMP_FORMAT_EAC_R11:
+            textureinfo.glInternalFormat = GL_COMPRESSED_R11_EAC;
+            break;
+        case CMP_FORMAT_EAC_RG11:
+            textureinfo.glInternalFormat = GL_COMPRESSED_RG11_EAC;
+            break;
         case CMP_FORMAT_DXT5_xGBR:
             textureinfo.glInternalFormat = COMPRESSED_FORMAT_DXT5_xGBR;
             break;
@@ -989,6 +1010,18 @@ int Plugin_KTX::TC_PluginFileLoadTexture(const TCHAR* pszFilename, MipSet* pMipS
             pMipSet->m_format = CMP_FORMAT_ETC2_RGB;
             pMipSet->m_TextureDataType = TDT_ARGB;
             break;
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+            pMipSet->m_format = CMP_FORMAT_ETC2_RGBA;
+            pMipSet->m_TextureDataType = TDT_ARGB;
+            break;
+        case GL_COMPRESSED_R11_EAC:
+            pMipSet->m_format = CMP_FORMAT_EAC_R11;
+            pMipSet->m_TextureDataType = TDT_ARGB;
+            break;
+        case GL_COMPRESSED_RG11_EAC:
+            pMipSet->m_format = CMP_FORMAT_EAC_RG11;
+            pMipSet->m_TextureDataType = TDT_ARGB;
+            break;
         case COMPRESSED_FORMAT_DXT5_RxBG :
             pMipSet->m_format = CMP_FORMAT_DXT5_RxBG;
             pMipSet->m_TextureDataType = TDT_ARGB;
@@ -1344,6 +1377,9 @@ int Plugin_KTX::TC_PluginFileSaveTexture(const TCHAR* pszFilename, MipSet* pMipS
     case  CMP_FORMAT_DXT5_xGxR :               
     case  CMP_FORMAT_ETC_RGB :                 
     case  CMP_FORMAT_ETC2_RGB:
+    case  CMP_FORMAT_ETC2_RGBA:
+    case  CMP_FORMAT_EAC_R11:
+    case  CMP_FORMAT_EAC_RG11:
     case  CMP_FORMAT_ASTC :
     case  CMP_FORMAT_GT:
         isCompressed            = true;
@@ -1501,6 +1537,15 @@ int Plugin_KTX::TC_PluginFileSaveTexture(const TCHAR* pszFilename, MipSet* pMipS
             case CMP_FORMAT_ETC2_RGB:
                 textureinfo.glInternalFormat = GL_COMPRESSED_RGB8_ETC2;
                 break;
+            case CMP_FORMAT_ETC2_RGBA:
+                textureinfo.glInternalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+                break;
+            case CMP_FORMAT_EAC_R11:
+                textureinfo.glInternalFormat = GL_COMPRESSED_R11_EAC;
+                break;
+            case CMP_FORMAT_EAC_RG11:
+                textureinfo.glInternalFormat = GL_COMPRESSED_RG11_EAC;
+                break;
             case CMP_FORMAT_DXT5_xGBR:
                 textureinfo.glInternalFormat = COMPRESSED_FORMAT_DXT5_xGBR;
                 break;
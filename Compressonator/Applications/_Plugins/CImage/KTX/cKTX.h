@@ -189,14 +189,14 @@ enum scanline_copy_method
 // #define GL_SRGB8                                         0x8C41
 // #define GL_SRGB8_ALPHA8                                  0x8C43
 // #define GL_ETC1_RGB8_OES                                 0x8d64
-// #define GL_COMPRESSED_R11_EAC                            0x9270
+#define GL_COMPRESSED_R11_EAC                               0x9270
 // #define GL_COMPRESSED_SIGNED_R11_EAC                     0x9271
-// #define GL_COMPRESSED_RG11_EAC                           0x9272
+#define GL_COMPRESSED_RG11_EAC                              0x9272
 // #define GL_COMPRESSED_SIGNED_RG11_EAC                    0x9273
 // #define GL_COMPRESSED_SRGB8_ETC2                         0x9275
 // #define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2      0x9276
 // #define GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2     0x9277
-// #define GL_COMPRESSED_RGBA8_ETC2_EAC                     0x9278
+#define GL_COMPRESSED_RGBA8_ETC2_EAC                        0x9278
 // #define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC              0x9279
 
 #define GL_COMPRESSED_RGB8_ETC2                             0x9274
@@ -71,6 +71,9 @@ CMP_FormatDesc g_FormatDesc[] =
    {CMP_FORMAT_ATC_RGBA_Interpolated,   "ATC_RGBA_Interpolated"},
    {CMP_FORMAT_ETC_RGB,                 "ETC_RGB"},
    {CMP_FORMAT_ETC2_RGB,                "ETC2_RGB" },
+   {CMP_FORMAT_ETC2_RGBA,               "ETC2_RGBA"},
+   {CMP_FORMAT_EAC_R11,                 "EAC_R11"},
+   {CMP_FORMAT_EAC_RG11,                "EAC_RG11"},
    {CMP_FORMAT_BC6H,                    "BC6H"},
    {CMP_FORMAT_BC7,                     "BC7"},
    {CMP_FORMAT_ASTC,                    "ASTC"},
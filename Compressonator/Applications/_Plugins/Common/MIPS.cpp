@@ -24,6 +24,7 @@
 
 #include "stdafx.h"
 #include <stdio.h>
+#include <malloc.h>
 #include "MIPS.h"
 
 void(*PrintStatusLine)(char *) = NULL;
@@ -213,6 +214,9 @@ bool CMIPS::AllocateMipSet(MipSet* pMipSet, ChannelFormat channelFormat, Texture
     pMipSet->m_nWidth = nWidth;
     pMipSet->m_nHeight = nHeight;
     pMipSet->m_nDepth = nDepth;
+    pMipSet->m_pArenaData = NULL;
+    pMipSet->m_nArenaSize = 0;
+    pMipSet->m_Flags &= ~MS_FLAG_MappedData;
     int numLevelsToAllocate;
     if(!AllocateMipLevelTable(&pMipSet->m_pMipLevelTable, pMipSet->m_nMaxMipLevels, textureType, nDepth, numLevelsToAllocate))
     {
@@ -306,6 +310,99 @@ bool CMIPS::AllocateCompressedMipLevelData(MipLevel* pMipLevel, int nWidth, int
     return (pMipLevel->m_pbData != NULL);
 }
 
+// Places the data of the first nMipLevels levels of every face in one aligned block, laid out
+// the way DDS files store them: each face in turn, from the top level down. pdwLevelSizes holds
+// the size of one face of each level. Volume textures are not supported as their slice count
+// changes from level to level. FreeMipSet releases the block.
+bool CMIPS::AllocateMipSetArena(MipSet* pMipSet, int nMipLevels, const DWORD* pdwLevelSizes)
+{
+    ASSERT(pMipSet);
+    ASSERT(pdwLevelSizes);
+    if(!pMipSet->m_pMipLevelTable || pMipSet->m_pArenaData || pMipSet->m_TextureType == TT_VolumeTexture)
+        return false;
+    if(nMipLevels < 1 || nMipLevels > pMipSet->m_nMaxMipLevels)
+    {
+        ASSERT(nMipLevels >= 1 && nMipLevels <= pMipSet->m_nMaxMipLevels);
+        return false;
+    }
+
+    size_t nFaceSize = 0;
+    for(int nMipLevel=0; nMipLevel<nMipLevels; nMipLevel++)
+    {
+        nFaceSize += pdwLevelSizes[nMipLevel];
+        for(int nFace=0; nFace<pMipSet->m_nDepth; nFace++)
+        {
+            // Levels that already own data are left alone
+            if(GetMipLevel(pMipSet, nMipLevel, nFace)->m_pbData)
+                return false;
+        }
+    }
+
+    size_t nArenaSize = nFaceSize * pMipSet->m_nDepth;
+    BYTE* pbArena = reinterpret_cast<BYTE*>(_aligned_malloc(nArenaSize, MIPSET_ARENA_ALIGNMENT));
+    if(!pbArena)
+        return false;
+
+    BYTE* pbData = pbArena;
+    for(int nFace=0; nFace<pMipSet->m_nDepth; nFace++)
+    {
+        int nWidth = pMipSet->m_nWidth;
+        int nHeight = pMipSet->m_nHeight;
+        for(int nMipLevel=0; nMipLevel<nMipLevels; nMipLevel++)
+        {
+            MipLevel* pMipLevel = GetMipLevel(pMipSet, nMipLevel, nFace);
+            pMipLevel->m_nWidth = nWidth;
+            pMipLevel->m_nHeight = nHeight;
+            pMipLevel->m_dwLinearSize = pdwLevelSizes[nMipLevel];
+            pMipLevel->m_pbData = pbData;
+            pbData += pdwLevelSizes[nMipLevel];
+
+            nWidth = nWidth>1 ? nWidth>>1 : 1;
+            nHeight = nHeight>1 ? nHeight>>1 : 1;
+        }
+    }
+
+    pMipSet->m_pArenaData = pbArena;
+    pMipSet->m_nArenaSize = nArenaSize;
+    pMipSet->m_Flags &= ~MS_FLAG_MappedData;
+    return true;
+}
+
+static bool IsArenaData(const MipSet* pMipSet, const BYTE* pbData)
+{
+    return pMipSet->m_pArenaData && pbData >= pMipSet->m_pArenaData && pbData < pMipSet->m_pArenaData + pMipSet->m_nArenaSize;
+}
+
+// Returns the data of the m_nMipLevels levels of every face when it lies in the arena back to
+// back in file order, so it can be written in one go. Returns NULL if any level was reallocated
+// on its own or the MipSet has no arena.
+BYTE* CMIPS::GetContiguousMipData(const MipSet* pMipSet, size_t& nDataSize)
+{
+    nDataSize = 0;
+    if(!pMipSet || !pMipSet->m_pArenaData || pMipSet->m_TextureType == TT_VolumeTexture || pMipSet->m_nMipLevels < 1)
+        return NULL;
+
+    BYTE* pbStart = GetMipLevel(pMipSet, 0, 0)->m_pbData;
+    if(!IsArenaData(pMipSet, pbStart))
+        return NULL;
+
+    BYTE* pbNext = pbStart;
+    for(int nFace=0; nFace<pMipSet->m_nDepth; nFace++)
+    {
+        for(int nMipLevel=0; nMipLevel<pMipSet->m_nMipLevels; nMipLevel++)
+        {
+            // The savers write the size of the first face for every face
+            MipLevel* pMipLevel = GetMipLevel(pMipSet, nMipLevel, nFace);
+            if(!pMipLevel || pMipLevel->m_pbData != pbNext || pMipLevel->m_dwLinearSize != GetMipLevel(pMipSet, nMipLevel)->m_dwLinearSize)
+                return NULL;
+            pbNext += pMipLevel->m_dwLinearSize;
+        }
+    }
+
+    nDataSize = pbNext - pbStart;
+    return pbStart;
+}
+
 void CMIPS::FreeMipSet(MipSet* pMipSet)
 {
     //TODO test
@@ -344,7 +441,8 @@ void CMIPS::FreeMipSet(MipSet* pMipSet)
             {
                 if (pMipSet->m_pMipLevelTable[i]->m_pbData)
                 {
-                    free(pMipSet->m_pMipLevelTable[i]->m_pbData);
+                    if (!IsArenaData(pMipSet, pMipSet->m_pMipLevelTable[i]->m_pbData))
+                        free(pMipSet->m_pMipLevelTable[i]->m_pbData);
                     pMipSet->m_pMipLevelTable[i]->m_pbData = NULL;
                 }
 
@@ -355,6 +453,24 @@ void CMIPS::FreeMipSet(MipSet* pMipSet)
                 }
             }
 
+            if (pMipSet->m_pArenaData)
+            {
+                // The levels kept for the gui view must not point into the released block
+                for(int i=max(nTotalOldMipLevels-2, 0); i<nTotalOldMipLevels; i++)
+                {
+                    if (pMipSet->m_pMipLevelTable[i] && IsArenaData(pMipSet, pMipSet->m_pMipLevelTable[i]->m_pbData))
+                        pMipSet->m_pMipLevelTable[i]->m_pbData = NULL;
+                }
+
+                if (pMipSet->m_Flags & MS_FLAG_MappedData)
+                    UnmapViewOfFile(pMipSet->m_pArenaData);
+                else
+                    _aligned_free(pMipSet->m_pArenaData);
+                pMipSet->m_pArenaData = NULL;
+                pMipSet->m_nArenaSize = 0;
+                pMipSet->m_Flags &= ~MS_FLAG_MappedData;
+            }
+
             free(pMipSet->m_pMipLevelTable);
             pMipSet->m_pMipLevelTable = NULL;
             pMipSet->m_nMaxMipLevels  = 0;
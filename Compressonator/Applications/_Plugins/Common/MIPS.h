@@ -28,6 +28,9 @@
 #include "stdlib.h"
 #include "TC_PluginAPI.h"
 
+// Alignment of the block made by AllocateMipSetArena, a page so it can be handed to file I/O as is
+#define MIPSET_ARENA_ALIGNMENT  4096
+
 extern void(*PrintStatusLine)(char *);
 
 class CMIPS
@@ -44,6 +47,8 @@ class CMIPS
     bool AllocateMipSet(MipSet* pMipSet, ChannelFormat channelFormat, TextureDataType textureDataType, TextureType textureType, int nWidth, int nHeight, int nDepth);
     bool AllocateMipLevelData(MipLevel* pMipLevel, int nWidth, int nHeight, ChannelFormat channelFormat, TextureDataType textureDataType);
     bool AllocateCompressedMipLevelData(MipLevel* pMipLevel, int nWidth, int nHeight, DWORD dwSize);
+    bool AllocateMipSetArena(MipSet* pMipSet, int nMipLevels, const DWORD* pdwLevelSizes);
+    BYTE* GetContiguousMipData(const MipSet* pMipSet, size_t& nDataSize);
 
     void FreeMipSet(MipSet* pMipSet);
 
@@ -105,6 +105,9 @@ extern "C" {
 #define FOURCC_ASTC                    MAKEFOURCC('A', 'S', 'T', 'C')
 #define FOURCC_GT                      MAKEFOURCC('G', 'T', '1', 'x')
 #define FOURCC_ETC2_RGB                MAKEFOURCC('E', 'T', 'C', '2')
+#define FOURCC_ETC2_RGBA               MAKEFOURCC('E', 'T', '2', 'A')
+#define FOURCC_EAC_R11                 MAKEFOURCC('E', 'A', 'R', '1')
+#define FOURCC_EAC_RG11                MAKEFOURCC('E', 'A', 'R', '2')
 
 /*
  * FOURCC codes for DX compressed-texture pixel formats
@@ -160,12 +163,18 @@ typedef enum
 #define   MS_FLAG_Default                0x0000
 #define   MS_FLAG_AlphaPremult            0x0001
 #define   MS_FLAG_DisableMipMapping        0x0002
+#define   MS_FLAG_sRGB                    0x0004      // 8 bit colour channels are sRGB encoded, the mip filters average them in linear light
+#define   MS_FLAG_MappedData              0x0008      // m_pArenaData is a copy-on-write view of the file the MipSet was loaded from
+#define   MS_FLAG_MapFileData             0x0010      // Set before loading when the file is not saved over while the MipSet lives, lets a loader map it
 
 typedef enum
 {
    MS_Default        = 0,
    MS_AlphaPremult   = 1,
    MS_DisableMipMapping = 2,
+   MS_sRGB           = 4,
+   MS_MappedData     = 8,
+   MS_MapFileData    = 16,
 } MS_Flags;
 
 
@@ -238,6 +247,8 @@ typedef struct
    int               m_nBlockHeight;      ///< Height in pixels of the Compression Block that is to be processed default for ASTC is 4
    int               m_nBlockDepth;       ///< Depth in pixels of the Compression Block that is to be processed default for ASTC is 1
    MipLevelTable*    m_pMipLevelTable;    ///< This is an implementation dependent way of storing the MipLevels that this mip-map set contains. Do not depend on it, use TC_AppGetMipLevel to access a mip-map set's MipLevels.
+   BYTE*             m_pArenaData;        ///< Set by CMIPS::AllocateMipSetArena to the single block holding the data of the MipLevels in file order, or by a loader to a view of the mapped file with MS_FLAG_MappedData. NULL when every MipLevel has an allocation of its own.
+   size_t            m_nArenaSize;        ///< Size in bytes of m_pArenaData.
 } MipSet;
 
 DWORD GetChannelSize(ChannelFormat channelFormat);       //< \internal
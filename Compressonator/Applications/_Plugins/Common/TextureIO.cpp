@@ -240,6 +240,9 @@ CMP_FORMAT GetFormat(DWORD dwFourCC)
         case FOURCC_ATC_RGBA_INTERP:    return CMP_FORMAT_ATC_RGBA_Interpolated;
         case FOURCC_ETC_RGB:            return CMP_FORMAT_ETC_RGB;
         case FOURCC_ETC2_RGB:           return CMP_FORMAT_ETC2_RGB;
+        case FOURCC_ETC2_RGBA:          return CMP_FORMAT_ETC2_RGBA;
+        case FOURCC_EAC_R11:            return CMP_FORMAT_EAC_R11;
+        case FOURCC_EAC_RG11:           return CMP_FORMAT_EAC_RG11;
         case FOURCC_BC6H:               return CMP_FORMAT_BC6H;
         case FOURCC_BC7:                return CMP_FORMAT_BC7;
         case FOURCC_ASTC:               return CMP_FORMAT_ASTC;
@@ -287,6 +290,9 @@ void Format2FourCC(CMP_FORMAT format, MipSet *pMipSet)
 
         case CMP_FORMAT_ETC_RGB:                pMipSet->m_dwFourCC =  FOURCC_ETC_RGB;             break;
         case CMP_FORMAT_ETC2_RGB:               pMipSet->m_dwFourCC =  FOURCC_ETC2_RGB;            break;
+        case CMP_FORMAT_ETC2_RGBA:              pMipSet->m_dwFourCC =  FOURCC_ETC2_RGBA;           break;
+        case CMP_FORMAT_EAC_R11:                pMipSet->m_dwFourCC =  FOURCC_EAC_R11;             break;
+        case CMP_FORMAT_EAC_RG11:               pMipSet->m_dwFourCC =  FOURCC_EAC_RG11;            break;
         case CMP_FORMAT_GT:                     pMipSet->m_dwFourCC =  FOURCC_GT;                  break;
 
         case CMP_FORMAT_BC6H:                   pMipSet->m_dwFourCC =  FOURCC_DX10;                break;
@@ -713,6 +719,9 @@ int AMDSaveMIPSTextureImage(const char * DestFile, MipSet *MipSetIn, bool use_OC
             case CMP_FORMAT_BC6H:
             case CMP_FORMAT_ETC_RGB:
             case CMP_FORMAT_ETC2_RGB:
+            case CMP_FORMAT_ETC2_RGBA:
+            case CMP_FORMAT_EAC_R11:
+            case CMP_FORMAT_EAC_RG11:
                 MipSetIn->m_swizzle = true;
                 break;
             }
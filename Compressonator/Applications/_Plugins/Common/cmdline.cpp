@@ -31,6 +31,8 @@
 #include "PluginInterface.h"
 #include "TC_PluginInternal.h"
 #include "Version.h"
+#include <process.h>
+#include <vector>
 
 
 
@@ -75,6 +77,12 @@ void PrintUsage()
     printf("                          how many mip levels to generate\n");
     printf("-miplevels  <Level>       Sets Mips Level for output,\n");
     printf("                          (mipSize overides this option): default is 1\n");
+    printf("-mipfilter  <filter>      Filter used to generate the mip levels:\n");
+    printf("                          box (default), kaiser, lanczos or mitchell\n");
+    printf("-miplinear                The 8 bit source is sRGB encoded, average the mip\n");
+    printf("                          levels in linear light\n");
+    printf("-mipfused                 Generate each mip level while the previous one\n");
+    printf("                          is compressed, releasing source levels once done\n");
     printf("Compression options:\n\n");
     printf("-fs <format>    Optionally specifies the source texture format to use\n");
     printf("-fd <format>    Specifies the destination texture format to use\n");
@@ -157,6 +165,9 @@ void PrintUsage()
     printf("               green channel. Eight bits per pixel\n");
     printf("ETC_RGB        Ericsson Texture Compression - Compressed RGB format.\n");
     printf("ETC2_RGB       Ericsson Texture Compression - Compressed RGB format.\n");
+    printf("ETC2_RGBA      Ericsson Texture Compression - Compressed RGBA format.\n");
+    printf("EAC_R11        Ericsson Alpha Compression - Compressed 11-bit R format.\n");
+    printf("EAC_RG11       Ericsson Alpha Compression - Compressed 11-bit RG format.\n");
     printf("\n");
     printf("<codec options>: Reference  documentation for range of values\n\n");
     printf("-UseChannelWeighting <value> Use channel weightings\n");
@@ -178,14 +189,24 @@ void PrintUsage()
     printf("                             default is 0.95, lower values produce darker images,\n");
     printf("                             higher values produce brighter images\n");
     printf("-CompressionSpeed <value>    The trade-off between compression speed & quality\n");
-    printf("                             This setting is not used in BC6H and BC7\n");
+    printf("                             This setting is not used in BC7, for BC6H 1 and 2\n");
+    printf("                             only try the best ranked partition shapes\n");
+    printf("                             for DXT1 to DXT5 3 uses the real time range fit\n");
+    printf("                             encoder\n");
+    printf("-RefinementEffort <value>    DXT1 to DXT5 only: search effort of the normal\n");
+    printf("                             speed encoder from 0.0 to 1.0, default 0.5\n");
+    printf("                             lower values are faster, -Quality also sets it\n");
     printf("-Signed <value>              Used for BC6H only, Default BC6H format disables\n");
     printf("                             use of a sign bit in the 16-bit floating point\n");
     printf("                             channels, with a value set to 1 BC6H format will\n");
     printf("                             use a sign bit\n");
     printf("-NumThreads <value>          Number of threads to initialize for BC6H or BC7\n");
     printf("                             encoding (Max up to 128). Default set to 8\n");
-    printf("-Quality <value>             Sets quality of encoding for BC7\n");
+    printf("                             ETC1, ETC2 and EAC default to one per processor\n");
+    printf("-Quality <value>             Sets quality of encoding for BC7, for ETC1 and\n");
+    printf("                             ETC2 0.5 adds an exhaustive search of the ETC1\n");
+    printf("                             modes and 0.8 searches all modes exhaustively,\n");
+    printf("                             for EAC 0.5 tries every table and 0.8 every base\n");
     printf("-Performance <value>         Sets performance of encoding for BC7\n");
     printf("-ColourRestrict <value>      This setting is a quality tuning setting for BC7\n");
     printf("                             which may be necessary for convenience in some\n");
@@ -195,6 +216,21 @@ void PrintUsage()
     printf("-ModeMask <value>            Mode to set BC7 to encode blocks using any of 8\n");
     printf("                             different block modes in order to obtain the\n");
     printf("                             highest quality\n");
+    printf("-PartitionCandidates <value> Number of BC7 partitions (1 to 64) that are fully\n");
+    printf("                             encoded after ranking them with a fast estimate\n");
+    printf("                             default of 0 derives it from Quality\n");
+    printf("-TargetMSE <value>           Adaptive BC7 search: each block stops searching\n");
+    printf("                             once its mean square error per channel is at or\n");
+    printf("                             below value, Quality sets the effort for the\n");
+    printf("                             blocks above it. Default 0 (off)\n");
+    printf("-TargetPSNR <value>          Same as -TargetMSE with the target given in dB\n");
+    printf("-AutoModeMask <value>        1 narrows the BC7 ModeMask to the modes used by a\n");
+    printf("                             sparse sample of blocks encoded with ModeMask\n");
+    printf("-CPUFeatureMask <value>      Restricts the CPU instruction sets the codecs use\n");
+    printf("                             to compare them on one machine, a sum of\n");
+    printf("                             SSE 0x1, SSE2 0x2, SSE4.1 0x4, AVX2 0x8,\n");
+    printf("                             AVX-512 0x10, F16C 0x20, BMI2 0x40\n");
+    printf("                             e.g. 0x3 runs the SSE2 kernels on an AVX2 CPU\n");
     printf("\n\n");
     printf("Output options:\n\n");
     printf("-silent                      Disable print messages\n");
@@ -266,6 +302,20 @@ CMP_GPUDecode DecodeWith(const  char *strParameter)
         return GPUDecode_INVALID;
 }
 
+const char *MipFilterPlugin(const char *strParameter)
+{
+    if (strcmp(strParameter, "box") == 0)
+        return "BOXFILTER";
+    else if (strcmp(strParameter, "kaiser") == 0)
+        return "KAISERFILTER";
+    else if (strcmp(strParameter, "lanczos") == 0)
+        return "LANCZOSFILTER";
+    else if (strcmp(strParameter, "mitchell") == 0)
+        return "MITCHELLFILTER";
+    else
+        return NULL;
+}
+
 bool isFloat(CMP_FORMAT format)
 {
     // determin of the swizzle flag needs to be turned on!
@@ -303,6 +353,18 @@ bool ProcessSingleFlags(const  char *strCommand)
         isset = true;
     }
     else
+    if ((strcmp(strCommand,"-miplinear") == 0))
+    {
+        g_CmdPrams.MipLinear = true;
+        isset = true;
+    }
+    else
+    if ((strcmp(strCommand,"-mipfused") == 0))
+    {
+        g_CmdPrams.MipFused = true;
+        isset = true;
+    }
+    else
     if ((strcmp(strCommand,"-silent") == 0))
     {
         g_CmdPrams.silent = true;
@@ -516,6 +578,17 @@ bool ProcessCMDLineOptions(const  char *strCommand, const char *strParameter)
             g_CmdPrams.CompressOptions.bUseGPUDecompress = true;
         }
         else
+        if (strcmp(strCommand, "-CPUFeatureMask") == 0)
+        {
+            if (strlen(strParameter) == 0)
+            {
+                throw "No CPU feature mask specified";
+            }
+            // Decimal or 0x prefixed hex
+            CMP_DWORD dwMask = (CMP_DWORD)strtoul(strParameter, NULL, 0);
+            CMP_SetCPUFeatureMask(dwMask);
+        }
+        else
         if (strcmp(strCommand, "-decomp") == 0)
         {
             if (strlen(strParameter) == 0)
@@ -587,6 +660,21 @@ bool ProcessCMDLineOptions(const  char *strCommand, const char *strParameter)
             g_CmdPrams.MipsLevel = 2;
         }
         else
+        if ((strcmp(strCommand,"-mipfilter") == 0))
+        {
+            if (strlen(strParameter) == 0)
+            {
+                throw "no mip filter is specified";
+            }
+
+            const char *pFilterPlugin = MipFilterPlugin(strParameter);
+            if (pFilterPlugin == NULL)
+            {
+                throw "unsupported mip filter is specified";
+            }
+            g_CmdPrams.MipFilter = pFilterPlugin;
+        }
+        else
         if (strcmp(strCommand,"-r") == 0)
         {
             if (strlen(strParameter) == 0)
@@ -835,10 +923,119 @@ bool _cdecl TC_PluginCodecSupportsFormat(const MipSet* pMipSet)
             pMipSet->m_ChannelFormat == CF_Float32);
 }
 
+// Bytes of level data held by a MipSet, an arena counts in full
+size_t MipSetDataSize(const MipSet* pMipSet)
+{
+    size_t nSize = pMipSet->m_nArenaSize;
+    for (int nMipLevel = 0; nMipLevel < pMipSet->m_nMipLevels; nMipLevel++)
+    {
+        for (int nFaceOrSlice = 0; nFaceOrSlice < MaxFacesOrSlices(pMipSet, nMipLevel); nFaceOrSlice++)
+        {
+            MipLevel* pMipLevel = g_CMIPS->GetMipLevel(pMipSet, nMipLevel, nFaceOrSlice);
+            if (pMipLevel && pMipLevel->m_pbData &&
+                (pMipLevel->m_pbData < pMipSet->m_pArenaData || pMipLevel->m_pbData >= pMipSet->m_pArenaData + pMipSet->m_nArenaSize))
+                nSize += pMipLevel->m_dwLinearSize;
+        }
+    }
+    return nSize;
+}
+
+//===============================================================
+// Fused MIP generation (-mipfused)
+// The levels of g_MipSetIn are not generated up front: while the
+// compression loop works on a level, a worker thread makes the
+// next one from it with the filter plugin.
+//===============================================================
+typedef struct
+{
+    PluginInterface_Filters *pFilter;       // Owned by the job until EndMipLevelJob
+    int                     nMinSize;       // nMinSize of the whole chain
+    int                     nLevelMinSize;  // nMinSize that makes just the next level
+    HANDLE                  hThread;        // Thread making the next level, NULL when idle
+    int                     nResult;        // Result of the last level made
+} MipLevelJob;
+
+MipLevelJob g_MipLevelJob = { NULL, 0, 0, NULL, PE_OK };
+
+unsigned int _stdcall MipLevelJobThreadProc(void* param)
+{
+    MipLevelJob *pJob = (MipLevelJob *)param;
+    pJob->nResult = pJob->pFilter->TC_GenerateMIPLevels(&g_MipSetIn, pJob->nLevelMinSize);
+    return 0;
+}
+
+// Starts making the level after the last one of g_MipSetIn, returns false if the chain is complete
+bool StartNextMipLevel()
+{
+    MipLevelJob *pJob = &g_MipLevelJob;
+    if (pJob->pFilter == NULL || g_MipSetIn.m_nMipLevels >= g_MipSetIn.m_nMaxMipLevels)
+        return false;
+
+    // Same end of the chain as generating all the levels at once with nMinSize
+    MipLevel* pLastMipLevel = g_CMIPS->GetMipLevel(&g_MipSetIn, g_MipSetIn.m_nMipLevels - 1);
+    int nWidth  = pLastMipLevel->m_nWidth;
+    int nHeight = pLastMipLevel->m_nHeight;
+    if (nWidth <= pJob->nMinSize || nHeight <= pJob->nMinSize)
+        return false;
+    if (g_MipSetIn.m_nMipLevels > 1 && (nWidth == 1 || nHeight == 1))
+        return false;
+
+    // The filter stops once either dimension of a new level is no more than nLevelMinSize
+    pJob->nLevelMinSize = max(min(nWidth, nHeight) / 2, pJob->nMinSize);
+    pJob->nResult       = PE_OK;
+    pJob->hThread       = (HANDLE)_beginthreadex(NULL, 0, MipLevelJobThreadProc, pJob, 0, NULL);
+    if (pJob->hThread == NULL)
+        MipLevelJobThreadProc(pJob);
+    return true;
+}
+
+// Number of levels g_MipSetIn has once StartNextMipLevel reports the chain complete
+int FusedMipChainLength()
+{
+    MipLevel* pLastMipLevel = g_CMIPS->GetMipLevel(&g_MipSetIn, g_MipSetIn.m_nMipLevels - 1);
+    int nWidth     = pLastMipLevel->m_nWidth;
+    int nHeight    = pLastMipLevel->m_nHeight;
+    int nMipLevels = g_MipSetIn.m_nMipLevels;
+    while (nMipLevels < g_MipSetIn.m_nMaxMipLevels && nWidth > g_MipLevelJob.nMinSize && nHeight > g_MipLevelJob.nMinSize &&
+           !(nMipLevels > 1 && (nWidth == 1 || nHeight == 1)))
+    {
+        nWidth  = max(nWidth >> 1, 1);
+        nHeight = max(nHeight >> 1, 1);
+        nMipLevels++;
+    }
+    return nMipLevels;
+}
+
+// Waits for the level started by StartNextMipLevel and returns the filter result
+int WaitNextMipLevel()
+{
+    MipLevelJob *pJob = &g_MipLevelJob;
+    if (pJob->hThread)
+    {
+        WaitForSingleObject(pJob->hThread, INFINITE);
+        CloseHandle(pJob->hThread);
+        pJob->hThread = NULL;
+    }
+    return pJob->nResult;
+}
+
+void EndMipLevelJob()
+{
+    WaitNextMipLevel();
+    if (g_MipLevelJob.pFilter)
+    {
+        delete g_MipLevelJob.pFilter;
+        g_MipLevelJob.pFilter = NULL;
+    }
+}
+
 void cleanup(bool Delete_gMipSetIn,bool SwizzleMipSetIn)
 {
     SetDllDirectory(NULL);
 
+    // A level may still be in the making from g_MipSetIn
+    EndMipLevelJob();
+
     if (Delete_gMipSetIn)
     {
         if (g_MipSetIn.m_pMipLevelTable)
@@ -1073,6 +1270,13 @@ bool MakeFormatCompatible(CMP_Texture& srcTexture, MipLevel* pInMipLevel, CMP_FO
 }
 
 
+// True when DestFile exists and is the same file as SourceFile
+static bool IsSameFile(std::string SourceFile, std::string DestFile)
+{
+    boost::system::error_code ec;
+    return boost::filesystem::exists(DestFile) && boost::filesystem::equivalent(SourceFile, DestFile, ec);
+}
+
 bool GenerateAnalysis(std::string SourceFile, std::string DestFile)
 {
     if (!(boost::filesystem::exists(SourceFile)))
@@ -1383,9 +1587,16 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
                     compress_loopStartTime      = {0},
                     compress_loopEndTime        = {0},
                     decompress_loopStartTime    = {0},
-                    decompress_loopEndTime      = {0};
+                    decompress_loopEndTime      = {0},
+                    mip_loopStartTime           = {0},
+                    mip_loopEndTime             = {0};
     int             compress_nIterations        =0,
                     decompress_nIterations      =0;
+    CMP_DWORD       compress_nBlocks            =0;
+    double          compress_fWork              =0;
+    CMP_DWORD       compress_dwModeMask         =0;
+    double          compress_fModeMaskTimeSaved =0;
+    size_t          compress_nPeakDataSize      =0;     // Most source and compressed level data held at once
 
     // These flags indicate if the source and destination files are compressed
     bool            SourceFormatIsCompressed        = false;
@@ -1394,6 +1605,7 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
 
     bool            TranscodeBits                   = false;
     bool            MidwayDecompress                = false;
+    bool            FusedMipGeneration              = false;
 
     //  With a user suppiled Mip Map dont delete it on exit
     bool            Delete_gMipSetIn            = false;
@@ -1514,6 +1726,10 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
             // Set user specification for Block sizes
             //----------------------------------------
 
+            // Loaders may map the source instead of reading it, unless the result is saved over it
+            if (!IsSameFile(g_CmdPrams.SourceFile, g_CmdPrams.DestFile))
+                g_MipSetIn.m_Flags |= MS_FLAG_MapFileData;
+
             if (AMDLoadMIPSTextureImage(g_CmdPrams.SourceFile.c_str(), &g_MipSetIn, g_CmdPrams.use_OCV) != 0)
             {
                 cleanup(Delete_gMipSetIn, SwizzledMipSetIn);
@@ -1592,7 +1808,7 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
         if (((g_CmdPrams.MipsLevel > 1) && (g_MipSetIn.m_nMipLevels == 1)) && (!g_CmdPrams.use_noMipMaps))
         {
             PluginInterface_Filters *plugin_Filter;
-            plugin_Filter = reinterpret_cast<PluginInterface_Filters *>(g_pluginManager.GetPlugin("FILTERS", "BOXFILTER"));
+            plugin_Filter = reinterpret_cast<PluginInterface_Filters *>(g_pluginManager.GetPlugin("FILTERS", (char *)g_CmdPrams.MipFilter.c_str()));
             if (plugin_Filter)
             {
 
@@ -1604,12 +1820,37 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
                 else
                     nMinSize = CalcMinMipSize(g_MipSetIn.m_nHeight, g_MipSetIn.m_nWidth, g_CmdPrams.MipsLevel);
 
-                plugin_Filter->TC_GenerateMIPLevels(&g_MipSetIn, nMinSize);
-                delete plugin_Filter;
+                if (g_CmdPrams.MipLinear)
+                    g_MipSetIn.m_Flags |= MS_FLAG_sRGB;
+
+                if (g_CmdPrams.MipFused && !SourceFormatIsCompressed && DestinationFormatIsCompressed && !g_CmdPrams.useGPU)
+                {
+                    // The compression loop makes each level while compressing the one before
+                    g_MipLevelJob.pFilter  = plugin_Filter;
+                    g_MipLevelJob.nMinSize = nMinSize;
+                    FusedMipGeneration     = true;
+                }
+                else
+                {
+                    if (g_CmdPrams.showperformance)
+                        QueryPerformanceCounter(&mip_loopStartTime);
+
+                    int nResult = plugin_Filter->TC_GenerateMIPLevels(&g_MipSetIn, nMinSize);
+                    delete plugin_Filter;
+                    if (nResult != PE_OK)
+                    {
+                        PrintInfo("Error: %s plugin failed to generate the MIP levels of this format\n", g_CmdPrams.MipFilter.c_str());
+                        cleanup(Delete_gMipSetIn, SwizzledMipSetIn);
+                        return -1;
+                    }
+
+                    if (g_CmdPrams.showperformance)
+                        QueryPerformanceCounter(&mip_loopEndTime);
+                }
             }
             else
             {
-                PrintInfo("Error Loading: BoxFilter plugin for MIP Level Generation\n");
+                PrintInfo("Error Loading: %s plugin for MIP Level Generation\n", g_CmdPrams.MipFilter.c_str());
                 cleanup(Delete_gMipSetIn, SwizzledMipSetIn);
                 return -1;
             }
@@ -1657,18 +1898,46 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
                g_MipSetCmp.m_format     = destFormat;
                Format2FourCC(destFormat,&g_MipSetCmp);
 
+               // Place the whole compressed chain in one block in file order so the
+               // savers can write it with one call. If this fails each level is
+               // allocated on its own as it is compressed.
+               {
+                   int nArenaMipLevels = min(FusedMipGeneration ? FusedMipChainLength() : g_MipSetIn.m_nMipLevels, g_MipSetCmp.m_nMaxMipLevels);
+                   std::vector<DWORD> dwLevelSizes(nArenaMipLevels);
+                   CMP_Texture levelTexture;
+                   memset(&levelTexture, 0, sizeof(levelTexture));
+                   levelTexture.dwSize       = sizeof(levelTexture);
+                   levelTexture.dwWidth      = g_MipSetIn.m_nWidth;
+                   levelTexture.dwHeight     = g_MipSetIn.m_nHeight;
+                   levelTexture.nBlockWidth  = g_CmdPrams.BlockWidth;
+                   levelTexture.nBlockHeight = g_CmdPrams.BlockHeight;
+                   levelTexture.format       = destFormat;
+                   for (int nMipLevel = 0; nMipLevel < nArenaMipLevels; nMipLevel++)
+                   {
+                       dwLevelSizes[nMipLevel] = CMP_CalculateBufferSize(&levelTexture);
+                       levelTexture.dwWidth    = max(levelTexture.dwWidth >> 1, 1);
+                       levelTexture.dwHeight   = max(levelTexture.dwHeight >> 1, 1);
+                   }
+                   if (nArenaMipLevels > 0)
+                       g_CMIPS->AllocateMipSetArena(&g_MipSetCmp, nArenaMipLevels, &dwLevelSizes[0]);
+               }
+
                CMP_Texture srcTexture;
                srcTexture.dwSize = sizeof(srcTexture);
-               int DestMipLevel = g_MipSetIn.m_nMipLevels;
 
                if (g_CmdPrams.showperformance)
                    QueryPerformanceCounter(&compress_loopStartTime);
 
-               for(int nMipLevel=0; nMipLevel<DestMipLevel; nMipLevel++)
+               // With -mipfused g_MipSetIn gains a level on each pass
+               for(int nMipLevel=0; nMipLevel<g_MipSetIn.m_nMipLevels; nMipLevel++)
                {        
                     g_MipLevel = nMipLevel+1;
+                    int nFacesOrSlices = MaxFacesOrSlices(&g_MipSetIn, nMipLevel);
+
+                    // Fused MIP generation: the filter reads this level while it is compressed
+                    bool bNextMipLevel = StartNextMipLevel();
 
-                    for (int nFaceOrSlice = 0; nFaceOrSlice < MaxFacesOrSlices(&g_MipSetIn, nMipLevel); nFaceOrSlice++)
+                    for (int nFaceOrSlice = 0; nFaceOrSlice < nFacesOrSlices; nFaceOrSlice++)
                     {
 
                         //=====================
@@ -1716,8 +1985,11 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
                                 destTexture.dwDataSize,
                                 srcTexture.dwDataSize / (float)destTexture.dwDataSize);
 
+                        // Levels placed in the arena already have their space
                         MipLevel* pOutMipLevel = g_CMIPS->GetMipLevel(&g_MipSetCmp, nMipLevel, nFaceOrSlice);
-                        if (!g_CMIPS->AllocateCompressedMipLevelData(pOutMipLevel, destTexture.dwWidth, destTexture.dwHeight, destTexture.dwDataSize))
+                        bool bPlaced = pOutMipLevel->m_pbData && pOutMipLevel->m_dwLinearSize == destTexture.dwDataSize &&
+                                       pOutMipLevel->m_nWidth == (int)destTexture.dwWidth && pOutMipLevel->m_nHeight == (int)destTexture.dwHeight;
+                        if (!bPlaced && !g_CMIPS->AllocateCompressedMipLevelData(pOutMipLevel, destTexture.dwWidth, destTexture.dwHeight, destTexture.dwDataSize))
                         {
                             PrintInfo("Memory Error(1): allocating MIPSet compression level data buffer\n");
                             cleanup(Delete_gMipSetIn, SwizzledMipSetIn);
@@ -1824,11 +2096,47 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
                         #endif
 
                         if (g_CmdPrams.showperformance)
-                                    compress_nIterations++;
+                        {
+                            compress_nIterations++;
+
+                            // Search effort of the codecs that report it (BC7)
+                            CMP_CompressStats stats;
+                            stats.dwSize = sizeof(stats);
+                            if (CMP_GetCompressStats(&stats) == CMP_OK)
+                            {
+                                compress_nBlocks += stats.dwBlocksEncoded;
+                                compress_fWork   += stats.fWorkPerBlock * stats.dwBlocksEncoded;
+                                compress_dwModeMask         |= stats.dwModeMask;
+                                compress_fModeMaskTimeSaved += stats.fModeMaskTimeSaved;
+                            }
+                        }
 
                     }
                     g_MipSetCmp.m_nMipLevels++;
+
+                    if (bNextMipLevel && WaitNextMipLevel() != PE_OK)
+                    {
+                        PrintInfo("Error: %s plugin failed to generate the MIP levels of this format\n", g_CmdPrams.MipFilter.c_str());
+                        cleanup(Delete_gMipSetIn, SwizzledMipSetIn);
+                        return -1;
+                    }
+
+                    if (g_CmdPrams.showperformance)
+                        compress_nPeakDataSize = max(compress_nPeakDataSize, MipSetDataSize(&g_MipSetIn) + MipSetDataSize(&g_MipSetCmp));
+
+                    // Fused MIP generation: nothing reads this level any more, release it
+                    // unless it belongs to the caller
+                    if (g_MipLevelJob.pFilter && Delete_gMipSetIn)
+                    {
+                        for (int nFaceOrSlice = 0; nFaceOrSlice < nFacesOrSlices; nFaceOrSlice++)
+                        {
+                            MipLevel* pInMipLevel = g_CMIPS->GetMipLevel(&g_MipSetIn, nMipLevel, nFaceOrSlice);
+                            free(pInMipLevel->m_pbData);
+                            pInMipLevel->m_pbData = NULL;
+                        }
+                    }
                 }
+                EndMipLevelJob();
 
                 if (g_CmdPrams.showperformance)
                     QueryPerformanceCounter(&compress_loopEndTime);
@@ -2162,17 +2470,37 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
        LONGLONG conversion_Duration = conversion_loopEndTime.QuadPart - conversion_loopStartTime.QuadPart;
        g_CmdPrams.conversion_fDuration = (((double) conversion_Duration) / ((double) frequency.QuadPart));
 
+       LONGLONG mip_Duration = mip_loopEndTime.QuadPart - mip_loopStartTime.QuadPart;
+       double mip_fDuration = (((double) mip_Duration) / ((double) frequency.QuadPart));
+
        //DWORD dwCoreCount = GetProcessorCount();
 
 #ifdef USE_WITH_COMMANDLINE_TOOL
        PrintInfo("\r");
 #endif
 
+       if (mip_Duration)
+       PrintInfo("Generated MIP levels in %.3f seconds\n", mip_fDuration);
+
        if (compress_nIterations)
-       PrintInfo("Compressed to %s with %i iteration(s) in %.3f seconds\n",
+       PrintInfo("Compressed to %s with %i iteration(s) in %.3f seconds%s\n",
                  GetFormatDesc(cmpformat),
                  compress_nIterations, 
-                 compress_fDuration);
+                 compress_fDuration,
+                 FusedMipGeneration ? " (includes fused MIP generation)" : "");
+
+       if (compress_nPeakDataSize)
+       PrintInfo("Peak source and compressed level data: %.1f MB\n", compress_nPeakDataSize / (1024.0 * 1024.0));
+
+       if (compress_nBlocks)
+       PrintInfo("Average work per block: %.2f candidates over %u blocks\n",
+                 compress_fWork / compress_nBlocks,
+                 compress_nBlocks);
+
+       if (compress_dwModeMask)
+       PrintInfo("Block mode mask used: 0x%02X, time saved by AutoModeMask: %.3f seconds\n",
+                 compress_dwModeMask,
+                 compress_fModeMaskTimeSaved);
        
        if (decompress_nIterations)
        PrintInfo("DeCompressed to %s with %i iteration(s) in %.3f seconds\n",
@@ -2196,6 +2524,8 @@ int ProcessCMDLine(CMP_Feedback_Proc pFeedbackProc, MipSet *p_userMipSetIn)
 
 #ifdef SHOW_PROCESS_MEMORY
     bool result2 = GetProcessMemoryInfo(GetCurrentProcess(), &memCounter2, sizeof(memCounter2));
+    if (result2 && (!g_CmdPrams.silent) && (g_CmdPrams.showperformance))
+        PrintInfo("Peak working set: %.1f MB\n", memCounter2.PeakWorkingSetSize / (1024.0 * 1024.0));
 #endif
 
     return 0;
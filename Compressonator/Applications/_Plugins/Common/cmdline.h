@@ -57,6 +57,9 @@ public:
         dwHeight                = 0;
         nMinSize                = 0;
         MipsLevel               = 1;
+        MipFilter               = "BOXFILTER";
+        MipLinear               = false;
+        MipFused                = false;
         silent                  = false;
         noswizzle               = false;
         doswizzle               = false;
@@ -89,6 +92,9 @@ public:
     double                      conversion_fDuration;   // Total Performance time
     int                         MipsLevel;              //
     int                         nMinSize;               //
+    std::string                 MipFilter;              // Name of the FILTERS plugin used to generate the mip levels
+    bool                        MipLinear;              // 8 bit source is sRGB, filter the mip levels in linear light
+    bool                        MipFused;               // Generate each mip level while the previous one is compressed
     bool                        doDecompress;           //
     bool                        noswizzle;              //
     bool                        doswizzle;              //
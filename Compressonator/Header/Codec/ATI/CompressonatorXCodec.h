@@ -29,6 +29,10 @@
 #ifndef _ATIXCODEC_H_
 #define _ATIXCODEC_H_
 
+// Refinement effort of CompRGBBlock in [0, 1], lower is faster and higher searches further
+// before the error stops improving. This value matches the original fixed search.
+#define DXTC_DEFAULT_REFINEMENT_EFFORT 0.5f
+
 /*------------------------------------------------------------------------------------
 void CompRGBBlock(CODECFLOAT* block_32,    [IN]  array of the 3 component color vectors (888)
                   CMP_DWORD block_dxtc[2],                [OUT] compressed data in DXT1 for mat
@@ -48,7 +52,8 @@ CODECFLOAT CompRGBBlock(CODECFLOAT* block_32,
                         CMP_BYTE nRefinementSteps,
                         CODECFLOAT* _pfChannelWeights = NULL,
                         bool _bUseAlpha = false,
-                        CODECFLOAT _fAlphaThreshold = 0.5);
+                        CODECFLOAT _fAlphaThreshold = 0.5,
+                        CODECFLOAT _fRefinementEffort = DXTC_DEFAULT_REFINEMENT_EFFORT);
 
 /*------------------------------------------------------------------------------------
 void CompRGBBlock(CMP_DWORD* block_32,    [IN]  array of the 3 component color vectors (888)
@@ -69,7 +74,8 @@ CODECFLOAT CompRGBBlock(CMP_DWORD* block_32,
                         CMP_BYTE nRefinementSteps,
                         CODECFLOAT* _pfChannelWeights = NULL,
                         bool _bUseAlpha = false, 
-                        CMP_BYTE _nAlphaThreshold = 128);
+                        CMP_BYTE _nAlphaThreshold = 128,
+                        CODECFLOAT _fRefinementEffort = DXTC_DEFAULT_REFINEMENT_EFFORT);
 
 /*--------------------------------------------------------------------------------------------
 // input [0,1]
@@ -36,6 +36,10 @@ public:
     ~BC6HBlockDecoder(){};
     void DecompressBlock(float out[BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG],BYTE in[BC6H_COMPRESSED_BLOCK_SIZE]);
 
+    // Decodes directly to half floats (RGBA16F), dwPitch is the byte offset between output rows
+    void DecompressBlockRGBA16F(BYTE *out, DWORD dwPitch, BYTE in[BC6H_COMPRESSED_BLOCK_SIZE]);
+    void DecompressBlocksRGBA16F(BYTE *in, DWORD inPitch, DWORD blocksX, DWORD blocksY, BYTE *out, DWORD outPitch, DWORD numThreads);
+
 private:
     int format; // this is suppiled by user for compression for SIGNED_F16 or UNSIGNED_F16 or obtained during decompression
 
@@ -281,4 +281,7 @@ struct AMD_BC6H_Format
 
 extern unsigned short    g_BC6H_FORMAT;
 
+// Set from the CPU features allowed by CMP_SetCPUFeatureMask, picks the SSE2 kernels of the encoder
+extern bool              g_bBC6HUseSSE2;
+
 #endif
@@ -47,6 +47,14 @@
 
 #include "Compressonator.h"
 
+// Maximum number of blocks handled by one call to CompressBlocks
+#define BC6H_BATCH_BLOCKS   8
+
+// Number of two region shapes fully fitted, after ranking them with an estimate,
+// at the reduced search speeds
+#define BC6H_FAST_SHAPES        8
+#define BC6H_SUPERFAST_SHAPES   2
+
 class BC6HBlockEncoder
 {
 public:
@@ -57,6 +65,8 @@ public:
                         m_isSigned                = user_options.bIsSigned;
                         m_ModeMask                = user_options.dwMask;
                         m_Exposure                = user_options.fExposure;
+                        m_maxShapes               = BC6H_MAX_PARTITIONS;
+                        m_fastModes               = false;
                     };
 
     ~BC6HBlockEncoder(){};
@@ -71,6 +81,16 @@ public:
 
 
     float   CompressBlock(float in[BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG],BYTE   out[BC6H_COMPRESSED_BLOCK_SIZE]);
+
+    // Compresses numBlocks (up to BC6H_BATCH_BLOCKS) blocks to consecutive locations in out,
+    // each block is encoded exactly as CompressBlock would. The blocks are encoded one after
+    // the other, the batch only saves handing each block to an encoder thread
+    void    CompressBlocks(float in[][BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG],BYTE *out,DWORD numBlocks);
+
+    // CMP_Speed_Normal fits all the two region shapes with all the modes.
+    // CMP_Speed_Fast only fits the BC6H_FAST_SHAPES best ranked shapes, CMP_Speed_SuperFast
+    // fits the BC6H_SUPERFAST_SHAPES best ranked shapes and only tries modes 1 and 11
+    void    SetCompressionSpeed(CMP_Speed speed);
     void    clampF16Max(float EndPoints[2][2][3]);
     void    QuantizeEndPoint(float    EndPoints[2][2][3], int iEndPoints[2][2][3], int max_subsets, int prec);
     void    SwapIndices(int iEndPoints[2][2][3], int iIndices[3][BC6H_MAX_SUBSET_SIZE], DWORD  entryCount[BC6H_MAX_SUBSETS], int max_subsets, int mode, int shape_pattern);
@@ -125,6 +145,10 @@ private:
     bool    m_isSigned;
     double  m_Exposure;
 
+    // Search limits set from the compression speed
+    int     m_maxShapes;
+    bool    m_fastModes;
+
     // Data for compressing a particular block mode
     DWORD m_parityBits;
     DWORD m_clusters[2];
@@ -39,5 +39,11 @@ extern void    BC6H_Partition(
                   int        ShapeTableToUse,
                   int        dimension);
 
+// Estimates the error of each of the BC6H_MAX_PARTITIONS two region shapes for a block,
+// lower values are expected to quantize better
+extern void    BC6H_EstimateShapeErrors(
+                  double    in[][BC6H_MAX_DIMENSION_BIG],
+                  double    error[BC6H_MAX_PARTITIONS]);
+
 
 #endif
\ No newline at end of file
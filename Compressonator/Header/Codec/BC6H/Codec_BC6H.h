@@ -74,8 +74,11 @@ private:
 
     // Encoder interfaces
     CodecError    CInitializeBC6HLibrary();
-    CodecError    CEncodeBC6HBlock(float  in[BC6H_BLOCK_PIXELS][BC6H_MAX_DIMENSION_BIG],BYTE *out);
+    CodecError    CEncodeBC6HBlocks(float  in[][BC6H_BLOCK_PIXELS][BC6H_MAX_DIMENSION_BIG],DWORD numBlocks,BYTE *out);
     CodecError    CFinishBC6HEncoding(void);
+
+    // Decoder interfaces
+    CodecError    DecompressRGBA16F(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2);
 };
 
 #endif // !defined(_CODEC_DXT5_H_INCLUDED_)
@@ -35,6 +35,11 @@ public:
     void DecompressBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                          BYTE   in[COMPRESSED_BLOCK_SIZE]);
 
+    // Integer decode straight to 8 bit RGBA texels, rows of the block are dwPitch bytes apart
+    void DecompressBlockRGBA8(BYTE   *out,
+                              DWORD  dwPitch,
+                              BYTE   in[COMPRESSED_BLOCK_SIZE]);
+
 private:
 
     void DecompressDualIndexBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
@@ -33,6 +33,9 @@ typedef unsigned char   BYTE;
 // Largest possible size for an individual subset
 #define MAX_SUBSET_SIZE         16
 
+// Width and height of a block in texels
+#define BLOCK_WIDTH             4
+
 // Maximum number of possible subsets
 #define MAX_SUBSETS             3
 
@@ -100,6 +103,10 @@ typedef struct
 
 extern BTI bti[NUM_BLOCK_TYPES];
 
+// Set from the CPU features allowed by CMP_SetCPUFeatureMask, picks the SSE2 kernels
+// of the partition estimates and the decoder
+extern bool g_bBC7UseSSE2;
+
 #ifndef min
 
 #define min(a,b) ((a) < (b) ? (a) : (b))
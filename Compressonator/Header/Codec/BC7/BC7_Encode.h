@@ -25,6 +25,7 @@
 #define _BC7_ENCODE_H_
 
 #include <float.h>
+#include <math.h>
 #include "BC7_definitions.h"
 
 // Threshold quality below which we will always run fast quality and shaking
@@ -32,6 +33,9 @@
 extern double g_qFAST_THRESHOLD;
 extern double g_HIGHQULITY_THRESHOLD;
 
+// Maximum number of blocks handled by one call to CompressBlocks
+#define BC7_BATCH_BLOCKS    8
+
 class BC7BlockEncoder
 {
 public:
@@ -41,7 +45,9 @@ public:
                     double quality,
                     BOOL colourRestrict,
                     BOOL alphaRestrict,
-                    double performance = 1.0
+                    double performance = 1.0,
+                    DWORD  partitionCandidates = 0,
+                    double errorTarget = 0.0
                     )
                     {
                         // Bug check : ModeMask must be > 0
@@ -57,6 +63,9 @@ public:
                         m_largestError       = 0.0;
                         m_colourRestrict     = colourRestrict;
                         m_alphaRestrict      = alphaRestrict;
+                        m_errorTarget        = max(errorTarget, 0.0);
+                        m_blocksEncoded      = 0;
+                        m_workDone           = 0.0;
                         
                         m_quantizerRangeThreshold  = 255 * m_performance;
 
@@ -67,8 +76,6 @@ public:
                             // Scale m_quality to be a linar range 0 to 1 in this section 
                             // to maximize quality with fast performance...
                             m_errorThreshold = 256. * (1.0 - ((m_quality*2.0)/g_qFAST_THRESHOLD));
-                            // Limit the size of the partition search space based on Quality
-                            m_partitionSearchSize = max( (1.0/16.0) , ((m_quality*2.0) / g_qFAST_THRESHOLD));
                         }
                         else
                         {
@@ -81,16 +88,30 @@ public:
                             {
                                 m_shakerRangeThreshold  = 255 * (m_quality / 10);                    // gain  performance within FAST_THRESHOLD and HIGHQULITY_THRESHOLD range
                                 m_errorThreshold = 256. * (1.0 - (m_quality/g_qFAST_THRESHOLD));
-                                // Limit the size of the partition search space based on Quality
-                                m_partitionSearchSize = max( (1.0/16.0) , (m_quality / g_qFAST_THRESHOLD));
                             }
                             else
                             {
                                 m_shakerRangeThreshold  = 255 * m_quality;     // lowers performance with incresing values
                                 m_errorThreshold = 0;                         // Dont exit early 
-                                m_partitionSearchSize   = 1.0;                 // use all partitions for best quality
                             }
                         }
+
+                        // Number of partitions that are fully quantized for the shared index modes after
+                        // ranking all of them with the partition estimator, 0 derives it from quality.
+                        // At or above the high quality threshold every partition is quantized
+                        if (partitionCandidates > 0)
+                            m_partitionCandidates = min(partitionCandidates, MAX_PARTITIONS);
+                        else
+                        if (m_quality < g_HIGHQULITY_THRESHOLD)
+                            m_partitionCandidates = max(8, (DWORD)floor((MAX_PARTITIONS * m_quality / g_HIGHQULITY_THRESHOLD) + 0.5));
+                        else
+                            m_partitionCandidates = MAX_PARTITIONS;
+
+                        // Adaptive mode: errorTarget is a per texel per channel MSE, the search for a
+                        // block stops as soon as its summed error reaches the target and only blocks
+                        // above it go on to the full search set by quality
+                        if (m_errorTarget > 0)
+                            m_errorThreshold = m_errorTarget * MAX_SUBSET_SIZE * (m_imageNeedsAlpha ? 4 : 3);
     };
 
 
@@ -106,8 +127,36 @@ public:
     double CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                          BYTE   out[COMPRESSED_BLOCK_SIZE]);
 
+    // Compresses numBlocks (up to BC7_BATCH_BLOCKS) blocks to consecutive locations in out.
+    // The blocks go through the block modes together so partition ranking runs with one
+    // block per SSE2 lane when g_bBC7UseSSE2 allows, blocks drop out of the search as they
+    // reach the error threshold. Only the 4 lane ranking is done across blocks, quantizing,
+    // shaking and mode encoding run a block at a time and have no AVX2 path.
+    // Each block is encoded exactly as CompressBlock would
+    void   CompressBlocks(double in[][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+                          BYTE   *out,
+                          DWORD  numBlocks);
+
+    // Search statistics, one unit of work is a partition or rotation candidate quantized or shaken
+    DWORD   GetBlocksEncoded() { return m_blocksEncoded; };
+    double  GetWorkDone()      { return m_workDone; };
+    void    ResetStatistics()  { m_blocksEncoded = 0; m_workDone = 0.0; };
+
+    // Changes the block modes used for the following blocks, the encoder must be idle
+    void    SetModeMask(DWORD validModeMask) { m_validModeMask = (validModeMask > 0) ? validModeMask : 0xCF; };
+
 private:
 
+    // Sets up the block min, max and ranges and returns the block modes that may be used for it
+    DWORD   BlockModeMask(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG]);
+
+    // Compresses a block with the given block mode, estimatedError holds precomputed
+    // partition estimates or is NULL to have them computed here
+    double  CompressBlockMode(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+                              BYTE   out[COMPRESSED_BLOCK_SIZE],
+                              DWORD  blockMode,
+                              double *estimatedError);
+
     void    BlockSetup(DWORD blockMode);
     void    EncodeSingleIndexBlock(DWORD blockMode,
                                    DWORD partition,
@@ -118,7 +167,8 @@ private:
     // This routine compresses a block to any of the single index modes
     double CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                                   BYTE   out[COMPRESSED_BLOCK_SIZE],
-                                  DWORD  blockMode);
+                                  DWORD  blockMode,
+                                  double *estimatedError);
 
     void EncodeDualIndexBlock(DWORD blockMode,
                               DWORD indexSelection,
@@ -147,12 +197,13 @@ private:
     // and shaker paths
     double m_quantizerRangeThreshold;
     double m_shakerRangeThreshold;
-    double m_partitionSearchSize;
+    DWORD  m_partitionCandidates;
     
     // Global data setup at initialisation time
     double m_quality;
     double m_performance;
     double m_errorThreshold;
+    double m_errorTarget;
     DWORD  m_validModeMask;
     BOOL   m_imageNeedsAlpha;
     BOOL   m_colourRestrict;
@@ -166,6 +217,8 @@ private:
     // Error stats
     double m_smallestError;
     double m_largestError;
+    DWORD  m_blocksEncoded;
+    double m_workDone;
 
 };
 
@@ -49,6 +49,15 @@
 // Number of pixels in a BC7 block
 #define BC7_BLOCK_PIXELS   BC7_BLOCK_BYTES
 
+// Automatic mode mask pre-pass: one block is sampled every BC7_AUTOMASK_STEP blocks in x and y
+// (the step grows to keep to BC7_AUTOMASK_MAX_SAMPLES), textures with fewer than
+// BC7_AUTOMASK_MIN_BLOCKS blocks keep their mode mask. A mode is kept when it wins at least
+// 1 in BC7_AUTOMASK_MIN_SHARE of the sampled blocks
+#define BC7_AUTOMASK_STEP           4
+#define BC7_AUTOMASK_MAX_SAMPLES    4096
+#define BC7_AUTOMASK_MIN_BLOCKS     256
+#define BC7_AUTOMASK_MIN_SHARE      32
+
 
 extern void Quant_DeInit();
 extern void Quant_Init();
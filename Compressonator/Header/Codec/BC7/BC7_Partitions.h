@@ -29,6 +29,7 @@
 
 extern DWORD    BC7_PARTITIONS[MAX_SUBSETS][MAX_PARTITIONS][MAX_SUBSET_SIZE];
 extern DWORD    BC7_FIXUPINDICES[MAX_SUBSETS][MAX_PARTITIONS][3];
+extern WORD     BC7_PARTITION_MASKS[MAX_SUBSETS][MAX_PARTITIONS][MAX_SUBSETS];
 
 
 extern void    Partition(DWORD partition,
@@ -38,5 +39,23 @@ extern void    Partition(DWORD partition,
                   DWORD blockType,
                   int   dimension);
 
+// Cheap per partition error estimate used to rank partitions before quantization
+extern void    EstimatePartitionErrors(double in[][MAX_DIMENSION_BIG],
+                                DWORD  blockType,
+                                int    dimension,
+                                DWORD  numPartitions,
+                                double error[MAX_PARTITIONS]);
+
+// Number of blocks ranked together by EstimatePartitionErrorsSoA
+#define BC7_ESTIMATE_LANES  4
+
+// Partition estimates for BC7_ESTIMATE_LANES blocks in structure of arrays layout, in[pixel][component][block].
+// For blocks of 8-bit integer texels the results match EstimatePartitionErrors on each block
+extern void    EstimatePartitionErrorsSoA(float  in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG][BC7_ESTIMATE_LANES],
+                                   DWORD  blockType,
+                                   int    dimension,
+                                   DWORD  numPartitions,
+                                   double error[BC7_ESTIMATE_LANES][MAX_PARTITIONS]);
+
 
 #endif
\ No newline at end of file
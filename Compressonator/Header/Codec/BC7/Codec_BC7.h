@@ -43,6 +43,8 @@ public:
     virtual bool SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue);
     virtual bool SetParameter(const CMP_CHAR* /*pszParamName*/, CMP_DWORD /*dwValue*/);
     virtual bool SetParameter(const CMP_CHAR* /*pszParamName*/, CODECFLOAT /*fValue*/);
+    virtual bool GetParameter(const CMP_CHAR* pszParamName, CMP_DWORD& dwValue);
+    virtual bool GetParameter(const CMP_CHAR* pszParamName, CODECFLOAT& fValue);
 
     // Required interfaces
     virtual CodecError Compress             (CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc = NULL, DWORD_PTR pUser1 = NULL, DWORD_PTR pUser2 = NULL);
@@ -60,6 +62,9 @@ private:
     BOOL    m_AlphaRestrict;
     WORD    m_NumThreads;    
     BOOL    m_ImageNeedsAlpha;
+    DWORD   m_PartitionCandidates;
+    double  m_ErrorTarget;
+    BOOL    m_AutoModeMask;
 
 
     // BC7 Internal status 
@@ -69,6 +74,11 @@ private:
     WORD     m_LiveThreads;
     WORD     m_LastThread;
 
+    // Automatic mode mask pre-pass results
+    double   m_SampleWorkPerBlock;
+    double   m_SampleTime;
+    double   m_ModeMaskTimeSaved;
+
     // BC7 Encoders and decoders: for encding use the interfaces below
     HANDLE*                m_EncodingThreadHandle;
     BC7BlockEncoder*    m_encoder[MAX_BC7_THREADS];
@@ -76,8 +86,9 @@ private:
 
     // Encoder interfaces
     CodecError    InitializeBC7Library();
-    CodecError    EncodeBC7Block(double  in[BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG],BYTE *out);
+    CodecError    EncodeBC7Blocks(double  in[][BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG],DWORD numBlocks,BYTE *out);
     CodecError    FinishBC7Encoding(void);
+    CodecError    SelectModeMask(CCodecBuffer& bufferIn, CMP_DWORD dwBlocksX, CMP_DWORD dwBlocksY);
 };
 
 #endif // !defined(_CODEC_DXT5_H_INCLUDED_)
@@ -60,6 +60,9 @@ typedef enum _CodecType
     CT_ETC_RGBA_Interpolated,
 #endif // SUPPORT_ETC_ALPHA
     CT_ETC2_RGB,
+    CT_ETC2_RGBA,
+    CT_EAC_R11,
+    CT_EAC_RG11,
     CT_BC6H,
     CT_BC7,
     CT_ASTC,
@@ -114,6 +117,19 @@ using namespace AMD_Compress;
 
 bool SupportsSSE();
 bool SupportsSSE2();
+bool SupportsSSE41();
+bool SupportsAVX2();
+bool SupportsAVX512();
+bool SupportsF16C();
+bool SupportsBMI2();
+
+// CPU features detected once and filtered by the mask, a combination of CMP_CPU_FEATURE_ flags
+CMP_DWORD GetCPUFeatures();
+void SetCPUFeatureMask(CMP_DWORD dwFeatureMask);
+
+// Fills a codec's kernel table from the CPU features, run at registration and on every mask change
+typedef void (*CPUDispatchProc)(CMP_DWORD dwCPUFeatures);
+bool RegisterCPUDispatch(CPUDispatchProc pDispatchProc);
 
 CCodec* CreateCodec(CodecType nCodecType);
 CMP_DWORD CalcBufferSize(CodecType nCodecType, CMP_DWORD dwWidth, CMP_DWORD dwHeight, CMP_BYTE nBlockWidth, CMP_BYTE nBlockHeight);
@@ -63,6 +63,11 @@ protected:
     virtual CodecError CompressRGBABlock_ExplicitAlpha_Fast(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
     virtual CodecError CompressRGBABlock_ExplicitAlpha_SuperFast(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
 
+    virtual CodecError CompressAlphaBlock_UltraFast(CMP_BYTE alphaBlock[BLOCK_SIZE_4X4], CMP_DWORD compressedBlock[2]);
+    virtual CodecError CompressRGBBlock_UltraFast(CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2], bool bDXT1UseAlpha = false, CMP_BYTE nDXT1AlphaThreshold = 0);
+    virtual CodecError CompressRGBABlock_UltraFast(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
+    virtual CodecError CompressRGBABlock_ExplicitAlpha_UltraFast(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
+
     virtual CodecError CompressAlphaBlock(CODECFLOAT alphaBlock[BLOCK_SIZE_4X4], CMP_DWORD compressedBlock[2]);
     virtual CodecError CompressExplicitAlphaBlock(CODECFLOAT alphaBlock[BLOCK_SIZE_4X4], CMP_DWORD compressedBlock[2]);
     virtual CodecError CompressRGBBlock(CODECFLOAT rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2], CODECFLOAT* pfChannelWeights = NULL, bool bDXT1 = false, bool bDXT1UseAlpha = false, CODECFLOAT fDXT1AlphaThreshold = 0.0);
@@ -97,6 +102,7 @@ protected:
     bool m_b3DRefinement;
     bool m_bSwizzleChannels;
     CMP_BYTE m_nRefinementSteps;
+    CODECFLOAT m_fRefinementEffort;
     CMP_Speed m_nCompressionSpeed;
 
     CODECFLOAT m_fBaseChannelWeights[3];
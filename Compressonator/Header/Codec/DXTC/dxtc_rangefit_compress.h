@@ -0,0 +1,43 @@
+//===============================================================================
+// Copyright (c) 2007-2016  Advanced Micro Devices, Inc. All rights reserved.
+// Copyright (c) 2004-2006 ATI Technologies Inc.
+//===============================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef AMD_DXTC_RANGEFIT_COMP_H
+#define AMD_DXTC_RANGEFIT_COMP_H
+
+///
+//    Public Functions
+//
+//    Real time range fit DXTC block encoders used by CMP_Speed_UltraFast.
+//    The colour endpoints are the inset bounding box of the block, with the
+//    box diagonal chosen from the sign of the colour covariance, and the
+//    indices are picked by projecting each texel onto the quantized endpoints
+//    in fixed point. nRedOffset is the byte offset of red in each texel, 2 for
+//    ARGB8888 and 0 when the channels are swizzled.
+//
+
+void DXTCRangeFitCompressBlock(DWORD block_32[16], DWORD block_dxtc[2], int nRedOffset,
+                               bool bDXT1UseAlpha = false, BYTE nAlphaThreshold = 0);
+
+void DXTCRangeFitCompressAlphaBlock(BYTE block_8[16], DWORD block_dxtc[2]);
+
+#endif /* AMD_DXTC_RANGEFIT_COMP_H */
@@ -0,0 +1,60 @@
+//===============================================================================
+// Copyright (c) 2007-2016  Advanced Micro Devices, Inc. All rights reserved.
+// Copyright (c) 2004-2006 ATI Technologies Inc.
+//===============================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+//  File Name:   Codec_EAC.h
+//  Description: interface for the CCodec_EAC class
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _Codec_EAC_H_INCLUDED_
+#define _Codec_EAC_H_INCLUDED_
+
+#include "Codec_Block_4x4.h"
+#include "etcpack.h"
+
+// EAC R11 and RG11, one 8 byte EAC block per channel
+class CCodec_EAC : public CCodec_Block_4x4
+{
+public:
+    CCodec_EAC(CodecType codecType, CMP_DWORD dwChannels);
+    virtual ~CCodec_EAC();
+
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue);
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CMP_DWORD dwValue);
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue);
+
+    virtual CodecError Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc = NULL, DWORD_PTR pUser1 = NULL, DWORD_PTR pUser2 = NULL);
+    virtual CodecError Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc = NULL, DWORD_PTR pUser1 = NULL, DWORD_PTR pUser2 = NULL);
+
+protected:
+    static CodecError CompressBlockProc(CCodec* pCodec, CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
+    CodecError CompressBlock(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
+
+    void DecompressBlock(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
+
+    CMP_DWORD   m_dwChannels;       // 1 for R11, 2 for RG11
+    ETC_QUALITY m_eQuality;         // Encoder tier picked from the "Quality" parameter
+    CMP_DWORD   m_dwNumThreads;     // 0 uses one thread per processor
+};
+#endif // !defined(_Codec_EAC_H_INCLUDED_)
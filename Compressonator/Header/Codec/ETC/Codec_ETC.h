@@ -30,6 +30,7 @@
 #define _Codec_ETC_H_INCLUDED_
 
 #include "Codec_Block_4x4.h"
+#include "etcpack.h"
 
 #define ATC_OFFSET_ALPHA 0
 #define ATC_OFFSET_RGB 2
@@ -40,7 +41,12 @@ public:
     CCodec_ETC(CodecType codecType);
     virtual ~CCodec_ETC();
 
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue);
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CMP_DWORD dwValue);
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue);
+
 protected:
+    static CodecError CompressRGBBlockProc(CCodec* pCodec, CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2]);
     CodecError CompressRGBBlock(CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2]);
     CodecError CompressRGBABlock_ExplicitAlpha(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
     CodecError CompressRGBABlock_InterpolatedAlpha(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4]);
@@ -55,5 +61,8 @@ protected:
 
     void EncodeAlphaBlock(CMP_DWORD compressedBlock[2], BYTE nEndpoints[2], BYTE nIndices[BLOCK_SIZE_4X4]);
     void GetCompressedAlphaRamp(CMP_BYTE alpha[8], CMP_DWORD compressedBlock[2]);
+
+    ETC_QUALITY m_eQuality;         // Encoder tier picked from the "Quality" parameter
+    CMP_DWORD   m_dwNumThreads;     // 0 uses one thread per processor
 };
 #endif // !defined(_Codec_ETC_H_INCLUDED_)
@@ -30,6 +30,7 @@
 #define _Codec_ETC2_H_INCLUDED_
 
 #include "Codec_Block_4x4.h"
+#include "etcpack.h"
 
 #define ATC_OFFSET_ALPHA 0
 #define ATC_OFFSET_RGB 2
@@ -40,10 +41,17 @@ public:
     CCodec_ETC2(CodecType codecType);
     virtual ~CCodec_ETC2();
 
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue);
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CMP_DWORD dwValue);
+    virtual bool SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue);
+
 protected:
+    static CodecError CompressRGBBlockProc(CCodec* pCodec, CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2]);
     CodecError CompressRGBBlock(CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2]);
 
     void DecompressRGBBlock(CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2]);
 
+    ETC_QUALITY m_eQuality;         // Encoder tier picked from the "Quality" parameter
+    CMP_DWORD   m_dwNumThreads;     // 0 uses one thread per processor
 };
 #endif // !defined(_Codec_ETC2_H_INCLUDED_)
@@ -23,12 +23,83 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include "Codec.h"
 #include "etcpack_lib.h"
 
+// Encoder quality tiers, selected from the codec "Quality" parameter
+//   ETC_QUALITY_FAST       : etcpack fast perceptual search (default)
+//   ETC_QUALITY_MEDIUM     : adds an exhaustive search of the ETC1 individual
+//                            and differential modes, the ETC2 T, H and planar
+//                            modes keep the fast search
+//   ETC_QUALITY_EXHAUSTIVE : exhaustive perceptual search of every mode
+typedef enum
+{
+    ETC_QUALITY_FAST,
+    ETC_QUALITY_MEDIUM,
+    ETC_QUALITY_EXHAUSTIVE
+} ETC_QUALITY;
+
+#define ETC_QUALITY_MEDIUM_THRESHOLD        0.5f
+#define ETC_QUALITY_EXHAUSTIVE_THRESHOLD    0.8f
+
+// Up to MAXIMUM_WAIT_OBJECTS worker threads, each taking ETC_BLOCKS_PER_JOB blocks
+// at a time to compress or ETC_DECODE_ROWS_PER_JOB block rows to decode
+#define ETC_MAX_THREADS                     64
+#define ETC_BLOCKS_PER_JOB                  8
+#define ETC_DECODE_ROWS_PER_JOB             2
+
+ETC_QUALITY atiGetQualityETC(float fQuality);
+
 void atiEncodeRGBBlockETC(
         unsigned char *pPixels,     //for Color888_t(* pPixels)[ 4 ] [ 4 ]
         unsigned int *pCompressed1,    // Return value
-        unsigned int *pCompressed2     // Return value
+        unsigned int *pCompressed2,    // Return value
+        ETC_QUALITY   eQuality = ETC_QUALITY_FAST
+    );
+
+void atiEncodeRGBBlockETC2(
+        unsigned char *pPixels,     //for Color888_t(* pPixels)[ 4 ] [ 4 ]
+        unsigned int *pCompressed1,    // Return value
+        unsigned int *pCompressed2,    // Return value
+        ETC_QUALITY   eQuality = ETC_QUALITY_FAST
+    );
+
+// EAC blocks, the alpha of ETC2 RGBA8 and each channel of R11 and RG11.
+// The 16 values are in row order, compressedBlock is the 8 byte block.
+// The 11 bit channels take and return 16 bit values, bit replicated the
+// same way etcpack does.
+void atiEncodeAlphaBlockEAC(
+        CMP_BYTE      alphaBlock[BLOCK_SIZE_4X4],
+        CMP_BYTE      compressedBlock[8],
+        ETC_QUALITY   eQuality = ETC_QUALITY_FAST
+    );
+
+void atiEncodeR11BlockEAC(
+        CMP_WORD      redBlock[BLOCK_SIZE_4X4],
+        CMP_BYTE      compressedBlock[8],
+        ETC_QUALITY   eQuality = ETC_QUALITY_FAST
+    );
+
+void atiDecodeAlphaBlockEAC(CMP_BYTE alphaBlock[BLOCK_SIZE_4X4], CMP_BYTE compressedBlock[8]);
+void atiDecodeR11BlockEAC(CMP_WORD redBlock[BLOCK_SIZE_4X4], CMP_BYTE compressedBlock[8]);
+
+// Compresses every 4x4 block of bufferIn into bufferOut with pCompressBlock,
+// which writes dwBlockSize DWORDs per block.
+// The blocks are handed out in jobs of ETC_BLOCKS_PER_JOB to dwNumThreads
+// threads (0 uses one per processor), so blocks with a slow exhaustive search
+// do not hold up the other threads. pCompressBlock must be thread safe.
+typedef CodecError (*ETC_CompressBlockProc)(CCodec* pCodec, CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[]);
+
+CodecError atiCompressBlocksETC(
+        CCodec* pCodec,
+        ETC_CompressBlockProc pCompressBlock,
+        CMP_DWORD dwBlockSize,
+        CMP_DWORD dwNumThreads,
+        CCodecBuffer& bufferIn,
+        CCodecBuffer& bufferOut,
+        Codec_Feedback_Proc pFeedbackProc,
+        DWORD_PTR pUser1,
+        DWORD_PTR pUser2
     );
 
 void atiDecodeRGBBlockETC(
@@ -37,4 +108,34 @@ void atiDecodeRGBBlockETC(
     unsigned int compressed2
     );
 
+// Decodes dwBlocksX * dwBlocksY CT_ETC_RGB, CT_ETC2_RGB or CT_ETC2_RGBA blocks,
+// rows of blocks dwInPitch bytes apart, straight into 8 bit RGBA texel rows
+// dwOutPitch bytes apart. Red is nRedOffset bytes into each texel and blue
+// 2 - nRedOffset, so 0 writes R,G,B,A and RGBA8888_CHANNEL_R the codec buffer
+// order. The rows of blocks are handed out in jobs to dwNumThreads threads
+// (0 uses one per processor), which are started once for the whole call.
+// The texels are the same as the etcpack decoders give.
+void atiDecodeBlocksETC(
+    CodecType nCodecType,
+    const CMP_BYTE* pIn,
+    CMP_DWORD dwInPitch,
+    CMP_DWORD dwBlocksX,
+    CMP_DWORD dwBlocksY,
+    CMP_BYTE* pOut,
+    CMP_DWORD dwOutPitch,
+    int nRedOffset,
+    CMP_DWORD dwNumThreads
+    );
+
+// Decompress for codec buffers with RGBA8888 output, through atiDecodeBlocksETC
+CodecError atiDecompressBlocksETC(
+    CodecType nCodecType,
+    CMP_DWORD dwNumThreads,
+    CCodecBuffer& bufferIn,
+    CCodecBuffer& bufferOut,
+    Codec_Feedback_Proc pFeedbackProc,
+    DWORD_PTR pUser1,
+    DWORD_PTR pUser2
+    );
+
 #endif
@@ -10,6 +10,10 @@ typedef unsigned char uint8;
 // ETC1
 void compressBlockDiffFlipFastPerceptual(uint8 *img, uint8 *imgdec, int width, int height, int startx, int starty, unsigned int &compressed1, unsigned int &compressed2);
 void decompressBlockDiffFlip(unsigned int block_part1, unsigned int block_part2, uint8 *img, int width, int height, int startx, int starty);
+// ETC1 - Slow
+void compressBlockETC1ExhaustivePerceptual(uint8 *img, uint8 *imgdec, int width, int height, int startx, int starty, unsigned int &compressed1, unsigned int &compressed2);
+
+double calcBlockPerceptualErrorRGB(uint8 *img, uint8 *imgdec, int width, int height, int startx, int starty);
 
 bool readCompressParams(void);
 
@@ -19,4 +23,9 @@ void compressBlockETC2FastPerceptual(uint8 *img, uint8 *imgdec, int width, int h
 void compressBlockETC2ExhaustivePerceptual(uint8 *img, uint8 *imgdec, int width, int height, int startx, int starty, unsigned int &compressed1, unsigned int &compressed2);
 void decompressBlockETC2(unsigned int block_part1, unsigned int block_part2, uint8 *img, int width, int height, int startx, int starty);
 
+// EAC - alpha and 11 bit channels
+void setupAlphaTable(void);
+void decompressBlockAlpha(uint8* data, uint8* img, int width, int height, int ix, int iy);
+void decompressBlockAlpha16bit(uint8* data, uint8* img, int width, int height, int ix, int iy);
+
 #endif
\ No newline at end of file
@@ -114,16 +114,21 @@ typedef enum
    CMP_FORMAT_ETC_RGB,                    ///< ETC  (Ericsson Texture Compression) 
    CMP_FORMAT_ETC2_RGB,                   ///< ETC2 (Ericsson Texture Compression) 
    CMP_FORMAT_GT,                         ///< GT   (Reserved for a future implementation)
+   // Formats added after GT, so the values above stay the same for existing binaries
+   CMP_FORMAT_ETC2_RGBA,                  ///< ETC2 RGBA8, ETC2 RGB with an EAC alpha channel. Eight bits per pixel.
+   CMP_FORMAT_EAC_R11,                    ///< EAC R11, single component 11 bit compressed format. Four bits per pixel.
+   CMP_FORMAT_EAC_RG11,                   ///< EAC RG11, two component 11 bit compressed format. Eight bits per pixel.
                                           //--------------------------------------------------------------------------------------------------------
-   CMP_FORMAT_MAX = CMP_FORMAT_GT
+   CMP_FORMAT_MAX = CMP_FORMAT_EAC_RG11
 } CMP_FORMAT;
 
 /// An enum selecting the speed vs. quality trade-off.
 typedef enum
 {
    CMP_Speed_Normal,                      ///< Highest quality mode
-   CMP_Speed_Fast,                        ///< Slightly lower quality but much faster compression mode - DXTn & ATInN only
-   CMP_Speed_SuperFast,                   ///< Slightly lower quality but much, much faster compression mode - DXTn & ATInN only
+   CMP_Speed_Fast,                        ///< Slightly lower quality but much faster compression mode - DXTn, ATInN & BC6H only
+   CMP_Speed_SuperFast,                   ///< Slightly lower quality but much, much faster compression mode - DXTn, ATInN & BC6H only
+   CMP_Speed_UltraFast,                   ///< Real time range fit encoder for runtime texture streaming, lowest quality - DXT1 to DXT5 & BC1 to BC3 only
 } CMP_Speed;
 
 /// An enum selecting the different GPU driver types.
@@ -246,8 +251,30 @@ typedef struct
     CMP_BYTE*    pData;                      ///< Pointer to the texture data
 } CMP_Texture;
 
+/// Statistics of the last texture compressed with CMP_ConvertTexture.
+/// Fields are zero when the codec does not report them (only BC7 does on this release)
+typedef struct
+{
+    CMP_DWORD    dwSize;                     ///< Size of this structure.
+    CMP_DWORD    dwBlocksEncoded;            ///< Number of blocks encoded.
+    double       fWorkPerBlock;              ///< Average number of partition or rotation candidates quantized and shaken per block,
+                                             ///< shows how much of the search the quality setting or error target (TargetMSE, TargetPSNR) needed
+    CMP_DWORD    dwModeMask;                 ///< BC7 block modes used for the encode, the mask picked by the pre-pass when AutoModeMask is set
+    double       fModeMaskTimeSaved;         ///< Estimated seconds saved by the AutoModeMask pre-pass including its own cost, negative if it cost time
+} CMP_CompressStats;
+
 #define MINIMUM_WEIGHT_VALUE 0.01f
 
+/// CPU features used by the codec kernels, see CMP_GetCPUFeatures and CMP_SetCPUFeatureMask
+#define CMP_CPU_FEATURE_SSE         0x00000001   ///< SSE
+#define CMP_CPU_FEATURE_SSE2        0x00000002   ///< SSE2
+#define CMP_CPU_FEATURE_SSE41       0x00000004   ///< SSE4.1
+#define CMP_CPU_FEATURE_AVX2        0x00000008   ///< AVX2
+#define CMP_CPU_FEATURE_AVX512      0x00000010   ///< AVX-512F
+#define CMP_CPU_FEATURE_F16C        0x00000020   ///< F16C half float conversions
+#define CMP_CPU_FEATURE_BMI2        0x00000040   ///< BMI2
+#define CMP_CPU_FEATURE_ALL         0xFFFFFFFF   ///< All detected features, the default mask
+
 //=================================================================================
 // Number of image components
 #define BC_COMPONENT_COUNT 4
@@ -397,6 +424,29 @@ extern "C" {
     BC_ERROR CMP_API CMP_DecodeBC6HBlock(BYTE* in, CMP_FLOAT  out[BC_BLOCK_PIXELS][BC_COMPONENT_COUNT]);
     BC_ERROR CMP_API CMP_DecodeBC7Block(BYTE* in, double out[BC_BLOCK_PIXELS][BC_COMPONENT_COUNT]);
 
+    //
+    // CMP_DecodeBC7Blocks() - Decode an array of BC7 blocks to 8 bit RGBA texels
+    //
+    // This function takes blocksX * blocksY encoded blocks stored row by row and writes the decoded
+    // texels in R,G,B,A byte order to out. pitch is the distance in bytes between texel rows of out
+    // and must be at least blocksX * 16.
+    //
+    // Decoding uses integer arithmetic and gives the same texels as CMP_DecodeBC7Block()
+    //
+    BC_ERROR CMP_API CMP_DecodeBC7Blocks(BYTE* in, CMP_DWORD blocksX, CMP_DWORD blocksY, BYTE* out, CMP_DWORD pitch);
+
+    //
+    // CMP_DecodeBC6HBlocks() - Decode an array of BC6H blocks to half float RGBA texels
+    //
+    // This function takes blocksX * blocksY encoded blocks stored row by row and writes the decoded
+    // texels as 16 bit half floats in R,G,B,A order to out. pitch is the distance in bytes between texel
+    // rows of out and must be at least blocksX * 32. The rows of blocks are shared between numThreads
+    // threads, a numThreads of 0 uses one thread per processor.
+    //
+    // Decoding uses integer arithmetic and gives the same values as CMP_DecodeBC6HBlock()
+    //
+    BC_ERROR CMP_API CMP_DecodeBC6HBlocks(BYTE* in, CMP_DWORD blocksX, CMP_DWORD blocksY, BYTE* out, CMP_DWORD pitch, CMP_DWORD numThreads);
+
     //
     // CMP_DestroyBC6HEncoder() - Deletes a previously allocated encoder object
     // CMP_DestroyBC7Encoder()  - Deletes a previously allocated encoder object
@@ -434,6 +484,36 @@ extern "C" {
                                         const CMP_CompressOptions* pOptions,
                                         CMP_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2);
 
+   /// Returns the statistics of the last texture compressed with CMP_ConvertTexture
+   /// \param[out] pStats A pointer to the statistics, dwSize must be set to sizeof(CMP_CompressStats).
+   /// \return    CMP_OK if successful, otherwise the error code.
+   CMP_ERROR CMP_API CMP_GetCompressStats(CMP_CompressStats* pStats);
+
+   /// Decodes an array of ETC1, ETC2 RGB or ETC2 RGBA8 blocks straight to 8 bit RGBA texels, for previews and
+   /// analysis of large textures without creating a destination texture. The texels are the same as CMP_ConvertTexture gives.
+   /// \param[in] format     CMP_FORMAT_ETC_RGB, CMP_FORMAT_ETC2_RGB or CMP_FORMAT_ETC2_RGBA.
+   /// \param[in] pIn        blocksX * blocksY encoded blocks stored row by row.
+   /// \param[out] pOut      The decoded texels in R,G,B,A byte order.
+   /// \param[in] pitch      The distance in bytes between texel rows of pOut, at least blocksX * 16.
+   /// \param[in] numThreads The rows of blocks are shared between this many threads, 0 uses one thread per processor.
+   /// \return    CMP_OK if successful, otherwise the error code.
+   CMP_ERROR CMP_API CMP_DecodeETCBlocks(CMP_FORMAT format, CMP_BYTE* pIn, CMP_DWORD blocksX, CMP_DWORD blocksY,
+                                         CMP_BYTE* pOut, CMP_DWORD pitch, CMP_DWORD numThreads);
+
+   /// Returns the CPU features the codecs use, the features detected on this CPU
+   /// that are also in the mask set with CMP_SetCPUFeatureMask.
+   /// \return    A combination of the CMP_CPU_FEATURE_ flags.
+   CMP_DWORD CMP_API CMP_GetCPUFeatures();
+
+   /// Restricts the CPU features the codecs may use, so each instruction set level can be
+   /// run and compared on one machine. Clearing a level also clears the levels above it
+   /// (SSE, SSE2, SSE4.1, AVX2, AVX-512). Kernel tables are switched immediately and
+   /// codecs created afterwards pick their paths from the new mask, so call this while no
+   /// conversion is running.
+   /// \param[in] dwFeatureMask A combination of the CMP_CPU_FEATURE_ flags, CMP_CPU_FEATURE_ALL restores the default.
+   /// \return    CMP_OK if successful, otherwise the error code.
+   CMP_ERROR CMP_API CMP_SetCPUFeatureMask(CMP_DWORD dwFeatureMask);
+
 #ifdef __cplusplus
 };
 #endif
@@ -34,6 +34,9 @@
 #include <xmmintrin.h>
 #include <emmintrin.h>
 #endif // USE_SSE
+#if defined(USE_AVX2) || defined(USE_AVX512)
+#include <immintrin.h>
+#endif // USE_AVX2 || USE_AVX512
 
 #include "Codec.h"
 
@@ -460,6 +463,46 @@ static CODECFLOAT Refine3D(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
                           int _NmrClrs, CMP_BYTE dwNumPoints, CODECFLOAT* _pfWeights, 
                           CMP_BYTE nRedBits, CMP_BYTE nGreenBits, CMP_BYTE nBlueBits, CMP_BYTE nRefineSteps);
 
+/*------------------------------------------------------------------------------------------------
+Search effort of the colour encoder.
+
+The refinement effort is a continuous level in [0, 1] that sets how many end point pairs the
+ramp search along the axis tries, how many times the axis is refitted and how many passes of the
+per channel refinement are made. Every loop still stops as soon as its error stops improving.
+DXTC_DEFAULT_REFINEMENT_EFFORT gives the 8x8 ramp search, the unbounded axis refit and the
+single refinement pass of the original encoder.
+------------------------------------------------------------------------------------------------*/
+// extent of the ramp search along the normalized axis, the default effort searches 8 steps of 0.025
+#define RMP_SRCH_RANGE 0.2f
+#define MAX_REFINE_PASSES 4
+
+typedef struct
+{
+    int nRampSrchSteps;     // end point positions tried at each end of the ramp
+    int nAxisIterations;    // maximum number of axis refits, 0 runs until the error stops improving
+    int nRefinePasses;      // maximum number of refinement passes, 0 only measures the snapped ramp
+} XCodecEffort;
+
+static void GetXCodecEffort(XCodecEffort& effort, CODECFLOAT fEffort)
+{
+    if(fEffort < 0.f)
+        fEffort = 0.f;
+    if(fEffort > 1.f)
+        fEffort = 1.f;
+
+    // 4 to 12 steps, 8 at the default
+    effort.nRampSrchSteps = 4 + (int)(fEffort * 8.f + 0.5f);
+
+    // below the default the axis is refitted at most 1 to 3 times
+    effort.nAxisIterations = (fEffort < DXTC_DEFAULT_REFINEMENT_EFFORT) ? 1 + (int)(fEffort * 6.f) : 0;
+
+    // at the lowest levels the ramp is only snapped to the grid, above the default
+    // up to MAX_REFINE_PASSES refinement passes
+    effort.nRefinePasses = (fEffort < 0.2f) ? 0 : 1;
+    if(fEffort > DXTC_DEFAULT_REFINEMENT_EFFORT)
+        effort.nRefinePasses = min(1 + (int)((fEffort - DXTC_DEFAULT_REFINEMENT_EFFORT) * 6.f + 0.5f), MAX_REFINE_PASSES);
+}
+
 #ifdef USE_SSE
 /*------------------------------------------------------------------------------------------------
 
@@ -505,6 +548,341 @@ static CODECFLOAT RampSrchWSS2E(ALIGN_16 CODECFLOAT _Blck[MAX_BLOCK],
 
     return (error);
 }
+
+#ifdef USE_AVX2
+/*------------------------------------------------------------------------------------------------
+AVX2 version of RampSrchWSS2E, 8 colours per iteration.
+Both halves are added to a 4 wide accumulator in colour order so the result matches the SSE2 one.
+------------------------------------------------------------------------------------------------*/
+static CODECFLOAT RampSrchWAVX2(ALIGN_16 CODECFLOAT _Blck[MAX_BLOCK],
+                                ALIGN_16 CODECFLOAT _BlckErr[MAX_BLOCK],
+                                ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK],
+                                CODECFLOAT _maxerror, CODECFLOAT _min_ex, CODECFLOAT _max_ex,
+                                int _NmbClrs,
+                                CMP_BYTE dwNumPoints)
+{
+    CODECFLOAT error = _maxerror;
+    CODECFLOAT step = (_max_ex - _min_ex) / (dwNumPoints - 1);
+    CODECFLOAT rstep = (CODECFLOAT)1.0f / step;
+
+    const __m256 minEx = _mm256_set1_ps(_min_ex);
+    const __m256 maxEx = _mm256_set1_ps(_max_ex);
+
+    __m128 err = _mm_setzero_ps();
+    for(int i=0; i < _NmbClrs; i += 8)
+    {
+        __m256 b = _mm256_loadu_ps(&_Blck[i]);
+        // do not add half since rounding is different
+        __m256 v = _mm256_cvtepi32_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_sub_ps(b, minEx), _mm256_set1_ps(rstep))));
+
+        v = _mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(step)), minEx);
+        v = _mm256_min_ps(_mm256_max_ps(v, minEx), maxEx);
+
+        __m256 d = _mm256_sub_ps(b, v);
+        d = _mm256_mul_ps(d, d);
+        __m256 e = _mm256_add_ps(_mm256_loadu_ps(&_BlckErr[i]), _mm256_mul_ps(_mm256_loadu_ps(&_Rpt[i]), d));
+
+        err = _mm_add_ps(err, _mm256_castps256_ps128(e));
+        err = _mm_add_ps(err, _mm256_extractf128_ps(e, 1));
+    }
+    _mm256_zeroupper();
+
+    err = _mm_add_ps(_mm_movelh_ps(err, _mm_setzero_ps()),_mm_movehl_ps(_mm_setzero_ps(), err));
+    err = _mm_add_ps(err, _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(0,0,3,1)));
+    _mm_store_ss(&error, err); 
+
+    return (error);
+}
+#endif // USE_AVX2
+
+#ifdef USE_AVX512
+/*------------------------------------------------------------------------------------------------
+AVX-512 version of RampSrchWSS2E, 16 colours per iteration.
+------------------------------------------------------------------------------------------------*/
+static CODECFLOAT RampSrchWAVX512(ALIGN_16 CODECFLOAT _Blck[MAX_BLOCK],
+                                  ALIGN_16 CODECFLOAT _BlckErr[MAX_BLOCK],
+                                  ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK],
+                                  CODECFLOAT _maxerror, CODECFLOAT _min_ex, CODECFLOAT _max_ex,
+                                  int _NmbClrs,
+                                  CMP_BYTE dwNumPoints)
+{
+    CODECFLOAT error = _maxerror;
+    CODECFLOAT step = (_max_ex - _min_ex) / (dwNumPoints - 1);
+    CODECFLOAT rstep = (CODECFLOAT)1.0f / step;
+
+    const __m512 minEx = _mm512_set1_ps(_min_ex);
+    const __m512 maxEx = _mm512_set1_ps(_max_ex);
+
+    __m128 err = _mm_setzero_ps();
+    for(int i=0; i < _NmbClrs; i += 16)
+    {
+        __m512 b = _mm512_loadu_ps(&_Blck[i]);
+        // do not add half since rounding is different
+        __m512 v = _mm512_cvtepi32_ps(_mm512_cvtps_epi32(_mm512_mul_ps(_mm512_sub_ps(b, minEx), _mm512_set1_ps(rstep))));
+
+        v = _mm512_add_ps(_mm512_mul_ps(v, _mm512_set1_ps(step)), minEx);
+        v = _mm512_min_ps(_mm512_max_ps(v, minEx), maxEx);
+
+        __m512 d = _mm512_sub_ps(b, v);
+        d = _mm512_mul_ps(d, d);
+        __m512 e = _mm512_add_ps(_mm512_loadu_ps(&_BlckErr[i]), _mm512_mul_ps(_mm512_loadu_ps(&_Rpt[i]), d));
+
+        err = _mm_add_ps(err, _mm512_extractf32x4_ps(e, 0));
+        err = _mm_add_ps(err, _mm512_extractf32x4_ps(e, 1));
+        err = _mm_add_ps(err, _mm512_extractf32x4_ps(e, 2));
+        err = _mm_add_ps(err, _mm512_extractf32x4_ps(e, 3));
+    }
+    _mm256_zeroupper();
+
+    err = _mm_add_ps(_mm_movelh_ps(err, _mm_setzero_ps()),_mm_movehl_ps(_mm_setzero_ps(), err));
+    err = _mm_add_ps(err, _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(0,0,3,1)));
+    _mm_store_ss(&error, err); 
+
+    return (error);
+}
+#endif // USE_AVX512
+
+/*------------------------------------------------------------------------------------------------
+Error of one refinement candidate, the kernel of RefineSSE2 and Refine3DSSE2.
+For every colour takes the closest point of the ramp of the channel being refined,
+the error of the two other channels is precomputed per ramp point in _RmpErr[point][colour]:
+
+    sum(min_r((_Clr[i] - _Rmp[r])^2 * _fWeight + _RmpErr[r][i]) * _Rpt[i])
+
+Colours are processed across the vector lanes, the arrays must be padded with zeros up to
+REFINE_PAD(_NmrClrs). The partial sums are kept in 4 lanes accumulated 4 colours at a time
+and added in lane order, so the wider versions return exactly the SSE2 result.
+------------------------------------------------------------------------------------------------*/
+#define REFINE_PAD(n) (((n) + 15) & ~15)
+
+static inline CODECFLOAT RefineErrSum(__m128 Mse)
+{
+    ALIGN_16 CODECFLOAT fMse[4];
+    _mm_store_ps(fMse, Mse);
+    return fMse[0] + fMse[1] + fMse[2] + fMse[3];
+}
+
+static CODECFLOAT RefineErrSSE2(ALIGN_16 CODECFLOAT _Clr[MAX_BLOCK], ALIGN_16 CODECFLOAT _RmpErr[MAX_POINTS][MAX_BLOCK],
+                                CODECFLOAT _Rmp[MAX_POINTS], ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK], CODECFLOAT _fWeight,
+                                int _NmrClrs, CMP_BYTE dwNumPoints)
+{
+    __m128 weight = _mm_set_ps1(_fWeight);
+    __m128 Mse = _mm_setzero_ps();
+    for(int k = 0; k < _NmrClrs; k += 4)
+    {
+        __m128 c = _mm_load_ps(&_Clr[k]);
+        __m128 minErr = _mm_set_ps1(FLT_MAX);
+        for(int r = 0; r < dwNumPoints; r++)
+        {
+            // dist from ramp
+            __m128 d = _mm_sub_ps(c, _mm_set_ps1(_Rmp[r]));
+            d = _mm_mul_ps(_mm_mul_ps(d, d), weight);
+            // overall error
+            minErr = _mm_min_ps(minErr, _mm_add_ps(d, _mm_load_ps(&_RmpErr[r][k])));
+        }
+        // repeats
+        Mse = _mm_add_ps(Mse, _mm_mul_ps(minErr, _mm_load_ps(&_Rpt[k])));
+    }
+    return RefineErrSum(Mse);
+}
+
+#ifdef USE_AVX2
+static CODECFLOAT RefineErrAVX2(ALIGN_16 CODECFLOAT _Clr[MAX_BLOCK], ALIGN_16 CODECFLOAT _RmpErr[MAX_POINTS][MAX_BLOCK],
+                                CODECFLOAT _Rmp[MAX_POINTS], ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK], CODECFLOAT _fWeight,
+                                int _NmrClrs, CMP_BYTE dwNumPoints)
+{
+    __m256 weight = _mm256_set1_ps(_fWeight);
+    __m128 Mse = _mm_setzero_ps();
+    for(int k = 0; k < _NmrClrs; k += 8)
+    {
+        __m256 c = _mm256_loadu_ps(&_Clr[k]);
+        __m256 minErr = _mm256_set1_ps(FLT_MAX);
+        for(int r = 0; r < dwNumPoints; r++)
+        {
+            __m256 d = _mm256_sub_ps(c, _mm256_set1_ps(_Rmp[r]));
+            d = _mm256_mul_ps(_mm256_mul_ps(d, d), weight);
+            minErr = _mm256_min_ps(minErr, _mm256_add_ps(d, _mm256_loadu_ps(&_RmpErr[r][k])));
+        }
+        __m256 e = _mm256_mul_ps(minErr, _mm256_loadu_ps(&_Rpt[k]));
+        Mse = _mm_add_ps(Mse, _mm256_castps256_ps128(e));
+        Mse = _mm_add_ps(Mse, _mm256_extractf128_ps(e, 1));
+    }
+    _mm256_zeroupper();
+    return RefineErrSum(Mse);
+}
+#endif // USE_AVX2
+
+#ifdef USE_AVX512
+static CODECFLOAT RefineErrAVX512(ALIGN_16 CODECFLOAT _Clr[MAX_BLOCK], ALIGN_16 CODECFLOAT _RmpErr[MAX_POINTS][MAX_BLOCK],
+                                  CODECFLOAT _Rmp[MAX_POINTS], ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK], CODECFLOAT _fWeight,
+                                  int _NmrClrs, CMP_BYTE dwNumPoints)
+{
+    __m512 weight = _mm512_set1_ps(_fWeight);
+    __m128 Mse = _mm_setzero_ps();
+    for(int k = 0; k < _NmrClrs; k += 16)
+    {
+        __m512 c = _mm512_loadu_ps(&_Clr[k]);
+        __m512 minErr = _mm512_set1_ps(FLT_MAX);
+        for(int r = 0; r < dwNumPoints; r++)
+        {
+            __m512 d = _mm512_sub_ps(c, _mm512_set1_ps(_Rmp[r]));
+            d = _mm512_mul_ps(_mm512_mul_ps(d, d), weight);
+            minErr = _mm512_min_ps(minErr, _mm512_add_ps(d, _mm512_loadu_ps(&_RmpErr[r][k])));
+        }
+        __m512 e = _mm512_mul_ps(minErr, _mm512_loadu_ps(&_Rpt[k]));
+        Mse = _mm_add_ps(Mse, _mm512_extractf32x4_ps(e, 0));
+        Mse = _mm_add_ps(Mse, _mm512_extractf32x4_ps(e, 1));
+        Mse = _mm_add_ps(Mse, _mm512_extractf32x4_ps(e, 2));
+        Mse = _mm_add_ps(Mse, _mm512_extractf32x4_ps(e, 3));
+    }
+    _mm256_zeroupper();
+    return RefineErrSum(Mse);
+}
+#endif // USE_AVX512
+
+/*------------------------------------------------------------------------------------------------
+Single channel ramp search (BC4, BC5, DXT5 alpha) for several ramps at once, one ramp per lane.
+Ramp k goes from _Min[k] to _Max[k], its error over the values _Blck weighted by _Rpt is
+written to _Err[k]. The arrays hold RMP1_BATCH ramps, the kernels round _NmbRmps up
+to their vector width.
+Each lane keeps 4 partial sums over the values (value i goes to sum i % 4) and adds them as
+(s0 + s2) + (s1 + s3), the order of the 4 wide search over values, so all the versions give
+the same errors.
+------------------------------------------------------------------------------------------------*/
+#define RMP1_BATCH 16
+
+static void RmpSrch1SSE2(ALIGN_16 CODECFLOAT _Blck[MAX_BLOCK], ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK],
+                         int _NmbClrs, CMP_BYTE dwNumPoints,
+                         CODECFLOAT* _Min, CODECFLOAT* _Max, CODECFLOAT* _Err, int _NmbRmps)
+{
+    const __m128 numSteps = _mm_set_ps1((CODECFLOAT)(dwNumPoints - 1));
+    for(int k = 0; k < _NmbRmps; k += 4)
+    {
+        __m128 minEx = _mm_loadu_ps(&_Min[k]);
+        __m128 maxEx = _mm_loadu_ps(&_Max[k]);
+        __m128 step = _mm_div_ps(_mm_sub_ps(maxEx, minEx), numSteps);
+        __m128 rstep = _mm_div_ps(_mm_set_ps1(1.f), step);
+
+        __m128 err[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+        for(int i = 0; i < _NmbClrs; i++)
+        {
+            __m128 b = _mm_set_ps1(_Blck[i]);
+            // do not add half since rounding is different
+            __m128 v = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(b, minEx), rstep)));
+            v = _mm_add_ps(_mm_mul_ps(v, step), minEx);
+            v = _mm_min_ps(_mm_max_ps(v, minEx), maxEx);
+
+            __m128 d = _mm_sub_ps(b, v);
+            err[i & 3] = _mm_add_ps(err[i & 3], _mm_mul_ps(_mm_set_ps1(_Rpt[i]), _mm_mul_ps(d, d)));
+        }
+        _mm_storeu_ps(&_Err[k], _mm_add_ps(_mm_add_ps(err[0], err[2]), _mm_add_ps(err[1], err[3])));
+    }
+}
+
+#ifdef USE_AVX2
+static void RmpSrch1AVX2(ALIGN_16 CODECFLOAT _Blck[MAX_BLOCK], ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK],
+                         int _NmbClrs, CMP_BYTE dwNumPoints,
+                         CODECFLOAT* _Min, CODECFLOAT* _Max, CODECFLOAT* _Err, int _NmbRmps)
+{
+    const __m256 numSteps = _mm256_set1_ps((CODECFLOAT)(dwNumPoints - 1));
+    for(int k = 0; k < _NmbRmps; k += 8)
+    {
+        __m256 minEx = _mm256_loadu_ps(&_Min[k]);
+        __m256 maxEx = _mm256_loadu_ps(&_Max[k]);
+        __m256 step = _mm256_div_ps(_mm256_sub_ps(maxEx, minEx), numSteps);
+        __m256 rstep = _mm256_div_ps(_mm256_set1_ps(1.f), step);
+
+        __m256 err[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+        for(int i = 0; i < _NmbClrs; i++)
+        {
+            __m256 b = _mm256_set1_ps(_Blck[i]);
+            __m256 v = _mm256_cvtepi32_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_sub_ps(b, minEx), rstep)));
+            v = _mm256_add_ps(_mm256_mul_ps(v, step), minEx);
+            v = _mm256_min_ps(_mm256_max_ps(v, minEx), maxEx);
+
+            __m256 d = _mm256_sub_ps(b, v);
+            err[i & 3] = _mm256_add_ps(err[i & 3], _mm256_mul_ps(_mm256_set1_ps(_Rpt[i]), _mm256_mul_ps(d, d)));
+        }
+        _mm256_storeu_ps(&_Err[k], _mm256_add_ps(_mm256_add_ps(err[0], err[2]), _mm256_add_ps(err[1], err[3])));
+    }
+    _mm256_zeroupper();
+}
+#endif // USE_AVX2
+
+#ifdef USE_AVX512
+static void RmpSrch1AVX512(ALIGN_16 CODECFLOAT _Blck[MAX_BLOCK], ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK],
+                           int _NmbClrs, CMP_BYTE dwNumPoints,
+                           CODECFLOAT* _Min, CODECFLOAT* _Max, CODECFLOAT* _Err, int _NmbRmps)
+{
+    const __m512 numSteps = _mm512_set1_ps((CODECFLOAT)(dwNumPoints - 1));
+    for(int k = 0; k < _NmbRmps; k += 16)
+    {
+        __m512 minEx = _mm512_loadu_ps(&_Min[k]);
+        __m512 maxEx = _mm512_loadu_ps(&_Max[k]);
+        __m512 step = _mm512_div_ps(_mm512_sub_ps(maxEx, minEx), numSteps);
+        __m512 rstep = _mm512_div_ps(_mm512_set1_ps(1.f), step);
+
+        __m512 err[4] = {_mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps()};
+        for(int i = 0; i < _NmbClrs; i++)
+        {
+            __m512 b = _mm512_set1_ps(_Blck[i]);
+            __m512 v = _mm512_cvtepi32_ps(_mm512_cvtps_epi32(_mm512_mul_ps(_mm512_sub_ps(b, minEx), rstep)));
+            v = _mm512_add_ps(_mm512_mul_ps(v, step), minEx);
+            v = _mm512_min_ps(_mm512_max_ps(v, minEx), maxEx);
+
+            __m512 d = _mm512_sub_ps(b, v);
+            err[i & 3] = _mm512_add_ps(err[i & 3], _mm512_mul_ps(_mm512_set1_ps(_Rpt[i]), _mm512_mul_ps(d, d)));
+        }
+        _mm512_storeu_ps(&_Err[k], _mm512_add_ps(_mm512_add_ps(err[0], err[2]), _mm512_add_ps(err[1], err[3])));
+    }
+    _mm256_zeroupper();
+}
+#endif // USE_AVX512
+
+/*------------------------------------------------------------------------------------------------
+Kernels used by the SSE2 compressor, picked from the CPU features (see RegisterCPUDispatch).
+The AVX2 and AVX-512 kernels are built only with USE_AVX2 / USE_AVX512,
+AVX-512 needs a compiler with AVX-512 intrinsics (VS2017 or later).
+------------------------------------------------------------------------------------------------*/
+typedef CODECFLOAT (*RampSrchFn)(CODECFLOAT _Blck[MAX_BLOCK], CODECFLOAT _BlckErr[MAX_BLOCK], CODECFLOAT _Rpt[MAX_BLOCK],
+                                 CODECFLOAT _maxerror, CODECFLOAT _min_ex, CODECFLOAT _max_ex, int _NmbClrs, CMP_BYTE dwNumPoints);
+typedef CODECFLOAT (*RefineErrFn)(CODECFLOAT _Clr[MAX_BLOCK], CODECFLOAT _RmpErr[MAX_POINTS][MAX_BLOCK], CODECFLOAT _Rmp[MAX_POINTS],
+                                  CODECFLOAT _Rpt[MAX_BLOCK], CODECFLOAT _fWeight, int _NmrClrs, CMP_BYTE dwNumPoints);
+typedef void (*RmpSrch1Fn)(CODECFLOAT _Blck[MAX_BLOCK], CODECFLOAT _Rpt[MAX_BLOCK], int _NmbClrs, CMP_BYTE dwNumPoints,
+                           CODECFLOAT* _Min, CODECFLOAT* _Max, CODECFLOAT* _Err, int _NmbRmps);
+
+typedef struct
+{
+    RampSrchFn  RampSrch;
+    RefineErrFn RefineErr;
+    RmpSrch1Fn  RmpSrch1;
+} XCodecKernels;
+
+static XCodecKernels g_XCodecKernels = {RampSrchWSS2E, RefineErrSSE2, RmpSrch1SSE2};
+
+static void SelectXCodecKernels(CMP_DWORD dwCPUFeatures)
+{
+    XCodecKernels kernels = {RampSrchWSS2E, RefineErrSSE2, RmpSrch1SSE2};
+#ifdef USE_AVX2
+    if(dwCPUFeatures & CMP_CPU_FEATURE_AVX2)
+    {
+        kernels.RampSrch = RampSrchWAVX2;
+        kernels.RefineErr = RefineErrAVX2;
+        kernels.RmpSrch1 = RmpSrch1AVX2;
+    }
+#endif // USE_AVX2
+#ifdef USE_AVX512
+    if(dwCPUFeatures & CMP_CPU_FEATURE_AVX512)
+    {
+        kernels.RampSrch = RampSrchWAVX512;
+        kernels.RefineErr = RefineErrAVX512;
+        kernels.RmpSrch1 = RmpSrch1AVX512;
+    }
+#endif // USE_AVX512
+    g_XCodecKernels = kernels;
+}
+
+static const bool g_bXCodecKernelsRegistered = RegisterCPUDispatch(SelectXCodecKernels);
 #endif //USE_SSE
 
 /*------------------------------------------------------------------------------------------------
@@ -1059,16 +1437,22 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
 {
     ALIGN_16 CODECFLOAT BlkSSE2[NUM_CHANNELS][MAX_BLOCK];
     ALIGN_16 CODECFLOAT Rmp[NUM_CHANNELS][MAX_POINTS];
-    ALIGN_16 CODECFLOAT RmpErr[MAX_BLOCK][MAX_POINTS];
-
-    int SIMDFac = 128 / (sizeof(CODECFLOAT) * 8);
-    int NbrCycls = (_NmrClrs + SIMDFac - 1) / SIMDFac; 
+    ALIGN_16 CODECFLOAT RmpErr[MAX_POINTS][MAX_BLOCK];
 
     CODECFLOAT Blk[MAX_BLOCK][NUM_CHANNELS];
     for(int i = 0; i < _NmrClrs; i++)
         for(int j = 0; j < 3; j++)
            BlkSSE2[j][i] = Blk[i][j] = _Blk[i][j];
 
+    // the kernels work on whole vectors, _Rpt is already zero past _NmrClrs
+    for(int i = _NmrClrs; i < REFINE_PAD(_NmrClrs); i++)
+    {
+        for(int j = 0; j < 3; j++)
+            BlkSSE2[j][i] = 0.f;
+        for(int r = 0; r < MAX_POINTS; r++)
+            RmpErr[r][i] = 0.f;
+    }
+
     CODECFLOAT fWeightRed = _pfWeights ? _pfWeights[0] : 1.f;
     CODECFLOAT fWeightGreen = _pfWeights ? _pfWeights[1] : 1.f;
     CODECFLOAT fWeightBlue = _pfWeights ? _pfWeights[2] : 1.f;
@@ -1100,7 +1484,7 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
         {
             CODECFLOAT DistG = (Rmp[GC][r] - Blk[i][GC]);
             CODECFLOAT DistB = (Rmp[BC][r] - Blk[i][BC]);
-            RmpErr[i][r] = DistG * DistG * fWeightGreen + DistB * DistB * fWeightBlue;
+            RmpErr[r][i] = DistG * DistG * fWeightGreen + DistB * DistB * fWeightBlue;
         }
 
     // Tweak each component in isolation and get the best values
@@ -1109,7 +1493,6 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
     CODECFLOAT bstC1 = InpRmp0[RC][1];
     int nRefineStart = 0 - (min(nRefineSteps, 8));
     int nRefineEnd = min(nRefineSteps, 8);
-    int nRampLoops = (dwNumPoints + 3) / 4;
 
     for(int i = nRefineStart; i <= nRefineEnd; i++)
     {
@@ -1121,90 +1504,7 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
             MkWkRmpPts(&Eq, WkRmpPts, InpRmp, nRedBits, nGreenBits, nBlueBits);
             BldClrRmp(Rmp[RC], WkRmpPts[RC], dwNumPoints);
 
-            CODECFLOAT mse;
-            {
-                __m128 Mse = _mm_setzero_ps();
-                __m128 weight = _mm_load_ps1(&fWeightRed);
-                for(int k = 0; k < NbrCycls; k++)
-                {
-                    __m128 minMse = _mm_set_ps1(FLT_MAX);
-                    for(int l = 0; l < nRampLoops; l++)
-                    {
-                        __m128 r = _mm_load_ps(&Rmp[RC][l * 4]);
-                        __m128 c4 = _mm_load_ps(&BlkSSE2[RC][k * SIMDFac]);
-                        // COLOR
-                        __m128 c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(0,0,0,0));
-                        __m128 rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 0][l * 4]);
-                        // dist from ramp
-                        __m128 d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        __m128 err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 1][l * 4]);
-
-                        __m128 min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,1)); // fold into 2 0 0 
-                        __m128 Min = _mm_min_ps(min, err); // take min
-
-                        // NEXT COLOR
-
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(1,1,1,1));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 2][l * 4]);
-
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 0,3)); // fold into 2 1 1 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                        // NEXT COLOR
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(2,2,2,2));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 3][l * 4]);
-
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(0,3, 3,3)); // fold into 2 2 2 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                        // NEXT COLOR
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(3,3,3,3));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(2,0, 3,3)); // fold into 2 3 3 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-                        // now we have 4 Mins from 4 colors
-                        // multiple them on 5 Rpt and accumulate
-                        minMse = _mm_min_ps(minMse, Min);
-                    }
-                    // repeats
-                    __m128 rp = _mm_load_ps(&_Rpt[k * SIMDFac]);
-                    Mse = _mm_add_ps(Mse, _mm_mul_ps(minMse, rp));
-                }
-                mse = Mse.m128_f32[0] + Mse.m128_f32[1] + Mse.m128_f32[2] + Mse.m128_f32[3];
-            }
+            CODECFLOAT mse = g_XCodecKernels.RefineErr(BlkSSE2[RC], RmpErr, Rmp[RC], _Rpt, fWeightRed, _NmrClrs, dwNumPoints);
 
             if(mse < bestE)
             {
@@ -1227,7 +1527,7 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
         {
             CODECFLOAT DistR = (Rmp[RC][r] - Blk[i][RC]);
             CODECFLOAT DistB = (Rmp[BC][r] - Blk[i][BC]);
-            RmpErr[i][r] = DistR * DistR * fWeightRed + DistB * DistB * fWeightBlue;
+            RmpErr[r][i] = DistR * DistR * fWeightRed + DistB * DistB * fWeightBlue;
         }
 
     bstC0 = InpRmp0[GC][0];
@@ -1243,90 +1543,7 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
             MkWkRmpPts(&Eq, WkRmpPts, InpRmp, nRedBits, nGreenBits, nBlueBits);
             BldClrRmp(Rmp[GC],WkRmpPts[GC], dwNumPoints);
 
-            CODECFLOAT mse;
-            {
-                __m128 Mse = _mm_setzero_ps();
-                __m128 weight = _mm_load_ps1(&fWeightGreen);
-                for(int k = 0; k < NbrCycls; k++)
-                {
-                    __m128 minMse = _mm_set_ps1(FLT_MAX);
-                    for(int l = 0; l < nRampLoops; l++)
-                    {
-                        __m128 r = _mm_load_ps(&Rmp[GC][l * 4]);
-                        __m128 c4 = _mm_load_ps(&BlkSSE2[GC][k * SIMDFac]);
-                        // COLOR
-                        __m128 c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(0,0,0,0));
-                        __m128 rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 0][l * 4]);
-                        // dist from ramp
-                        __m128 d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        __m128 err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 1][l * 4]);
-
-                        __m128 min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,1)); // fold into 2 0 0 
-                        __m128 Min = _mm_min_ps(min, err); // take min
-
-                        // NEXT COLOR
-
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(1,1,1,1));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 2][l * 4]);
-
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 0,3)); // fold into 2 1 1 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                        // NEXT COLOR
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(2,2,2,2));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 3][l * 4]);
-
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(0,3, 3,3)); // fold into 2 2 2 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                        // NEXT COLOR
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(3,3,3,3));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(2,0, 3,3)); // fold into 2 3 3 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-                        // now we have 4 Mins from 4 colors
-                        // multiple them on 5 Rpt and accumulate
-                        minMse = _mm_min_ps(minMse, Min);
-                    }
-                    // repeats
-                    __m128 rp = _mm_load_ps(&_Rpt[k * SIMDFac]);
-                    Mse = _mm_add_ps(Mse, _mm_mul_ps(minMse, rp));
-                }
-                mse = Mse.m128_f32[0] + Mse.m128_f32[1] + Mse.m128_f32[2] + Mse.m128_f32[3];
-            }
+            CODECFLOAT mse = g_XCodecKernels.RefineErr(BlkSSE2[GC], RmpErr, Rmp[GC], _Rpt, fWeightGreen, _NmrClrs, dwNumPoints);
 
             if(mse < bestE)
             {
@@ -1349,7 +1566,7 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
         {
             CODECFLOAT DistR = (Rmp[RC][r] - Blk[i][RC]);
             CODECFLOAT DistG = (Rmp[GC][r] - Blk[i][GC]);
-            RmpErr[i][r] = DistR * DistR * fWeightRed + DistG * DistG * fWeightGreen;
+            RmpErr[r][i] = DistR * DistR * fWeightRed + DistG * DistG * fWeightGreen;
         }
 
     bstC0 = InpRmp0[BC][0];
@@ -1365,90 +1582,7 @@ CODECFLOAT RefineSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
             MkWkRmpPts(&Eq, WkRmpPts, InpRmp, nRedBits, nGreenBits, nBlueBits);
             BldClrRmp(Rmp[BC],WkRmpPts[BC], dwNumPoints);
 
-            CODECFLOAT mse;
-            {
-                __m128 Mse = _mm_setzero_ps();
-                __m128 weight = _mm_load_ps1(&fWeightBlue);
-                for(int k = 0; k < NbrCycls; k++)
-                {
-                    __m128 minMse = _mm_set_ps1(FLT_MAX);
-                    for(int l = 0; l < nRampLoops; l++)
-                    {
-                        __m128 r = _mm_load_ps(&Rmp[BC][l * 4]);
-                        __m128 c4 = _mm_load_ps(&BlkSSE2[BC][k * SIMDFac]);
-                        // COLOR
-                        __m128 c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(0,0,0,0));
-                        __m128 rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 0][l * 4]);
-                        // dist from ramp
-                        __m128 d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        __m128 err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 1][l * 4]);
-
-                        __m128 min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,1)); // fold into 2 0 0 
-                        __m128 Min = _mm_min_ps(min, err); // take min
-
-                        // NEXT COLOR
-
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(1,1,1,1));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 2][l * 4]);
-
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 0,3)); // fold into 2 1 1 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                        // NEXT COLOR
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(2,2,2,2));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-                        // next rmp error
-                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 3][l * 4]);
-
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(0,3, 3,3)); // fold into 2 2 2 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                        // NEXT COLOR
-                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(3,3,3,3));
-                        // dist from ramp
-                        d  = _mm_sub_ps(c, r);
-                        d = _mm_mul_ps(d, d);
-                        d = _mm_mul_ps(d, weight);
-                        // overall error
-                        err = _mm_add_ps(d, rmp_err);
-
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                        err = _mm_min_ps(min, err); // take min
-                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(2,0, 3,3)); // fold into 2 3 3 
-                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-                        // now we have 4 Mins from 4 colors
-                        // multiple them on 4 Rpts and accumulate
-                        minMse = _mm_min_ps(minMse, Min);
-                    }
-                    // repeats
-                    __m128 rp = _mm_load_ps(&_Rpt[k * SIMDFac]);
-                    Mse = _mm_add_ps(Mse, _mm_mul_ps(minMse, rp));
-                }
-                mse = Mse.m128_f32[0] + Mse.m128_f32[1] + Mse.m128_f32[2] + Mse.m128_f32[3];
-            }
+            CODECFLOAT mse = g_XCodecKernels.RefineErr(BlkSSE2[BC], RmpErr, Rmp[BC], _Rpt, fWeightBlue, _NmrClrs, dwNumPoints);
 
             if(mse < bestE)
             {
@@ -1482,17 +1616,23 @@ static CODECFLOAT Refine3DSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
 {
     ALIGN_16 CODECFLOAT BlkSSE2[NUM_CHANNELS][MAX_BLOCK];
     ALIGN_16 CODECFLOAT Rmp[NUM_CHANNELS][MAX_POINTS];
-    ALIGN_16 CODECFLOAT RmpErr[MAX_BLOCK][MAX_POINTS];
-    ALIGN_16 CODECFLOAT RmpErrG[MAX_BLOCK][MAX_POINTS];
-
-    int SIMDFac = 128 / (sizeof(CODECFLOAT) * 8);
-    int NbrCycls = (_NmrClrs + SIMDFac - 1) / SIMDFac; 
+    ALIGN_16 CODECFLOAT RmpErr[MAX_POINTS][MAX_BLOCK];
+    ALIGN_16 CODECFLOAT RmpErrG[MAX_POINTS][MAX_BLOCK];
 
     CODECFLOAT Blk[MAX_BLOCK][NUM_CHANNELS];
     for(int i = 0; i < _NmrClrs; i++)
         for(int j = 0; j < 3; j++)
             BlkSSE2[j][i] = Blk[i][j] = _Blk[i][j];
 
+    // the kernels work on whole vectors, _Rpt is already zero past _NmrClrs
+    for(int i = _NmrClrs; i < REFINE_PAD(_NmrClrs); i++)
+    {
+        for(int j = 0; j < 3; j++)
+            BlkSSE2[j][i] = 0.f;
+        for(int r = 0; r < MAX_POINTS; r++)
+            RmpErr[r][i] = 0.f;
+    }
+
     CODECFLOAT fWeightRed = _pfWeights ? _pfWeights[0] : 1.f;
     CODECFLOAT fWeightGreen = _pfWeights ? _pfWeights[1] : 1.f;
     CODECFLOAT fWeightBlue = _pfWeights ? _pfWeights[2] : 1.f;
@@ -1522,7 +1662,6 @@ static CODECFLOAT Refine3DSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
     // Jitter endpoints in each direction
     int nRefineStart = 0 - (min(nRefineSteps, 8));
     int nRefineEnd = min(nRefineSteps, 8);
-    int nRampLoops = (dwNumPoints + 3) / 4;
 
     for(int nJitterG0 = nRefineStart; nJitterG0 <= nRefineEnd; nJitterG0++)
     {
@@ -1538,7 +1677,7 @@ static CODECFLOAT Refine3DSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
                 for(int r = 0; r < dwNumPoints; r++)
                 {
                     CODECFLOAT DistG = (Rmp[GC][r] - Blk[i][GC]);
-                    RmpErrG[i][r] = DistG * DistG * fWeightGreen;
+                    RmpErrG[r][i] = DistG * DistG * fWeightGreen;
                 }
             }
 
@@ -1556,7 +1695,7 @@ static CODECFLOAT Refine3DSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
                         for(int r = 0; r < dwNumPoints; r++)
                         {
                             CODECFLOAT DistB = (Rmp[BC][r] - Blk[i][BC]);
-                            RmpErr[i][r] = RmpErrG[i][r] + DistB * DistB * fWeightBlue;
+                            RmpErr[r][i] = RmpErrG[r][i] + DistB * DistB * fWeightBlue;
                         }
                     }
 
@@ -1569,91 +1708,7 @@ static CODECFLOAT Refine3DSSE2(CODECFLOAT _OutRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
                             MkWkRmpPts(&Eq, WkRmpPts, InpRmp, nRedBits, nGreenBits, nBlueBits);
                             BldClrRmp(Rmp[RC], WkRmpPts[RC], dwNumPoints);
 
-                            CODECFLOAT mse;
-                            {
-                                __m128 Mse = _mm_setzero_ps();
-                                __m128 weight = _mm_load_ps1(&fWeightRed);
-                                for(int k = 0; k < NbrCycls; k++)
-                                {
-                                    __m128 minMse = _mm_set_ps1(FLT_MAX);
-                                    for(int l = 0; l < nRampLoops; l++)
-                                    {
-                                        __m128 r = _mm_load_ps(&Rmp[RC][l * 4]);
-
-                                        __m128 c4 = _mm_load_ps(&BlkSSE2[RC][k * SIMDFac]);
-                                        // COLOR
-                                        __m128 c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(0,0,0,0));
-                                        __m128 rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 0][l * 4]);
-                                        // dist from ramp
-                                        __m128 d  = _mm_sub_ps(c, r);
-                                        d = _mm_mul_ps(d, d);
-                                        d = _mm_mul_ps(d, weight);
-                                        // overall error
-                                        __m128 err = _mm_add_ps(d, rmp_err);
-                                        // next rmp error
-                                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 1][l * 4]);
-
-                                        __m128 min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                                        err = _mm_min_ps(min, err); // take min
-                                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,1)); // fold into 2 0 0 
-                                        __m128 Min = _mm_min_ps(min, err); // take min
-
-                                        // NEXT COLOR
-
-                                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(1,1,1,1));
-                                        // dist from ramp
-                                        d  = _mm_sub_ps(c, r);
-                                        d = _mm_mul_ps(d, d);
-                                        d = _mm_mul_ps(d, weight);
-                                        // overall error
-                                        err = _mm_add_ps(d, rmp_err);
-                                        // next rmp error
-                                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 2][l * 4]);
-
-                                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 3,2)); // fold into 2 01 01
-                                        err = _mm_min_ps(min, err); // take min
-                                        min = _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(3,3, 0,3)); // fold into 2 1 1 
-                                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                                        // NEXT COLOR
-                                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(2,2,2,2));
-                                        // dist from ramp
-                                            d  = _mm_sub_ps(c, r);
-                                        d = _mm_mul_ps(d, d);
-                                        d = _mm_mul_ps(d, weight);
-                                        // overall error
-                                        err = _mm_add_ps(d, rmp_err);
-                                        // next rmp error
-                                        rmp_err = _mm_load_ps(&RmpErr[k * SIMDFac + 3][l * 4]);
-
-                                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                                        err = _mm_min_ps(min, err); // take min
-                                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(0,3, 3,3)); // fold into 2 2 2 
-                                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-
-                                        // NEXT COLOR
-                                        c  = _mm_shuffle_ps(c4, c4, _MM_SHUFFLE(3,3,3,3));
-                                        // dist from ramp
-                                        d  = _mm_sub_ps(c, r);
-                                        d = _mm_mul_ps(d, d);
-                                        d = _mm_mul_ps(d, weight);
-                                        // overall error
-                                        err = _mm_add_ps(d, rmp_err);
-
-                                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(1,0, 3,3)); // fold into 2 23 23
-                                        err = _mm_min_ps(min, err); // take min
-                                        min = _mm_shuffle_ps(_mm_setzero_ps(), err, _MM_SHUFFLE(2,0, 3,3)); // fold into 2 3 3 
-                                        Min = _mm_add_ps(Min, _mm_min_ps(min, err));
-                                        // now we have 4 Mins from 4 colors
-                                        // multiple them on 5 Rpt and accumulate
-                                        minMse = _mm_min_ps(minMse, Min);
-                                    }
-                                    // repeats
-                                    __m128 rp = _mm_load_ps(&_Rpt[k * SIMDFac]);
-                                    Mse = _mm_add_ps(Mse, _mm_mul_ps(minMse, rp));
-                                }
-                                mse = Mse.m128_f32[0] + Mse.m128_f32[1] + Mse.m128_f32[2] + Mse.m128_f32[3];
-                            }
+                            CODECFLOAT mse = g_XCodecKernels.RefineErr(BlkSSE2[RC], RmpErr, Rmp[RC], _Rpt, fWeightRed, _NmrClrs, dwNumPoints);
 
                             // save if we achieve better result
                             if(mse < bestE)
@@ -1690,7 +1745,8 @@ void CompressRGBBlockXSSE2(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
                            int _UniqClrs, CMP_BYTE dwNumPoints, 
                            bool b3DRefinement, CMP_BYTE nRefinementSteps,
                            CODECFLOAT* _pfWeights, CMP_BYTE nRedBits, 
-                           CMP_BYTE nGreenBits, CMP_BYTE nBlueBits)
+                           CMP_BYTE nGreenBits, CMP_BYTE nBlueBits,
+                           CODECFLOAT _fRefinementEffort)
 {
     ALIGN_16 CODECFLOAT Prj0[BLOCK_SIZE];
     ALIGN_16 CODECFLOAT Prj[BLOCK_SIZE];
@@ -1707,6 +1763,9 @@ void CompressRGBBlockXSSE2(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
     CODECFLOAT rsltC[NUM_CHANNELS][NUM_ENDPOINTS];   
     int i, j, k;
 
+    XCodecEffort effort;
+    GetXCodecEffort(effort, _fRefinementEffort);
+
     for(i=0; i < _UniqClrs; i++)
         for(j = 0; j < 3; j++)
             Blk[i][j] = _BlkIn[i][j] / 255.f;
@@ -1751,7 +1810,7 @@ void CompressRGBBlockXSSE2(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
         LineDir[j] = LineDir0[j];
 
     // the search loop to find a more precise line along which we are going to find a ramp
-    for(;;)
+    for(int nAxisIter = 1; ; nAxisIter++)
     {
         // From Foley & Van Dam: Closest point of approach of a line (P + v) to a point (R) is
         //                            P + ((R-P).v) / (v.v))v
@@ -1794,7 +1853,7 @@ void CompressRGBBlockXSSE2(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
 
         CODECFLOAT Err = MAX_ERROR;
 
-        static const CODECFLOAT stp = 0.025f;
+        const CODECFLOAT stp = RMP_SRCH_RANGE / effort.nRampSrchSteps;
         const CODECFLOAT lS = (PrjBnd[0] - 2.f * stp > 0.f) ?  PrjBnd[0] - 2.f * stp : 0.f;
         const CODECFLOAT hE = (PrjBnd[1] + 2.f * stp < 1.f) ?  PrjBnd[1] + 2.f * stp : 1.f;
 
@@ -1802,12 +1861,12 @@ void CompressRGBBlockXSSE2(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
         CODECFLOAT Pos[NUM_ENDPOINTS];
         CODECFLOAT lP, hP;
         int l, h;
-        for(l = 0, lP = lS; l < 8; l++, lP += stp)
+        for(l = 0, lP = lS; l < effort.nRampSrchSteps; l++, lP += stp)
         {
-            for(h = 0, hP = hE; h < 8; h++, hP -= stp)
+            for(h = 0, hP = hE; h < effort.nRampSrchSteps; h++, hP -= stp)
             {
                 CODECFLOAT err = Err;
-                err = RampSrchWSS2E(Prj, PrjErr, PreMRep, 0.f, lP, hP, _UniqClrs, dwNumPoints);
+                err = g_XCodecKernels.RampSrch(Prj, PrjErr, PreMRep, 0.f, lP, hP, _UniqClrs, dwNumPoints);
                 if(err < Err)
                 {
                     Err = err;
@@ -1831,6 +1890,9 @@ void CompressRGBBlockXSSE2(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINTS],
             PosG[0] = Pos[0];
             PosG[1] = Pos[1];
 
+            if(nAxisIter == effort.nAxisIterations)
+                break;
+
             // indexes
             {
                 CODECFLOAT indxAvrg;
@@ -1907,10 +1969,28 @@ DONE:
     CODECFLOAT inpRmpEndPts[NUM_CHANNELS][NUM_ENDPOINTS];
     MkRmpOnGrid(inpRmpEndPts, rsltC, 0.f, 255.f, nRedBits, nGreenBits, nBlueBits);
 
-    if(b3DRefinement)
-        Refine3DSSE2(_RsltRmpPnts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefinementSteps);
-    else
-        RefineSSE2(_RsltRmpPnts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefinementSteps);
+    // the lowest effort levels only measure the snapped ramp, further passes restart from the
+    // refined ramp and stop once a pass no longer improves it
+    CODECFLOAT bestE = MAX_ERROR;
+    CMP_BYTE nRefineSteps = effort.nRefinePasses ? nRefinementSteps : 0;
+    for(int nPass = 0; nPass < max(effort.nRefinePasses, 1); nPass++)
+    {
+        CODECFLOAT passRmpEndPts[NUM_CHANNELS][NUM_ENDPOINTS];
+        CODECFLOAT passE;
+        if(b3DRefinement)
+            passE = Refine3DSSE2(passRmpEndPts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefineSteps);
+        else
+            passE = RefineSSE2(passRmpEndPts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefineSteps);
+
+        if(nPass > 0 && passE >= bestE)
+            break;
+
+        bestE = passE;
+        memcpy(_RsltRmpPnts, passRmpEndPts, sizeof(passRmpEndPts));
+        memcpy(inpRmpEndPts, passRmpEndPts, sizeof(passRmpEndPts));
+        if(bestE == 0.f)
+            break;
+    }
 }
 #endif // USE_SSE
 
@@ -1923,7 +2003,8 @@ static void CompressRGBBlockX(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
                            int _UniqClrs,
                            CMP_BYTE dwNumPoints, bool b3DRefinement, CMP_BYTE nRefinementSteps,
                            CODECFLOAT* _pfWeights, 
-                           CMP_BYTE nRedBits, CMP_BYTE nGreenBits, CMP_BYTE nBlueBits)
+                           CMP_BYTE nRedBits, CMP_BYTE nGreenBits, CMP_BYTE nBlueBits,
+                           CODECFLOAT _fRefinementEffort)
 {
     ALIGN_16 CODECFLOAT Prj0[MAX_BLOCK];
     ALIGN_16 CODECFLOAT Prj[MAX_BLOCK];
@@ -1941,6 +2022,9 @@ static void CompressRGBBlockX(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
     CODECFLOAT rsltC[NUM_CHANNELS][NUM_ENDPOINTS];   
     int i, j, k;
 
+    XCodecEffort effort;
+    GetXCodecEffort(effort, _fRefinementEffort);
+
 // down to [0., 1.]
     for(i = 0; i < _UniqClrs; i++)
         for(j = 0; j < 3; j++)
@@ -2004,8 +2088,8 @@ static void CompressRGBBlockX(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
 //    in 3 dim space Ai(s) represent a line direction, along which
 //    we again try to find (sub)optimal quantizer.
 
-//    That's what our for(;;) loop is about.
-    for(;;)
+//    That's what our for(;;) loop is about, the effort level may cap the number of refits.
+    for(int nAxisIter = 1; ; nAxisIter++)
     {
         //  1. Project input set on the axis in consideration.
         // From Foley & Van Dam: Closest point of approach of a line (P + v) to a point (R) is
@@ -2056,7 +2140,7 @@ static void CompressRGBBlockX(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
         CODECFLOAT Err = MAX_ERROR;
 
         // search step
-        static const CODECFLOAT stp = 0.025f;
+        const CODECFLOAT stp = RMP_SRCH_RANGE / effort.nRampSrchSteps;
 
         // low Start/End; high Start/End
         const CODECFLOAT lS = (PrjBnd[0] - 2.f * stp > 0.f) ?  PrjBnd[0] - 2.f * stp : 0.f;
@@ -2066,9 +2150,9 @@ static void CompressRGBBlockX(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
         CODECFLOAT Pos[NUM_ENDPOINTS];
         CODECFLOAT lP, hP;
         int l, h;
-        for(l = 0, lP = lS; l < 8; l++, lP += stp)
+        for(l = 0, lP = lS; l < effort.nRampSrchSteps; l++, lP += stp)
         {
-            for(h = 0, hP = hE; h < 8; h++, hP -= stp)
+            for(h = 0, hP = hE; h < effort.nRampSrchSteps; h++, hP -= stp)
             {
                 CODECFLOAT err = Err;
                 // compute an error for the current pair of end points.
@@ -2098,6 +2182,11 @@ static void CompressRGBBlockX(CODECFLOAT _RsltRmpPnts[NUM_CHANNELS][NUM_ENDPOINT
             LineDirG[2] =  LineDir[2];
             PosG[0] = Pos[0];
             PosG[1] = Pos[1];
+
+            // out of refits for this effort level
+            if(nAxisIter == effort.nAxisIterations)
+                break;
+
             //  3. Compute the vector of indexes (or clusters) for the current approximate ramp.
             // indexes
             const CODECFLOAT step = (Pos[1] - Pos[0]) / (CODECFLOAT)(dwNumPoints - 1);
@@ -2170,10 +2259,28 @@ DONE:
 
 //    This not a small procedure squeezes and stretches the ramp along each axis (R,G,B) separately while other 2 are fixed.
 //    It does it only over coarse grid - 565 that is. It tries to squeeze more precision for the real world ramp.
-    if(b3DRefinement)
-        Refine3D(_RsltRmpPnts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefinementSteps);
-    else
-        Refine(_RsltRmpPnts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefinementSteps);
+//    The lowest effort levels skip it, higher ones repeat it from the refined ramp until a pass
+//    no longer improves it.
+    CODECFLOAT bestE = MAX_ERROR;
+    CMP_BYTE nRefineSteps = effort.nRefinePasses ? nRefinementSteps : 0;
+    for(int nPass = 0; nPass < max(effort.nRefinePasses, 1); nPass++)
+    {
+        CODECFLOAT passRmpEndPts[NUM_CHANNELS][NUM_ENDPOINTS];
+        CODECFLOAT passE;
+        if(b3DRefinement)
+            passE = Refine3D(passRmpEndPts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefineSteps);
+        else
+            passE = Refine(passRmpEndPts, inpRmpEndPts, _BlkIn, _Rpt, _UniqClrs, dwNumPoints, _pfWeights, nRedBits, nGreenBits, nBlueBits, nRefineSteps);
+
+        if(nPass > 0 && passE >= bestE)
+            break;
+
+        bestE = passE;
+        memcpy(_RsltRmpPnts, passRmpEndPts, sizeof(passRmpEndPts));
+        memcpy(inpRmpEndPts, passRmpEndPts, sizeof(passRmpEndPts));
+        if(bestE == 0.f)
+            break;
+    }
 }
 
 /*--------------------------------------------------------------------------------------------------------
@@ -2184,7 +2291,7 @@ CODECFLOAT CompRGBBlock(CODECFLOAT* block_32, CMP_WORD dwBlockSize,
                         CMP_BYTE nRedBits, CMP_BYTE nGreenBits, CMP_BYTE nBlueBits, 
                         CMP_BYTE nEndpoints[3][NUM_ENDPOINTS], CMP_BYTE* pcIndices, CMP_BYTE dwNumPoints, 
                         bool _bUseSSE2, bool b3DRefinement, CMP_BYTE nRefinementSteps, CODECFLOAT* _pfChannelWeights, 
-                        bool _bUseAlpha, CODECFLOAT _fAlphaThreshold)
+                        bool _bUseAlpha, CODECFLOAT _fAlphaThreshold, CODECFLOAT _fRefinementEffort)
 {
     ALIGN_16 CODECFLOAT Rpt[MAX_BLOCK];
     ALIGN_16 CODECFLOAT BlkIn[MAX_BLOCK][NUM_CHANNELS];
@@ -2243,11 +2350,11 @@ CODECFLOAT CompRGBBlock(CODECFLOAT* block_32, CMP_WORD dwBlockSize,
 #ifdef USE_SSE
         if(_bUseSSE2)
             CompressRGBBlockXSSE2(rsltC, BlkIn, Rpt, dwUniqueColors, dwNumPoints, b3DRefinement, nRefinementSteps, 
-                                    _pfChannelWeights, nRedBits, nGreenBits, nBlueBits);
+                                    _pfChannelWeights, nRedBits, nGreenBits, nBlueBits, _fRefinementEffort);
         else
 #endif // USE_SSE
             CompressRGBBlockX(rsltC, BlkIn, Rpt, dwUniqueColors, dwNumPoints, b3DRefinement, nRefinementSteps, 
-                _pfChannelWeights, nRedBits, nGreenBits, nBlueBits);
+                _pfChannelWeights, nRedBits, nGreenBits, nBlueBits, _fRefinementEffort);
 
         // return to integer realm
         for(int i = 0; i < 3; i++)
@@ -2283,7 +2390,7 @@ CODECFLOAT CompRGBBlock(CMP_DWORD* block_32, CMP_WORD dwBlockSize,
                         CMP_BYTE nRedBits, CMP_BYTE nGreenBits, CMP_BYTE nBlueBits, 
                         CMP_BYTE nEndpoints[3][NUM_ENDPOINTS], CMP_BYTE* pcIndices, CMP_BYTE dwNumPoints, 
                         bool _bUseSSE2, bool b3DRefinement, CMP_BYTE nRefinementSteps, CODECFLOAT* _pfChannelWeights, 
-                        bool _bUseAlpha, CMP_BYTE _nAlphaThreshold)
+                        bool _bUseAlpha, CMP_BYTE _nAlphaThreshold, CODECFLOAT _fRefinementEffort)
 {
     ALIGN_16 CODECFLOAT Rpt[BLOCK_SIZE];
     ALIGN_16 CODECFLOAT BlkIn[BLOCK_SIZE][NUM_CHANNELS];
@@ -2340,11 +2447,11 @@ CODECFLOAT CompRGBBlock(CMP_DWORD* block_32, CMP_WORD dwBlockSize,
 #ifdef USE_SSE
         if(_bUseSSE2)
             CompressRGBBlockXSSE2(rsltC, BlkIn, Rpt, dwUniqueColors, dwNumPoints, b3DRefinement, nRefinementSteps, 
-                                    _pfChannelWeights, nRedBits, nGreenBits, nBlueBits);
+                                    _pfChannelWeights, nRedBits, nGreenBits, nBlueBits, _fRefinementEffort);
         else
 #endif // USE_SSE
             CompressRGBBlockX(rsltC, BlkIn, Rpt, dwUniqueColors, dwNumPoints, b3DRefinement, nRefinementSteps, 
-                            _pfChannelWeights, nRedBits, nGreenBits, nBlueBits);
+                            _pfChannelWeights, nRedBits, nGreenBits, nBlueBits, _fRefinementEffort);
 
         // return to integer realm
         for(int i = 0; i < 3; i++)
@@ -2389,7 +2496,8 @@ static  CODECFLOAT   Clstr1(CMP_BYTE* pcIndices,
                        bool bFixedRampPoints,
                        int _intPrec = 8,
                        int _fracPrec = 0,
-                       bool _bFixedRamp = true
+                       bool _bFixedRamp = true,
+                       bool _bUseSSE2 = true
                      );
 
 /*------------------------------------------------------------------------------------------------
@@ -2453,7 +2561,8 @@ static void GetRmp1(CODECFLOAT _rampDat[MAX_POINTS], CODECFLOAT _ramp[NUM_ENDPOI
 
 ---------------------------------------------------------------------------------------------*/
 static CODECFLOAT Clstr1(CMP_BYTE* pcIndices, CODECFLOAT _blockIn[MAX_BLOCK], CODECFLOAT _ramp[NUM_ENDPOINTS], 
-                         int _NmbrClrs, int nNumPoints, bool bFixedRampPoints, int _intPrec, int _fracPrec, bool _bFixedRamp)
+                         int _NmbrClrs, int nNumPoints, bool bFixedRampPoints, int _intPrec, int _fracPrec, bool _bFixedRamp,
+                         bool _bUseSSE2)
 {
     CODECFLOAT Err = 0.f;
     CODECFLOAT alpha[MAX_POINTS];
@@ -2479,10 +2588,44 @@ static CODECFLOAT Clstr1(CMP_BYTE* pcIndices, CODECFLOAT _blockIn[MAX_BLOCK], CO
     for(int i = 0; i < nNumPoints; i++)
        alpha[i] *= OverIntFctr;
 
+    int i = 0;
+#ifdef USE_SSE
+    if(_bUseSSE2)
+    {
+        // 4 values at a time, the first closest point wins as in the C loop below
+        for(; i + 4 <= _NmbrClrs; i += 4)
+        {
+            __m128 acur = _mm_loadu_ps(&_blockIn[i]);
+            __m128 shortest = _mm_set_ps1(10000000.f);
+            __m128i index = _mm_setzero_si128();
+
+            for(int j = 0; j < nNumPoints; j++)
+            {
+                __m128 adist = _mm_sub_ps(acur, _mm_set_ps1(alpha[j]));
+                adist = _mm_mul_ps(adist, adist);
+
+                __m128i closer = _mm_castps_si128(_mm_cmplt_ps(adist, shortest));
+                index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(j)), _mm_andnot_si128(closer, index));
+                shortest = _mm_min_ps(adist, shortest);
+            }
+
+            ALIGN_16 CODECFLOAT fShortest[4];
+            ALIGN_16 int nIndex[4];
+            _mm_store_ps(fShortest, shortest);
+            _mm_store_si128((__m128i*)nIndex, index);
+            for(int k = 0; k < 4; k++)
+            {
+                pcIndices[i + k] = (CMP_BYTE)nIndex[k];
+                Err += fShortest[k];
+            }
+        }
+    }
+#endif // USE_SSE
+
     // For each colour in the original block, calculate its weighted
     // distance from each point in the original and assign it
     // to the closest cluster
-    for(int i = 0; i < _NmbrClrs; i++)
+    for(; i < _NmbrClrs; i++)
     {
         CODECFLOAT shortest = 10000000.f;
 
@@ -2507,65 +2650,6 @@ static CODECFLOAT Clstr1(CMP_BYTE* pcIndices, CODECFLOAT _blockIn[MAX_BLOCK], CO
     return Err;
 }
 
-#ifdef USE_SSE
-/*------------------------------------------------------------------------------------------------
-
-------------------------------------------------------------------------------------------------*/
-static CODECFLOAT RmpSrch1SSE2(ALIGN_16 CODECFLOAT _Blck[MAX_BLOCK],
-                            ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK],
-                            CODECFLOAT _maxerror,
-                            CODECFLOAT _min_ex,
-                            CODECFLOAT _max_ex,
-                            int _NmbClrs,
-                            CMP_BYTE dwNumPoints)
-{
-    CODECFLOAT error = _maxerror;
-    CODECFLOAT step = (_max_ex - _min_ex) / (dwNumPoints - 1);
-    CODECFLOAT rstep = (CODECFLOAT)1.0f / step;
-    static const int SIMDFac = 128 / (sizeof(CODECFLOAT) * 8);
-    int NbrCycls = (_NmbClrs + SIMDFac - 1) / SIMDFac; 
-
-    __m128 err = _mm_setzero_ps();
-    for(int i=0; i < NbrCycls; i++)
-    {
-        __m128 v;
-// do not add half since rounding is different
-         v = _mm_cvtepi32_ps(
-            _mm_cvtps_epi32(
-               _mm_mul_ps(
-                  _mm_sub_ps(
-                     _mm_load_ps(&_Blck[SIMDFac * i]),
-                     _mm_set_ps1(_min_ex)
-                 ),
-                  _mm_set_ps1(rstep)
-              )
-            )
-       );
-
-        v = _mm_add_ps(_mm_mul_ps(v, _mm_set_ps1(step)), _mm_set_ps1(_min_ex));
-        
-        v = _mm_min_ps(_mm_max_ps(v, _mm_set_ps1(_min_ex)), _mm_set_ps1(_max_ex));
-
-
-__m128  d = _mm_sub_ps(_mm_load_ps(&_Blck[SIMDFac * i]), v);
-        d = _mm_mul_ps(d,d);
-        err = _mm_add_ps(err, _mm_mul_ps(_mm_load_ps(&_Rpt[SIMDFac * i]),d));
-    }
-
-       err = _mm_add_ps(
-           _mm_movelh_ps(err, _mm_setzero_ps()),
-           _mm_movehl_ps(_mm_setzero_ps(), err)
-       );
-
-       err = _mm_add_ps(err,
-                 _mm_shuffle_ps(err, _mm_setzero_ps(), _MM_SHUFFLE(0,0,3,1))
-             );
-        _mm_store_ss(&error, err); 
-
-    return (error);
-}
-#endif // USE_SSE
-
 /*--------------------------------------------------------------------------------------------
 
 ---------------------------------------------------------------------------------------------*/
@@ -2610,6 +2694,38 @@ static CODECFLOAT RmpSrch1(CODECFLOAT _Blk[MAX_BLOCK],
 }
 
 
+#ifdef USE_SSE
+/*--------------------------------------------------------------------------------------------
+Evaluates _NmbRmps (up to RMP1_BATCH) ramps in the vector lanes. Returns the index of the ramp
+a one by one search would keep, the first one with the lowest error below _MaxError, or -1.
+---------------------------------------------------------------------------------------------*/
+static int RmpSrch1Batch(ALIGN_16 CODECFLOAT _Blk[MAX_BLOCK], ALIGN_16 CODECFLOAT _Rpt[MAX_BLOCK],
+                         int _NmbrClrs, CMP_BYTE dwNumPoints, CODECFLOAT _Min[RMP1_BATCH], CODECFLOAT _Max[RMP1_BATCH],
+                         int _NmbRmps, CODECFLOAT& _MaxError)
+{
+    // fill the unused lanes with the last ramp
+    for(int k = _NmbRmps; k < RMP1_BATCH; k++)
+    {
+        _Min[k] = _Min[_NmbRmps - 1];
+        _Max[k] = _Max[_NmbRmps - 1];
+    }
+
+    CODECFLOAT Err[RMP1_BATCH];
+    g_XCodecKernels.RmpSrch1(_Blk, _Rpt, _NmbrClrs, dwNumPoints, _Min, _Max, Err, _NmbRmps);
+
+    int best = -1;
+    for(int k = 0; k < _NmbRmps; k++)
+    {
+        if(Err[k] < _MaxError)
+        {
+            _MaxError = Err[k];
+            best = k;
+        }
+    }
+    return best;
+}
+#endif // USE_SSE
+
 /*--------------------------------------------------------------------------------------------
 
 ---------------------------------------------------------------------------------------------*/
@@ -2633,6 +2749,27 @@ static CODECFLOAT Refine1(ALIGN_16 CODECFLOAT _Blk[MAX_BLOCK], ALIGN_16 CODECFLO
     {
         CODECFLOAT cr_min0 = min_ex;
         CODECFLOAT cr_max0 = max_ex;
+#ifdef USE_SSE
+        if(_bUseSSE2)
+        {
+            // all the moves at once
+            CODECFLOAT cr_min[RMP1_BATCH];
+            CODECFLOAT cr_max[RMP1_BATCH];
+            for(mode = 0; mode < SCH_STPS * SCH_STPS; mode++)
+            {
+                cr_min[mode] = max(min_ex + _m_step * sMvF[mode / SCH_STPS], _min_bnd);
+                cr_max[mode] = min(max_ex + _m_step * sMvF[mode % SCH_STPS], _max_bnd);
+            }
+
+            bestmode = RmpSrch1Batch(_Blk, _Rpt, _NmbrClrs, dwNumPoints, cr_min, cr_max, SCH_STPS * SCH_STPS, maxerror);
+            if(bestmode != -1)
+            {
+                cr_min0 = cr_min[bestmode];
+                cr_max0 = cr_max[bestmode];
+            }
+        }
+        else
+#endif // USE_SSE
         for(bestmode = -1, mode = 0; mode < SCH_STPS * SCH_STPS; mode++)
         {
             // check each move (see sStep for direction)
@@ -2642,13 +2779,7 @@ static CODECFLOAT Refine1(ALIGN_16 CODECFLOAT _Blk[MAX_BLOCK], ALIGN_16 CODECFLO
             cr_min = max(cr_min, _min_bnd);
             cr_max = min(cr_max, _max_bnd);
 
-            CODECFLOAT error;
-#ifdef USE_SSE
-            if(_bUseSSE2)
-                error = RmpSrch1SSE2(_Blk, _Rpt, maxerror, cr_min, cr_max, _NmbrClrs, dwNumPoints);
-            else
-#endif // USE_SSE
-                error = RmpSrch1(_Blk, _Rpt, maxerror, cr_min, cr_max, _NmbrClrs, dwNumPoints);
+            CODECFLOAT error = RmpSrch1(_Blk, _Rpt, maxerror, cr_min, cr_max, _NmbrClrs, dwNumPoints);
 
             if(error < maxerror)
             {
@@ -2673,18 +2804,19 @@ static CODECFLOAT Refine1(ALIGN_16 CODECFLOAT _Blk[MAX_BLOCK], ALIGN_16 CODECFLO
     return maxerror;
 }
 
-static int QSortFCmp(const void * Elem1, const void * Elem2)
+// Insertion sort, the blocks are too small for qsort to pay off
+static void SortFloats(CODECFLOAT* _Vals, int _Nmbr)
 {
-    int ret = 0;
-
-    if(*(CODECFLOAT*)Elem1 - *(CODECFLOAT*)Elem2 < 0.)
-        ret = -1;
-    else if(*(CODECFLOAT*)Elem1 - *(CODECFLOAT*)Elem2 > 0.)
-        ret = 1;
-    return ret;
+    for(int i = 1; i < _Nmbr; i++)
+    {
+        CODECFLOAT v = _Vals[i];
+        int j = i;
+        for(; j > 0 && _Vals[j - 1] > v; j--)
+            _Vals[j] = _Vals[j - 1];
+        _Vals[j] = v;
+    }
 }
 
-
 /*--------------------------------------------------------------------------------------------
 // input [0,1]
 static CODECFLOAT CompBlock1(CODECFLOAT _RmpPnts[NUM_ENDPOINTS], [OUT] Min amd Max value of the ramp in float
@@ -2718,7 +2850,7 @@ static CODECFLOAT CompBlock1(CODECFLOAT _RmpPnts[NUM_ENDPOINTS], CODECFLOAT _Blk
     memcpy(fBlk, _Blk, _Nmbr * sizeof(CODECFLOAT)); 
 
     // sort the input
-    qsort((void *)fBlk, (size_t)_Nmbr, sizeof(CODECFLOAT), QSortFCmp);
+    SortFloats(fBlk, _Nmbr);
     
     CODECFLOAT new_p = -2.;
 
@@ -2821,17 +2953,49 @@ static CODECFLOAT CompBlock1(CODECFLOAT _RmpPnts[NUM_ENDPOINTS], CODECFLOAT _Blk
     CODECFLOAT gbl_rrb = (max_bnd <  max_r + GBL_SCH_EXT) ? max_bnd : max_r + GBL_SCH_EXT;
     CODECFLOAT gbl_lrb = (cntr <  min_r + GBL_SCH_EXT) ? cntr : min_r + GBL_SCH_EXT;
     CODECFLOAT gbl_rlb = (cntr >  max_r - GBL_SCH_EXT) ? cntr : max_r - GBL_SCH_EXT;
+#ifdef USE_SSE
+    if(_bUseSSE2)
+    {
+        // queue the ramps in search order and evaluate them RMP1_BATCH at a time
+        CODECFLOAT sch_l[RMP1_BATCH];
+        CODECFLOAT sch_r[RMP1_BATCH];
+        int nRmps = 0;
+        for(CODECFLOAT step_l = gbl_llb; step_l < gbl_lrb ; step_l+= GBL_SCH_STEP)
+        {
+            for(CODECFLOAT step_r = gbl_rrb; gbl_rlb <= step_r; step_r-=GBL_SCH_STEP)
+            {
+                sch_l[nRmps] = step_l;
+                sch_r[nRmps] = step_r;
+                if(++nRmps == RMP1_BATCH)
+                {
+                    int best = RmpSrch1Batch(afUniqueValues, afValueRepeats, dwUniqueValues, dwNumPoints, sch_l, sch_r, nRmps, gbl_err);
+                    if(best != -1)
+                    {
+                        gbl_l = sch_l[best];
+                        gbl_r = sch_r[best];
+                    }
+                    nRmps = 0;
+                }
+            }
+        }
+
+        if(nRmps)
+        {
+            int best = RmpSrch1Batch(afUniqueValues, afValueRepeats, dwUniqueValues, dwNumPoints, sch_l, sch_r, nRmps, gbl_err);
+            if(best != -1)
+            {
+                gbl_l = sch_l[best];
+                gbl_r = sch_r[best];
+            }
+        }
+    }
+    else
+#endif // USE_SSE
     for(CODECFLOAT step_l = gbl_llb; step_l < gbl_lrb ; step_l+= GBL_SCH_STEP)
     {
         for(CODECFLOAT step_r = gbl_rrb; gbl_rlb <= step_r; step_r-=GBL_SCH_STEP)
         {
-            CODECFLOAT sch_err;
-#ifdef USE_SSE
-            if(_bUseSSE2)
-                sch_err = RmpSrch1SSE2(afUniqueValues, afValueRepeats, gbl_err, step_l, step_r, dwUniqueValues, dwNumPoints);
-            else
-#endif // USE_SSE
-                sch_err = RmpSrch1(afUniqueValues, afValueRepeats, gbl_err, step_l, step_r, dwUniqueValues, dwNumPoints);
+            CODECFLOAT sch_err = RmpSrch1(afUniqueValues, afValueRepeats, gbl_err, step_l, step_r, dwUniqueValues, dwNumPoints);
             if(sch_err < gbl_err)
             {
                 gbl_err = sch_err;
@@ -2926,7 +3090,7 @@ CODECFLOAT CompBlock1X(CODECFLOAT* _Blk, CMP_WORD dwBlockSize, CMP_BYTE nEndpoin
     CompBlock1(Ramp, _Blk, dwBlockSize, dwNumPoints, bFixedRampPoints, _intPrec, _fracPrec, _bFixedRamp, _bUseSSE2);
 
     // final clusterization applied
-    CODECFLOAT fError = Clstr1(pcIndices, _Blk, Ramp, dwBlockSize, dwNumPoints, bFixedRampPoints, _intPrec, _fracPrec, _bFixedRamp);
+    CODECFLOAT fError = Clstr1(pcIndices, _Blk, Ramp, dwBlockSize, dwNumPoints, bFixedRampPoints, _intPrec, _fracPrec, _bFixedRamp, _bUseSSE2);
     nEndpoints[0] = (BYTE)Ramp[0];
     nEndpoints[1] = (BYTE)Ramp[1];
 
@@ -31,6 +31,11 @@
 #include <float.h>
 #include <assert.h>
 
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif // USE_SSE
+
 #include "BC6H_3dquant_constants.h"
 #include "BC6H_3dquant_vpc.h"
 #include "bc6h_definitions.h"
@@ -66,6 +71,25 @@ inline int a_compare( const void *arg1, const void *arg2 )
             ((BC6H_a* )arg1)->d-((BC6H_a* )arg2)->d < 0 ? -1 : 0;
 };
 
+//
+// Sorts at most BC6H_MAX_ENTRIES values, insertion sort is much faster than qsort for
+// so few entries. It is stable, equal elements keep the order they were given in
+//
+static void BC6H_sortAscending(BC6H_a *what, int n)
+{
+    for (int i=1; i < n; i++)
+    {
+        BC6H_a  key = what[i];
+        int     j   = i-1;
+        while (j >= 0 && what[j].d > key.d)
+        {
+            what[j+1] = what[j];
+            j--;
+        }
+        what[j+1] = key;
+    }
+}
+
 void BC6H_quant_AnD_Shell(double* v_, int k, int n, int *idx) { 
     // input:
     //
@@ -104,7 +128,29 @@ void BC6H_quant_AnD_Shell(double* v_, int k, int n, int *idx) {
 
     assert(M-m >0);
     s = (k-1)/(M-m);
-    for (i=0; i < n;i++) {
+    i = 0;
+#ifdef USE_SSE
+    if (g_bBC6HUseSSE2) {
+        // Two points at a time, the floor is a truncation since v_[i] >= m
+        __m128d ms = _mm_set1_pd(m *s);
+        for (; i+1 < n;i+=2) {
+            __m128d vi = _mm_mul_pd(_mm_loadu_pd(&v_[i]), _mm_set1_pd(s));
+            __m128d zi = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_sub_pd(_mm_add_pd(vi, _mm_set1_pd(0.5)), ms)));
+            __m128d di = _mm_sub_pd(_mm_sub_pd(vi, zi), ms);
+            _mm_storeu_pd(&v[i], vi);
+            _mm_storeu_pd(&z[i], zi);
+
+            for (int p=i; p < i+2; p++) {
+                idx[p]=(int)z[p];
+                _mm_store_sd(&d[p].d, p == i ? di : _mm_unpackhi_pd(di, di));
+                d[p].i = p;
+                dm+= d[p].d;
+                r += d[p].d*d[p].d;
+            }
+        }
+    }
+#endif // USE_SSE
+    for (; i < n;i++) {
         v[i] = v_[i]*s;
 
         idx[i]=(int)(z[i] = floor(v[i] +0.5 /* stabilizer*/ - m *s));
@@ -121,7 +167,7 @@ void BC6H_quant_AnD_Shell(double* v_, int k, int n, int *idx) {
         for (i=0; i < n;i++) 
             d[i].d -= dm;
 
-        qsort((void*)&d, n, sizeof(BC6H_a),a_compare);
+        BC6H_sortAscending(d, n);
 
     // got into fundamental simplex
     // move coordinate system origin to its center
@@ -192,7 +238,7 @@ void BC6H_sortProjection(double projection[BC6H_MAX_ENTRIES], int order[BC6H_MAX
     for (i=0; i < numEntries;i++) 
         what[what[i].i=i].d = projection[i];
 
-    qsort((void*)&what, numEntries, sizeof(BC6H_a),a_compare);
+    BC6H_sortAscending(what, numEntries);
     
     for (i=0; i < numEntries;i++) 
         order[i]=what[i].i;
@@ -206,6 +252,22 @@ void BC6H_project_d(double data[][BC6H_MAX_DIMENSION_BIG], int numEntries, doubl
     // assume that vector is normalized already
     int i,k;
 
+#ifdef USE_SSE
+    if (dimension == 3 && g_bBC6HUseSSE2)
+    {
+        // Products are summed in component order, as below
+        __m128d v01 = _mm_loadu_pd(vector);
+        __m128d v2  = _mm_load_sd(vector+2);
+        for(k=0;k<numEntries;k++)
+        {
+            __m128d p01 = _mm_mul_pd(_mm_loadu_pd(data[k]), v01);
+            __m128d p   = _mm_add_sd(p01, _mm_unpackhi_pd(p01, p01));
+            _mm_store_sd(&projection[k], _mm_add_sd(p, _mm_mul_sd(_mm_load_sd(&data[k][2]), v2)));
+        }
+        return;
+    }
+#endif // USE_SSE
+
     for(k=0;k<numEntries;k++)
     {
         projection[k]=0;
@@ -237,7 +299,12 @@ void BC6H_eigenVector_d(double cov[BC6H_MAX_DIMENSION_BIG][BC6H_MAX_DIMENSION_BI
         for(j=0;j<dimension;j++)
             c[0][i][j] =cov[i][j];
 
-    p = (int) floor(log( (DBL_MAX_EXP - EV_SLACK) / ceil (log((double)dimension)/log(2.)) )/log(2.)); 
+    // The number of squarings per normalization only depends on the dimension, BC6H always uses 3
+    static const int p3 = (int) floor(log( (DBL_MAX_EXP - EV_SLACK) / ceil (log(3.)/log(2.)) )/log(2.));
+    if (dimension == 3)
+        p = p3;
+    else
+        p = (int) floor(log( (DBL_MAX_EXP - EV_SLACK) / ceil (log((double)dimension)/log(2.)) )/log(2.)); 
 
     assert(p>0);
 
@@ -266,6 +333,26 @@ void BC6H_eigenVector_d(double cov[BC6H_MAX_DIMENSION_BIG][BC6H_MAX_DIMENSION_BI
                 c[l][i][j] /=maxDiag;
 
         for(m=0;m<p;m++) {
+#ifdef USE_SSE
+            if (dimension == 3 && g_bBC6HUseSSE2)
+            {
+                // Row i of the square is the sum of the rows k scaled by c[i][k], in k order
+                for(i=0;i<3;i++)
+                {
+                    __m128d c01 = _mm_mul_pd(_mm_set1_pd(c[l][i][0]), _mm_loadu_pd(c[l][0]));
+                    __m128d c2  = _mm_mul_sd(_mm_load_sd(&c[l][i][0]), _mm_load_sd(&c[l][0][2]));
+                    for(k=1;k<3;k++)
+                    {
+                        c01 = _mm_add_pd(c01, _mm_mul_pd(_mm_set1_pd(c[l][i][k]), _mm_loadu_pd(c[l][k])));
+                        c2  = _mm_add_sd(c2,  _mm_mul_sd(_mm_load_sd(&c[l][i][k]), _mm_load_sd(&c[l][k][2])));
+                    }
+                    _mm_storeu_pd(c[1-l][i], c01);
+                    _mm_store_sd(&c[1-l][i][2], c2);
+                }
+                l=1-l;
+                continue;
+            }
+#endif // USE_SSE
             for(i=0;i<dimension;i++)
                 for(j=0;j<dimension;j++) {
                     c[1-l][i][j]=0;
@@ -311,6 +398,36 @@ void BC6H_covariance_d(double data[][BC6H_MAX_DIMENSION_BIG], int numEntries, do
 
     int i,j,k;
 
+#ifdef USE_SSE
+    if (dimension == 3 && g_bBC6HUseSSE2)
+    {
+        // Accumulates the full 3x3 outer products in entry order, the upper triangle
+        // matches the mirrored lower one since the products are the same
+        __m128d c01[3], c2[3];
+        for(i=0;i<3;i++)
+            c01[i] = c2[i] = _mm_setzero_pd();
+
+        for(k=0;k<numEntries;k++)
+        {
+            __m128d d01 = _mm_loadu_pd(data[k]);
+            __m128d d2  = _mm_load_sd(&data[k][2]);
+            for(i=0;i<3;i++)
+            {
+                __m128d di = _mm_set1_pd(data[k][i]);
+                c01[i] = _mm_add_pd(c01[i], _mm_mul_pd(di, d01));
+                c2[i]  = _mm_add_sd(c2[i],  _mm_mul_sd(di, d2));
+            }
+        }
+
+        for(i=0;i<3;i++)
+        {
+            _mm_storeu_pd(cov[i], c01[i]);
+            _mm_store_sd(&cov[i][2], c2[i]);
+        }
+        return;
+    }
+#endif // USE_SSE
+
     for(i=0;i<dimension;i++)
         for(j=0;j<=i;j++)
         {
@@ -331,6 +448,37 @@ void BC6H_centerInPlace_d(double data[][BC6H_MAX_DIMENSION_BIG], int numEntries,
 #endif
     int i,k;
 
+#ifdef USE_SSE
+    if (dimension == 3 && g_bBC6HUseSSE2)
+    {
+        __m128d m01 = _mm_setzero_pd();
+        __m128d m2  = _mm_setzero_pd();
+        for(k=0;k<numEntries;k++)
+        {
+            m01 = _mm_add_pd(m01, _mm_loadu_pd(data[k]));
+            m2  = _mm_add_sd(m2,  _mm_load_sd(&data[k][2]));
+        }
+        _mm_storeu_pd(mean, m01);
+        _mm_store_sd(&mean[2], m2);
+
+        if (!numEntries)
+            return;
+
+        __m128d n = _mm_set1_pd((double) numEntries);
+        m01 = _mm_div_pd(m01, n);
+        m2  = _mm_div_sd(m2, n);
+        _mm_storeu_pd(mean, m01);
+        _mm_store_sd(&mean[2], m2);
+
+        for(k=0;k<numEntries;k++)
+        {
+            _mm_storeu_pd(data[k], _mm_sub_pd(_mm_loadu_pd(data[k]), m01));
+            _mm_store_sd(&data[k][2], _mm_sub_sd(_mm_load_sd(&data[k][2]), m2));
+        }
+        return;
+    }
+#endif // USE_SSE
+
     for(i=0;i<dimension;i++)
     {
             mean[i]=0;
@@ -349,6 +497,45 @@ void BC6H_centerInPlace_d(double data[][BC6H_MAX_DIMENSION_BIG], int numEntries,
     }
 }
 
+//
+// Sums the centered points weighted by their index into direction, and returns the
+// squared length of the (unnormalized) direction
+//
+static double BC6H_indexDirection_d(double data[][BC6H_MAX_DIMENSION_BIG], int index[BC6H_MAX_ENTRIES], int numEntries, double direction[BC6H_MAX_DIMENSION_BIG], int dimension)
+{
+    int j,k;
+    double q=0;
+
+#ifdef USE_SSE
+    if (dimension == 3 && g_bBC6HUseSSE2)
+    {
+        __m128d d01 = _mm_setzero_pd();
+        __m128d d2  = _mm_setzero_pd();
+        for (k=0;k<numEntries;k++)
+        {
+            __m128d w = _mm_set1_pd((double) index[k]);
+            d01 = _mm_add_pd(d01, _mm_mul_pd(_mm_loadu_pd(data[k]), w));
+            d2  = _mm_add_sd(d2,  _mm_mul_sd(_mm_load_sd(&data[k][2]), w));
+        }
+        _mm_storeu_pd(direction, d01);
+        _mm_store_sd(&direction[2], d2);
+
+        for (j=0;j<dimension;j++)
+            q+= direction[j]* direction[j];
+        return q;
+    }
+#endif // USE_SSE
+
+    for (j=0;j<dimension;j++)
+    {
+        direction[j]=0;
+        for (k=0;k<numEntries;k++) 
+            direction[j]+=data[k][j]*index[k];
+        q+= direction[j]* direction[j];
+    }
+    return q;
+}
+
 void BC6H_optQuantAnD_d(
     double data[BC6H_MAX_ENTRIES][BC6H_MAX_DIMENSION_BIG], 
     int numEntries, int numClusters, int index[BC6H_MAX_ENTRIES],
@@ -422,14 +609,7 @@ void BC6H_optQuantAnD_d(
                     t+= index[k]*index[k];
                 }
 
-                for (j=0;j<dimension;j++)
-                {
-                    direction[j]=0;
-                    for (k=0;k<numEntries;k++) 
-                        direction[j]+=centered[k][j]*index[k];
-                    q+= direction[j]* direction[j];
-
-                }
+                q = BC6H_indexDirection_d(centered, index, numEntries, direction, dimension);
 
                 s /= (double) numEntries;
                 t = t - s * s * (double) numEntries;
@@ -496,13 +676,7 @@ void BC6H_optQuantAnD_d(
         t+= index[k]*index[k];
     }
 
-    for (j=0;j<dimension;j++)
-    {
-        direction[j]=0;
-        for (k=0;k<numEntries;k++) 
-            direction[j]+=centered[k][j]*index[k];
-        q+= direction[j]* direction[j];
-    }
+    q = BC6H_indexDirection_d(centered, index, numEntries, direction, dimension);
 
     s /= (double) numEntries;
 
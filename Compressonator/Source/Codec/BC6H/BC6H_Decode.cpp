@@ -37,6 +37,7 @@
 
 #include <bitset>
 #include <stddef.h>
+#include <process.h>
 
 #pragma warning(disable:4244)
 #include "half.h"
@@ -440,7 +441,7 @@ AMD_BC6H_Format extract_format(BYTE in[BC6H_COMPRESSED_BLOCK_SIZE])
                 bc6h_format.bw = header.getvalue(25,10) |            //11:    bw[9:0]
                                 (header.getvalue(60,1) << 10);        //        bw[10]
                 bc6h_format.bx = header.getvalue(55,5);                //5:    bx[4:0]
-                bc6h_format.by = header.getvalue(61,4);                //5:    by[3:0]
+                bc6h_format.by = header.getvalue(61,4) |                //5:    by[3:0]
                                 (header.getvalue(40,1) << 4);        //        by[4]
                 bc6h_format.bz = header.getvalue(50,1) |             //5:    bz[0]
                                 (header.getvalue(69,1) << 1) |        //        bz[1]
@@ -774,3 +775,370 @@ void BC6HBlockDecoder::DecompressBlock( float out[BC6H_MAX_SUBSET_SIZE][BC6H_MAX
 
 }
 
+//---------------------------------------------------------------------------------------------------------------------------------------
+// Table driven decoder
+//
+// Each mode is described by the runs of header bits that make up its endpoint fields, as read
+// by extract_format above. The palette is built with integer arithmetic and texels are written
+// as half floats (RGBA16F), giving the same values as DecompressBlock without a float round trip.
+//---------------------------------------------------------------------------------------------------------------------------------------
+
+typedef unsigned long long BC6H_QWORD;
+
+#define BC6H_MAX_FIELD_RUNS     23
+#define BC6H_NUM_MODES          14
+#define BC6H_HALF_ONE           0x3C00      // 1.0 as a half float, used for the output alpha
+#define BC6H_TEXEL_SIZE         (BC6H_MAX_DIMENSION_BIG * sizeof(WORD))
+
+// Endpoint fields, indexed channel * 4 + (w, x, y, z)
+enum
+{
+    BC6H_R_W, BC6H_R_X, BC6H_R_Y, BC6H_R_Z,
+    BC6H_G_W, BC6H_G_X, BC6H_G_Y, BC6H_G_Z,
+    BC6H_B_W, BC6H_B_X, BC6H_B_Y, BC6H_B_Z,
+    BC6H_NUM_FIELDS
+};
+
+struct BC6H_FieldRun
+{
+    BYTE    field;      // endpoint field the bits belong to
+    BYTE    start;      // first bit in the block
+    BYTE    bits;       // number of bits
+    BYTE    shift;      // position of the bits in the field
+};
+
+struct BC6H_ModeInfo
+{
+    BYTE            mode;
+    BYTE            wBits;
+    BYTE            tBits[NCHANNELS];
+    BYTE            numRuns;
+    BC6H_FieldRun   runs[BC6H_MAX_FIELD_RUNS];
+};
+
+static const BC6H_ModeInfo BC6H_MODE_INFO[BC6H_NUM_MODES] =
+{
+    // Mode 1 (0x00) 10:5:5:5
+    { 1, 10, {5, 5, 5}, 19, {
+        {BC6H_R_W,5,10,0}, {BC6H_R_X,35,5,0}, {BC6H_R_Y,65,5,0}, {BC6H_R_Z,71,5,0},
+        {BC6H_G_W,15,10,0}, {BC6H_G_X,45,5,0}, {BC6H_G_Y,41,4,0}, {BC6H_G_Y,2,1,4},
+        {BC6H_G_Z,51,4,0}, {BC6H_G_Z,40,1,4}, {BC6H_B_W,25,10,0}, {BC6H_B_X,55,5,0},
+        {BC6H_B_Y,61,4,0}, {BC6H_B_Y,3,1,4}, {BC6H_B_Z,50,1,0}, {BC6H_B_Z,60,1,1},
+        {BC6H_B_Z,70,1,2}, {BC6H_B_Z,76,1,3}, {BC6H_B_Z,4,1,4}
+    }},
+    // Mode 2 (0x01) 7:6:6:6
+    { 2,  7, {6, 6, 6}, 23, {
+        {BC6H_R_W,5,7,0}, {BC6H_R_X,35,6,0}, {BC6H_R_Y,65,6,0}, {BC6H_R_Z,71,6,0},
+        {BC6H_G_W,15,7,0}, {BC6H_G_X,45,6,0}, {BC6H_G_Y,41,4,0}, {BC6H_G_Y,24,1,4},
+        {BC6H_G_Y,2,1,5}, {BC6H_G_Z,51,4,0}, {BC6H_G_Z,3,1,4}, {BC6H_G_Z,4,1,5},
+        {BC6H_B_W,25,7,0}, {BC6H_B_X,55,6,0}, {BC6H_B_Y,61,4,0}, {BC6H_B_Y,14,1,4},
+        {BC6H_B_Y,22,1,5}, {BC6H_B_Z,12,1,0}, {BC6H_B_Z,13,1,1}, {BC6H_B_Z,23,1,2},
+        {BC6H_B_Z,32,1,3}, {BC6H_B_Z,34,1,4}, {BC6H_B_Z,33,1,5}
+    }},
+    // Mode 3 (0x02) 11:5:4:4
+    { 3, 11, {5, 4, 4}, 18, {
+        {BC6H_R_W,5,10,0}, {BC6H_R_W,40,1,10}, {BC6H_R_X,35,5,0}, {BC6H_R_Y,65,5,0},
+        {BC6H_R_Z,71,5,0}, {BC6H_G_W,15,10,0}, {BC6H_G_W,49,1,10}, {BC6H_G_X,45,4,0},
+        {BC6H_G_Y,41,4,0}, {BC6H_G_Z,51,4,0}, {BC6H_B_W,25,10,0}, {BC6H_B_W,59,1,10},
+        {BC6H_B_X,55,4,0}, {BC6H_B_Y,61,4,0}, {BC6H_B_Z,50,1,0}, {BC6H_B_Z,60,1,1},
+        {BC6H_B_Z,70,1,2}, {BC6H_B_Z,76,1,3}
+    }},
+    // Mode 4 (0x06) 11:4:5:4
+    { 4, 11, {4, 5, 4}, 20, {
+        {BC6H_R_W,5,10,0}, {BC6H_R_W,39,1,10}, {BC6H_R_X,35,4,0}, {BC6H_R_Y,65,4,0},
+        {BC6H_R_Z,71,4,0}, {BC6H_G_W,15,10,0}, {BC6H_G_W,50,1,10}, {BC6H_G_X,45,5,0},
+        {BC6H_G_Y,41,4,0}, {BC6H_G_Y,75,1,4}, {BC6H_G_Z,51,4,0}, {BC6H_G_Z,40,1,4},
+        {BC6H_B_W,25,10,0}, {BC6H_B_W,59,1,10}, {BC6H_B_X,55,4,0}, {BC6H_B_Y,61,4,0},
+        {BC6H_B_Z,69,1,0}, {BC6H_B_Z,60,1,1}, {BC6H_B_Z,70,1,2}, {BC6H_B_Z,76,1,3}
+    }},
+    // Mode 5 (0x0A) 11:4:4:5
+    { 5, 11, {4, 4, 5}, 20, {
+        {BC6H_R_W,5,10,0}, {BC6H_R_W,39,1,10}, {BC6H_R_X,35,4,0}, {BC6H_R_Y,65,4,0},
+        {BC6H_R_Z,71,4,0}, {BC6H_G_W,15,10,0}, {BC6H_G_W,49,1,10}, {BC6H_G_X,45,4,0},
+        {BC6H_G_Y,41,4,0}, {BC6H_G_Z,51,4,0}, {BC6H_B_W,25,10,0}, {BC6H_B_W,60,1,10},
+        {BC6H_B_X,55,5,0}, {BC6H_B_Y,61,4,0}, {BC6H_B_Y,40,1,4}, {BC6H_B_Z,50,1,0},
+        {BC6H_B_Z,69,1,1}, {BC6H_B_Z,70,1,2}, {BC6H_B_Z,76,1,3}, {BC6H_B_Z,75,1,4}
+    }},
+    // Mode 6 (0x0E) 9:5:5:5
+    { 6,  9, {5, 5, 5}, 19, {
+        {BC6H_R_W,5,9,0}, {BC6H_G_W,15,9,0}, {BC6H_B_W,25,9,0}, {BC6H_R_X,35,5,0},
+        {BC6H_G_X,45,5,0}, {BC6H_B_X,55,5,0}, {BC6H_R_Y,65,5,0}, {BC6H_G_Y,41,4,0},
+        {BC6H_G_Y,24,1,4}, {BC6H_B_Y,61,4,0}, {BC6H_B_Y,14,1,4}, {BC6H_R_Z,71,5,0},
+        {BC6H_G_Z,51,4,0}, {BC6H_G_Z,40,1,4}, {BC6H_B_Z,50,1,0}, {BC6H_B_Z,60,1,1},
+        {BC6H_B_Z,70,1,2}, {BC6H_B_Z,76,1,3}, {BC6H_B_Z,34,1,4}
+    }},
+    // Mode 7 (0x12) 8:6:5:5
+    { 7,  8, {6, 5, 5}, 19, {
+        {BC6H_R_W,5,8,0}, {BC6H_G_W,15,8,0}, {BC6H_B_W,25,8,0}, {BC6H_R_X,35,6,0},
+        {BC6H_G_X,45,5,0}, {BC6H_B_X,55,5,0}, {BC6H_R_Y,65,6,0}, {BC6H_G_Y,41,4,0},
+        {BC6H_G_Y,24,1,4}, {BC6H_B_Y,61,4,0}, {BC6H_B_Y,14,1,4}, {BC6H_R_Z,71,6,0},
+        {BC6H_G_Z,51,4,0}, {BC6H_G_Z,13,1,4}, {BC6H_B_Z,50,1,0}, {BC6H_B_Z,60,1,1},
+        {BC6H_B_Z,23,1,2}, {BC6H_B_Z,33,1,3}, {BC6H_B_Z,34,1,4}
+    }},
+    // Mode 8 (0x16) 8:5:6:5
+    { 8,  8, {5, 6, 5}, 21, {
+        {BC6H_R_W,5,8,0}, {BC6H_G_W,15,8,0}, {BC6H_B_W,25,8,0}, {BC6H_R_X,35,5,0},
+        {BC6H_G_X,45,6,0}, {BC6H_B_X,55,5,0}, {BC6H_R_Y,65,5,0}, {BC6H_G_Y,41,4,0},
+        {BC6H_G_Y,24,1,4}, {BC6H_G_Y,23,1,5}, {BC6H_B_Y,61,4,0}, {BC6H_B_Y,14,1,4},
+        {BC6H_R_Z,71,5,0}, {BC6H_G_Z,51,4,0}, {BC6H_G_Z,40,1,4}, {BC6H_G_Z,33,1,5},
+        {BC6H_B_Z,13,1,0}, {BC6H_B_Z,60,1,1}, {BC6H_B_Z,70,1,2}, {BC6H_B_Z,76,1,3},
+        {BC6H_B_Z,34,1,4}
+    }},
+    // Mode 9 (0x1A) 8:5:5:6
+    { 9,  8, {5, 5, 6}, 21, {
+        {BC6H_R_W,5,8,0}, {BC6H_G_W,15,8,0}, {BC6H_B_W,25,8,0}, {BC6H_R_X,35,5,0},
+        {BC6H_G_X,45,5,0}, {BC6H_B_X,55,6,0}, {BC6H_R_Y,65,5,0}, {BC6H_G_Y,41,4,0},
+        {BC6H_G_Y,24,1,4}, {BC6H_B_Y,61,4,0}, {BC6H_B_Y,14,1,4}, {BC6H_B_Y,23,1,5},
+        {BC6H_R_Z,71,5,0}, {BC6H_G_Z,51,4,0}, {BC6H_G_Z,40,1,4}, {BC6H_B_Z,50,1,0},
+        {BC6H_B_Z,13,1,1}, {BC6H_B_Z,70,1,2}, {BC6H_B_Z,76,1,3}, {BC6H_B_Z,34,1,4},
+        {BC6H_B_Z,33,1,5}
+    }},
+    // Mode 10 (0x1E) 6:6:6:6
+    {10,  6, {6, 6, 6}, 23, {
+        {BC6H_R_W,5,6,0}, {BC6H_G_W,15,6,0}, {BC6H_B_W,25,6,0}, {BC6H_R_X,35,6,0},
+        {BC6H_G_X,45,6,0}, {BC6H_B_X,55,6,0}, {BC6H_R_Y,65,6,0}, {BC6H_G_Y,41,4,0},
+        {BC6H_G_Y,24,1,4}, {BC6H_G_Y,21,1,5}, {BC6H_B_Y,61,4,0}, {BC6H_B_Y,14,1,4},
+        {BC6H_B_Y,22,1,5}, {BC6H_R_Z,71,6,0}, {BC6H_G_Z,51,4,0}, {BC6H_G_Z,11,1,4},
+        {BC6H_G_Z,31,1,5}, {BC6H_B_Z,12,1,0}, {BC6H_B_Z,13,1,1}, {BC6H_B_Z,23,1,2},
+        {BC6H_B_Z,32,1,3}, {BC6H_B_Z,34,1,4}, {BC6H_B_Z,33,1,5}
+    }},
+    // Mode 11 (0x03) 10:10:10:10
+    {11, 10, {10, 10, 10}, 6, {
+        {BC6H_R_W,5,10,0}, {BC6H_G_W,15,10,0}, {BC6H_B_W,25,10,0}, {BC6H_R_X,35,10,0},
+        {BC6H_G_X,45,10,0}, {BC6H_B_X,55,10,0}
+    }},
+    // Mode 12 (0x07) 11:9:9:9
+    {12, 11, {9, 9, 9}, 9, {
+        {BC6H_R_W,5,10,0}, {BC6H_R_W,44,1,10}, {BC6H_G_W,15,10,0}, {BC6H_G_W,54,1,10},
+        {BC6H_B_W,25,10,0}, {BC6H_B_W,64,1,10}, {BC6H_R_X,35,9,0}, {BC6H_G_X,45,9,0},
+        {BC6H_B_X,55,9,0}
+    }},
+    // Mode 13 (0x0B) 12:8:8:8
+    {13, 12, {8, 8, 8}, 9, {
+        {BC6H_R_W,5,10,0}, {BC6H_R_W,43,2,10}, {BC6H_G_W,15,10,0}, {BC6H_G_W,53,2,10},
+        {BC6H_B_W,25,10,0}, {BC6H_B_W,63,2,10}, {BC6H_R_X,35,8,0}, {BC6H_G_X,45,8,0},
+        {BC6H_B_X,55,8,0}
+    }},
+    // Mode 14 (0x0F) 16:4:4:4
+    {14, 16, {4, 4, 4}, 9, {
+        {BC6H_R_W,5,10,0}, {BC6H_R_W,39,6,10}, {BC6H_G_W,15,10,0}, {BC6H_G_W,49,6,10},
+        {BC6H_B_W,25,10,0}, {BC6H_B_W,59,6,10}, {BC6H_R_X,35,4,0}, {BC6H_G_X,45,4,0},
+        {BC6H_B_X,55,4,0}
+    }}
+};
+
+// Maps the mode bits (five bits, or two bits when bit 1 is clear) to BC6H_MODE_INFO, -1 is a reserved mode
+static const signed char BC6H_MODE_LOOKUP[32] =
+{
+     0,  1,  2, 10, -1, -1,  3, 11,
+    -1, -1,  4, 12, -1, -1,  5, 13,
+    -1, -1,  6, -1, -1, -1,  7, -1,
+    -1, -1,  8, -1, -1, -1,  9, -1
+};
+
+static inline DWORD BC6H_GetBits(const BC6H_QWORD block[2], DWORD bitPosition, DWORD count)
+{
+    DWORD   bits;
+
+    if(bitPosition >= 64)
+        bits = (DWORD)(block[1] >> (bitPosition - 64));
+    else if(bitPosition + count <= 64)
+        bits = (DWORD)(block[0] >> bitPosition);
+    else
+        bits = (DWORD)((block[0] >> bitPosition) | (block[1] << (64 - bitPosition)));
+
+    return bits & ((1 << count) - 1);
+}
+
+// Same as unquantize for UNSIGNED_F16
+static inline int BC6H_UnquantizeUnsigned(int q, int prec)
+{
+    if (prec >= 15)
+        return q;
+    if (q == 0)
+        return 0;
+    if (q == ((1<<prec)-1))
+        return U16MAX;
+    return (q * (U16MAX+1) + (U16MAX+1)/2) >> prec;
+}
+
+void BC6HBlockDecoder::DecompressBlockRGBA16F(BYTE   *out,
+                                              DWORD  dwPitch,
+                                              BYTE   in[BC6H_COMPRESSED_BLOCK_SIZE])
+{
+    BC6H_QWORD  block[2];
+    DWORD       i, ch;
+
+    memcpy(block, in, BC6H_COMPRESSED_BLOCK_SIZE);
+
+    // 2 bit mode has Mode bit:2 = 0, 5 bit mode has Mode bit:2 = 1
+    DWORD   modeBits  = (in[0] & 0x02) ? (in[0] & 0x1F) : (in[0] & 0x01);
+    int     modeIndex = BC6H_MODE_LOOKUP[modeBits];
+
+    if (modeIndex < 0)
+    {
+        // Reserved mode, decodes to black with alpha = 1
+        const WORD black[BC6H_MAX_DIMENSION_BIG] = {0, 0, 0, BC6H_HALF_ONE};
+        for (i=0; i<BC6H_MAX_SUBSET_SIZE; i++)
+            memcpy(out + (i/4)*dwPitch + (i%4)*BC6H_TEXEL_SIZE, black, BC6H_TEXEL_SIZE);
+        return;
+    }
+
+    const BC6H_ModeInfo &mode = BC6H_MODE_INFO[modeIndex];
+
+    int     field[BC6H_NUM_FIELDS] = {0};
+    for (i=0; i<mode.numRuns; i++)
+    {
+        const BC6H_FieldRun &run = mode.runs[i];
+        field[run.field] |= BC6H_GetBits(block, run.start, run.bits) << run.shift;
+    }
+
+    // Modes 1 to 10 are two region tiles, modes 1 to 9 store the x,y,z endpoints as deltas from w
+    BOOL    twoRegions  = mode.mode <= 10;
+    BOOL    transformed = mode.mode < 10;
+
+    // endpoint[region][A or B][channel]
+    int     endpoint[2][2][NCHANNELS];
+    for (ch=0; ch<NCHANNELS; ch++)
+    {
+        int w = field[ch*4];
+        endpoint[0][0][ch] = w;
+        endpoint[0][1][ch] = field[ch*4+1];
+        endpoint[1][0][ch] = field[ch*4+2];
+        endpoint[1][1][ch] = field[ch*4+3];
+
+        if (transformed)
+        {
+            endpoint[0][1][ch] = (SIGN_EXTEND(endpoint[0][1][ch], mode.tBits[ch]) + w) & MASK(mode.wBits);
+            endpoint[1][0][ch] = (SIGN_EXTEND(endpoint[1][0][ch], mode.tBits[ch]) + w) & MASK(mode.wBits);
+            endpoint[1][1][ch] = (SIGN_EXTEND(endpoint[1][1][ch], mode.tBits[ch]) + w) & MASK(mode.wBits);
+        }
+    }
+
+    // Palette of half floats for each region, interpolation as in lerp followed by finish_unquantize
+    DWORD       numRegions = twoRegions ? 2 : 1;
+    DWORD       denom      = twoRegions ? 7 : 15;
+    const int   *weights   = twoRegions ? g_aWeights3 : g_aWeights4;
+    WORD        palette[2][16][BC6H_MAX_DIMENSION_BIG];
+
+    for (DWORD r=0; r<numRegions; r++)
+    {
+        for (ch=0; ch<NCHANNELS; ch++)
+        {
+            int a = BC6H_UnquantizeUnsigned(endpoint[r][0][ch], mode.wBits);
+            int b = BC6H_UnquantizeUnsigned(endpoint[r][1][ch], mode.wBits);
+            for (i=0; i<=denom; i++)
+                palette[r][i][ch] = (WORD)((((a*weights[denom-i] + b*weights[i]) >> 6) * 31) >> 6);
+        }
+        for (i=0; i<=denom; i++)
+            palette[r][i][3] = BC6H_HALF_ONE;
+    }
+
+    if (twoRegions)
+    {
+        DWORD   shape       = BC6H_GetBits(block, 77, 5);
+        DWORD   fixup       = g_indexfixups[shape];
+        DWORD   bitPosition = TWO_REGION_INDEX_OFFSET;
+        for (i=0; i<BC6H_MAX_SUBSET_SIZE; i++)
+        {
+            DWORD nbits = (i == 0 || i == fixup) ? 2 : 3;
+            DWORD index = BC6H_GetBits(block, bitPosition, nbits);
+            bitPosition += nbits;
+            memcpy(out + (i/4)*dwPitch + (i%4)*BC6H_TEXEL_SIZE, palette[BC7_PARTITIONS[1][shape][i]][index], BC6H_TEXEL_SIZE);
+        }
+    }
+    else
+    {
+        DWORD   bitPosition = ONE_REGION_INDEX_OFFSET;
+        for (i=0; i<BC6H_MAX_SUBSET_SIZE; i++)
+        {
+            DWORD nbits = (i == 0) ? 3 : 4;
+            DWORD index = BC6H_GetBits(block, bitPosition, nbits);
+            bitPosition += nbits;
+            memcpy(out + (i/4)*dwPitch + (i%4)*BC6H_TEXEL_SIZE, palette[0][index], BC6H_TEXEL_SIZE);
+        }
+    }
+}
+
+struct BC6HDecodeThreadParam
+{
+    BC6HBlockDecoder    *decoder;
+    BYTE                *in;
+    DWORD               inPitch;
+    DWORD               blocksX;
+    DWORD               blocksY;
+    BYTE                *out;
+    DWORD               outPitch;
+};
+
+static unsigned int _stdcall BC6HThreadProcDecode(void* param)
+{
+    BC6HDecodeThreadParam *tp = (BC6HDecodeThreadParam*)param;
+
+    for (DWORD y=0; y<tp->blocksY; y++)
+    {
+        BYTE *in  = tp->in  + y*tp->inPitch;
+        BYTE *out = tp->out + y*4*tp->outPitch;
+        for (DWORD x=0; x<tp->blocksX; x++)
+            tp->decoder->DecompressBlockRGBA16F(out + x*4*BC6H_TEXEL_SIZE, tp->outPitch, in + x*BC6H_COMPRESSED_BLOCK_SIZE);
+    }
+
+    return 0;
+}
+
+//
+// Decodes rows of blocks to RGBA16F, the rows are split into bands across numThreads threads.
+// in is inPitch bytes per row of blocks, out is outPitch bytes per row of texels
+//
+void BC6HBlockDecoder::DecompressBlocksRGBA16F(BYTE   *in,
+                                               DWORD  inPitch,
+                                               DWORD  blocksX,
+                                               DWORD  blocksY,
+                                               BYTE   *out,
+                                               DWORD  outPitch,
+                                               DWORD  numThreads)
+{
+    BC6HDecodeThreadParam   param[MAXIMUM_WAIT_OBJECTS];
+    HANDLE                  threadHandle[MAXIMUM_WAIT_OBJECTS];
+
+    numThreads = min(min(numThreads, blocksY), (DWORD)MAXIMUM_WAIT_OBJECTS);
+    if (numThreads == 0)
+        return;
+
+    DWORD   firstRow = 0;
+    for (DWORD t=0; t<numThreads; t++)
+    {
+        DWORD   rows = (blocksY - firstRow) / (numThreads - t);
+        param[t].decoder  = this;
+        param[t].in       = in  + firstRow*inPitch;
+        param[t].inPitch  = inPitch;
+        param[t].blocksX  = blocksX;
+        param[t].blocksY  = rows;
+        param[t].out      = out + firstRow*4*outPitch;
+        param[t].outPitch = outPitch;
+        firstRow += rows;
+    }
+
+    if (numThreads == 1)
+    {
+        BC6HThreadProcDecode(&param[0]);
+        return;
+    }
+
+    DWORD   numHandles = 0;
+    for (DWORD t=0; t<numThreads; t++)
+    {
+        threadHandle[numHandles] = (HANDLE)_beginthreadex(NULL, 0, BC6HThreadProcDecode, (void*)&param[t], 0, NULL);
+        if (threadHandle[numHandles])
+            numHandles++;
+        else
+            BC6HThreadProcDecode(&param[t]);
+    }
+
+    if (numHandles)
+    {
+        WaitForMultipleObjects(numHandles, threadHandle, TRUE, INFINITE);
+        for (DWORD t=0; t<numHandles; t++)
+            CloseHandle(threadHandle[t]);
+    }
+}
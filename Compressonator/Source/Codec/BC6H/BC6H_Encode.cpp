@@ -49,6 +49,11 @@
 #include "compclient.h"
 #endif
 
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif // USE_SSE
+
 extern int  g_block;
 extern FILE *g_fp;
 int gl_block = 0;
@@ -996,36 +1001,57 @@ double    BC6HBlockEncoder::FindBestPattern(AMD_BC6H_Format &BC6H_data,
     clampF16Max(BC6H_data.EndPoints);
 
     error = 0;
-    double  NewShape[BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG];
 
     // Build the new shape from the partition output data
     int sub0index = 0;
     int sub1index = 0;
-    for (int i = 0; i < BC6H_MAX_SUBSET_SIZE; i++)
+#ifdef USE_SSE
+    if (g_bBC6HUseSSE2)
     {
-        // subset 0 or subset 1
-        if (BC7_PARTITIONS[1][shape_pattern][i])
+        // Absolute values by clearing the sign bits, summed in component order as below
+        const __m128d absMask = _mm_castsi128_pd(_mm_set_epi32(0x7FFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF, 0xFFFFFFFF));
+        for (int i = 0; i < BC6H_MAX_SUBSET_SIZE; i++)
         {
-            NewShape[i][0] = outB[1][sub1index][0];
-            NewShape[i][1] = outB[1][sub1index][1];
-            NewShape[i][2] = outB[1][sub1index][2];
-            NewShape[i][3] = outB[1][sub1index][3];
-            sub1index++;
+            double *outPoint = BC7_PARTITIONS[1][shape_pattern][i] ? outB[1][sub1index++] : outB[0][sub0index++];
+
+            __m128d e01 = _mm_and_pd(_mm_sub_pd(_mm_loadu_pd(in[i]),   _mm_loadu_pd(outPoint)),   absMask);
+            __m128d e23 = _mm_and_pd(_mm_sub_pd(_mm_loadu_pd(in[i]+2), _mm_loadu_pd(outPoint+2)), absMask);
+            __m128d e   = _mm_add_sd(e01, _mm_unpackhi_pd(e01, e01));
+            e = _mm_add_sd(e, e23);
+            e = _mm_add_sd(e, _mm_unpackhi_pd(e23, e23));
+            error += _mm_cvtsd_f64(e);
         }
-        else
+    }
+    else
+#endif // USE_SSE
+    {
+        double  NewShape[BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG];
+        for (int i = 0; i < BC6H_MAX_SUBSET_SIZE; i++)
         {
-            NewShape[i][0] = outB[0][sub0index][0];
-            NewShape[i][1] = outB[0][sub0index][1];
-            NewShape[i][2] = outB[0][sub0index][2];
-            NewShape[i][3] = outB[0][sub0index][3];
-            sub0index++;
-        }
+            // subset 0 or subset 1
+            if (BC7_PARTITIONS[1][shape_pattern][i])
+            {
+                NewShape[i][0] = outB[1][sub1index][0];
+                NewShape[i][1] = outB[1][sub1index][1];
+                NewShape[i][2] = outB[1][sub1index][2];
+                NewShape[i][3] = outB[1][sub1index][3];
+                sub1index++;
+            }
+            else
+            {
+                NewShape[i][0] = outB[0][sub0index][0];
+                NewShape[i][1] = outB[0][sub0index][1];
+                NewShape[i][2] = outB[0][sub0index][2];
+                NewShape[i][3] = outB[0][sub0index][3];
+                sub0index++;
+            }
 
-        // Calculate error from original
-        error +=    abs(in[i][0] - NewShape[i][0]) +
-                    abs(in[i][1] - NewShape[i][1]) +
-                    abs(in[i][2] - NewShape[i][2]) +
-                    abs(in[i][3] - NewShape[i][3]);
+            // Calculate error from original
+            error +=    abs(in[i][0] - NewShape[i][0]) +
+                        abs(in[i][1] - NewShape[i][1]) +
+                        abs(in[i][2] - NewShape[i][2]) +
+                        abs(in[i][3] - NewShape[i][3]);
+        }
     }
 
 
@@ -1076,6 +1102,11 @@ double    BC6HBlockEncoder::EncodePattern(AMD_BC6H_Format &BC6H_data,
     bool fits[15];
     memset(fits,0,sizeof(fits));
 
+    // The fast modes only use mode 1 for two regions (ModeFitOrder[4]) and
+    // mode 11 for one region (ModeFitOrder[14])
+    if (m_fastModes)
+        min_mode = max_mode = (BC6H_data.region == 2)?4:MAX_BC6H_PARTITIONS;
+
     //
     // Notes;  Only the endpoints are varying; the indices stay fixed in values!
     // so to optimize which mode we need only check the endpoints error against our original to pick the mode to save
@@ -1213,8 +1244,8 @@ double    BC6HBlockEncoder::EncodePattern(AMD_BC6H_Format &BC6H_data,
         }
 #endif
 
-    // Should not get here!
-    return error;
+    // Should not get here unless the modes were restricted: no mode can hold the endpoints
+    return DBL_MAX;
 
 }
 
@@ -1258,8 +1289,11 @@ float BC6HBlockEncoder::CompressBlock(float    in[BC6H_MAX_SUBSET_SIZE][BC6H_MAX
 
     AMD_BC6H_Format            BC6H_data;
     AMD_BC6H_Format            best_BC6H_data;
+    AMD_BC6H_Format            oneRegion_BC6H_data;
+    double                     oneRegionError   = DBL_MAX;
 
     memset(&best_BC6H_data,0,sizeof(AMD_BC6H_Format));
+    memset(&oneRegion_BC6H_data,0,sizeof(AMD_BC6H_Format));
 
     if (m_useMonoShapePatterns)
     {
@@ -1281,10 +1315,41 @@ float BC6HBlockEncoder::CompressBlock(float    in[BC6H_MAX_SUBSET_SIZE][BC6H_MAX
                 bestShape = -1;
                 memcpy(&best_BC6H_data,&BC6H_data,sizeof(BC6H_data));
         }
+        oneRegionError = bestError;
+        memcpy(&oneRegion_BC6H_data,&BC6H_data,sizeof(BC6H_data));
+
+        // At the reduced speeds only the shapes with the lowest estimated error are
+        // fitted, ties go to the lower shape
+        bool    tryShape[BC6H_MAX_PARTITIONS];
+        if (m_maxShapes < BC6H_MAX_PARTITIONS)
+        {
+            double  shapeError[BC6H_MAX_PARTITIONS];
+            BC6H_EstimateShapeErrors(din, shapeError);
 
-        // now run through all two regions shapes to find the best pattern
+            memset(tryShape,0,sizeof(tryShape));
+            for (int n=0; n<m_maxShapes; n++)
+            {
+                int bestEstimate = -1;
+                for (int shape=0; shape<BC6H_MAX_PARTITIONS; shape++)
+                {
+                    if (!tryShape[shape] && ((bestEstimate < 0) || (shapeError[shape] < shapeError[bestEstimate])))
+                        bestEstimate = shape;
+                }
+                tryShape[bestEstimate] = true;
+            }
+        }
+        else
+        {
+            for (int shape=0; shape<BC6H_MAX_PARTITIONS; shape++)
+                tryShape[shape] = true;
+        }
+
+        // now run through the two regions shapes to find the best pattern
         for (int shape=0; shape<32; shape++)
         {
+            if (!tryShape[shape])
+                continue;
+
             memset(&BC6H_data,0,sizeof(BC6H_data));
             Error = FindBestPattern(BC6H_data,true,shape,din);
             if (Error <= bestError)
@@ -1299,6 +1364,13 @@ float BC6HBlockEncoder::CompressBlock(float    in[BC6H_MAX_SUBSET_SIZE][BC6H_MAX
 
     // Optimize the result for encoding
     bestError = EncodePattern(best_BC6H_data,bestError);
+
+    // With the fast modes the best two region shape may not fit mode 1, use the one region result
+    if ((bestError == DBL_MAX) && (best_BC6H_data.region == 2))
+    {
+        memcpy(&best_BC6H_data,&oneRegion_BC6H_data,sizeof(best_BC6H_data));
+        bestError = EncodePattern(best_BC6H_data,oneRegionError);
+    }
     
     // do final encoding and save to output block
     SaveDataBlock(best_BC6H_data,out);
@@ -1373,3 +1445,30 @@ float BC6HBlockEncoder::CompressBlock(float    in[BC6H_MAX_SUBSET_SIZE][BC6H_MAX
 
     return (float) bestError;
 }
+
+void BC6HBlockEncoder::SetCompressionSpeed(CMP_Speed speed)
+{
+    switch (speed)
+    {
+        case CMP_Speed_SuperFast:
+            m_maxShapes = BC6H_SUPERFAST_SHAPES;
+            m_fastModes = true;
+            break;
+        case CMP_Speed_Fast:
+            m_maxShapes = BC6H_FAST_SHAPES;
+            m_fastModes = false;
+            break;
+        default:
+            m_maxShapes = BC6H_MAX_PARTITIONS;
+            m_fastModes = false;
+            break;
+    }
+}
+
+void BC6HBlockEncoder::CompressBlocks(float in[][BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG], BYTE *out, DWORD numBlocks)
+{
+    for (DWORD block=0; block<numBlocks; block++)
+    {
+        CompressBlock(in[block], out + block*BC6H_COMPRESSED_BLOCK_SIZE);
+    }
+}
@@ -101,6 +101,35 @@ extern "C" BC_ERROR CMP_DecodeBC6HBlock( BYTE *in, float  out[BC_BLOCK_PIXELS][M
 }
 
 
+//
+// Decode an array of blocks to half floats
+//
+//
+//
+extern "C" BC_ERROR CMP_DecodeBC6HBlocks( BYTE *in, DWORD blocksX, DWORD blocksY, BYTE *out, DWORD pitch, DWORD numThreads )
+{
+    if(!g_LibraryInitialized)
+    {
+        return BC_ERROR_LIBRARY_NOT_INITIALIZED;
+    }
+
+    if( !in || !out || (pitch < blocksX * 4 * BC6H_MAX_DIMENSION_BIG * sizeof(WORD)) )
+    {
+        return BC_ERROR_INVALID_PARAMETERS;
+    }
+
+    if( numThreads == 0 )
+    {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        numThreads = systemInfo.dwNumberOfProcessors;
+    }
+
+    g_Decoder.DecompressBlocksRGBA16F(in, blocksX * BC6H_COMPRESSED_BLOCK_SIZE, blocksX, blocksY, out, pitch, numThreads);
+    return BC_ERROR_NONE;
+}
+
+
 //
 // Destroys encoder object
 //
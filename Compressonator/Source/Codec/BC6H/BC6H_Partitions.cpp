@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 //
 
+#include <math.h>
 #include "bc6h_partitions.h"
 
 //
@@ -76,3 +77,143 @@ void    BC6H_Partition(
 }
 
 
+
+
+//
+// Fast ranking of the two region shapes
+//
+// The pixels of each region are fitted with a line through the region mean along its
+// principal axis, the squared distance of the pixels off that line estimates how well
+// the quantizer will do on the shape. The moments of region 0 are the block totals
+// less those of region 1.
+//
+
+// Squared distances off the principal axis of a region, given its scatter matrix
+static double BC6H_RegionLineError(double scatter[3][3])
+{
+    int     i,j,k,n;
+    double  v[3], w[3];
+    double  trace, lambda, norm;
+
+    trace = scatter[0][0] + scatter[1][1] + scatter[2][2];
+    if (trace <= 0.0)
+        return 0.0;
+
+    // Power iteration from the column with the largest variance
+    k = 0;
+    for (i=1; i<3; i++)
+        if (scatter[i][i] > scatter[k][k])
+            k = i;
+
+    for (i=0; i<3; i++)
+        v[i] = scatter[i][k];
+
+    for (n=0; n<4; n++)
+    {
+        norm = 0.0;
+        for (i=0; i<3; i++)
+        {
+            w[i] = 0.0;
+            for (j=0; j<3; j++)
+                w[i] += scatter[i][j] * v[j];
+            norm = max(norm, fabs(w[i]));
+        }
+        if (norm <= 0.0)
+            return 0.0;
+        for (i=0; i<3; i++)
+            v[i] = w[i] / norm;
+    }
+
+    // Rayleigh quotient
+    lambda = 0.0;
+    norm   = 0.0;
+    for (i=0; i<3; i++)
+    {
+        w[i] = 0.0;
+        for (j=0; j<3; j++)
+            w[i] += scatter[i][j] * v[j];
+        lambda += v[i] * w[i];
+        norm   += v[i] * v[i];
+    }
+    lambda /= norm;
+
+    return max(0.0, trace - lambda);
+}
+
+void    BC6H_EstimateShapeErrors(double in[][BC6H_MAX_DIMENSION_BIG],
+                                 double error[BC6H_MAX_PARTITIONS])
+{
+#ifdef USE_DBGTRACE
+    DbgTrace(());
+#endif
+    int     i,j,k,s;
+    double  total[3];
+    double  totalXX[3][3];
+
+    for (j=0; j<3; j++)
+    {
+        total[j] = 0.0;
+        for (k=0; k<3; k++)
+            totalXX[j][k] = 0.0;
+    }
+
+    for (i=0; i<BC6H_MAX_SUBSET_SIZE; i++)
+        for (j=0; j<3; j++)
+        {
+            total[j] += in[i][j];
+            for (k=j; k<3; k++)
+                totalXX[j][k] += in[i][j] * in[i][k];
+        }
+
+    for (s=0; s<BC6H_MAX_PARTITIONS; s++)
+    {
+        double  sum[2][3];
+        double  sumXX[2][3][3];
+        double  count[2];
+
+        count[1] = 0.0;
+        for (j=0; j<3; j++)
+        {
+            sum[1][j] = 0.0;
+            for (k=j; k<3; k++)
+                sumXX[1][j][k] = 0.0;
+        }
+
+        for (i=0; i<BC6H_MAX_SUBSET_SIZE; i++)
+        {
+            if (BC7_PARTITIONS[1][s][i])
+            {
+                count[1] += 1.0;
+                for (j=0; j<3; j++)
+                {
+                    sum[1][j] += in[i][j];
+                    for (k=j; k<3; k++)
+                        sumXX[1][j][k] += in[i][j] * in[i][k];
+                }
+            }
+        }
+
+        count[0] = BC6H_MAX_SUBSET_SIZE - count[1];
+        for (j=0; j<3; j++)
+        {
+            sum[0][j] = total[j] - sum[1][j];
+            for (k=j; k<3; k++)
+                sumXX[0][j][k] = totalXX[j][k] - sumXX[1][j][k];
+        }
+
+        error[s] = 0.0;
+        for (int region=0; region<2; region++)
+        {
+            // One or two pixels always lie on a line
+            if (count[region] < 2.5)
+                continue;
+
+            double  scatter[3][3];
+            for (j=0; j<3; j++)
+                for (k=j; k<3; k++)
+                    scatter[j][k] = scatter[k][j] = sumXX[region][j][k] - sum[region][j] * sum[region][k] / count[region];
+
+            error[s] += BC6H_RegionLineError(scatter);
+        }
+    }
+}
@@ -35,6 +35,11 @@
 #include "BC6H_Definitions.h"
 #include "process.h"
 
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif // USE_SSE
+
 
 #ifdef BC6H_COMPDEBUGGER
 #include "CompClient.h"
@@ -44,18 +49,33 @@ extern     CompViewerClient g_CompClient;
 //======================================================================================
 #define USE_MULTITHREADING  1
 
+bool g_bBC6HUseSSE2 = false;
+
+// Picks the kernels from the CPU features allowed by CMP_SetCPUFeatureMask
+static void SelectBC6HKernels(CMP_DWORD dwCPUFeatures)
+{
+#ifdef USE_SSE
+    g_bBC6HUseSSE2 = (dwCPUFeatures & CMP_CPU_FEATURE_SSE2) ? true : false;
+#else
+    UNREFERENCED_PARAMETER(dwCPUFeatures);
+#endif // USE_SSE
+}
+
+static const bool g_bBC6HKernelsRegistered = RegisterCPUDispatch(SelectBC6HKernels);
+
 
 struct BC6HEncodeThreadParam
 {
     BC6HBlockEncoder    *encoder;
-    float    in[BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG];
+    float    in[BC6H_BATCH_BLOCKS][BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG];
     BYTE    *out;
+    DWORD    numBlocks;
     volatile BOOL    run;
     volatile BOOL    exit;
 };
 
 //
-// Thread procedure for encoding a block
+// Thread procedure for encoding a batch of blocks
 //
 // The thread stays alive, and expects blocks to be pushed to it by a producer
 // process that signals it when new work is available. When the producer is finished
@@ -70,7 +90,7 @@ unsigned int    _stdcall BC6HThreadProcEncode(void* param)
     {
         if(tp->run == TRUE)
         {
-            tp->encoder->CompressBlock(tp->in, tp->out);
+            tp->encoder->CompressBlocks(tp->in, tp->out, tp->numBlocks);
             tp->run = FALSE;
         }
         Sleep(0);
@@ -80,6 +100,55 @@ unsigned int    _stdcall BC6HThreadProcEncode(void* param)
 }
 
 
+//
+// The encoder works on the 16 bit patterns of the half floats held in floats (see Rgba2Texture),
+// so half float sources are widened straight into the block to encode without a float buffer
+//
+static void BC6H_ReadBlockHalfBits(CCodecBuffer& bufferIn, CMP_DWORD x, CMP_DWORD y, float block[BC6H_MAX_SUBSET_SIZE][BC6H_MAX_DIMENSION_BIG])
+{
+    if((x + BLOCK_SIZE_4 <= bufferIn.GetWidth()) && (y + BLOCK_SIZE_4 <= bufferIn.GetHeight()))
+    {
+        const CMP_DWORD dwPitch = bufferIn.GetPitch();
+        const CMP_BYTE  *pData  = bufferIn.GetData() + y*dwPitch + x*BC6H_MAX_DIMENSION_BIG*sizeof(CMP_WORD);
+
+        for(int row=0; row < BLOCK_SIZE_4; row++)
+        {
+            const CMP_WORD *pRow = (const CMP_WORD *)(pData + row*dwPitch);
+            float (*pDest)[BC6H_MAX_DIMENSION_BIG] = &block[row*BLOCK_SIZE_4];
+#ifdef USE_SSE
+            if(g_bBC6HUseSSE2)
+            {
+                // Two texels per load, zero extended to 32 bits and converted
+                const __m128i zero = _mm_setzero_si128();
+                __m128i texels01 = _mm_loadu_si128((const __m128i *)pRow);
+                __m128i texels23 = _mm_loadu_si128((const __m128i *)(pRow + 2*BC6H_MAX_DIMENSION_BIG));
+                _mm_storeu_ps(pDest[0], _mm_cvtepi32_ps(_mm_unpacklo_epi16(texels01, zero)));
+                _mm_storeu_ps(pDest[1], _mm_cvtepi32_ps(_mm_unpackhi_epi16(texels01, zero)));
+                _mm_storeu_ps(pDest[2], _mm_cvtepi32_ps(_mm_unpacklo_epi16(texels23, zero)));
+                _mm_storeu_ps(pDest[3], _mm_cvtepi32_ps(_mm_unpackhi_epi16(texels23, zero)));
+            }
+            else
+#endif // USE_SSE
+            {
+                for(int i=0; i < BLOCK_SIZE_4*BC6H_MAX_DIMENSION_BIG; i++)
+                {
+                    pDest[i/BC6H_MAX_DIMENSION_BIG][i%BC6H_MAX_DIMENSION_BIG] = (float)pRow[i];
+                }
+            }
+        }
+    }
+    else
+    {
+        // Edge blocks are padded by the buffer
+        half hBlock[BLOCK_SIZE_4X4X4];
+        bufferIn.ReadBlockRGBA(x, y, BLOCK_SIZE_4, BLOCK_SIZE_4, hBlock);
+        for(int i=0; i < BLOCK_SIZE_4X4X4; i++)
+        {
+            block[i/BC6H_MAX_DIMENSION_BIG][i%BC6H_MAX_DIMENSION_BIG] = (float)hBlock[i].bits();
+        }
+    }
+}
+
 static BC6HEncodeThreadParam *g_BC6EncodeParameterStorage = NULL;
 int    g_block= 0; // Keep track of current encoder block!
 
@@ -100,6 +169,7 @@ CCodec_BC6H::CCodec_BC6H() : CCodec_DXTC(CT_BC6H)
     m_NumThreads            = 8;
     m_bIsSigned             = false;
     m_UsePatternRec         = false;
+    m_nCompressionSpeed     = CMP_Speed_Normal;
 
     // Internal setting
     m_LibraryInitialized    = false;
@@ -392,8 +462,9 @@ CodecError CCodec_BC6H::CInitializeBC6HLibrary()
 }
 
 
-CodecError CCodec_BC6H::CEncodeBC6HBlock(float  in[BC6H_BLOCK_PIXELS][BC6H_MAX_DIMENSION_BIG],
-                                         BYTE  *out)
+CodecError CCodec_BC6H::CEncodeBC6HBlocks(float  in[][BC6H_BLOCK_PIXELS][BC6H_MAX_DIMENSION_BIG],
+                                          DWORD  numBlocks,
+                                          BYTE  *out)
 {
 if (m_Use_MultiThreading)
 {
@@ -430,10 +501,11 @@ if (m_Use_MultiThreading)
     // Copy the input data into the thread storage
     memcpy(g_BC6EncodeParameterStorage[threadIndex].in,
            in,
-           BC6H_MAX_SUBSET_SIZE * BC6H_MAX_DIMENSION_BIG * sizeof(float));
+           numBlocks * BC6H_MAX_SUBSET_SIZE * BC6H_MAX_DIMENSION_BIG * sizeof(float));
 
     // Set the output pointer for the thread to the provided location
     g_BC6EncodeParameterStorage[threadIndex].out = out;
+    g_BC6EncodeParameterStorage[threadIndex].numBlocks = numBlocks;
 
     // Tell the thread to start working
     g_BC6EncodeParameterStorage[threadIndex].run = TRUE;
@@ -441,10 +513,11 @@ if (m_Use_MultiThreading)
 else 
 {
         // Copy the input data into the thread storage
-        memcpy(g_BC6EncodeParameterStorage[0].in, in, BC6H_MAX_SUBSET_SIZE * BC6H_MAX_DIMENSION_BIG * sizeof(float));
+        memcpy(g_BC6EncodeParameterStorage[0].in, in, numBlocks * BC6H_MAX_SUBSET_SIZE * BC6H_MAX_DIMENSION_BIG * sizeof(float));
         // Set the output pointer for the thread to write
         g_BC6EncodeParameterStorage[0].out = out;
-        m_encoder[0]->CompressBlock(g_BC6EncodeParameterStorage[0].in,g_BC6EncodeParameterStorage[0].out);
+        g_BC6EncodeParameterStorage[0].numBlocks = numBlocks;
+        m_encoder[0]->CompressBlocks(g_BC6EncodeParameterStorage[0].in,g_BC6EncodeParameterStorage[0].out,numBlocks);
 }
     return CE_OK;
 }
@@ -489,6 +562,12 @@ CodecError CCodec_BC6H::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut
     if (err != CE_OK)
         return err;
 
+    // The encoders are idle between calls to Compress
+    for(int i=0; i < m_NumEncodingThreads; i++)
+    {
+        m_encoder[i]->SetCompressionSpeed(m_nCompressionSpeed);
+    }
+
 #ifdef BC6H_COMPDEBUGGER
     CompViewerClient    g_CompClient;
     if (g_CompClient.connect())
@@ -526,6 +605,14 @@ CodecError CCodec_BC6H::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut
 
     DWORD block = 0;
 
+    // Blocks are handed to the encoders in batches, the output of consecutive
+    // blocks is contiguous so a batch may span rows
+    float  blocksToEncode[BC6H_BATCH_BLOCKS][BLOCK_SIZE_4X4][CHANNEL_SIZE_ARGB];
+    DWORD  batchBlocks = 0;
+    DWORD  batchStart  = 0;
+
+    const bool bHalfSource = (bufferIn.GetBufferType() == CBT_RGBA16F);
+
 #ifdef _SAVE_AS_BC6
     FILE *bc6file = fopen("Test.bc6", "wb");
 #endif
@@ -535,27 +622,35 @@ CodecError CCodec_BC6H::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut
 
         for(CMP_DWORD i = 0; i < dwBlocksX; i++)
         {
-            float blockToEncode[BLOCK_SIZE_4X4][CHANNEL_SIZE_ARGB];
-            CMP_FLOAT srcBlock[BLOCK_SIZE_4X4X4];
+            float (*blockToEncode)[CHANNEL_SIZE_ARGB] = blocksToEncode[batchBlocks];
+
+            if(bHalfSource)
+            {
+                BC6H_ReadBlockHalfBits(bufferIn, i*4, j*4, blockToEncode);
+            }
+            else
+            {
+                CMP_FLOAT srcBlock[BLOCK_SIZE_4X4X4];
 
-            memset(srcBlock,0,sizeof(srcBlock));
-            bufferIn.ReadBlockRGBA(i*4, j*4, 4, 4, srcBlock);
+                memset(srcBlock,0,sizeof(srcBlock));
+                bufferIn.ReadBlockRGBA(i*4, j*4, 4, 4, srcBlock);
 
-            #ifdef _BC6H_COMPDEBUGGER
-            g_CompClient.SendData(1,sizeof(srcBlock),srcBlock);
-            #endif
+                #ifdef _BC6H_COMPDEBUGGER
+                g_CompClient.SendData(1,sizeof(srcBlock),srcBlock);
+                #endif
 
-            // Create the block for encoding
-            srcIndex = 0;
-            for(row=0; row < BLOCK_SIZE_4; row++)
-            {
-                for(col=0; col < BLOCK_SIZE_4; col++)
+                // Create the block for encoding
+                srcIndex = 0;
+                for(row=0; row < BLOCK_SIZE_4; row++)
                 {
-                    blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_RED]        = (float)srcBlock[srcIndex];
-                    blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_GREEN]    = (float)srcBlock[srcIndex+1];
-                    blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_BLUE]        = (float)srcBlock[srcIndex+2];
-                    blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_ALPHA]    = (float)srcBlock[srcIndex+3];
-                    srcIndex+=4;
+                    for(col=0; col < BLOCK_SIZE_4; col++)
+                    {
+                        blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_RED]        = (float)srcBlock[srcIndex];
+                        blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_GREEN]    = (float)srcBlock[srcIndex+1];
+                        blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_BLUE]        = (float)srcBlock[srcIndex+2];
+                        blockToEncode[row*BLOCK_SIZE_4+col][BC6H_COMP_ALPHA]    = (float)srcBlock[srcIndex+3];
+                        srcIndex+=4;
+                    }
                 }
             }
 
@@ -567,7 +662,16 @@ CodecError CCodec_BC6H::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut
             } data;
 
             memset(data.in,0,sizeof(data));
-            CEncodeBC6HBlock(blockToEncode,pOutBuffer+block);
+            if(batchBlocks == 0)
+            {
+                batchStart = block;
+            }
+
+            if(++batchBlocks == BC6H_BATCH_BLOCKS)
+            {
+                CEncodeBC6HBlocks(blocksToEncode,batchBlocks,pOutBuffer+batchStart);
+                batchBlocks = 0;
+            }
             
 #ifdef _SAVE_AS_BC6
             if (fwrite(pOutBuffer+block, sizeof(char), 16, bc6file) != 16)
@@ -612,6 +716,11 @@ CodecError CCodec_BC6H::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut
     }
 
 
+    if(batchBlocks)
+    {
+        CEncodeBC6HBlocks(blocksToEncode,batchBlocks,pOutBuffer+batchStart);
+    }
+
     #ifdef _SAVE_AS_BC6
     if (fclose(bc6file)) throw "Close failed on .bc6 file";
     #endif
@@ -650,6 +759,10 @@ CodecError CCodec_BC6H::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferO
     const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
     const CMP_DWORD dwBlocksXY = dwBlocksX*dwBlocksY;
 
+    // Half float output is decoded directly, other buffer types go through float
+    if (bufferOut.GetBufferType() == CBT_RGBA16F)
+        return DecompressRGBA16F(bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
+
     for(CMP_DWORD j = 0; j < dwBlocksY; j++)
     {
         for(CMP_DWORD i = 0; i < dwBlocksX; i++)
@@ -711,14 +824,71 @@ CodecError CCodec_BC6H::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferO
     return CE_OK;
 }
 
-// Not implemented
-CodecError CCodec_BC6H::Compress_Fast(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
+//
+// Full blocks are decoded straight into the output buffer, in bands of block rows shared
+// between the decoding threads. Blocks on the right and bottom edges of images that are
+// not a multiple of 4 are decoded to a local block and clipped by WriteBlockRGBA
+//
+CodecError CCodec_BC6H::DecompressRGBA16F(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
 {
+    const CMP_DWORD dwBlocksX = ((bufferIn.GetWidth() + 3) >> 2);
+    const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
+    const CMP_DWORD dwFullBlocksX = bufferOut.GetWidth() >> 2;
+    const CMP_DWORD dwFullBlocksY = bufferOut.GetHeight() >> 2;
+    const CMP_DWORD dwNumThreads = (m_Use_MultiThreading && m_NumThreads > 1) ? m_NumThreads : 1;
+    const CMP_DWORD dwBandRows = dwNumThreads * 4;
+
+    CMP_BYTE *pIn  = bufferIn.GetData();
+    CMP_BYTE *pOut = bufferOut.GetData();
+    const CMP_DWORD dwInPitch  = bufferIn.GetPitch();
+    const CMP_DWORD dwOutPitch = bufferOut.GetPitch();
+
+    for(CMP_DWORD j = 0; j < dwFullBlocksY; j += dwBandRows)
+    {
+        CMP_DWORD dwRows = min(dwBandRows, dwFullBlocksY - j);
+        m_decoder->DecompressBlocksRGBA16F(pIn + j*dwInPitch, dwInPitch, dwFullBlocksX, dwRows,
+                                           pOut + j*4*dwOutPitch, dwOutPitch, dwNumThreads);
+
+        if (pFeedbackProc)
+        {
+            float fProgress = 100.f * (j + dwRows) / dwBlocksY;
+            if (pFeedbackProc(fProgress, pUser1, pUser2))
+            {
+                return CE_Aborted;
+            }
+        }
+    }
+
+    for(CMP_DWORD j = 0; j < dwBlocksY; j++)
+    {
+        for(CMP_DWORD i = (j < dwFullBlocksY) ? dwFullBlocksX : 0; i < dwBlocksX; i++)
+        {
+            union BBLOCKS
+            {
+                CMP_DWORD    compressedBlock[4];
+                BYTE            in[16];
+            } CompData;
+
+            half destBlock[BLOCK_SIZE_4X4X4];
+
+            bufferIn.ReadBlock(i*4, j*4, CompData.compressedBlock, 4);
+            m_decoder->DecompressBlockRGBA16F((BYTE *) destBlock, BLOCK_SIZE_4 * BC6H_MAX_DIMENSION_BIG * sizeof(half), CompData.in);
+            bufferOut.WriteBlockRGBA(i*4, j*4, 4, 4, destBlock);
+        }
+    }
+
     return CE_OK;
 }
 
-// Not implemented
+// The reduced searches are selected in the block encoders, see BC6HBlockEncoder::SetCompressionSpeed
+CodecError CCodec_BC6H::Compress_Fast(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
+{
+    m_nCompressionSpeed = CMP_Speed_Fast;
+    return Compress(bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
+}
+
 CodecError CCodec_BC6H::Compress_SuperFast(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
 {
-   return CE_OK;
+    m_nCompressionSpeed = CMP_Speed_SuperFast;
+    return Compress(bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
 }
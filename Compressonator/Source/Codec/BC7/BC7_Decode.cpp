@@ -28,8 +28,14 @@
 #include "BC7_Definitions.h"
 #include "BC7_Partitions.h"
 #include "BC7_Decode.h"
+#include <string.h>
 #include "BC7_Utils.h"
 
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif // USE_SSE
+
 #ifdef USE_BC7_TESTBLOCK
 // This is a block that I dumped out of Microsoft's compressor
 // as a sanity check for the decoder
@@ -360,3 +366,243 @@ void BC7BlockDecoder::DecompressBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION
         }
     }
 }
+
+//
+// Integer decoder
+//
+// The block is read as two 64 bit words and the fields are extracted with shifts and masks.
+// Ramps use the 6 bit BC7 interpolation weights, (e0*(64-w) + e1*w + 32) >> 6, which gives
+// the same texels as the reference decoder above.
+//
+
+typedef unsigned long long BC7_QWORD;
+
+static const WORD BC7_INTEGER_WEIGHTS[5][1<<MAX_INDEX_BITS] =
+{
+    {0},                                                                // 0 bit index
+    {0, 64},                                                            // 1 bit index
+    {0, 21, 43, 64},                                                    // 2 bit index
+    {0, 9, 18, 27, 37, 46, 55, 64},                                     // 3 bit index
+    {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64}       // 4 bit index
+};
+
+static inline DWORD GetBits(BC7_QWORD block[2], DWORD &bitPosition, DWORD count)
+{
+    DWORD   bits;
+
+    if(bitPosition >= 64)
+        bits = (DWORD)(block[1] >> (bitPosition - 64));
+    else if(bitPosition + count <= 64)
+        bits = (DWORD)(block[0] >> bitPosition);
+    else
+        bits = (DWORD)((block[0] >> bitPosition) | (block[1] << (64 - bitPosition)));
+
+    bitPosition += count;
+    return bits & ((1 << count) - 1);
+}
+
+void BC7BlockDecoder::DecompressBlockRGBA8(BYTE   *out,
+                                           DWORD  dwPitch,
+                                           BYTE   in[COMPRESSED_BLOCK_SIZE])
+{
+#ifdef USE_DBGTRACE
+    DbgTrace(());
+#endif
+    BC7_QWORD   block[2];
+    DWORD       i, subset, ep, component;
+    DWORD       blockMode = 0;
+
+    memcpy(block, in, COMPRESSED_BLOCK_SIZE);
+
+    // The mode is unary coded from the LSB
+    while((blockMode < NUM_BLOCK_TYPES) && !((in[0] >> blockMode) & 1))
+    {
+        blockMode++;
+    }
+
+    if(blockMode >= NUM_BLOCK_TYPES)
+    {
+        // Reserved mode, decodes to transparent black
+        for(i=0; i<BLOCK_WIDTH; i++)
+        {
+            memset(out + i*dwPitch, 0, BLOCK_WIDTH*MAX_DIMENSION_BIG);
+        }
+        return;
+    }
+
+    const BTI   &mode = bti[blockMode];
+    DWORD       bitPosition = blockMode + 1;
+
+    DWORD   rotation  = GetBits(block, bitPosition, mode.rotationBits);
+    DWORD   indexSwap = GetBits(block, bitPosition, mode.indexModeBits);
+    DWORD   partition = GetBits(block, bitPosition, mode.partitionBits);
+
+    DWORD   componentBits[MAX_DIMENSION_BIG];
+    componentBits[COMP_RED]   =
+    componentBits[COMP_GREEN] =
+    componentBits[COMP_BLUE]  = mode.vectorBits / (mode.encodingType == COMBINED_ALPHA ? 4 : 3);
+    componentBits[COMP_ALPHA] = (mode.encodingType == COMBINED_ALPHA) ? componentBits[COMP_RED] :
+                                (mode.encodingType == SEPARATE_ALPHA) ? mode.scalarBits : 0;
+
+    // Endpoints are stored in the following order RRRR GGGG BBBB (AAAA) (PPPP)
+    DWORD   endpoint[MAX_SUBSETS][2][MAX_DIMENSION_BIG];
+    for(component=0; component < MAX_DIMENSION_BIG; component++)
+    {
+        for(subset=0; subset<mode.subsetCount; subset++)
+        {
+            for(ep=0; ep<2; ep++)
+            {
+                endpoint[subset][ep][component] = GetBits(block, bitPosition, componentBits[component]);
+            }
+        }
+    }
+
+    if(mode.pBitType != NO_PBIT)
+    {
+        for(subset=0; subset<mode.subsetCount; subset++)
+        {
+            DWORD   pBit[2];
+            pBit[0] = GetBits(block, bitPosition, 1);
+            pBit[1] = (mode.pBitType == TWO_PBIT) ? GetBits(block, bitPosition, 1) : pBit[0];
+
+            for(component=0; component < MAX_DIMENSION_BIG; component++)
+            {
+                if(componentBits[component])
+                {
+                    endpoint[subset][0][component] = (endpoint[subset][0][component] << 1) | pBit[0];
+                    endpoint[subset][1][component] = (endpoint[subset][1][component] << 1) | pBit[1];
+                }
+            }
+        }
+
+        for(component=0; component < MAX_DIMENSION_BIG; component++)
+        {
+            if(componentBits[component])
+            {
+                componentBits[component]++;
+            }
+        }
+    }
+
+    // Component rotation is resolved up front by swizzling the endpoints and weights,
+    // output channel c is interpolated from endpoint component swizzle[c]
+    DWORD   swizzle[MAX_DIMENSION_BIG] = {COMP_RED, COMP_GREEN, COMP_BLUE, COMP_ALPHA};
+    if(rotation)
+    {
+        swizzle[rotation-1] = COMP_ALPHA;
+        swizzle[COMP_ALPHA] = rotation-1;
+    }
+
+    // Expand each endpoint component to 8 bits by replicating the high bits,
+    // blocks without alpha bits decode with alpha = 255
+    WORD    expanded[MAX_SUBSETS][2][MAX_DIMENSION_BIG];
+    for(subset=0; subset<mode.subsetCount; subset++)
+    {
+        for(ep=0; ep<2; ep++)
+        {
+            for(component=0; component < MAX_DIMENSION_BIG; component++)
+            {
+                DWORD   bits = componentBits[swizzle[component]];
+                DWORD   value = 255;
+                if(bits)
+                {
+                    value = endpoint[subset][ep][swizzle[component]] << (8 - bits);
+                    value |= value >> bits;
+                }
+                expanded[subset][ep][component] = (WORD)value;
+            }
+        }
+    }
+
+    // Colour and alpha weights for each texel
+    WORD    weight[MAX_SUBSET_SIZE][2];
+    DWORD   texelSubset[MAX_SUBSET_SIZE];
+
+    if(mode.encodingType == SEPARATE_ALPHA)
+    {
+        DWORD   index[2][MAX_SUBSET_SIZE];
+        for(DWORD set=0; set<2; set++)
+        {
+            // The anchor index of each set has an implicit MSB of zero
+            for(i=0; i<MAX_SUBSET_SIZE; i++)
+            {
+                index[set][i] = GetBits(block, bitPosition, mode.indexBits[set] - (i == 0 ? 1 : 0));
+            }
+        }
+
+        const WORD  *colourWeights = BC7_INTEGER_WEIGHTS[mode.indexBits[indexSwap]];
+        const WORD  *alphaWeights  = BC7_INTEGER_WEIGHTS[mode.indexBits[indexSwap^1]];
+        for(i=0; i<MAX_SUBSET_SIZE; i++)
+        {
+            weight[i][0] = colourWeights[index[indexSwap][i]];
+            weight[i][1] = alphaWeights[index[indexSwap^1][i]];
+            texelSubset[i] = 0;
+        }
+    }
+    else
+    {
+        DWORD   *partitionTable = BC7_PARTITIONS[mode.subsetCount-1][partition];
+        DWORD   fixup[MAX_SUBSETS] = {0,
+                                      BC7_FIXUPINDICES[mode.subsetCount-1][partition][1],
+                                      BC7_FIXUPINDICES[mode.subsetCount-1][partition][2]};
+
+        const WORD  *weights = BC7_INTEGER_WEIGHTS[mode.indexBits[0]];
+        for(i=0; i<MAX_SUBSET_SIZE; i++)
+        {
+            DWORD   p = partitionTable[i];
+            DWORD   index = GetBits(block, bitPosition, mode.indexBits[0] - (i == fixup[p] ? 1 : 0));
+            weight[i][0] = weight[i][1] = weights[index];
+            texelSubset[i] = p;
+        }
+    }
+
+    // Per texel endpoints and weights laid out RGBA to match the output
+    WORD    texelEndpoint[2][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    WORD    texelWeight[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    for(i=0; i<MAX_SUBSET_SIZE; i++)
+    {
+        memcpy(texelEndpoint[0][i], expanded[texelSubset[i]][0], sizeof(texelEndpoint[0][i]));
+        memcpy(texelEndpoint[1][i], expanded[texelSubset[i]][1], sizeof(texelEndpoint[1][i]));
+        for(component=0; component < MAX_DIMENSION_BIG; component++)
+        {
+            texelWeight[i][component] = weight[i][swizzle[component] == COMP_ALPHA ? 1 : 0];
+        }
+    }
+
+#ifdef USE_SSE
+    if(g_bBC7UseSSE2)
+    {
+        // Two texels per register, one row of four texels per store
+        const __m128i   rounding  = _mm_set1_epi16(32);
+        const __m128i   fullScale = _mm_set1_epi16(64);
+        for(i=0; i<MAX_SUBSET_SIZE; i+=BLOCK_WIDTH)
+        {
+            __m128i     texels[2];
+            for(DWORD pair=0; pair<2; pair++)
+            {
+                __m128i e0 = _mm_loadu_si128((__m128i*)texelEndpoint[0][i + pair*2]);
+                __m128i e1 = _mm_loadu_si128((__m128i*)texelEndpoint[1][i + pair*2]);
+                __m128i w  = _mm_loadu_si128((__m128i*)texelWeight[i + pair*2]);
+
+                __m128i sum = _mm_add_epi16(_mm_mullo_epi16(e0, _mm_sub_epi16(fullScale, w)),
+                                            _mm_mullo_epi16(e1, w));
+                texels[pair] = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 6);
+            }
+            _mm_storeu_si128((__m128i*)(out + (i/BLOCK_WIDTH)*dwPitch), _mm_packus_epi16(texels[0], texels[1]));
+        }
+    }
+    else
+#endif // USE_SSE
+    {
+        for(i=0; i<MAX_SUBSET_SIZE; i++)
+        {
+            BYTE    *texel = out + (i/BLOCK_WIDTH)*dwPitch + (i%BLOCK_WIDTH)*MAX_DIMENSION_BIG;
+            for(component=0; component < MAX_DIMENSION_BIG; component++)
+            {
+                DWORD   w = texelWeight[i][component];
+                texel[component] = (BYTE)((texelEndpoint[0][i][component] * (64 - w) +
+                                           texelEndpoint[1][i][component] * w + 32) >> 6);
+            }
+        }
+    }
+}
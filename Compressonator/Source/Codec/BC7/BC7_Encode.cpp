@@ -29,6 +29,7 @@
 #include <float.h>
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 #include "Common.h"
 #include "BC7_Definitions.h"
 #include "BC7_Partitions.h"
@@ -354,7 +355,8 @@ void BC7BlockEncoder::EncodeSingleIndexBlock(DWORD blockMode,
 
 double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                                                  BYTE   out[COMPRESSED_BLOCK_SIZE],
-                                                 DWORD  blockMode)
+                                                 DWORD  blockMode,
+                                                 double *estimatedError)
 {
 #ifdef USE_DBGTRACE
     DbgTrace(());
@@ -374,14 +376,43 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
 
     DWORD numPartitionModes = 1 << bti[blockMode].partitionBits;
     DWORD partitionsToTry = numPartitionModes;
+    DWORD partitionOrder[MAX_PARTITIONS];
 
-    // Linearly reduce the number of partitions to try as the quality falls below a threshold
-    if(m_quality < g_qFAST_THRESHOLD) 
+    for(i=0; i < numPartitionModes; i++)
     {
-        partitionsToTry = (DWORD)floor((double)(partitionsToTry * m_partitionSearchSize) + 0.5);
-        partitionsToTry = min(numPartitionModes, max(1, partitionsToTry));
+        partitionOrder[i] = i;
     }
 
+    // Below the exhaustive quality level rank all the partitions with a cheap
+    // principal axis estimate and only quantize the best m_partitionCandidates
+    if(m_partitionCandidates < numPartitionModes)
+    {
+        double  blockEstimatedError[MAX_PARTITIONS];
+        int     rankedPartitions[MAX_PARTITIONS];
+
+        if(!estimatedError)
+        {
+            EstimatePartitionErrors(in,
+                                    blockMode,
+                                    dimension,
+                                    numPartitionModes,
+                                    blockEstimatedError);
+            estimatedError = blockEstimatedError;
+        }
+
+        sortProjection(estimatedError,
+                       rankedPartitions,
+                       numPartitionModes);
+
+        for(i=0; i < numPartitionModes; i++)
+        {
+            partitionOrder[i] = rankedPartitions[i];
+        }
+
+        partitionsToTry = max(1, m_partitionCandidates);
+    }
+
+    DWORD   candidate;
     DWORD   blockPartition;
     double  partition[MAX_SUBSETS][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
     DWORD   entryCount[MAX_SUBSETS];
@@ -399,12 +430,14 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
 #endif
 
 
-    // Loop over the available partitions for the block mode and quantize them 
+    // Loop over the candidate partitions for the block mode and quantize them 
     // to figure out the best candidates for further refinement
-    for(blockPartition = 0;
-        blockPartition < partitionsToTry;
-        blockPartition++)
+    for(candidate = 0;
+        candidate < partitionsToTry;
+        candidate++)
     {
+        blockPartition = partitionOrder[candidate];
+
         Partition(blockPartition,
                   in,
                   partition,
@@ -525,12 +558,21 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
                 // Store off the indices for later
                 for(DWORD idx=0; idx < entryCount[subset]; idx++)
                 {
-                    m_storedIndices[blockPartition][subset][idx] = indices[subset][idx];
+                    m_storedIndices[candidate][subset][idx] = indices[subset][idx];
                 }
             }
         }
 
-        m_storedError[blockPartition] = error;
+        m_storedError[candidate] = error;
+        m_workDone++;
+
+        // In adaptive mode a candidate that already meets the error target leaves nothing
+        // to gain from quantizing the lower ranked partitions, shaking can only improve it
+        if((m_errorTarget > 0) && (error <= m_errorThreshold))
+        {
+            partitionsToTry = candidate + 1;
+            break;
+        }
     }
 
     // Sort the results
@@ -604,7 +646,8 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
     {
         double error = 0;
 
-        blockPartition = m_sortedModes[i];
+        candidate      = m_sortedModes[i];
+        blockPartition = partitionOrder[candidate];
 
         Partition(blockPartition,
                   in,
@@ -624,7 +667,7 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
                 {
                     error += ep_shaker_2_d(partition[subset],
                                           entryCount[subset],
-                                          m_storedIndices[blockPartition][subset],
+                                          m_storedIndices[candidate][subset],
                                           outB,
                                           epo_code[subset],
                                           shakeSize,
@@ -643,7 +686,7 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
 
                     for(k=0; k < entryCount[subset]; k++)
                     {
-                        tempIndices[k] = m_storedIndices[blockPartition][subset][k];
+                        tempIndices[k] = m_storedIndices[candidate][subset][k];
                     }
 
                     tempError[0] = ep_shaker_d(partition[subset],
@@ -658,7 +701,7 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
 
                     tempError[1] = ep_shaker_2_d(partition[subset],
                                                  entryCount[subset],
-                                                 m_storedIndices[blockPartition][subset],
+                                                 m_storedIndices[candidate][subset],
                                                  outB,
                                                  epo_code[subset],
                                                  shakeSize,
@@ -686,7 +729,7 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
                         // Copy the results into the expected location
                         for(k=0; k<entryCount[subset]; k++)
                         {
-                            m_storedIndices[blockPartition][subset][k] = tempIndices[k];
+                            m_storedIndices[candidate][subset][k] = tempIndices[k];
                         }
 
                         for(k=0; k < MAX_DIMENSION_BIG; k++)
@@ -701,6 +744,8 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
             }
         }
 
+        m_workDone++;
+
 
         if(error < bestError)
         {
@@ -720,7 +765,7 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
 
                     for(n=0; n < entryCount[subset]; n++)
                     {
-                        bestIndices[subset][n] = m_storedIndices[blockPartition][subset][n];
+                        bestIndices[subset][n] = m_storedIndices[candidate][subset][n];
                     }
                 }
             }
@@ -728,7 +773,9 @@ double BC7BlockEncoder::CompressSingleIndexBlock(double in[MAX_SUBSET_SIZE][MAX_
             bestError = error;
         }
 
-        // Early out if we  found we can compress with error below the quality threshold
+        // Early out if we  found we can compress with error below the quality threshold,
+        // in adaptive mode the threshold is the error target and the remaining candidates
+        // are not shaken once a block meets it
         if (m_errorThreshold > 0)
         {
             if(bestError <= m_errorThreshold)
@@ -1299,6 +1346,14 @@ double BC7BlockEncoder::CompressDualIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DI
                     bestQuantizerError = quantizerError;
                 }
 
+                m_workDone++;
+            }
+            m_workDone++;
+
+            // Adaptive mode stops at the first rotation and index selection that meets the error target
+            if((m_errorTarget > 0) && (bestOverallError <= m_errorThreshold))
+            {
+                return bestOverallError;
             }
         } // B
     } // A
@@ -1308,35 +1363,16 @@ double BC7BlockEncoder::CompressDualIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DI
 
 
 //
-// This routine compresses a block and returns the RMS error
-//
+// Block statistics and the block modes that are valid for the block
 //
 //
 //
-#include <stdio.h>
-
-double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
-                                      BYTE   out[COMPRESSED_BLOCK_SIZE])
+DWORD BC7BlockEncoder::BlockModeMask(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG])
 {
-#ifdef USE_DBGTRACE
-    DbgTrace(());
-#endif
     DWORD   i, j;
     BOOL    blockNeedsAlpha        = FALSE;
     BOOL    blockAlphaZeroOne      = FALSE;
     DWORD   validModeMask          = m_validModeMask;
-    BOOL    encodedBlock           = FALSE;
-
-#ifdef    BC7_DEBUG_TO_RESULTS_TXT
-    fp = fopen("debugdata.txt","w");
-    if (fp)
-    {
-        fprintf(fp,"Data INPUT\n");
-        double  data[16][4];
-        memcpy(data,in,sizeof(data));
-        for (int row=0; row<16; row++)
-            fprintf(fp,"%4.0f, %4.0f, %4.0f\n", data[row][0],data[row][1],data[row][2]);
-#endif
 
     for(i=0;i<MAX_DIMENSION_BIG;i++)
     {
@@ -1448,6 +1484,79 @@ double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_B
 
     assert(validModeMask != 0);
 
+    return validModeMask;
+}
+
+
+double BC7BlockEncoder::CompressBlockMode(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+                                          BYTE   out[COMPRESSED_BLOCK_SIZE],
+                                          DWORD  blockMode,
+                                          double *estimatedError)
+{
+    // Setup mode parameters for this block
+    BlockSetup(blockMode);
+    
+    if(bti[blockMode].encodingType != SEPARATE_ALPHA)
+    {
+   
+        #ifdef    BC7_DEBUG_TO_RESULTS_TXT
+        fprintf(fp,"=================== CompressSingleIndexBlock ======================\n");
+        #endif
+        return CompressSingleIndexBlock(in, out, blockMode, estimatedError);
+
+    }
+    else
+    {
+        
+        #ifdef    BC7_DEBUG_TO_RESULTS_TXT
+        fprintf(fp,"==================  CompressDualIndexBlock =======================\n");
+        #endif
+   
+        return CompressDualIndexBlock(in, out, blockMode);
+    }
+}
+
+
+// We change the order in which we visit the block modes to try to maximize the chance
+// that we manage to early out as quickly as possible.
+// This is a significant performance optimization for the lower quality modes where the
+// exit threshold is higher, and also tends to improve quality (as the generally higher quality
+// modes are now enumerated earlier, so the first encoding that passes the threshold will
+// tend to pass by a greater margin than if we used a dumb ordering, and thus overall error will
+// be improved)
+static const DWORD  blockModeOrder[NUM_BLOCK_TYPES] = {4, 6, 3, 1, 0, 2, 7, 5};
+
+
+//
+// This routine compresses a block and returns the RMS error
+//
+//
+//
+//
+#include <stdio.h>
+
+double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+                                      BYTE   out[COMPRESSED_BLOCK_SIZE])
+{
+#ifdef USE_DBGTRACE
+    DbgTrace(());
+#endif
+    DWORD   i;
+    BOOL    encodedBlock           = FALSE;
+
+#ifdef    BC7_DEBUG_TO_RESULTS_TXT
+    fp = fopen("debugdata.txt","w");
+    if (fp)
+    {
+        fprintf(fp,"Data INPUT\n");
+        double  data[16][4];
+        memcpy(data,in,sizeof(data));
+        for (int row=0; row<16; row++)
+            fprintf(fp,"%4.0f, %4.0f, %4.0f\n", data[row][0],data[row][1],data[row][2]);
+#endif
+
+    DWORD   validModeMask = BlockModeMask(in);
+
     // Try all the legal block modes that we flagged
 
     BYTE    temporaryOutputBlock[COMPRESSED_BLOCK_SIZE];
@@ -1455,15 +1564,6 @@ double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_B
     double thisError;
     DWORD bestblockMode=99;
 
-    // We change the order in which we visit the block modes to try to maximize the chance
-    // that we manage to early out as quickly as possible.
-    // This is a significant performance optimization for the lower quality modes where the
-    // exit threshold is higher, and also tends to improve quality (as the generally higher quality
-    // modes are now enumerated earlier, so the first encoding that passes the threshold will
-    // tend to pass by a greater margin than if we used a dumb ordering, and thus overall error will
-    // be improved)
-    DWORD   blockModeOrder[NUM_BLOCK_TYPES] = {4, 6, 3, 1, 0, 2, 7, 5};
-
     for(DWORD j1=0; j1 < NUM_BLOCK_TYPES; j1++)
     {
         DWORD blockMode = blockModeOrder[j1];
@@ -1474,27 +1574,7 @@ double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_B
             continue;
         }
 
-        // Setup mode parameters for this block
-        BlockSetup(blockMode);
-        
-        if(bti[blockMode].encodingType != SEPARATE_ALPHA)
-        {
-       
-            #ifdef    BC7_DEBUG_TO_RESULTS_TXT
-            fprintf(fp,"=================== CompressSingleIndexBlock ======================\n");
-            #endif
-            thisError = CompressSingleIndexBlock(in, temporaryOutputBlock, blockMode);
-
-        }
-        else
-        {
-            
-            #ifdef    BC7_DEBUG_TO_RESULTS_TXT
-            fprintf(fp,"==================  CompressDualIndexBlock =======================\n");
-            #endif
-       
-            thisError = CompressDualIndexBlock(in, temporaryOutputBlock, blockMode);
-        }
+        thisError = CompressBlockMode(in, temporaryOutputBlock, blockMode, NULL);
 
         // If this compression did better than all previous attempts then copy the result
         // to the output block
@@ -1520,6 +1600,8 @@ double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_B
         }
     }
 
+    m_blocksEncoded++;
+
     if(bestError < m_smallestError)
     {
         m_smallestError = bestError;
@@ -1549,4 +1631,177 @@ double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_B
 }
 
 
+//
+// Compresses a batch of blocks
+//
+// The blocks visit the block modes in the same order as CompressBlock, the blocks that are still
+// searching are kept in a lane mask. For the shared index modes the partition estimates of all the
+// searching blocks are computed together in SIMD lanes before each block is quantized in turn.
+// A block leaves the mask as soon as its best error is under the threshold and the batch finishes
+// when the mask is empty.
+//
+void BC7BlockEncoder::CompressBlocks(double in[][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+                                     BYTE   *out,
+                                     DWORD  numBlocks)
+{
+#ifdef USE_DBGTRACE
+    DbgTrace(());
+#endif
+    DWORD   i, j, b;
+    DWORD   activeBlocks  = 0;
+    DWORD   integerBlocks = 0;
+
+    // Per block state that CompressBlock keeps in the encoder while it runs
+    struct
+    {
+        double  blockMin[MAX_DIMENSION_BIG];
+        double  blockMax[MAX_DIMENSION_BIG];
+        double  blockRange[MAX_DIMENSION_BIG];
+        double  blockMaxRange;
+        DWORD   validModeMask;
+        double  bestError;
+    } block[BC7_BATCH_BLOCKS];
+
+    // Blocks in structure of arrays layout for the partition estimator
+    float   soa[BC7_BATCH_BLOCKS/BC7_ESTIMATE_LANES][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG][BC7_ESTIMATE_LANES];
+    double  estimatedError[BC7_BATCH_BLOCKS][MAX_PARTITIONS];
+
+    numBlocks = min(numBlocks, BC7_BATCH_BLOCKS);
+    memset(soa, 0, sizeof(soa));
+
+    for(b=0; b < numBlocks; b++)
+    {
+        block[b].validModeMask = BlockModeMask(in[b]);
+        block[b].bestError     = DBL_MAX;
+        block[b].blockMaxRange = m_blockMaxRange;
+        memcpy(block[b].blockMin,   m_blockMin,   sizeof(m_blockMin));
+        memcpy(block[b].blockMax,   m_blockMax,   sizeof(m_blockMax));
+        memcpy(block[b].blockRange, m_blockRange, sizeof(m_blockRange));
+        activeBlocks |= 1 << b;
+
+        // Lanes are only bit exact with the single block estimator for 8-bit integer texels,
+        // anything else keeps using the single block estimator
+        BOOL    integerTexels = TRUE;
+        for(i=0; i<MAX_SUBSET_SIZE; i++)
+        {
+            for(j=0; j<MAX_DIMENSION_BIG; j++)
+            {
+                double  value = in[b][i][j];
+                if((value < 0.0) || (value > 255.0) || (value != floor(value)))
+                {
+                    integerTexels = FALSE;
+                }
+                soa[b/BC7_ESTIMATE_LANES][i][j][b%BC7_ESTIMATE_LANES] = (float)value;
+            }
+        }
+        if(integerTexels)
+        {
+            integerBlocks |= 1 << b;
+        }
+    }
+
+    for(DWORD j1=0; (j1 < NUM_BLOCK_TYPES) && activeBlocks; j1++)
+    {
+        DWORD blockMode = blockModeOrder[j1];
+        DWORD Mode = 0x0001 << blockMode;
+        DWORD modeBlocks = 0;
+
+        for(b=0; b < numBlocks; b++)
+        {
+            if((activeBlocks & (1 << b)) && (block[b].validModeMask & Mode))
+            {
+                modeBlocks |= 1 << b;
+            }
+        }
+
+        if(!modeBlocks)
+        {
+            continue;
+        }
+
+        // Rank the partitions of every block searching this mode, the same
+        // condition as CompressSingleIndexBlock uses to run the estimator
+        DWORD   numPartitionModes = 1 << bti[blockMode].partitionBits;
+        BOOL    useEstimates      = (bti[blockMode].encodingType != SEPARATE_ALPHA) &&
+                                    (m_partitionCandidates < numPartitionModes);
+        if(useEstimates)
+        {
+            int dimension = (bti[blockMode].encodingType == NO_ALPHA) ? 3 : 4;
+
+            for(DWORD group=0; group < BC7_BATCH_BLOCKS/BC7_ESTIMATE_LANES; group++)
+            {
+                DWORD   laneMask = (1 << BC7_ESTIMATE_LANES) - 1;
+                DWORD   groupBlocks = (modeBlocks >> (group*BC7_ESTIMATE_LANES)) & laneMask;
+
+                if(groupBlocks & (integerBlocks >> (group*BC7_ESTIMATE_LANES)))
+                {
+                    EstimatePartitionErrorsSoA(soa[group],
+                                               blockMode,
+                                               dimension,
+                                               numPartitionModes,
+                                               &estimatedError[group*BC7_ESTIMATE_LANES]);
+                }
+
+                for(DWORD lane=0; lane < BC7_ESTIMATE_LANES; lane++)
+                {
+                    b = group*BC7_ESTIMATE_LANES + lane;
+                    if((groupBlocks & (1 << lane)) && !(integerBlocks & (1 << b)))
+                    {
+                        EstimatePartitionErrors(in[b],
+                                                blockMode,
+                                                dimension,
+                                                numPartitionModes,
+                                                estimatedError[b]);
+                    }
+                }
+            }
+        }
+
+        for(b=0; b < numBlocks; b++)
+        {
+            if(!(modeBlocks & (1 << b)))
+            {
+                continue;
+            }
+
+            BYTE    temporaryOutputBlock[COMPRESSED_BLOCK_SIZE];
+            double  thisError;
 
+            m_blockMaxRange = block[b].blockMaxRange;
+            memcpy(m_blockMin,   block[b].blockMin,   sizeof(m_blockMin));
+            memcpy(m_blockMax,   block[b].blockMax,   sizeof(m_blockMax));
+            memcpy(m_blockRange, block[b].blockRange, sizeof(m_blockRange));
+
+            thisError = CompressBlockMode(in[b],
+                                          temporaryOutputBlock,
+                                          blockMode,
+                                          useEstimates ? estimatedError[b] : NULL);
+
+            if(thisError < block[b].bestError)
+            {
+                memcpy(out + b*COMPRESSED_BLOCK_SIZE, temporaryOutputBlock, COMPRESSED_BLOCK_SIZE);
+                block[b].bestError = thisError;
+            }
+
+            // Masked early out, the block takes no further part in the search
+            if((m_errorThreshold > 0) && (block[b].bestError <= m_errorThreshold))
+            {
+                activeBlocks &= ~(1 << b);
+            }
+        }
+    }
+
+    m_blocksEncoded += numBlocks;
+
+    for(b=0; b < numBlocks; b++)
+    {
+        if(block[b].bestError < m_smallestError)
+        {
+            m_smallestError = block[b].bestError;
+        }
+        if(block[b].bestError > m_largestError)
+        {
+            m_largestError = block[b].bestError;
+        }
+    }
+}
@@ -123,6 +123,38 @@ extern "C" BC_ERROR CMP_DecodeBC7Block( BYTE *in, double  out[BC_BLOCK_PIXELS][M
 }
 
 
+//
+// Decode a row major array of blocks to 8 bit RGBA texels
+//
+//
+//
+extern "C" BC_ERROR CMP_DecodeBC7Blocks( BYTE *in, DWORD blocksX, DWORD blocksY, BYTE *out, DWORD pitch )
+{
+    if(!g_LibraryInitialized)
+    {
+        return BC_ERROR_LIBRARY_NOT_INITIALIZED;
+    }
+
+    if( !in || !out || (pitch < blocksX * BLOCK_WIDTH * MAX_DIMENSION_BIG) )
+    {
+        return BC_ERROR_INVALID_PARAMETERS;
+    }
+
+    for(DWORD y = 0; y < blocksY; y++)
+    {
+        BYTE    *dest = out + y * BLOCK_WIDTH * pitch;
+        for(DWORD x = 0; x < blocksX; x++)
+        {
+            g_Decoder.DecompressBlockRGBA8(dest, pitch, in);
+            dest += BLOCK_WIDTH * MAX_DIMENSION_BIG;
+            in += COMPRESSED_BLOCK_SIZE;
+        }
+    }
+
+    return BC_ERROR_NONE;
+}
+
+
 //
 // Destroys encoder object
 //
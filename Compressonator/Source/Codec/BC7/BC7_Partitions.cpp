@@ -22,8 +22,15 @@
 // THE SOFTWARE.
 //
 
+#include <math.h>
+#include <string.h>
 #include "bc7_partitions.h"
 
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif // USE_SSE
+
 //
 // Verified to match the final definitions as detailedin the OpenGL BPTC spec
 //
@@ -997,6 +1004,67 @@ DWORD  BC7_FIXUPINDICES[MAX_SUBSETS][MAX_PARTITIONS][3] =
     },
 
 };
+
+
+//
+// The partition tables above expressed as one 16-bit pixel mask per subset
+// (bit n set means pixel n belongs to the subset). Used for fast partition
+// pre-selection where the pixels of a subset are selected without branching
+//
+
+WORD   BC7_PARTITION_MASKS[MAX_SUBSETS][MAX_PARTITIONS][MAX_SUBSETS] =
+{
+    // One subset
+    {
+        {0xFFFF, 0x0000, 0x0000},
+    },
+
+    // Two subsets
+    {
+        {0x3333,0xCCCC}, {0x7777,0x8888}, {0x1111,0xEEEE}, {0x1337,0xECC8},
+        {0x377F,0xC880}, {0x0113,0xFEEC}, {0x0137,0xFEC8}, {0x137F,0xEC80},
+        {0x37FF,0xC800}, {0x0013,0xFFEC}, {0x017F,0xFE80}, {0x17FF,0xE800},
+        {0x0017,0xFFE8}, {0x00FF,0xFF00}, {0x000F,0xFFF0}, {0x0FFF,0xF000},
+        {0x08EF,0xF710}, {0xFF71,0x008E}, {0x8EFF,0x7100}, {0xF731,0x08CE},
+        {0xFF73,0x008C}, {0x8CEF,0x7310}, {0xCEFF,0x3100}, {0x7331,0x8CCE},
+        {0xF773,0x088C}, {0xCEEF,0x3110}, {0x9999,0x6666}, {0xC993,0x366C},
+        {0xE817,0x17E8}, {0xF00F,0x0FF0}, {0x8E71,0x718E}, {0xC663,0x399C},
+        {0x5555,0xAAAA}, {0x0F0F,0xF0F0}, {0xA5A5,0x5A5A}, {0xCC33,0x33CC},
+        {0xC3C3,0x3C3C}, {0xAA55,0x55AA}, {0x6969,0x9696}, {0x5AA5,0xA55A},
+        {0x8C31,0x73CE}, {0xEC37,0x13C8}, {0xCDB3,0x324C}, {0xC423,0x3BDC},
+        {0x9669,0x6996}, {0x3CC3,0xC33C}, {0x6699,0x9966}, {0xF99F,0x0660},
+        {0xFD8D,0x0272}, {0xFB1B,0x04E4}, {0xB1BF,0x4E40}, {0xD8DF,0x2720},
+        {0x36C9,0xC936}, {0x6C93,0x936C}, {0xC639,0x39C6}, {0x9C63,0x639C},
+        {0x6CC9,0x9336}, {0x6339,0x9CC6}, {0x7E81,0x817E}, {0x18E7,0xE718},
+        {0x330F,0xCCF0}, {0xF033,0x0FCC}, {0x88BB,0x7744}, {0x11DD,0xEE22},
+    },
+
+    // Three subsets
+    {
+        {0x0133,0x08CC,0xF600}, {0x0037,0x8CC8,0x7300}, {0x006F,0xCC80,0x3310},
+        {0x1331,0xEC00,0x00CE}, {0x00FF,0x3300,0xCC00}, {0x3333,0x00CC,0xCC00},
+        {0x0033,0xFF00,0x00CC}, {0x0033,0xCCCC,0x3300}, {0x00FF,0x0F00,0xF000},
+        {0x000F,0x0FF0,0xF000}, {0x000F,0x00F0,0xFF00}, {0x3333,0x4444,0x8888},
+        {0x1111,0x6666,0x8888}, {0x1111,0x2222,0xCCCC}, {0x0013,0x136C,0xEC80},
+        {0x8C63,0x008C,0x7310}, {0x0137,0x36C8,0xC800}, {0xC631,0x08CE,0x3100},
+        {0x000F,0x3330,0xCCC0}, {0x0333,0xF000,0x0CCC}, {0x1111,0x00EE,0xEE00},
+        {0x0077,0x8888,0x7700}, {0x113F,0x22C0,0xCC00}, {0x88CF,0x4430,0x3300},
+        {0xF311,0x0C22,0x00CC}, {0x0033,0x0344,0xFC88}, {0x9009,0x6996,0x0660},
+        {0x009F,0x9960,0x6600}, {0x3443,0x0330,0xC88C}, {0x0699,0x0066,0xF900},
+        {0x3113,0xC22C,0x0CC0}, {0x00EF,0x8C00,0x7310}, {0x007F,0x1300,0xEC80},
+        {0x3331,0xC400,0x08CE}, {0x1333,0x004C,0xEC80}, {0x9999,0x2222,0x4444},
+        {0xF00F,0x00F0,0x0F00}, {0x9249,0x2492,0x4924}, {0x9429,0x2942,0x4294},
+        {0x30C3,0xC30C,0x0C30}, {0x3C03,0xC03C,0x03C0}, {0x0055,0x00AA,0xFF00},
+        {0x00FF,0xAA00,0x5500}, {0x0303,0x3030,0xCCCC}, {0x3333,0xC0C0,0x0C0C},
+        {0x0909,0x9090,0x6666}, {0x5005,0xA00A,0x0FF0}, {0x000F,0xAAA0,0x5550},
+        {0x0555,0x0AAA,0xF000}, {0x1111,0xE0E0,0x0E0E}, {0x0707,0x7070,0x8888},
+        {0x000F,0x6660,0x9990}, {0x1111,0x0EE0,0xE00E}, {0x7007,0x0770,0x8888},
+        {0x0999,0x0666,0xF000}, {0x00FF,0x6600,0x9900}, {0x0099,0x0066,0xFF00},
+        {0x3333,0x0CC0,0xC00C}, {0x3003,0x0330,0xCCCC}, {0x0FFF,0x6000,0x9000},
+        {0x7777,0x8080,0x0808}, {0x0101,0x1010,0xEEEE}, {0x0005,0x000A,0xFFF0},
+        {0x8421,0x08CE,0x7310},
+    },
+};
    
 
 
@@ -1059,3 +1127,455 @@ void    Partition(DWORD partition,
 }
 
 
+
+
+//
+// Fast partition pre-selection for the shared index block modes (0,1,2,3 and 7)
+//
+// For every partition the pixels of each subset are fitted with a line through
+// the subset mean along its principal axis, the residual error off that line is
+// used as an estimate of how well the quantizer will do on the partition.
+// The first and second order moments of the subsets are accumulated from the
+// 16-bit partition masks, the last subset is derived from the block totals
+//
+
+// Residual error of a subset about its principal axis given its moments
+// sum = {r,g,b,a}  sq = {rr,gg,bb,aa}  x1 = {rg,gb,ba,ar}  x2 = {rb,ga,-,-}
+static double SubsetLineError(float sum[4], float sq[4], float x1[4], float x2[4], float n)
+{
+    int     i,j,k;
+    float   mean[4];
+    float   cov[4][4];
+    float   v[4], w[4];
+    float   trace, lambda, norm;
+
+    // One or two pixels can always be represented exactly by a line
+    if(n < 2.5f)
+        return 0.0;
+
+    for(i=0; i<4; i++)
+        mean[i] = sum[i] / n;
+
+    cov[0][1] = cov[1][0] = x1[0] / n - mean[0] * mean[1];
+    cov[1][2] = cov[2][1] = x1[1] / n - mean[1] * mean[2];
+    cov[2][3] = cov[3][2] = x1[2] / n - mean[2] * mean[3];
+    cov[3][0] = cov[0][3] = x1[3] / n - mean[3] * mean[0];
+    cov[0][2] = cov[2][0] = x2[0] / n - mean[0] * mean[2];
+    cov[1][3] = cov[3][1] = x2[1] / n - mean[1] * mean[3];
+
+    trace = 0.f;
+    k     = 0;
+    for(i=0; i<4; i++)
+    {
+        cov[i][i] = sq[i] / n - mean[i] * mean[i];
+        trace += cov[i][i];
+        if(cov[i][i] > cov[k][k])
+            k = i;
+    }
+
+    if(trace <= 0.f)
+        return 0.0;
+
+    // Power iteration for the largest eigenvalue, starting from the
+    // column of the covariance matrix with the largest variance
+    for(i=0; i<4; i++)
+        v[i] = cov[i][k];
+
+    for(k=0; k<4; k++)
+    {
+        norm = 0.f;
+        for(i=0; i<4; i++)
+        {
+            w[i] = 0.f;
+            for(j=0; j<4; j++)
+                w[i] += cov[i][j] * v[j];
+            norm = max(norm, (float)fabs(w[i]));
+        }
+        if(norm <= 0.f)
+            return 0.0;
+        for(i=0; i<4; i++)
+            v[i] = w[i] / norm;
+    }
+
+    // Rayleigh quotient
+    lambda = 0.f;
+    norm   = 0.f;
+    for(i=0; i<4; i++)
+    {
+        w[i] = 0.f;
+        for(j=0; j<4; j++)
+            w[i] += cov[i][j] * v[j];
+        lambda += v[i] * w[i];
+        norm   += v[i] * v[i];
+    }
+    lambda /= norm;
+
+    return (double)(max(0.f, trace - lambda) * n);
+}
+
+void    EstimatePartitionErrors(double in[][MAX_DIMENSION_BIG],
+                                DWORD  blockType,
+                                int    dimension,
+                                DWORD  numPartitions,
+                                double error[MAX_PARTITIONS])
+{
+#ifdef USE_DBGTRACE
+    DbgTrace(());
+#endif
+    DWORD   subsetCount = bti[blockType].subsetCount;
+    DWORD   i, p, s;
+    float   sum[MAX_SUBSETS][4];
+    float   sq[MAX_SUBSETS][4];
+    float   x1[MAX_SUBSETS][4];
+    float   x2[MAX_SUBSETS][4];
+    float   count[MAX_SUBSETS];
+
+    if(subsetCount < 2)
+    {
+        for(p=0; p<numPartitions; p++)
+            error[p] = 0.0;
+        return;
+    }
+
+#ifdef USE_SSE
+    if(g_bBC7UseSSE2)
+    {
+        __m128  px[MAX_SUBSET_SIZE];
+        __m128  pxSq[MAX_SUBSET_SIZE];
+        __m128  pxX1[MAX_SUBSET_SIZE];
+        __m128  pxX2[MAX_SUBSET_SIZE];
+        __m128  totSum = _mm_setzero_ps();
+        __m128  totSq  = _mm_setzero_ps();
+        __m128  totX1  = _mm_setzero_ps();
+        __m128  totX2  = _mm_setzero_ps();
+
+        // Per pixel products, the channels beyond the mode dimension are left at zero
+        for(i=0; i<MAX_SUBSET_SIZE; i++)
+        {
+            px[i]   = _mm_set_ps(dimension > 3 ? (float)in[i][3] : 0.f, (float)in[i][2], (float)in[i][1], (float)in[i][0]);
+            pxSq[i] = _mm_mul_ps(px[i], px[i]);
+            pxX1[i] = _mm_mul_ps(px[i], _mm_shuffle_ps(px[i], px[i], _MM_SHUFFLE(0,3,2,1)));
+            pxX2[i] = _mm_mul_ps(px[i], _mm_shuffle_ps(px[i], px[i], _MM_SHUFFLE(1,0,3,2)));
+
+            totSum  = _mm_add_ps(totSum, px[i]);
+            totSq   = _mm_add_ps(totSq,  pxSq[i]);
+            totX1   = _mm_add_ps(totX1,  pxX1[i]);
+            totX2   = _mm_add_ps(totX2,  pxX2[i]);
+        }
+
+        for(p=0; p<numPartitions; p++)
+        {
+            __m128  restSum = totSum;
+            __m128  restSq  = totSq;
+            __m128  restX1  = totX1;
+            __m128  restX2  = totX2;
+            float   restCount = (float)MAX_SUBSET_SIZE;
+
+            for(s=0; s<subsetCount-1; s++)
+            {
+                DWORD   mask = BC7_PARTITION_MASKS[subsetCount-1][p][s];
+                __m128  aSum = _mm_setzero_ps();
+                __m128  aSq  = _mm_setzero_ps();
+                __m128  aX1  = _mm_setzero_ps();
+                __m128  aX2  = _mm_setzero_ps();
+                DWORD   n = 0;
+
+                for(i=0; i<MAX_SUBSET_SIZE; i++)
+                {
+                    DWORD   bit = (mask >> i) & 1;
+                    __m128  sel = _mm_castsi128_ps(_mm_set1_epi32(-(int)bit));
+                    aSum = _mm_add_ps(aSum, _mm_and_ps(sel, px[i]));
+                    aSq  = _mm_add_ps(aSq,  _mm_and_ps(sel, pxSq[i]));
+                    aX1  = _mm_add_ps(aX1,  _mm_and_ps(sel, pxX1[i]));
+                    aX2  = _mm_add_ps(aX2,  _mm_and_ps(sel, pxX2[i]));
+                    n   += bit;
+                }
+
+                _mm_storeu_ps(sum[s], aSum);
+                _mm_storeu_ps(sq[s],  aSq);
+                _mm_storeu_ps(x1[s],  aX1);
+                _mm_storeu_ps(x2[s],  aX2);
+                count[s] = (float)n;
+
+                restSum = _mm_sub_ps(restSum, aSum);
+                restSq  = _mm_sub_ps(restSq,  aSq);
+                restX1  = _mm_sub_ps(restX1,  aX1);
+                restX2  = _mm_sub_ps(restX2,  aX2);
+                restCount -= (float)n;
+            }
+
+            _mm_storeu_ps(sum[s], restSum);
+            _mm_storeu_ps(sq[s],  restSq);
+            _mm_storeu_ps(x1[s],  restX1);
+            _mm_storeu_ps(x2[s],  restX2);
+            count[s] = restCount;
+
+            error[p] = 0.0;
+            for(s=0; s<subsetCount; s++)
+                error[p] += SubsetLineError(sum[s], sq[s], x1[s], x2[s], count[s]);
+        }
+    }
+    else
+#endif // USE_SSE
+    {
+        float   px[MAX_SUBSET_SIZE][4];
+
+        for(i=0; i<MAX_SUBSET_SIZE; i++)
+        {
+            px[i][0] = (float)in[i][0];
+            px[i][1] = (float)in[i][1];
+            px[i][2] = (float)in[i][2];
+            px[i][3] = dimension > 3 ? (float)in[i][3] : 0.f;
+        }
+
+        for(p=0; p<numPartitions; p++)
+        {
+            memset(sum,   0, sizeof(sum));
+            memset(sq,    0, sizeof(sq));
+            memset(x1,    0, sizeof(x1));
+            memset(x2,    0, sizeof(x2));
+            memset(count, 0, sizeof(count));
+
+            for(i=0; i<MAX_SUBSET_SIZE; i++)
+            {
+                float   *c = px[i];
+                s = BC7_PARTITIONS[subsetCount-1][p][i];
+
+                sum[s][0] += c[0];         sum[s][1] += c[1];         sum[s][2] += c[2];         sum[s][3] += c[3];
+                sq[s][0]  += c[0] * c[0];  sq[s][1]  += c[1] * c[1];  sq[s][2]  += c[2] * c[2];  sq[s][3]  += c[3] * c[3];
+                x1[s][0]  += c[0] * c[1];  x1[s][1]  += c[1] * c[2];  x1[s][2]  += c[2] * c[3];  x1[s][3]  += c[3] * c[0];
+                x2[s][0]  += c[0] * c[2];  x2[s][1]  += c[1] * c[3];
+                count[s]  += 1.f;
+            }
+
+            error[p] = 0.0;
+            for(s=0; s<subsetCount; s++)
+                error[p] += SubsetLineError(sum[s], sq[s], x1[s], x2[s], count[s]);
+        }
+    }
+}
+
+//
+// Partition ranking for several blocks at once, one block per SIMD lane
+//
+// The input is in structure of arrays layout, in[pixel][component][lane]. The moments of
+// 8-bit integer texels are exact in single precision whatever the summation order, and the
+// line fit below performs the same operations per lane as SubsetLineError, so each lane
+// gets the same estimates as EstimatePartitionErrors on that block on its own
+//
+
+#ifdef USE_SSE
+static void SubsetLineErrorSoA(__m128 sum[4], __m128 sq[4], __m128 x1[4], __m128 x2[2], float n,
+                               double error[BC7_ESTIMATE_LANES][MAX_PARTITIONS], DWORD p)
+{
+    int     i,j;
+    __m128  zero = _mm_setzero_ps();
+    __m128  absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128  vn = _mm_set1_ps(n);
+    __m128  mean[4];
+    __m128  cov[4][4];
+    __m128  v[4], w[4];
+    __m128  trace, lambda, norm, best, valid;
+    float   lineError[BC7_ESTIMATE_LANES];
+
+    // One or two pixels can always be represented exactly by a line
+    if(n < 2.5f)
+        return;
+
+    for(i=0; i<4; i++)
+        mean[i] = _mm_div_ps(sum[i], vn);
+
+    cov[0][1] = cov[1][0] = _mm_sub_ps(_mm_div_ps(x1[0], vn), _mm_mul_ps(mean[0], mean[1]));
+    cov[1][2] = cov[2][1] = _mm_sub_ps(_mm_div_ps(x1[1], vn), _mm_mul_ps(mean[1], mean[2]));
+    cov[2][3] = cov[3][2] = _mm_sub_ps(_mm_div_ps(x1[2], vn), _mm_mul_ps(mean[2], mean[3]));
+    cov[3][0] = cov[0][3] = _mm_sub_ps(_mm_div_ps(x1[3], vn), _mm_mul_ps(mean[3], mean[0]));
+    cov[0][2] = cov[2][0] = _mm_sub_ps(_mm_div_ps(x2[0], vn), _mm_mul_ps(mean[0], mean[2]));
+    cov[1][3] = cov[3][1] = _mm_sub_ps(_mm_div_ps(x2[1], vn), _mm_mul_ps(mean[1], mean[3]));
+
+    trace = zero;
+    for(i=0; i<4; i++)
+    {
+        cov[i][i] = _mm_sub_ps(_mm_div_ps(sq[i], vn), _mm_mul_ps(mean[i], mean[i]));
+        trace = _mm_add_ps(trace, cov[i][i]);
+    }
+
+    // Start from the column with the largest variance, lanes that take
+    // an early exit in the scalar version are masked out of the result
+    best = cov[0][0];
+    for(i=0; i<4; i++)
+        v[i] = cov[i][0];
+    for(j=1; j<4; j++)
+    {
+        __m128  larger = _mm_cmpgt_ps(cov[j][j], best);
+        best = _mm_or_ps(_mm_and_ps(larger, cov[j][j]), _mm_andnot_ps(larger, best));
+        for(i=0; i<4; i++)
+            v[i] = _mm_or_ps(_mm_and_ps(larger, cov[i][j]), _mm_andnot_ps(larger, v[i]));
+    }
+    valid = _mm_cmpgt_ps(trace, zero);
+
+    for(int iteration=0; iteration<4; iteration++)
+    {
+        norm = zero;
+        for(i=0; i<4; i++)
+        {
+            w[i] = _mm_mul_ps(cov[i][0], v[0]);
+            for(j=1; j<4; j++)
+                w[i] = _mm_add_ps(w[i], _mm_mul_ps(cov[i][j], v[j]));
+            norm = _mm_max_ps(norm, _mm_and_ps(w[i], absMask));
+        }
+        valid = _mm_and_ps(valid, _mm_cmpgt_ps(norm, zero));
+        for(i=0; i<4; i++)
+            v[i] = _mm_div_ps(w[i], norm);
+    }
+
+    // Rayleigh quotient
+    lambda = zero;
+    norm   = zero;
+    for(i=0; i<4; i++)
+    {
+        w[i] = _mm_mul_ps(cov[i][0], v[0]);
+        for(j=1; j<4; j++)
+            w[i] = _mm_add_ps(w[i], _mm_mul_ps(cov[i][j], v[j]));
+        lambda = _mm_add_ps(lambda, _mm_mul_ps(v[i], w[i]));
+        norm   = _mm_add_ps(norm,   _mm_mul_ps(v[i], v[i]));
+    }
+    lambda = _mm_div_ps(lambda, norm);
+
+    _mm_storeu_ps(lineError, _mm_and_ps(valid, _mm_mul_ps(_mm_max_ps(zero, _mm_sub_ps(trace, lambda)), vn)));
+    for(i=0; i<BC7_ESTIMATE_LANES; i++)
+        error[i][p] += (double)lineError[i];
+}
+#endif // USE_SSE
+
+void    EstimatePartitionErrorsSoA(float  in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG][BC7_ESTIMATE_LANES],
+                                   DWORD  blockType,
+                                   int    dimension,
+                                   DWORD  numPartitions,
+                                   double error[BC7_ESTIMATE_LANES][MAX_PARTITIONS])
+{
+#ifdef USE_DBGTRACE
+    DbgTrace(());
+#endif
+    DWORD   subsetCount = bti[blockType].subsetCount;
+    DWORD   i, p, s, lane;
+
+    if(subsetCount < 2)
+    {
+        for(lane=0; lane<BC7_ESTIMATE_LANES; lane++)
+            for(p=0; p<numPartitions; p++)
+                error[lane][p] = 0.0;
+        return;
+    }
+
+#ifdef USE_SSE
+    if(g_bBC7UseSSE2)
+    {
+        __m128  px[MAX_SUBSET_SIZE][4];
+        __m128  pxSq[MAX_SUBSET_SIZE][4];
+        __m128  pxX1[MAX_SUBSET_SIZE][4];
+        __m128  pxX2[MAX_SUBSET_SIZE][2];
+        __m128  totSum[4], totSq[4], totX1[4], totX2[2];
+        DWORD   c;
+
+        for(c=0; c<4; c++)
+            totSum[c] = totSq[c] = totX1[c] = _mm_setzero_ps();
+        totX2[0] = totX2[1] = _mm_setzero_ps();
+
+        // Per pixel products, the channels beyond the mode dimension are left at zero
+        for(i=0; i<MAX_SUBSET_SIZE; i++)
+        {
+            for(c=0; c<4; c++)
+                px[i][c] = ((int)c < dimension) ? _mm_loadu_ps(in[i][c]) : _mm_setzero_ps();
+
+            for(c=0; c<4; c++)
+            {
+                pxSq[i][c] = _mm_mul_ps(px[i][c], px[i][c]);
+                pxX1[i][c] = _mm_mul_ps(px[i][c], px[i][(c+1)&3]);
+            }
+            pxX2[i][0] = _mm_mul_ps(px[i][0], px[i][2]);
+            pxX2[i][1] = _mm_mul_ps(px[i][1], px[i][3]);
+
+            for(c=0; c<4; c++)
+            {
+                totSum[c] = _mm_add_ps(totSum[c], px[i][c]);
+                totSq[c]  = _mm_add_ps(totSq[c],  pxSq[i][c]);
+                totX1[c]  = _mm_add_ps(totX1[c],  pxX1[i][c]);
+            }
+            totX2[0] = _mm_add_ps(totX2[0], pxX2[i][0]);
+            totX2[1] = _mm_add_ps(totX2[1], pxX2[i][1]);
+        }
+
+        for(p=0; p<numPartitions; p++)
+        {
+            __m128  restSum[4], restSq[4], restX1[4], restX2[2];
+            float   restCount = (float)MAX_SUBSET_SIZE;
+
+            for(c=0; c<4; c++)
+            {
+                restSum[c] = totSum[c];
+                restSq[c]  = totSq[c];
+                restX1[c]  = totX1[c];
+            }
+            restX2[0] = totX2[0];
+            restX2[1] = totX2[1];
+
+            for(lane=0; lane<BC7_ESTIMATE_LANES; lane++)
+                error[lane][p] = 0.0;
+
+            for(s=0; s<subsetCount-1; s++)
+            {
+                DWORD   mask = BC7_PARTITION_MASKS[subsetCount-1][p][s];
+                __m128  aSum[4], aSq[4], aX1[4], aX2[2];
+                DWORD   n = 0;
+
+                for(c=0; c<4; c++)
+                    aSum[c] = aSq[c] = aX1[c] = _mm_setzero_ps();
+                aX2[0] = aX2[1] = _mm_setzero_ps();
+
+                // The partition is the same for every lane so the subset pixels are a plain loop
+                for(i=0; i<MAX_SUBSET_SIZE; i++)
+                {
+                    if(!((mask >> i) & 1))
+                        continue;
+                    for(c=0; c<4; c++)
+                    {
+                        aSum[c] = _mm_add_ps(aSum[c], px[i][c]);
+                        aSq[c]  = _mm_add_ps(aSq[c],  pxSq[i][c]);
+                        aX1[c]  = _mm_add_ps(aX1[c],  pxX1[i][c]);
+                    }
+                    aX2[0] = _mm_add_ps(aX2[0], pxX2[i][0]);
+                    aX2[1] = _mm_add_ps(aX2[1], pxX2[i][1]);
+                    n++;
+                }
+
+                SubsetLineErrorSoA(aSum, aSq, aX1, aX2, (float)n, error, p);
+
+                for(c=0; c<4; c++)
+                {
+                    restSum[c] = _mm_sub_ps(restSum[c], aSum[c]);
+                    restSq[c]  = _mm_sub_ps(restSq[c],  aSq[c]);
+                    restX1[c]  = _mm_sub_ps(restX1[c],  aX1[c]);
+                }
+                restX2[0] = _mm_sub_ps(restX2[0], aX2[0]);
+                restX2[1] = _mm_sub_ps(restX2[1], aX2[1]);
+                restCount -= (float)n;
+            }
+
+            SubsetLineErrorSoA(restSum, restSq, restX1, restX2, restCount, error, p);
+        }
+    }
+    else
+#endif // USE_SSE
+    {
+        double  block[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+
+        for(lane=0; lane<BC7_ESTIMATE_LANES; lane++)
+        {
+            for(i=0; i<MAX_SUBSET_SIZE; i++)
+                for(s=0; s<MAX_DIMENSION_BIG; s++)
+                    block[i][s] = (double)in[i][s][lane];
+
+            EstimatePartitionErrors(block, blockType, dimension, numPartitions, error[lane]);
+        }
+    }
+}
@@ -41,17 +41,32 @@ extern     CompViewerClient g_CompClient;
 //======================================================================================
 #define USE_MULTITHREADING  1
 
+bool g_bBC7UseSSE2 = false;
+
+// Picks the kernels from the CPU features allowed by CMP_SetCPUFeatureMask
+static void SelectBC7Kernels(CMP_DWORD dwCPUFeatures)
+{
+#ifdef USE_SSE
+    g_bBC7UseSSE2 = (dwCPUFeatures & CMP_CPU_FEATURE_SSE2) ? true : false;
+#else
+    UNREFERENCED_PARAMETER(dwCPUFeatures);
+#endif // USE_SSE
+}
+
+static const bool g_bBC7KernelsRegistered = RegisterCPUDispatch(SelectBC7Kernels);
+
 struct BC7EncodeThreadParam
 {
     BC7BlockEncoder    *encoder;
-    double    in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    double    in[BC7_BATCH_BLOCKS][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
     BYTE    *out;
+    DWORD    numBlocks;
     volatile BOOL    run;
     volatile BOOL    exit;
 };
 
 //
-// Thread procedure for encoding a block
+// Thread procedure for encoding a batch of blocks
 //
 // The thread stays alive, and expects blocks to be pushed to it by a producer
 // process that signals it when new work is available. When the producer is finished
@@ -66,7 +81,7 @@ unsigned int    _stdcall BC7ThreadProcEncode(void* param)
     {
         if(tp->run == TRUE)
         {
-            tp->encoder->CompressBlock(tp->in, tp->out);
+            tp->encoder->CompressBlocks(tp->in, tp->out, tp->numBlocks);
             tp->run = FALSE;
         }
         Sleep(0);
@@ -95,12 +110,18 @@ CCodec_BC7::CCodec_BC7() : CCodec_DXTC(CT_BC7)
     m_AlphaRestrict        = FALSE;
     m_ImageNeedsAlpha      = TRUE;
     m_NumThreads           = 8;
+    m_PartitionCandidates  = 0;     // Derived from m_Quality
+    m_ErrorTarget          = 0;     // MSE per texel channel, 0 disables the adaptive search
+    m_AutoModeMask         = FALSE;
 
     m_NumEncodingThreads   = m_NumThreads;
     m_EncodingThreadHandle = NULL;
     m_LiveThreads          = 0;
     m_LastThread           = 0;
 
+    m_SampleWorkPerBlock   = 0;
+    m_SampleTime           = 0;
+    m_ModeMaskTimeSaved    = 0;
 }
 
 
@@ -123,11 +144,46 @@ bool CCodec_BC7::SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue)
     if(strcmp(pszParamName, "ImageNeedsAlpha") == 0)
         m_ImageNeedsAlpha     = (BOOL) std::stoi(sValue) > 0;
     else
+    if(strcmp(pszParamName, "AutoModeMask") == 0)
+        m_AutoModeMask        = (BOOL) std::stoi(sValue) > 0;
+    else
     if(strcmp(pszParamName, "NumThreads") == 0)
     {
         m_NumThreads = (CMP_BYTE) std::stoi(sValue) & 0xFF;
         m_Use_MultiThreading = m_NumThreads > 1;
     }
+    else
+    if(strcmp(pszParamName, "PartitionCandidates") == 0)
+    {
+        m_PartitionCandidates = std::stoi(sValue);
+        if (m_PartitionCandidates > MAX_PARTITIONS)
+        {
+            m_PartitionCandidates = 0;
+            return false;
+        }
+    }
+    else
+    if(strcmp(pszParamName, "TargetMSE") == 0)
+    {
+        m_ErrorTarget = std::stof(sValue);
+        if (m_ErrorTarget < 0)
+        {
+            m_ErrorTarget = 0;
+            return false;
+        }
+    }
+    else
+    if(strcmp(pszParamName, "TargetPSNR") == 0)
+    {
+        double psnr = std::stof(sValue);
+        if (psnr <= 0)
+        {
+            m_ErrorTarget = 0;
+            return false;
+        }
+        m_ErrorTarget = (255.0 * 255.0) / pow(10.0, psnr / 10.0);
+    }
+    else
     if(strcmp(pszParamName, "Quality") == 0)
     {
         m_Quality = std::stof(sValue);
@@ -166,11 +222,17 @@ bool CCodec_BC7::SetParameter(const CMP_CHAR* pszParamName, CMP_DWORD dwValue)
     if(strcmp(pszParamName, "ImageNeedsAlpha") == 0)
         m_ImageNeedsAlpha     = (BOOL) dwValue & 1;
     else
+    if(strcmp(pszParamName, "AutoModeMask") == 0)
+        m_AutoModeMask        = (BOOL) dwValue & 1;
+    else
     if(strcmp(pszParamName, "NumThreads") == 0)
     {
         m_NumThreads = (CMP_BYTE) dwValue;
         m_Use_MultiThreading = m_NumThreads > 1;
     }
+    else
+    if(strcmp(pszParamName, "PartitionCandidates") == 0)
+        m_PartitionCandidates = min(dwValue, MAX_PARTITIONS);
     else
         return CCodec_DXTC::SetParameter(pszParamName, dwValue);
     return true;
@@ -183,11 +245,61 @@ bool CCodec_BC7::SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue)
     else
     if(strcmp(pszParamName, "Performance") == 0)
         m_Performance = fValue;
+    else
+    if(strcmp(pszParamName, "TargetMSE") == 0)
+        m_ErrorTarget = max(fValue, 0.0f);
+    else
+    if(strcmp(pszParamName, "TargetPSNR") == 0)
+        m_ErrorTarget = (fValue > 0) ? (255.0 * 255.0) / pow(10.0, fValue / 10.0) : 0;
     else
         return CCodec_DXTC::SetParameter(pszParamName, fValue);
     return true;
 }
 
+// Encoding statistics, summed over the encoder instances of the last Compress
+bool CCodec_BC7::GetParameter(const CMP_CHAR* pszParamName, CMP_DWORD& dwValue)
+{
+    if(strcmp(pszParamName, "BlocksEncoded") == 0)
+    {
+        dwValue = 0;
+        for(DWORD i=0; m_LibraryInitialized && (i < m_NumEncodingThreads); i++)
+        {
+            if (m_encoder[i])
+                dwValue += m_encoder[i]->GetBlocksEncoded();
+        }
+    }
+    else
+    if(strcmp(pszParamName, "ModeMask") == 0)
+        dwValue = m_ModeMask;
+    else
+        return CCodec_DXTC::GetParameter(pszParamName, dwValue);
+    return true;
+}
+
+bool CCodec_BC7::GetParameter(const CMP_CHAR* pszParamName, CODECFLOAT& fValue)
+{
+    if(strcmp(pszParamName, "WorkPerBlock") == 0)
+    {
+        double  workDone      = 0;
+        DWORD   blocksEncoded = 0;
+        for(DWORD i=0; m_LibraryInitialized && (i < m_NumEncodingThreads); i++)
+        {
+            if (m_encoder[i])
+            {
+                workDone      += m_encoder[i]->GetWorkDone();
+                blocksEncoded += m_encoder[i]->GetBlocksEncoded();
+            }
+        }
+        fValue = blocksEncoded ? (CODECFLOAT)(workDone / blocksEncoded) : 0;
+    }
+    else
+    if(strcmp(pszParamName, "ModeMaskTimeSaved") == 0)
+        fValue = (CODECFLOAT)m_ModeMaskTimeSaved;
+    else
+        return CCodec_DXTC::GetParameter(pszParamName, fValue);
+    return true;
+}
+
 
 CCodec_BC7::~CCodec_BC7()
 {
@@ -316,7 +428,9 @@ CodecError CCodec_BC7::InitializeBC7Library()
                                                 m_Quality,
                                                 m_ColourRestrict,
                                                 m_AlphaRestrict,
-                                                m_Performance);
+                                                m_Performance,
+                                                m_PartitionCandidates,
+                                                m_ErrorTarget);
 
             
             // Cleanup if problem!
@@ -385,8 +499,9 @@ CodecError CCodec_BC7::InitializeBC7Library()
 }
 
 
-CodecError CCodec_BC7::EncodeBC7Block(double  in[BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG],
-                                    BYTE    *out)
+CodecError CCodec_BC7::EncodeBC7Blocks(double  in[][BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG],
+                                     DWORD   numBlocks,
+                                     BYTE    *out)
 {
 if (m_Use_MultiThreading)
 {
@@ -427,10 +542,11 @@ if (m_Use_MultiThreading)
     // Copy the input data into the thread storage
     memcpy(g_EncodeParameterStorage[threadIndex].in,
            in,
-           MAX_SUBSET_SIZE * MAX_DIMENSION_BIG * sizeof(double));
+           numBlocks * MAX_SUBSET_SIZE * MAX_DIMENSION_BIG * sizeof(double));
 
     // Set the output pointer for the thread to the provided location
     g_EncodeParameterStorage[threadIndex].out = out;
+    g_EncodeParameterStorage[threadIndex].numBlocks = numBlocks;
 
     // Tell the thread to start working
     g_EncodeParameterStorage[threadIndex].run = TRUE;
@@ -438,10 +554,11 @@ if (m_Use_MultiThreading)
 else 
 {
         // Copy the input data into the thread storage
-        memcpy(g_EncodeParameterStorage[0].in, in, MAX_SUBSET_SIZE * MAX_DIMENSION_BIG * sizeof(double));
+        memcpy(g_EncodeParameterStorage[0].in, in, numBlocks * MAX_SUBSET_SIZE * MAX_DIMENSION_BIG * sizeof(double));
         // Set the output pointer for the thread to write
         g_EncodeParameterStorage[0].out = out;
-        m_encoder[0]->CompressBlock(g_EncodeParameterStorage[0].in,g_EncodeParameterStorage[0].out);
+        g_EncodeParameterStorage[0].numBlocks = numBlocks;
+        m_encoder[0]->CompressBlocks(g_EncodeParameterStorage[0].in,g_EncodeParameterStorage[0].out,numBlocks);
 }
     return CE_OK;
 }
@@ -474,6 +591,140 @@ if (m_Use_MultiThreading)
 return CE_OK;
 }
 
+//
+// Automatic mode mask
+//
+// A sparse grid of blocks is encoded with the modes of m_ModeMask, the modes that win on at
+// least 1 in BC7_AUTOMASK_MIN_SHARE of the samples make up the mode mask for the full encode,
+// so the pre-pass only ever removes modes. Mode 6 is kept when m_ModeMask allows it, and mode 4
+// when colour or alpha restriction is set, so every block is left with at least one valid mode.
+// The work per block of the samples is kept to estimate the time saved once the encode is done
+//
+CodecError CCodec_BC7::SelectModeMask(CCodecBuffer& bufferIn, CMP_DWORD dwBlocksX, CMP_DWORD dwBlocksY)
+{
+    if (dwBlocksX*dwBlocksY < BC7_AUTOMASK_MIN_BLOCKS)
+        return CE_OK;
+
+    CMP_DWORD step = BC7_AUTOMASK_STEP;
+    while (((dwBlocksX + step - 1) / step) * ((dwBlocksY + step - 1) / step) > BC7_AUTOMASK_MAX_SAMPLES)
+        step++;
+
+    const CMP_DWORD numSamples = ((dwBlocksX + step - 1) / step) * ((dwBlocksY + step - 1) / step);
+
+    BYTE *sampleOut = new BYTE[numSamples * COMPRESSED_BLOCK_SIZE];
+    if (!sampleOut)
+        return CE_Unknown;
+    memset(sampleOut, 0, numSamples * COMPRESSED_BLOCK_SIZE);
+
+    LARGE_INTEGER   frequency, startTime, endTime;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&startTime);
+
+    DWORD   i;
+    for(i=0; i < m_NumEncodingThreads; i++)
+    {
+        m_encoder[i]->SetModeMask(m_ModeMask);
+        m_encoder[i]->ResetStatistics();
+    }
+
+    double  blocksToEncode[BC7_BATCH_BLOCKS][BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG];
+    DWORD   batchBlocks = 0;
+    DWORD   sample      = 0;
+
+    for(CMP_DWORD y = 0; y < dwBlocksY; y += step)
+    {
+        for(CMP_DWORD x = 0; x < dwBlocksX; x += step)
+        {
+            CMP_BYTE srcBlock[BLOCK_SIZE_4X4X4];
+
+            memset(srcBlock,0,sizeof(srcBlock));
+            bufferIn.ReadBlockRGBA(x*4, y*4, 4, 4, srcBlock);
+
+            for(i=0; i < BC7_BLOCK_PIXELS; i++)
+            {
+                blocksToEncode[batchBlocks][i][BC_COMP_RED]   = (double)srcBlock[i*4];
+                blocksToEncode[batchBlocks][i][BC_COMP_GREEN] = (double)srcBlock[i*4+1];
+                blocksToEncode[batchBlocks][i][BC_COMP_BLUE]  = (double)srcBlock[i*4+2];
+                blocksToEncode[batchBlocks][i][BC_COMP_ALPHA] = (double)srcBlock[i*4+3];
+            }
+            sample++;
+
+            if(++batchBlocks == BC7_BATCH_BLOCKS)
+            {
+                EncodeBC7Blocks(blocksToEncode,batchBlocks,sampleOut + (sample - batchBlocks)*COMPRESSED_BLOCK_SIZE);
+                batchBlocks = 0;
+            }
+        }
+    }
+
+    if(batchBlocks)
+    {
+        EncodeBC7Blocks(blocksToEncode,batchBlocks,sampleOut + (sample - batchBlocks)*COMPRESSED_BLOCK_SIZE);
+    }
+
+    CodecError err = FinishBC7Encoding();
+    if (err != CE_OK)
+    {
+        delete[] sampleOut;
+        return err;
+    }
+
+    // The block mode is unary coded from the LSB of the first byte
+    DWORD   modeCount[NUM_BLOCK_TYPES];
+    memset(modeCount, 0, sizeof(modeCount));
+    for(i=0; i < numSamples; i++)
+    {
+        for(DWORD blockMode=0; blockMode < NUM_BLOCK_TYPES; blockMode++)
+        {
+            if(sampleOut[i*COMPRESSED_BLOCK_SIZE] & (1 << blockMode))
+            {
+                modeCount[blockMode]++;
+                break;
+            }
+        }
+    }
+    delete[] sampleOut;
+
+    DWORD   modeMask = 1 << 6;
+    if (m_ColourRestrict || m_AlphaRestrict)
+        modeMask |= 1 << 4;
+
+    for(DWORD blockMode=0; blockMode < NUM_BLOCK_TYPES; blockMode++)
+    {
+        if(modeCount[blockMode] * BC7_AUTOMASK_MIN_SHARE >= numSamples)
+            modeMask |= 1 << blockMode;
+    }
+    modeMask &= m_ModeMask;
+
+    // Without mode 6 in the caller's mask the samples' most used mode stands in for it
+    if(modeMask == 0 || !(m_ModeMask & (1 << 6)))
+    {
+        DWORD   mostUsed = 0;
+        for(DWORD blockMode=1; blockMode < NUM_BLOCK_TYPES; blockMode++)
+        {
+            if(modeCount[blockMode] > modeCount[mostUsed])
+                mostUsed = blockMode;
+        }
+        modeMask |= (modeCount[mostUsed] > 0) ? (1 << mostUsed) : m_ModeMask;
+    }
+
+    CODECFLOAT  workPerBlock = 0;
+    GetParameter("WorkPerBlock", workPerBlock);
+    m_SampleWorkPerBlock = workPerBlock;
+
+    m_ModeMask = modeMask;
+    for(i=0; i < m_NumEncodingThreads; i++)
+    {
+        m_encoder[i]->SetModeMask(m_ModeMask);
+        m_encoder[i]->ResetStatistics();
+    }
+
+    QueryPerformanceCounter(&endTime);
+    m_SampleTime = (double)(endTime.QuadPart - startTime.QuadPart) / (double)frequency.QuadPart;
+
+    return CE_OK;
+}
+
 CodecError CCodec_BC7::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
 {
     assert(bufferIn.GetWidth()    == bufferOut.GetWidth());
@@ -499,6 +750,19 @@ CodecError CCodec_BC7::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut,
     const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
     const CMP_DWORD dwBlocksXY = dwBlocksX*dwBlocksY;
 
+    LARGE_INTEGER   frequency, encodeStartTime, encodeEndTime;
+    QueryPerformanceFrequency(&frequency);
+
+    m_SampleWorkPerBlock = 0;
+    m_ModeMaskTimeSaved  = 0;
+    if (m_AutoModeMask)
+    {
+        err = SelectModeMask(bufferIn, dwBlocksX, dwBlocksY);
+        if (err != CE_OK) return err;
+    }
+
+    QueryPerformanceCounter(&encodeStartTime);
+
 
     #ifdef USE_DBGTRACE
     DbgTrace(("IN : BufferType %d ChannelCount %d ChannelDepth %d",bufferIn.GetBufferType(),bufferIn.GetChannelCount(),bufferIn.GetChannelDepth()));
@@ -518,12 +782,18 @@ CodecError CCodec_BC7::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut,
 
     DWORD block = 0;
 
+    // Blocks are handed to the encoders in batches, the output of consecutive
+    // blocks is contiguous so a batch may span rows
+    double blocksToEncode[BC7_BATCH_BLOCKS][BLOCK_SIZE_4X4][CHANNEL_SIZE_ARGB];
+    DWORD  batchBlocks = 0;
+    DWORD  batchStart  = 0;
+
     for(CMP_DWORD j = 0; j < dwBlocksY; j++)
     {
 
         for(CMP_DWORD i = 0; i < dwBlocksX; i++)
         {
-            double blockToEncode[BLOCK_SIZE_4X4][CHANNEL_SIZE_ARGB];
+            double (*blockToEncode)[CHANNEL_SIZE_ARGB] = blocksToEncode[batchBlocks];
             CMP_BYTE srcBlock[BLOCK_SIZE_4X4X4];
 
             memset(srcBlock,0,sizeof(srcBlock));
@@ -547,9 +817,18 @@ CodecError CCodec_BC7::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut,
                 }
             }
 
-            EncodeBC7Block(blockToEncode,pOutBuffer+block);
+            if(batchBlocks == 0)
+            {
+                batchStart = block;
+            }
             block += 16;
 
+            if(++batchBlocks == BC7_BATCH_BLOCKS)
+            {
+                EncodeBC7Blocks(blocksToEncode,batchBlocks,pOutBuffer+batchStart);
+                batchBlocks = 0;
+            }
+
             #ifdef BC7_COMPDEBUGGER // Checks decompression it should match or be close to source
             union BBLOCKS
             {
@@ -595,11 +874,32 @@ CodecError CCodec_BC7::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut,
     }
 
 
+    if(batchBlocks)
+    {
+        EncodeBC7Blocks(blocksToEncode,batchBlocks,pOutBuffer+batchStart);
+    }
+
     #ifdef BC7_COMPDEBUGGER
     g_CompClient.disconnect();
     #endif
 
-    return FinishBC7Encoding();
+    err = FinishBC7Encoding();
+
+    // The time saved by the automatic mode mask is estimated from the work per block of
+    // the samples encoded with every mode against the work per block of the full encode
+    if ((err == CE_OK) && (m_SampleWorkPerBlock > 0))
+    {
+        CODECFLOAT  workPerBlock = 0;
+        GetParameter("WorkPerBlock", workPerBlock);
+
+        QueryPerformanceCounter(&encodeEndTime);
+        double encodeTime = (double)(encodeEndTime.QuadPart - encodeStartTime.QuadPart) / (double)frequency.QuadPart;
+
+        if (workPerBlock > 0)
+            m_ModeMaskTimeSaved = encodeTime * (m_SampleWorkPerBlock / workPerBlock - 1.0) - m_SampleTime;
+    }
+
+    return err;
 }
 
 
@@ -618,16 +918,15 @@ CodecError CCodec_BC7::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOu
     const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
     const CMP_DWORD dwBlocksXY = dwBlocksX*dwBlocksY;
 
+    // Whole blocks are decoded straight into RGBA8888 output, anything else
+    // goes through a local block and the buffer's own conversion
+    const bool bDirectOutput = (bufferOut.GetBufferType() == CBT_RGBA8888);
+    const CMP_DWORD dwPitch = bufferOut.GetPitch();
+
     for(CMP_DWORD j = 0; j < dwBlocksY; j++)
     {
         for(CMP_DWORD i = 0; i < dwBlocksX; i++)
         {
-            union FBLOCKS
-            {
-                double decodedBlock[16][4];
-                double destBlock[BLOCK_SIZE_4X4X4];
-            } DecData;
-
             union BBLOCKS
             {
                 CMP_DWORD    compressedBlock[4];
@@ -635,29 +934,18 @@ CodecError CCodec_BC7::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOu
                 BYTE            in[16];
             } CompData;
 
-            CMP_BYTE destBlock[BLOCK_SIZE_4X4X4];
-            
             bufferIn.ReadBlock(i*4, j*4, CompData.compressedBlock, 4);
 
-            // Encode to the appropriate location in the compressed image
-            m_decoder->DecompressBlock(DecData.decodedBlock,CompData.in);
-
-            // Create the block for decoding
-            int srcIndex = 0;
-            for(int row=0; row < BLOCK_SIZE_4; row++)
+            if(bDirectOutput && ((i+1)*4 <= bufferOut.GetWidth()) && ((j+1)*4 <= bufferOut.GetHeight()))
             {
-                for(int col=0; col<BLOCK_SIZE_4; col++)
-                {
-                    destBlock[srcIndex]   = (CMP_BYTE)DecData.decodedBlock[row*BLOCK_SIZE_4+col][BC_COMP_RED];
-                    destBlock[srcIndex+1] = (CMP_BYTE)DecData.decodedBlock[row*BLOCK_SIZE_4+col][BC_COMP_GREEN];
-                    destBlock[srcIndex+2] = (CMP_BYTE)DecData.decodedBlock[row*BLOCK_SIZE_4+col][BC_COMP_BLUE];
-                    destBlock[srcIndex+3] = (CMP_BYTE)DecData.decodedBlock[row*BLOCK_SIZE_4+col][BC_COMP_ALPHA];
-                    srcIndex+=4;
-                }
+                m_decoder->DecompressBlockRGBA8(bufferOut.GetData() + (j*4*dwPitch) + (i*4*CHANNEL_SIZE_ARGB), dwPitch, CompData.in);
+            }
+            else
+            {
+                CMP_BYTE destBlock[BLOCK_SIZE_4X4X4];
+                m_decoder->DecompressBlockRGBA8(destBlock, BLOCK_SIZE_4*CHANNEL_SIZE_ARGB, CompData.in);
+                bufferOut.WriteBlockRGBA(i*4, j*4, 4, 4, destBlock);
             }
-
-            bufferOut.WriteBlockRGBA(i*4, j*4, 4, 4, destBlock);
-
         }
 
         if (pFeedbackProc)
@@ -46,11 +46,18 @@
 #include "Codec_ATC_RGBA_Interpolated.h"
 #include "Codec_ETC_RGB.h"
 #include "Codec_ETC2_RGB.h"
+#include "Codec_ETC2_RGBA.h"
+#include "Codec_EAC_R11.h"
+#include "Codec_EAC_RG11.h"
 #include "Codec_BC6H.h"
 #include "Codec_BC7.h"
 #include "ASTC\Codec_ASTC.h"
 #include "Codec_GT.h"
 
+#ifdef USE_SSE
+#include <intrin.h>
+#endif // USE_SSE
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -90,10 +97,109 @@ bool CCodec::GetParameter(const CMP_CHAR* /*pszParamName*/, CODECFLOAT& /*fValue
     return false;
 }
 
+//
+// CPU features are detected once and filtered by the mask set with SetCPUFeatureMask.
+// Codecs with kernels picked at runtime register a dispatch procedure that fills their
+// kernel table, the procedures are run again whenever the mask changes.
+//
+#define MAX_CPU_DISPATCH_PROCS 16
+
+static CMP_DWORD        g_dwCPUFeatureMask = CMP_CPU_FEATURE_ALL;
+static CPUDispatchProc  g_pCPUDispatchProcs[MAX_CPU_DISPATCH_PROCS];
+static int              g_nCPUDispatchProcs = 0;
+
+#if defined(USE_SSE)
+// The OS must save the extended registers selected by xcr0Mask on context switches
+static bool SupportsXSaveState(int cpuInfo1ECX, unsigned __int64 xcr0Mask)
+{
+    // OSXSAVE and AVX
+    if((cpuInfo1ECX & (1 << 27)) == 0 || (cpuInfo1ECX & (1 << 28)) == 0)
+        return false;
+
+    return (_xgetbv(0) & xcr0Mask) == xcr0Mask;
+}
+#endif // USE_SSE
+
+static CMP_DWORD DetectCPUFeatures()
+{
+    CMP_DWORD dwFeatures = 0;
+#if defined(USE_SSE)
+    if(IsProcessorFeaturePresent(PF_XMMI_INSTRUCTIONS_AVAILABLE))
+        dwFeatures |= CMP_CPU_FEATURE_SSE;
+    if(IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE))
+        dwFeatures |= CMP_CPU_FEATURE_SSE2;
+
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    int nMaxLeaf = cpuInfo[0];
+    if(nMaxLeaf < 1)
+        return dwFeatures;
+
+    __cpuid(cpuInfo, 1);
+    int cpuInfo1ECX = cpuInfo[2];
+    if(cpuInfo1ECX & (1 << 19))
+        dwFeatures |= CMP_CPU_FEATURE_SSE41;
+
+    // F16C works on YMM registers, XMM and YMM state
+    bool bAVXState = SupportsXSaveState(cpuInfo1ECX, 0x6);
+    if(bAVXState && (cpuInfo1ECX & (1 << 29)))
+        dwFeatures |= CMP_CPU_FEATURE_F16C;
+
+    if(nMaxLeaf < 7)
+        return dwFeatures;
+
+    __cpuidex(cpuInfo, 7, 0);
+    if(bAVXState && (cpuInfo[1] & (1 << 5)))
+        dwFeatures |= CMP_CPU_FEATURE_AVX2;
+    if(cpuInfo[1] & (1 << 8))
+        dwFeatures |= CMP_CPU_FEATURE_BMI2;
+
+    // AVX-512F, XMM, YMM, opmask and ZMM state
+    if(SupportsXSaveState(cpuInfo1ECX, 0xE6) && (cpuInfo[1] & (1 << 16)))
+        dwFeatures |= CMP_CPU_FEATURE_AVX512;
+#endif // USE_SSE
+    return dwFeatures;
+}
+
+CMP_DWORD GetCPUFeatures()
+{
+    static const CMP_DWORD dwDetectedFeatures = DetectCPUFeatures();
+    return dwDetectedFeatures & g_dwCPUFeatureMask;
+}
+
+void SetCPUFeatureMask(CMP_DWORD dwFeatureMask)
+{
+    // Each SIMD level builds on the ones below it
+    static const CMP_DWORD dwLevels[] = {CMP_CPU_FEATURE_SSE, CMP_CPU_FEATURE_SSE2, CMP_CPU_FEATURE_SSE41,
+                                         CMP_CPU_FEATURE_AVX2, CMP_CPU_FEATURE_AVX512};
+    for(size_t i = 1; i < sizeof(dwLevels) / sizeof(dwLevels[0]); i++)
+        if((dwFeatureMask & dwLevels[i-1]) == 0)
+            dwFeatureMask &= ~dwLevels[i];
+
+    g_dwCPUFeatureMask = dwFeatureMask;
+
+    CMP_DWORD dwFeatures = GetCPUFeatures();
+    for(int i = 0; i < g_nCPUDispatchProcs; i++)
+        g_pCPUDispatchProcs[i](dwFeatures);
+}
+
+bool RegisterCPUDispatch(CPUDispatchProc pDispatchProc)
+{
+    assert(g_nCPUDispatchProcs < MAX_CPU_DISPATCH_PROCS);
+    if(pDispatchProc == NULL || g_nCPUDispatchProcs >= MAX_CPU_DISPATCH_PROCS)
+        return false;
+
+    g_pCPUDispatchProcs[g_nCPUDispatchProcs++] = pDispatchProc;
+    pDispatchProc(GetCPUFeatures());
+    return true;
+}
+
+// The Supports functions also need the kernels for the feature to be built
+
 bool SupportsSSE()
 {
 #if defined(USE_SSE)
-    return IsProcessorFeaturePresent(PF_XMMI_INSTRUCTIONS_AVAILABLE) ? true : false;
+    return (GetCPUFeatures() & CMP_CPU_FEATURE_SSE) ? true : false;
 #else
     return false;
 #endif
@@ -102,7 +208,52 @@ bool SupportsSSE()
 bool SupportsSSE2()
 {
 #if defined(USE_SSE2)
-    return IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) ? true : false;
+    return (GetCPUFeatures() & CMP_CPU_FEATURE_SSE2) ? true : false;
+#else
+    return false;
+#endif
+}
+
+bool SupportsSSE41()
+{
+#if defined(USE_SSE41)
+    return (GetCPUFeatures() & CMP_CPU_FEATURE_SSE41) ? true : false;
+#else
+    return false;
+#endif
+}
+
+bool SupportsAVX2()
+{
+#if defined(USE_AVX2)
+    return (GetCPUFeatures() & CMP_CPU_FEATURE_AVX2) ? true : false;
+#else
+    return false;
+#endif
+}
+
+bool SupportsAVX512()
+{
+#if defined(USE_AVX512)
+    return (GetCPUFeatures() & CMP_CPU_FEATURE_AVX512) ? true : false;
+#else
+    return false;
+#endif
+}
+
+bool SupportsF16C()
+{
+#if defined(USE_F16C)
+    return (GetCPUFeatures() & CMP_CPU_FEATURE_F16C) ? true : false;
+#else
+    return false;
+#endif
+}
+
+bool SupportsBMI2()
+{
+#if defined(USE_BMI2)
+    return (GetCPUFeatures() & CMP_CPU_FEATURE_BMI2) ? true : false;
 #else
     return false;
 #endif
@@ -133,6 +284,9 @@ CCodec* CreateCodec(CodecType nCodecType)
         case CT_ATC_RGBA_Interpolated:      return new CCodec_ATC_RGBA_Interpolated;
         case CT_ETC_RGB:                    return new CCodec_ETC_RGB;
         case CT_ETC2_RGB:                   return new CCodec_ETC2_RGB;
+        case CT_ETC2_RGBA:                  return new CCodec_ETC2_RGBA;
+        case CT_EAC_R11:                    return new CCodec_EAC_R11;
+        case CT_EAC_RG11:                   return new CCodec_EAC_RG11;
         case CT_BC6H:                       return new CCodec_BC6H;
         case CT_BC7:                        return new CCodec_BC7;
         case CT_ASTC:                       return new CCodec_ASTC;
@@ -160,6 +314,7 @@ CMP_DWORD CalcBufferSize(CodecType nCodecType, CMP_DWORD dwWidth, CMP_DWORD dwHe
         case CT_ATC_RGB:
         case CT_ETC_RGB:
         case CT_ETC2_RGB:
+        case CT_EAC_R11:
             dwChannels       = 1;
             dwBitsPerChannel = 4;
             dwWidth = ((dwWidth + 3) / 4) * 4;
@@ -180,6 +335,8 @@ CMP_DWORD CalcBufferSize(CodecType nCodecType, CMP_DWORD dwWidth, CMP_DWORD dwHe
         case CT_ATI2N_DXT5:
         case CT_ATC_RGBA_Explicit:
         case CT_ATC_RGBA_Interpolated:
+        case CT_ETC2_RGBA:
+        case CT_EAC_RG11:
             dwChannels       = 2;
             dwBitsPerChannel = 4;
             dwWidth = ((dwWidth + 3) / 4) * 4;
@@ -48,6 +48,9 @@ CCodec_DXT5_Swizzled::~CCodec_DXT5_Swizzled()
 
 CodecError CCodec_DXT5_Swizzled::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
 {
+    if(m_nCompressionSpeed == CMP_Speed_UltraFast)
+        return Compress_UltraFast(bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
+
 #ifndef _WIN64  //todo: add sse2 feature for win64
     if(m_nCompressionSpeed == CMP_Speed_SuperFast && m_bUseSSE2)
         return Compress_SuperFast(bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
@@ -159,6 +162,38 @@ CodecError CCodec_DXT5_Swizzled::Compress_SuperFast(CCodecBuffer& bufferIn, CCod
     return CE_OK;
 }
 
+CodecError CCodec_DXT5_Swizzled::Compress_UltraFast(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
+{
+    assert(bufferIn.GetWidth() == bufferOut.GetWidth());
+    assert(bufferIn.GetHeight() == bufferOut.GetHeight());
+
+    if(bufferIn.GetWidth() != bufferOut.GetWidth() || bufferIn.GetHeight() != bufferOut.GetHeight())
+        return CE_Unknown;
+
+    const CMP_DWORD dwBlocksX = ((bufferIn.GetWidth() + 3) >> 2);
+    const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
+
+    CMP_DWORD compressedBlock[4];
+    CMP_BYTE srcBlock[BLOCK_SIZE_4X4X4];
+    for(CMP_DWORD j = 0; j < dwBlocksY; j++)
+    {
+        for(CMP_DWORD i = 0; i < dwBlocksX; i++)
+        {
+            ReadBlock(bufferIn, i*4, j*4, srcBlock);
+            CompressRGBABlock_UltraFast(srcBlock, compressedBlock);
+            bufferOut.WriteBlock(i*4, j*4, compressedBlock, 4);
+        }
+        if(pFeedbackProc)
+        {
+            float fProgress = 100.f * (j * dwBlocksX) / (dwBlocksX * dwBlocksY);
+            if(pFeedbackProc(fProgress, pUser1, pUser2))
+                return CE_Aborted;
+        }
+    }
+
+    return CE_OK;
+}
+
 CodecError CCodec_DXT5_Swizzled::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
 {
     assert(bufferIn.GetWidth() == bufferOut.GetWidth());
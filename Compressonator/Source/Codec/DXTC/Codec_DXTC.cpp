@@ -29,6 +29,7 @@
 
 #include "Common.h"
 #include "Codec_DXTC.h"
+#include "CompressonatorXCodec.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -45,6 +46,7 @@ CCodec_DXTC::CCodec_DXTC(CodecType codecType)
     m_bUseFloat = false;
     m_b3DRefinement = false;
     m_nRefinementSteps = 1;
+    m_fRefinementEffort = DXTC_DEFAULT_REFINEMENT_EFFORT;
     m_nCompressionSpeed = CMP_Speed_SuperFast;
     m_bSwizzleChannels = false;
 }
@@ -64,6 +66,8 @@ bool CCodec_DXTC::SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue)
         m_b3DRefinement = std::stoi(sValue) > 0 ? true : false;
     else if(strcmp(pszParamName, "RefinementSteps") == 0)
         m_nRefinementSteps = (CMP_BYTE) std::stoi(sValue);
+    else if(strcmp(pszParamName, "RefinementEffort") == 0)
+        m_fRefinementEffort = std::stof(sValue);
     else if(strcmp(pszParamName, "ForceFloatPath") == 0)
         m_bUseFloat = std::stoi(sValue) > 0 ? true: false;
     else if(strcmp(pszParamName, "CompressionSpeed") == 0)
@@ -140,6 +144,8 @@ bool CCodec_DXTC::SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue)
         m_fChannelWeights[1] = m_fBaseChannelWeights[1] = fValue * fValue;
     else if(strcmp(pszParamName, "WeightB") == 0)
         m_fChannelWeights[2] = m_fBaseChannelWeights[2] = fValue * fValue;
+    else if(strcmp(pszParamName, "RefinementEffort") == 0)
+        m_fRefinementEffort = fValue;
     else
         return __super::SetParameter(pszParamName, fValue);
     return true;
@@ -153,6 +159,8 @@ bool CCodec_DXTC::GetParameter(const CMP_CHAR* pszParamName, CODECFLOAT& fValue)
         fValue = sqrt(m_fBaseChannelWeights[1]);
     else if(strcmp(pszParamName, "WeightB") == 0)
         fValue = sqrt(m_fBaseChannelWeights[2]);
+    else if(strcmp(pszParamName, "RefinementEffort") == 0)
+        fValue = m_fRefinementEffort;
     else
         return __super::GetParameter(pszParamName, fValue);
     return true;
@@ -31,6 +31,7 @@
 #include "Codec_DXTC.h"
 #include "CompressonatorXCodec.h"
 #include "dxtc_v11_compress.h"
+#include "dxtc_rangefit_compress.h"
 
 CodecError CCodec_DXTC::CompressAlphaBlock(CMP_BYTE alphaBlock[BLOCK_SIZE_4X4], CMP_DWORD compressedBlock[2])
 {
@@ -55,6 +56,12 @@ CodecError CCodec_DXTC::CompressAlphaBlock_Fast(CMP_BYTE alphaBlock[BLOCK_SIZE_4
     return CE_OK;
 }
 
+CodecError CCodec_DXTC::CompressAlphaBlock_UltraFast(CMP_BYTE alphaBlock[BLOCK_SIZE_4X4], CMP_DWORD compressedBlock[2])
+{
+    DXTCRangeFitCompressAlphaBlock(alphaBlock, compressedBlock);
+    return CE_OK;
+}
+
 CodecError CCodec_DXTC::CompressAlphaBlock(CODECFLOAT alphaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2])
 {
     BYTE nEndpoints[2][2];
@@ -0,0 +1,475 @@
+//===============================================================================
+// Copyright (c) 2007-2016  Advanced Micro Devices, Inc. All rights reserved.
+// Copyright (c) 2004-2006 ATI Technologies Inc.
+//===============================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+//  File Name:   dxtc_rangefit_compress.cpp
+//  Description: real time range fit DXTC block encoders
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Common.h"
+#include "dxtc_rangefit_compress.h"
+
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif // USE_SSE
+
+// The endpoints are pulled in by 1/16th (colour) and 1/32nd (alpha) of the block range,
+// this moves them from the extremes towards where the least squares fit would put them
+#define RANGEFIT_COLOUR_INSET_SHIFT 4
+#define RANGEFIT_ALPHA_INSET_SHIFT  5
+
+#define RANGEFIT_ALPHA_OFFSET       3
+
+// Rounds v * ((1 << nBits) - 1) / 255 to the nearest integer
+static inline int QuantizeChannel(int v, int nBits)
+{
+    int t = v * ((1 << nBits) - 1) + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+// Replicates the high bits the same way the decoder expands 565 colours
+static inline int ExpandChannel(int q, int nBits)
+{
+    return (q << (8 - nBits)) | (q >> (2 * nBits - 8));
+}
+
+static inline int InsetChannel(int nRange, int nShift)
+{
+    return (nRange >= 0) ? (nRange >> nShift) : -((-nRange) >> nShift);
+}
+
+// Moves the low 16 bits into the even bit positions
+static inline DWORD SpreadBits(DWORD x)
+{
+    x = (x | (x << 8)) & 0x00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+static void BlockMinMax(DWORD block_32[16], int nMin[4], int nMax[4])
+{
+    DWORD dwMin, dwMax;
+#ifdef USE_SSE
+    __m128i row0 = _mm_loadu_si128((__m128i*) &block_32[0]);
+    __m128i row1 = _mm_loadu_si128((__m128i*) &block_32[4]);
+    __m128i row2 = _mm_loadu_si128((__m128i*) &block_32[8]);
+    __m128i row3 = _mm_loadu_si128((__m128i*) &block_32[12]);
+
+    __m128i mn = _mm_min_epu8(_mm_min_epu8(row0, row1), _mm_min_epu8(row2, row3));
+    __m128i mx = _mm_max_epu8(_mm_max_epu8(row0, row1), _mm_max_epu8(row2, row3));
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    dwMin = (DWORD) _mm_cvtsi128_si32(mn);
+    dwMax = (DWORD) _mm_cvtsi128_si32(mx);
+#else
+    dwMin = 0xffffffff;
+    dwMax = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        DWORD dwMinTexel = 0, dwMaxTexel = 0;
+        for(int c = 0; c < 4; c++)
+        {
+            DWORD t = (block_32[i] >> (c * 8)) & 0xff;
+            dwMinTexel |= min(t, (dwMin >> (c * 8)) & 0xff) << (c * 8);
+            dwMaxTexel |= max(t, (dwMax >> (c * 8)) & 0xff) << (c * 8);
+        }
+        dwMin = dwMinTexel;
+        dwMax = dwMaxTexel;
+    }
+#endif // USE_SSE
+
+    for(int c = 0; c < 4; c++)
+    {
+        nMin[c] = (dwMin >> (c * 8)) & 0xff;
+        nMax[c] = (dwMax >> (c * 8)) & 0xff;
+    }
+}
+
+// Accumulates the cross products of the colour channels about nCentre,
+// nCov[c] holds the covariance of channels c and (c + 1) % 3
+static void BlockCovariance(DWORD block_32[16], const int nCentre[3], int nCov[3])
+{
+#ifdef USE_SSE
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i centre = _mm_setr_epi16((short) nCentre[0], (short) nCentre[1], (short) nCentre[2], 0,
+                                          (short) nCentre[0], (short) nCentre[1], (short) nCentre[2], 0);
+    const __m128i even   = _mm_setr_epi16(-1, 0, -1, 0, -1, 0, -1, 0);
+    const __m128i odd    = _mm_setr_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+    const __m128i keep   = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+
+    // With v = (c0, c1, c2, 0) and w = (c1, c2, c0, 0) the even lanes of v * w give
+    // c0c1 and c2c0 and the odd lanes give c1c2, madd widens each product to 32 bits
+    __m128i accEven = zero;
+    __m128i accOdd  = zero;
+    for(int i = 0; i < 16; i += 4)
+    {
+        __m128i row = _mm_loadu_si128((__m128i*) &block_32[i]);
+        for(int half = 0; half < 2; half++)
+        {
+            __m128i v = half ? _mm_unpackhi_epi8(row, zero) : _mm_unpacklo_epi8(row, zero);
+            v = _mm_and_si128(_mm_sub_epi16(v, centre), keep);
+            __m128i w = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 2, 1)), _MM_SHUFFLE(3, 0, 2, 1));
+            accEven = _mm_add_epi32(accEven, _mm_madd_epi16(_mm_and_si128(v, even), w));
+            accOdd  = _mm_add_epi32(accOdd,  _mm_madd_epi16(_mm_and_si128(v, odd),  w));
+        }
+    }
+
+    int nEven[4], nOdd[4];
+    _mm_storeu_si128((__m128i*) nEven, accEven);
+    _mm_storeu_si128((__m128i*) nOdd, accOdd);
+    nCov[0] = nEven[0] + nEven[2];
+    nCov[1] = nOdd[0] + nOdd[2];
+    nCov[2] = nEven[1] + nEven[3];
+#else
+    nCov[0] = nCov[1] = nCov[2] = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        int v[3];
+        for(int c = 0; c < 3; c++)
+            v[c] = (int) ((block_32[i] >> (c * 8)) & 0xff) - nCentre[c];
+        for(int c = 0; c < 3; c++)
+            nCov[c] += v[c] * v[(c + 1) % 3];
+    }
+#endif // USE_SSE
+}
+
+// Scalar covariance over the texels set in dwMask, used for the punch through alpha blocks
+static void BlockCovarianceMasked(DWORD block_32[16], DWORD dwMask, const int nCentre[3], int nCov[3])
+{
+    nCov[0] = nCov[1] = nCov[2] = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        if(!(dwMask & (1 << i)))
+            continue;
+
+        int v[3];
+        for(int c = 0; c < 3; c++)
+            v[c] = (int) ((block_32[i] >> (c * 8)) & 0xff) - nCentre[c];
+        for(int c = 0; c < 3; c++)
+            nCov[c] += v[c] * v[(c + 1) % 3];
+    }
+}
+
+// Turns the bounding box into a pair of quantized endpoints. The diagonal follows the sign of the
+// covariance of each channel against the channel with the largest extent, the endpoints are then
+// inset and rounded to 565. nColour receives the packed colours and nEndpoints their 8 bit expansion.
+static void RangeFitEndpoints(int nMin[3], int nMax[3], const int nCov[3], int nRedOffset,
+                              int nColour[2], int nEndpoints[2][3])
+{
+    int nRef = 0;
+    for(int c = 1; c < 3; c++)
+        if(nMax[c] - nMin[c] > nMax[nRef] - nMin[nRef])
+            nRef = c;
+
+    // nCov[c] pairs channel c with channel (c + 1) % 3
+    int nCovRef[3];
+    nCovRef[nRef]           = 1;
+    nCovRef[(nRef + 1) % 3] = nCov[nRef];
+    nCovRef[(nRef + 2) % 3] = nCov[(nRef + 2) % 3];
+
+    int nLo[3], nHi[3];
+    for(int c = 0; c < 3; c++)
+    {
+        nLo[c] = (nCovRef[c] < 0) ? nMax[c] : nMin[c];
+        nHi[c] = (nCovRef[c] < 0) ? nMin[c] : nMax[c];
+
+        int nInset = InsetChannel(nHi[c] - nLo[c], RANGEFIT_COLOUR_INSET_SHIFT);
+        nLo[c] += nInset;
+        nHi[c] -= nInset;
+    }
+
+    // Red and blue are both 5 bits wide whichever way round they are, green is 6
+    int q[2][3];
+    q[0][0] = QuantizeChannel(nLo[0], 5);
+    q[0][1] = QuantizeChannel(nLo[1], 6);
+    q[0][2] = QuantizeChannel(nLo[2], 5);
+    q[1][0] = QuantizeChannel(nHi[0], 5);
+    q[1][1] = QuantizeChannel(nHi[1], 6);
+    q[1][2] = QuantizeChannel(nHi[2], 5);
+
+    const int nBlueOffset = 2 - nRedOffset;
+    for(int e = 0; e < 2; e++)
+    {
+        nEndpoints[e][0] = ExpandChannel(q[e][0], 5);
+        nEndpoints[e][1] = ExpandChannel(q[e][1], 6);
+        nEndpoints[e][2] = ExpandChannel(q[e][2], 5);
+        nColour[e] = (q[e][nRedOffset] << 11) | (q[e][1] << 5) | q[e][nBlueOffset];
+    }
+}
+
+// Picks the nearest of the four ramp colours by projecting each texel onto e0 -> e1.
+// The rounded ramp position k = round(3 * t / |d|^2) is found by comparing 6t against
+// |d|^2, 3|d|^2 and 5|d|^2, and ramp positions 0, 1, 2, 3 map to the DXT indices 0, 2, 3, 1.
+static DWORD RangeFitIndices4(DWORD block_32[16], const int e0[3], const int e1[3])
+{
+    int d[3];
+    for(int c = 0; c < 3; c++)
+        d[c] = e1[c] - e0[c];
+
+    const int nDot  = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    const int nBase = e0[0] * d[0] + e0[1] * d[1] + e0[2] * d[2];
+
+    DWORD dwBit0 = 0, dwBit1 = 0;
+#ifdef USE_SSE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i dir  = _mm_setr_epi16((short) d[0], (short) d[1], (short) d[2], 0,
+                                        (short) d[0], (short) d[1], (short) d[2], 0);
+    const __m128i base = _mm_set1_epi32(nBase);
+    const __m128i thr1 = _mm_set1_epi32(nDot - 1);
+    const __m128i thr3 = _mm_set1_epi32(3 * nDot - 1);
+    const __m128i thr5 = _mm_set1_epi32(5 * nDot - 1);
+
+    for(int i = 0; i < 16; i += 4)
+    {
+        __m128i row = _mm_loadu_si128((__m128i*) &block_32[i]);
+        __m128 lo = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(row, zero), dir));
+        __m128 hi = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(row, zero), dir));
+
+        // madd leaves (c0d0 + c1d1, c2d2) per texel, add the pairs to get the four dot products
+        __m128i dot = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))),
+                                    _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))));
+        __m128i t = _mm_sub_epi32(dot, base);
+        t = _mm_add_epi32(_mm_slli_epi32(t, 2), _mm_slli_epi32(t, 1));
+
+        __m128i k1 = _mm_cmpgt_epi32(t, thr1);
+        __m128i k2 = _mm_cmpgt_epi32(t, thr3);
+        __m128i k3 = _mm_cmpgt_epi32(t, thr5);
+
+        dwBit0 |= _mm_movemask_ps(_mm_castsi128_ps(k2)) << i;
+        dwBit1 |= _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(k3, k1))) << i;
+    }
+#else
+    for(int i = 0; i < 16; i++)
+    {
+        int t = -nBase;
+        for(int c = 0; c < 3; c++)
+            t += (int) ((block_32[i] >> (c * 8)) & 0xff) * d[c];
+        t *= 6;
+
+        if(t >= 3 * nDot)
+            dwBit0 |= 1 << i;
+        if(t >= nDot && t < 5 * nDot)
+            dwBit1 |= 1 << i;
+    }
+#endif // USE_SSE
+
+    return SpreadBits(dwBit0) | (SpreadBits(dwBit1) << 1);
+}
+
+// DXT1 blocks with transparent texels use the three colour mode, colour0 <= colour1,
+// with index 3 for the transparent texels
+static void RangeFitCompressPunchThrough(DWORD block_32[16], DWORD block_dxtc[2], int nRedOffset, BYTE nAlphaThreshold)
+{
+    DWORD dwOpaque = 0;
+    int nMin[3] = {255, 255, 255};
+    int nMax[3] = {0, 0, 0};
+    for(int i = 0; i < 16; i++)
+    {
+        if((block_32[i] >> 24) < nAlphaThreshold)
+            continue;
+
+        dwOpaque |= 1 << i;
+        for(int c = 0; c < 3; c++)
+        {
+            int t = (block_32[i] >> (c * 8)) & 0xff;
+            nMin[c] = min(nMin[c], t);
+            nMax[c] = max(nMax[c], t);
+        }
+    }
+
+    if(!dwOpaque)
+    {
+        block_dxtc[0] = 0;
+        block_dxtc[1] = 0xffffffff;
+        return;
+    }
+
+    int nCentre[3], nCov[3];
+    for(int c = 0; c < 3; c++)
+        nCentre[c] = (nMin[c] + nMax[c]) >> 1;
+    BlockCovarianceMasked(block_32, dwOpaque, nCentre, nCov);
+
+    int nColour[2], nEndpoints[2][3];
+    RangeFitEndpoints(nMin, nMax, nCov, nRedOffset, nColour, nEndpoints);
+
+    int e0 = (nColour[0] <= nColour[1]) ? 0 : 1;
+    block_dxtc[0] = nColour[e0] | (nColour[e0 ^ 1] << 16);
+
+    int d[3];
+    for(int c = 0; c < 3; c++)
+        d[c] = nEndpoints[e0 ^ 1][c] - nEndpoints[e0][c];
+    const int nDot = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+
+    // Ramp positions 0, 1, 2 map to the DXT indices 0, 2, 1
+    static const DWORD dwRampIndex[3] = {0, 2, 1};
+    DWORD dwIndices = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        DWORD dwIndex = 3;
+        if(dwOpaque & (1 << i))
+        {
+            int t = 0;
+            for(int c = 0; c < 3; c++)
+                t += ((int) ((block_32[i] >> (c * 8)) & 0xff) - nEndpoints[e0][c]) * d[c];
+            t *= 4;
+            dwIndex = dwRampIndex[(t >= nDot) + (t >= 3 * nDot)];
+            if(nDot == 0)
+                dwIndex = 0;
+        }
+        dwIndices |= dwIndex << (2 * i);
+    }
+    block_dxtc[1] = dwIndices;
+}
+
+void DXTCRangeFitCompressBlock(DWORD block_32[16], DWORD block_dxtc[2], int nRedOffset,
+                               bool bDXT1UseAlpha, BYTE nAlphaThreshold)
+{
+    int nMin[4], nMax[4];
+    BlockMinMax(block_32, nMin, nMax);
+
+    if(bDXT1UseAlpha && nMin[RANGEFIT_ALPHA_OFFSET] < nAlphaThreshold)
+    {
+        RangeFitCompressPunchThrough(block_32, block_dxtc, nRedOffset, nAlphaThreshold);
+        return;
+    }
+
+    int nCentre[3], nCov[3];
+    for(int c = 0; c < 3; c++)
+        nCentre[c] = (nMin[c] + nMax[c]) >> 1;
+    BlockCovariance(block_32, nCentre, nCov);
+
+    int nColour[2], nEndpoints[2][3];
+    RangeFitEndpoints(nMin, nMax, nCov, nRedOffset, nColour, nEndpoints);
+
+    // Solid blocks, or ones that quantize to a single colour, only need index 0
+    if(nColour[0] == nColour[1])
+    {
+        block_dxtc[0] = nColour[0] | (nColour[0] << 16);
+        block_dxtc[1] = 0;
+        return;
+    }
+
+    // The four colour mode needs colour0 > colour1
+    int e0 = (nColour[0] > nColour[1]) ? 0 : 1;
+    block_dxtc[0] = nColour[e0] | (nColour[e0 ^ 1] << 16);
+    block_dxtc[1] = RangeFitIndices4(block_32, nEndpoints[e0], nEndpoints[e0 ^ 1]);
+}
+
+// Eight value alpha block with alpha0 = max and alpha1 = min. The ramp position
+// t = round(7 * (a - min) / range) counts how many of the thresholds (2k - 1) * range
+// 14 * (a - min) reaches, and positions 0..7 map to the indices 1, 7, 6, .. 2, 0.
+void DXTCRangeFitCompressAlphaBlock(BYTE block_8[16], DWORD block_dxtc[2])
+{
+    int nMin, nMax;
+#ifdef USE_SSE
+    __m128i alpha = _mm_loadu_si128((__m128i*) block_8);
+    __m128i mn = _mm_min_epu8(alpha, _mm_srli_si128(alpha, 8));
+    __m128i mx = _mm_max_epu8(alpha, _mm_srli_si128(alpha, 8));
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 4));
+    mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 4));
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 2));
+    mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 2));
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 1));
+    mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 1));
+    nMin = _mm_cvtsi128_si32(mn) & 0xff;
+    nMax = _mm_cvtsi128_si32(mx) & 0xff;
+#else
+    nMin = 255;
+    nMax = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        nMin = min(nMin, (int) block_8[i]);
+        nMax = max(nMax, (int) block_8[i]);
+    }
+#endif // USE_SSE
+
+    if(nMin == nMax)
+    {
+        block_dxtc[0] = nMax | (nMax << 8);
+        block_dxtc[1] = 0;
+        return;
+    }
+
+    int nInset = (nMax - nMin) >> RANGEFIT_ALPHA_INSET_SHIFT;
+    nMin += nInset;
+    nMax -= nInset;
+    const int nRange = nMax - nMin;
+
+    BYTE nIndices[16];
+#ifdef USE_SSE
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i base  = _mm_set1_epi16((short) nMin);
+    const __m128i scale = _mm_set1_epi16(14);
+    __m128i v[2];
+    __m128i t[2];
+    v[0] = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(alpha, zero), base), scale);
+    v[1] = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(alpha, zero), base), scale);
+    t[0] = t[1] = zero;
+    for(int k = 1; k < 8; k++)
+    {
+        __m128i thr = _mm_set1_epi16((short) ((2 * k - 1) * nRange - 1));
+        t[0] = _mm_sub_epi16(t[0], _mm_cmpgt_epi16(v[0], thr));
+        t[1] = _mm_sub_epi16(t[1], _mm_cmpgt_epi16(v[1], thr));
+    }
+
+    const __m128i eight = _mm_set1_epi16(8);
+    const __m128i seven = _mm_set1_epi16(7);
+    const __m128i two   = _mm_set1_epi16(2);
+    const __m128i one   = _mm_set1_epi16(1);
+    for(int h = 0; h < 2; h++)
+    {
+        t[h] = _mm_and_si128(_mm_sub_epi16(eight, t[h]), seven);
+        t[h] = _mm_xor_si128(t[h], _mm_and_si128(_mm_cmplt_epi16(t[h], two), one));
+    }
+    _mm_storeu_si128((__m128i*) nIndices, _mm_packus_epi16(t[0], t[1]));
+#else
+    for(int i = 0; i < 16; i++)
+    {
+        int v = ((int) block_8[i] - nMin) * 14;
+        int t = 0;
+        for(int k = 1; k < 8; k++)
+            t += (v >= (2 * k - 1) * nRange);
+
+        int nIndex = (8 - t) & 7;
+        nIndices[i] = (BYTE) (nIndex < 2 ? nIndex ^ 1 : nIndex);
+    }
+#endif // USE_SSE
+
+    // 24 bits of indices for each half of the block, the first half follows alpha0 and alpha1
+    DWORD dwLo = 0, dwHi = 0;
+    for(int i = 0; i < 8; i++)
+    {
+        dwLo |= nIndices[i] << (3 * i);
+        dwHi |= nIndices[i + 8] << (3 * i);
+    }
+
+    block_dxtc[0] = nMax | (nMin << 8) | (dwLo << 16);
+    block_dxtc[1] = (dwLo >> 16) | (dwHi << 8);
+}
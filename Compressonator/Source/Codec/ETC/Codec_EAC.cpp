@@ -0,0 +1,171 @@
+//===============================================================================
+// Copyright (c) 2007-2016  Advanced Micro Devices, Inc. All rights reserved.
+// Copyright (c) 2004-2006 ATI Technologies Inc.
+//===============================================================================
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+//  File Name:   Codec_EAC.cpp
+//  Description: implementation of the CCodec_EAC class
+//
+//////////////////////////////////////////////////////////////////////////////
+#pragma warning(disable:4100)
+
+#include "Common.h"
+#include "Codec_EAC.h"
+#include "etcpack.h"
+
+
+CCodec_EAC::CCodec_EAC(CodecType codecType, CMP_DWORD dwChannels) :
+CCodec_Block_4x4(codecType)
+{
+    m_dwChannels    = dwChannels;
+    m_eQuality      = ETC_QUALITY_FAST;
+    m_dwNumThreads  = 0;
+}
+
+CCodec_EAC::~CCodec_EAC()
+{
+}
+
+bool CCodec_EAC::SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue)
+{
+    if (sValue == NULL) return false;
+
+    if(strcmp(pszParamName, "Quality") == 0)
+    {
+        float fQuality = std::stof(sValue);
+        if ((fQuality < 0) || (fQuality > 1.0))
+            return false;
+        m_eQuality = atiGetQualityETC(fQuality);
+    }
+    else
+    if(strcmp(pszParamName, "NumThreads") == 0)
+        m_dwNumThreads = (CMP_DWORD) std::stoi(sValue);
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, sValue);
+    return true;
+}
+
+bool CCodec_EAC::SetParameter(const CMP_CHAR* pszParamName, CMP_DWORD dwValue)
+{
+    if(strcmp(pszParamName, "NumThreads") == 0)
+        m_dwNumThreads = dwValue;
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, dwValue);
+    return true;
+}
+
+bool CCodec_EAC::SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue)
+{
+    if(strcmp(pszParamName, "Quality") == 0)
+        m_eQuality = atiGetQualityETC(fValue);
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, fValue);
+    return true;
+}
+
+CodecError CCodec_EAC::Compress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
+{
+    assert(bufferIn.GetWidth() == bufferOut.GetWidth());
+    assert(bufferIn.GetHeight() == bufferOut.GetHeight());
+
+    if(bufferIn.GetWidth() != bufferOut.GetWidth() || bufferIn.GetHeight() != bufferOut.GetHeight())
+        return CE_Unknown;
+
+    return atiCompressBlocksETC(this, CompressBlockProc, m_dwChannels * 2, m_dwNumThreads, bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
+}
+
+CodecError CCodec_EAC::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
+{
+    assert(bufferIn.GetWidth() == bufferOut.GetWidth());
+    assert(bufferIn.GetHeight() == bufferOut.GetHeight());
+
+    if(bufferIn.GetWidth() != bufferOut.GetWidth() || bufferIn.GetHeight() != bufferOut.GetHeight())
+        return CE_Unknown;
+
+    setupAlphaTable();
+
+    const CMP_DWORD dwBlocksX = ((bufferIn.GetWidth() + 3) >> 2);
+    const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
+    const CMP_DWORD dwBlocksXY = dwBlocksX*dwBlocksY;
+
+    CMP_DWORD compressedBlock[4];
+    CMP_BYTE destBlock[BLOCK_SIZE_4X4X4];
+    for(CMP_DWORD j = 0; j < dwBlocksY; j++)
+    {
+        for(CMP_DWORD i = 0; i < dwBlocksX; i++)
+        {
+            bufferIn.ReadBlock(i*4, j*4, compressedBlock, m_dwChannels * 2);
+            DecompressBlock(destBlock, compressedBlock);
+            bufferOut.WriteBlockRGBA(i*4, j*4, 4, 4, destBlock);
+        }
+
+        if (pFeedbackProc)
+        {
+            float fProgress = 100.f * (j * dwBlocksX) / dwBlocksXY;
+            if (pFeedbackProc(fProgress, pUser1, pUser2))
+            {
+                return CE_Aborted;
+            }
+        }
+    }
+
+    return CE_OK;
+}
+
+CodecError CCodec_EAC::CompressBlockProc(CCodec* pCodec, CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4])
+{
+    return ((CCodec_EAC*) pCodec)->CompressBlock(rgbaBlock, compressedBlock);
+}
+
+// The 8 bit channels are bit replicated to the 16 bits the 11 bit search works in
+CodecError CCodec_EAC::CompressBlock(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4])
+{
+    static const CMP_DWORD dwChannelOffset[2] = { RGBA8888_CHANNEL_R, RGBA8888_CHANNEL_G };
+
+    CMP_WORD channelBlock[BLOCK_SIZE_4X4];
+    for (CMP_DWORD c = 0; c < m_dwChannels; c++)
+    {
+        for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+            channelBlock[i] = (CMP_WORD)(rgbaBlock[(i * 4) + dwChannelOffset[c]] * 257);
+        atiEncodeR11BlockEAC(channelBlock, (CMP_BYTE*)&compressedBlock[c * 2], m_eQuality);
+    }
+
+    return CE_OK;
+}
+
+// R11 is shown as grey like ATI1N, RG11 as red and green like ATI2N
+void CCodec_EAC::DecompressBlock(CMP_BYTE rgbaBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[4])
+{
+    CMP_WORD channelBlock[2][BLOCK_SIZE_4X4];
+    for (CMP_DWORD c = 0; c < m_dwChannels; c++)
+        atiDecodeR11BlockEAC(channelBlock[c], (CMP_BYTE*)&compressedBlock[c * 2]);
+
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        CMP_BYTE cRed   = (CMP_BYTE)((channelBlock[0][i] * 255 + 32767) / 65535);
+        CMP_BYTE cGreen = (m_dwChannels > 1) ? (CMP_BYTE)((channelBlock[1][i] * 255 + 32767) / 65535) : cRed;
+        rgbaBlock[(i * 4) + RGBA8888_CHANNEL_R] = cRed;
+        rgbaBlock[(i * 4) + RGBA8888_CHANNEL_G] = cGreen;
+        rgbaBlock[(i * 4) + RGBA8888_CHANNEL_B] = (m_dwChannels > 1) ? 0 : cRed;
+        rgbaBlock[(i * 4) + RGBA8888_CHANNEL_A] = 255;
+    }
+}
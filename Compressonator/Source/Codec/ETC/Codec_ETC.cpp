@@ -40,6 +40,8 @@
 CCodec_ETC::CCodec_ETC(CodecType codecType) :
 CCodec_Block_4x4(codecType)
 {
+    m_eQuality      = ETC_QUALITY_FAST;
+    m_dwNumThreads  = 0;
 }
 
 CCodec_ETC::~CCodec_ETC()
@@ -47,6 +49,48 @@ CCodec_ETC::~CCodec_ETC()
 
 }
 
+bool CCodec_ETC::SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue)
+{
+    if (sValue == NULL) return false;
+
+    if(strcmp(pszParamName, "Quality") == 0)
+    {
+        float fQuality = std::stof(sValue);
+        if ((fQuality < 0) || (fQuality > 1.0))
+            return false;
+        m_eQuality = atiGetQualityETC(fQuality);
+    }
+    else
+    if(strcmp(pszParamName, "NumThreads") == 0)
+        m_dwNumThreads = (CMP_DWORD) std::stoi(sValue);
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, sValue);
+    return true;
+}
+
+bool CCodec_ETC::SetParameter(const CMP_CHAR* pszParamName, CMP_DWORD dwValue)
+{
+    if(strcmp(pszParamName, "NumThreads") == 0)
+        m_dwNumThreads = dwValue;
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, dwValue);
+    return true;
+}
+
+bool CCodec_ETC::SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue)
+{
+    if(strcmp(pszParamName, "Quality") == 0)
+        m_eQuality = atiGetQualityETC(fValue);
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, fValue);
+    return true;
+}
+
+CodecError CCodec_ETC::CompressRGBBlockProc(CCodec* pCodec, CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2])
+{
+    return ((CCodec_ETC*) pCodec)->CompressRGBBlock(rgbBlock, compressedBlock);
+}
+
 #define SWIZZLE_DWORD(i) ((((i >> 24) & BYTE_MASK)) | (((i >> 16) & BYTE_MASK) << 8) | (((i >> 8) & BYTE_MASK) << 16) | ((i & BYTE_MASK) << 24))
 
 CodecError CCodec_ETC::CompressRGBBlock(CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2])
@@ -63,7 +107,7 @@ CodecError CCodec_ETC::CompressRGBBlock(CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP
     }
 
     unsigned int uiCompressedBlockHi, uiCompressedBlockLo;
-    atiEncodeRGBBlockETC((unsigned char *) &srcRGB, &uiCompressedBlockHi, &uiCompressedBlockLo);
+    atiEncodeRGBBlockETC((unsigned char *) &srcRGB, &uiCompressedBlockHi, &uiCompressedBlockLo, m_eQuality);
     compressedBlock[0] = SWIZZLE_DWORD(uiCompressedBlockHi);
     compressedBlock[1] = SWIZZLE_DWORD(uiCompressedBlockLo);
 
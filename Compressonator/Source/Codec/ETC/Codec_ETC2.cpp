@@ -40,12 +40,56 @@
 CCodec_ETC2::CCodec_ETC2(CodecType codecType) :
 CCodec_Block_4x4(codecType)
 {
+    m_eQuality      = ETC_QUALITY_FAST;
+    m_dwNumThreads  = 0;
 }
 
 CCodec_ETC2::~CCodec_ETC2()
 {
 }
 
+bool CCodec_ETC2::SetParameter(const CMP_CHAR* pszParamName, CMP_CHAR* sValue)
+{
+    if (sValue == NULL) return false;
+
+    if(strcmp(pszParamName, "Quality") == 0)
+    {
+        float fQuality = std::stof(sValue);
+        if ((fQuality < 0) || (fQuality > 1.0))
+            return false;
+        m_eQuality = atiGetQualityETC(fQuality);
+    }
+    else
+    if(strcmp(pszParamName, "NumThreads") == 0)
+        m_dwNumThreads = (CMP_DWORD) std::stoi(sValue);
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, sValue);
+    return true;
+}
+
+bool CCodec_ETC2::SetParameter(const CMP_CHAR* pszParamName, CMP_DWORD dwValue)
+{
+    if(strcmp(pszParamName, "NumThreads") == 0)
+        m_dwNumThreads = dwValue;
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, dwValue);
+    return true;
+}
+
+bool CCodec_ETC2::SetParameter(const CMP_CHAR* pszParamName, CODECFLOAT fValue)
+{
+    if(strcmp(pszParamName, "Quality") == 0)
+        m_eQuality = atiGetQualityETC(fValue);
+    else
+        return CCodec_Block_4x4::SetParameter(pszParamName, fValue);
+    return true;
+}
+
+CodecError CCodec_ETC2::CompressRGBBlockProc(CCodec* pCodec, CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CMP_DWORD compressedBlock[2])
+{
+    return ((CCodec_ETC2*) pCodec)->CompressRGBBlock(rgbBlock, compressedBlock);
+}
+
 #define SWIZZLE_DWORD(i) ((((i >> 24) & BYTE_MASK)) | (((i >> 16) & BYTE_MASK) << 8) | (((i >> 8) & BYTE_MASK) << 16) | ((i & BYTE_MASK) << 24))
 
 
@@ -56,18 +100,38 @@ void atiEncodeRGBBlockETC2(
     unsigned char *pPixels,         //Color888_t(* pPixels)[ 4 ] [ 4 ],
     unsigned int *pCompressed1,     // Return value
     unsigned int *pCompressed2,     // Return value
-    bool          fast = true      // Mode to use fast or slow
+    ETC_QUALITY   eQuality
 )
 {
     unsigned int compressed1, compressed2;       // Used to interface C's (unsigned int*) to C++'s &(unsigned int)
     unsigned char tmp[4 * 4 * 3];                // 
 
-    if (fast)
+    switch (eQuality)
     {
+    case ETC_QUALITY_EXHAUSTIVE:
+        compressBlockETC2ExhaustivePerceptual((uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, compressed1, compressed2);
+        break;
+    case ETC_QUALITY_MEDIUM:
+        {
+            // Keep the exhaustive ETC1 encoding when it beats the fast search of all the modes
+            unsigned int etc1Compressed1, etc1Compressed2;
+            compressBlockETC2FastPerceptual((uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, compressed1, compressed2);
+            decompressBlockETC2(compressed1, compressed2, (uint8 *)tmp, 4, 4, 0, 0);
+            double fError = calcBlockPerceptualErrorRGB((uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0);
+
+            compressBlockETC1ExhaustivePerceptual((uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, etc1Compressed1, etc1Compressed2);
+            decompressBlockETC2(etc1Compressed1, etc1Compressed2, (uint8 *)tmp, 4, 4, 0, 0);
+            if (calcBlockPerceptualErrorRGB((uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0) < fError)
+            {
+                compressed1 = etc1Compressed1;
+                compressed2 = etc1Compressed2;
+            }
+        }
+        break;
+    default:
         compressBlockETC2FastPerceptual((uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, compressed1, compressed2);
+        break;
     }
-    else
-        compressBlockETC2ExhaustivePerceptual((uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, compressed1, compressed2);
 
     *pCompressed1 = compressed1;
     *pCompressed2 = compressed2;
@@ -99,7 +163,7 @@ CodecError CCodec_ETC2::CompressRGBBlock(CMP_BYTE rgbBlock[BLOCK_SIZE_4X4X4], CM
     }
 
     unsigned int uiCompressedBlockHi, uiCompressedBlockLo;
-    atiEncodeRGBBlockETC2((unsigned char *)&srcRGB, &uiCompressedBlockHi, &uiCompressedBlockLo);
+    atiEncodeRGBBlockETC2((unsigned char *)&srcRGB, &uiCompressedBlockHi, &uiCompressedBlockLo, m_eQuality);
 
     compressedBlock[0] = SWIZZLE_DWORD(uiCompressedBlockHi);
     compressedBlock[1] = SWIZZLE_DWORD(uiCompressedBlockLo);
@@ -31,7 +31,7 @@
 #include "Common.h"
 #include "Codec_ETC2_RGB.h"
 #include "Compressonator_tc.h"
-#include "etcpack_lib.h"
+#include "etcpack.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -63,30 +63,7 @@ CodecError CCodec_ETC2_RGB::Compress(CCodecBuffer& bufferIn, CCodecBuffer& buffe
     if(bufferIn.GetWidth() != bufferOut.GetWidth() || bufferIn.GetHeight() != bufferOut.GetHeight())
         return CE_Unknown;
 
-    readCompressParams();
-
-    const CMP_DWORD dwBlocksX = ((bufferIn.GetWidth() + 3) >> 2);
-    const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
-
-    CMP_BYTE srcBlock[BLOCK_SIZE_4X4X4];
-    CMP_DWORD compressedBlock[2];
-    for(CMP_DWORD j = 0; j < dwBlocksY; j++)
-    {
-        for(CMP_DWORD i = 0; i < dwBlocksX; i++)
-        {
-            bufferIn.ReadBlockRGBA(i*4, j*4, 4, 4, srcBlock);
-            CompressRGBBlock(srcBlock, compressedBlock);
-            bufferOut.WriteBlock(i*4, j*4, compressedBlock, 2);
-        }
-        if(pFeedbackProc)
-        {
-            float fProgress = 100.f * (j * dwBlocksX) / (dwBlocksX * dwBlocksY);
-            if(pFeedbackProc(fProgress, pUser1, pUser2))
-                return CE_Aborted;
-        }
-    }
-
-    return CE_OK;
+    return atiCompressBlocksETC(this, CCodec_ETC2::CompressRGBBlockProc, 2, m_dwNumThreads, bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
 }
 
 CodecError CCodec_ETC2_RGB::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& bufferOut, Codec_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2)
@@ -97,6 +74,9 @@ CodecError CCodec_ETC2_RGB::Decompress(CCodecBuffer& bufferIn, CCodecBuffer& buf
     if(bufferIn.GetWidth() != bufferOut.GetWidth() || bufferIn.GetHeight() != bufferOut.GetHeight())
         return CE_Unknown;
 
+    if (bufferOut.GetBufferType() == CBT_RGBA8888)
+        return atiDecompressBlocksETC(CT_ETC2_RGB, m_dwNumThreads, bufferIn, bufferOut, pFeedbackProc, pUser1, pUser2);
+
     const CMP_DWORD dwBlocksX = ((bufferIn.GetWidth() + 3) >> 2);
     const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
     const CMP_DWORD dwBlocksXY = dwBlocksX*dwBlocksY;
@@ -0,0 +1,500 @@
+//===============================================================================
+// Copyright (c) 2007-2016  Advanced Micro Devices, Inc. All rights reserved.
+// Copyright (c) 2004-2006 ATI Technologies Inc.
+//===============================================================================
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+//  File Name:   eac.cpp
+//  Description: EAC block encoders and decoders for the ETC2 RGBA8 alpha
+//               channel and the R11 / RG11 formats
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <float.h>
+#include <limits.h>
+#include "Common.h"
+#include "etcpack.h"
+
+#ifdef USE_SSE
+#include <emmintrin.h>
+#endif // USE_SSE
+
+// The 16 modifier tables, etcdec.cxx
+extern int alphaBase[16][4];
+
+#define EAC_NUM_TABLES          16
+#define EAC_NUM_MULTIPLIERS     16
+#define EAC_NUM_BASES           256
+
+// Base values searched in steps of this size by the fast and medium tiers,
+// then refined one at a time around the best one
+#define EAC_FAST_BASE_STEP      8
+#define EAC_MEDIUM_BASE_STEP    4
+
+// One table scaled by a multiplier, the 8 offsets from the base value
+typedef struct
+{
+    int     nTable;
+    int     nMultiplier;
+    int     nModifier[8];
+    int     nMinModifier;
+    int     nMaxModifier;
+#ifdef USE_SSE
+    __m128i addModifier[8];     // Alpha, positive offsets in every byte
+    __m128i subModifier[8];     // Alpha, negated negative offsets in every byte
+    __m128i modifier;           // R11, the 8 offsets as 16 bit lanes
+#endif // USE_SSE
+} EAC_TABLE;
+
+// The 4 negative and 4 positive offsets of each table in index order
+static inline int EACModifier(int nTable, int nIndex)
+{
+    return (nIndex < 4) ? alphaBase[nTable][3 - nIndex] : -alphaBase[nTable][7 - nIndex] - 1;
+}
+
+static void SetupTableEAC(EAC_TABLE& table, int nTable, int nMultiplier, bool bR11)
+{
+    table.nTable       = nTable;
+    table.nMultiplier  = nMultiplier;
+    table.nMinModifier = INT_MAX;
+    table.nMaxModifier = INT_MIN;
+    for (int i = 0; i < 8; i++)
+    {
+        int nModifier = EACModifier(nTable, i);
+        if (bR11)
+            nModifier = (nMultiplier == 0) ? nModifier : nModifier * nMultiplier * 8;
+        else
+            nModifier *= nMultiplier;
+
+        table.nModifier[i]  = nModifier;
+        table.nMinModifier  = min(table.nMinModifier, nModifier);
+        table.nMaxModifier  = max(table.nMaxModifier, nModifier);
+#ifdef USE_SSE
+        if (!bR11)
+        {
+            table.addModifier[i] = _mm_set1_epi8((char)(nModifier > 0 ? nModifier : 0));
+            table.subModifier[i] = _mm_set1_epi8((char)(nModifier < 0 ? -nModifier : 0));
+        }
+#endif // USE_SSE
+    }
+#ifdef USE_SSE
+    if (bR11)
+        table.modifier = _mm_setr_epi16((short)table.nModifier[0], (short)table.nModifier[1], (short)table.nModifier[2], (short)table.nModifier[3],
+                                        (short)table.nModifier[4], (short)table.nModifier[5], (short)table.nModifier[6], (short)table.nModifier[7]);
+#endif // USE_SSE
+}
+
+// The value the decoder produces, the 11 bit values are replicated to 16 bits like get16bits11bits()
+static inline int DecodeAlphaEAC(int nBase, int nModifier)
+{
+    return min(max(nBase + nModifier, 0), 255);
+}
+
+static inline int DecodeR11EAC(int nBase, int nModifier)
+{
+    int nValue = min(max(nBase * 8 + 4 + nModifier, 0), 2047);
+    return (nValue << 5) | (nValue >> 6);
+}
+
+// The pixels of one block with the bounds of its values
+typedef struct
+{
+    int     nPixel[BLOCK_SIZE_4X4];
+    int     nMin;
+    int     nMax;
+#ifdef USE_SSE
+    __m128i pixels[2];          // 16 bytes for alpha, 2 x 8 words for R11
+#endif // USE_SSE
+} EAC_BLOCK;
+
+//-------------------------------------------------------------------------
+// Sum of the squared errors of every pixel against the closest of the 8
+// values. The SSE2 paths test all the pixels against one value at a time.
+//-------------------------------------------------------------------------
+static int AlphaErrorEAC(const EAC_BLOCK& block, const EAC_TABLE& table, int nBase)
+{
+#ifdef USE_SSE
+    __m128i base = _mm_set1_epi8((char)nBase);
+    __m128i best = _mm_set1_epi8((char)0xff);
+    for (int i = 0; i < 8; i++)
+    {
+        // Saturating arithmetic clamps to 0..255 the same way as the decoder
+        __m128i value = _mm_subs_epu8(_mm_adds_epu8(base, table.addModifier[i]), table.subModifier[i]);
+        __m128i diff  = _mm_or_si128(_mm_subs_epu8(value, block.pixels[0]), _mm_subs_epu8(block.pixels[0], value));
+        best = _mm_min_epu8(best, diff);
+    }
+
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(best, zero);
+    __m128i hi = _mm_unpackhi_epi8(best, zero);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int nValue[8];
+    for (int i = 0; i < 8; i++)
+        nValue[i] = DecodeAlphaEAC(nBase, table.nModifier[i]);
+
+    int nError = 0;
+    for (int k = 0; k < BLOCK_SIZE_4X4; k++)
+    {
+        int nBest = 255;
+        for (int i = 0; i < 8; i++)
+            nBest = min(nBest, abs(nValue[i] - block.nPixel[k]));
+        nError += nBest * nBest;
+    }
+    return nError;
+#endif // USE_SSE
+}
+
+// The squares of the 16 bit differences do not fit in 32 bits once summed,
+// so the error is returned as a double like etcpack's calcError()
+static double R11ErrorEAC(const EAC_BLOCK& block, const EAC_TABLE& table, int nBase)
+{
+#ifdef USE_SSE
+    __m128i value = _mm_add_epi16(_mm_set1_epi16((short)(nBase * 8 + 4)), table.modifier);
+    value = _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(2047));
+    value = _mm_or_si128(_mm_slli_epi16(value, 5), _mm_srli_epi16(value, 6));
+
+    __m128i best0 = _mm_set1_epi16((short)0xffff);
+    __m128i best1 = best0;
+    for (int i = 0; i < 8; i++)
+    {
+        __m128i v;
+        switch (i)
+        {
+            case 0: v = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 0, 0, 0)); v = _mm_unpacklo_epi64(v, v); break;
+            case 1: v = _mm_shufflelo_epi16(value, _MM_SHUFFLE(1, 1, 1, 1)); v = _mm_unpacklo_epi64(v, v); break;
+            case 2: v = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 2, 2, 2)); v = _mm_unpacklo_epi64(v, v); break;
+            case 3: v = _mm_shufflelo_epi16(value, _MM_SHUFFLE(3, 3, 3, 3)); v = _mm_unpacklo_epi64(v, v); break;
+            case 4: v = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 0, 0, 0)); v = _mm_unpackhi_epi64(v, v); break;
+            case 5: v = _mm_shufflehi_epi16(value, _MM_SHUFFLE(1, 1, 1, 1)); v = _mm_unpackhi_epi64(v, v); break;
+            case 6: v = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 2, 2, 2)); v = _mm_unpackhi_epi64(v, v); break;
+            default: v = _mm_shufflehi_epi16(value, _MM_SHUFFLE(3, 3, 3, 3)); v = _mm_unpackhi_epi64(v, v); break;
+        }
+
+        // SSE2 has no unsigned 16 bit minimum, min(a, b) = a - max(a - b, 0)
+        __m128i diff0 = _mm_or_si128(_mm_subs_epu16(v, block.pixels[0]), _mm_subs_epu16(block.pixels[0], v));
+        __m128i diff1 = _mm_or_si128(_mm_subs_epu16(v, block.pixels[1]), _mm_subs_epu16(block.pixels[1], v));
+        best0 = _mm_sub_epi16(best0, _mm_subs_epu16(best0, diff0));
+        best1 = _mm_sub_epi16(best1, _mm_subs_epu16(best1, diff1));
+    }
+
+    // Square into high and low 16 bit halves and sum each in 32 bit lanes
+    __m128i zero = _mm_setzero_si128();
+    __m128i hi0 = _mm_mulhi_epu16(best0, best0);
+    __m128i lo0 = _mm_mullo_epi16(best0, best0);
+    __m128i hi1 = _mm_mulhi_epu16(best1, best1);
+    __m128i lo1 = _mm_mullo_epi16(best1, best1);
+    __m128i sumHi = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(hi0, zero), _mm_unpackhi_epi16(hi0, zero)),
+                                  _mm_add_epi32(_mm_unpacklo_epi16(hi1, zero), _mm_unpackhi_epi16(hi1, zero)));
+    __m128i sumLo = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo0, zero), _mm_unpackhi_epi16(lo0, zero)),
+                                  _mm_add_epi32(_mm_unpacklo_epi16(lo1, zero), _mm_unpackhi_epi16(lo1, zero)));
+    sumHi = _mm_add_epi32(sumHi, _mm_shuffle_epi32(sumHi, _MM_SHUFFLE(1, 0, 3, 2)));
+    sumHi = _mm_add_epi32(sumHi, _mm_shuffle_epi32(sumHi, _MM_SHUFFLE(2, 3, 0, 1)));
+    sumLo = _mm_add_epi32(sumLo, _mm_shuffle_epi32(sumLo, _MM_SHUFFLE(1, 0, 3, 2)));
+    sumLo = _mm_add_epi32(sumLo, _mm_shuffle_epi32(sumLo, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (double)_mm_cvtsi128_si32(sumHi) * 65536.0 + (double)_mm_cvtsi128_si32(sumLo);
+#else
+    int nValue[8];
+    for (int i = 0; i < 8; i++)
+        nValue[i] = DecodeR11EAC(nBase, table.nModifier[i]);
+
+    double fError = 0;
+    for (int k = 0; k < BLOCK_SIZE_4X4; k++)
+    {
+        int nBest = 65535;
+        for (int i = 0; i < 8; i++)
+            nBest = min(nBest, abs(nValue[i] - block.nPixel[k]));
+        fError += (double)nBest * nBest;
+    }
+    return fError;
+#endif // USE_SSE
+}
+
+//-------------------------------------------------------------------------
+// Finds the base value with the lowest error for one table. Only the bases
+// in nLow..nHigh are searched, outside them every value is on the same side
+// of every pixel and moving the base towards the pixels cannot add error.
+//-------------------------------------------------------------------------
+static int SearchAlphaBaseEAC(const EAC_BLOCK& block, const EAC_TABLE& table, int nStep, int& nBestError)
+{
+    int nLow  = max(block.nMin - table.nMaxModifier, 0);
+    int nHigh = min(block.nMax - table.nMinModifier, EAC_NUM_BASES - 1);
+
+    int nBestBase  = -1;
+    int nCoarseBase = nLow;
+    int nCoarseError = INT_MAX;
+    for (int nBase = nLow; nBase <= nHigh; nBase += nStep)
+    {
+        int nError = AlphaErrorEAC(block, table, nBase);
+        if (nError < nCoarseError)
+        {
+            nCoarseError = nError;
+            nCoarseBase  = nBase;
+        }
+    }
+
+    if (nCoarseError < nBestError)
+    {
+        nBestError = nCoarseError;
+        nBestBase  = nCoarseBase;
+    }
+
+    if (nStep > 1)
+    {
+        int nFrom = max(nCoarseBase - nStep + 1, nLow);
+        int nTo   = min(nCoarseBase + nStep - 1, nHigh);
+        for (int nBase = nFrom; nBase <= nTo; nBase++)
+        {
+            int nError = AlphaErrorEAC(block, table, nBase);
+            if (nError < nBestError)
+            {
+                nBestError = nError;
+                nBestBase  = nBase;
+            }
+        }
+    }
+
+    return nBestBase;
+}
+
+static int SearchR11BaseEAC(const EAC_BLOCK& block, const EAC_TABLE& table, int nStep, double& fBestError)
+{
+    // The same bounds in 11 bit units, widened by a base step for the rounding
+    int nMin11 = block.nMin >> 5;
+    int nMax11 = (block.nMax >> 5) + 1;
+    int nLow   = max((nMin11 - table.nMaxModifier - 4) / 8 - 1, 0);
+    int nHigh  = min((nMax11 - table.nMinModifier - 4 + 7) / 8 + 1, EAC_NUM_BASES - 1);
+
+    int nBestBase   = -1;
+    int nCoarseBase = nLow;
+    double fCoarseError = DBL_MAX;
+    for (int nBase = nLow; nBase <= nHigh; nBase += nStep)
+    {
+        double fError = R11ErrorEAC(block, table, nBase);
+        if (fError < fCoarseError)
+        {
+            fCoarseError = fError;
+            nCoarseBase  = nBase;
+        }
+    }
+
+    if (fCoarseError < fBestError)
+    {
+        fBestError = fCoarseError;
+        nBestBase  = nCoarseBase;
+    }
+
+    if (nStep > 1)
+    {
+        int nFrom = max(nCoarseBase - nStep + 1, nLow);
+        int nTo   = min(nCoarseBase + nStep - 1, nHigh);
+        for (int nBase = nFrom; nBase <= nTo; nBase++)
+        {
+            double fError = R11ErrorEAC(block, table, nBase);
+            if (fError < fBestError)
+            {
+                fBestError = fError;
+                nBestBase  = nBase;
+            }
+        }
+    }
+
+    return nBestBase;
+}
+
+// The multiplier that stretches the table over the range of the block
+static int EstimateMultiplierEAC(int nTable, int nRange)
+{
+    int nSpread = EACModifier(nTable, 7) - EACModifier(nTable, 3);
+    return (nRange + nSpread / 2) / nSpread;
+}
+
+static void GetBlockRangeEAC(EAC_BLOCK& block)
+{
+    block.nMin = block.nPixel[0];
+    block.nMax = block.nPixel[0];
+    for (int k = 1; k < BLOCK_SIZE_4X4; k++)
+    {
+        block.nMin = min(block.nMin, block.nPixel[k]);
+        block.nMax = max(block.nMax, block.nPixel[k]);
+    }
+}
+
+// Picks the closest value for every pixel and packs the block, the indices
+// are stored 3 bits each, most significant first, down the columns
+static void PackBlockEAC(const EAC_BLOCK& block, int nBase, const EAC_TABLE& table, bool bR11, CMP_BYTE compressedBlock[8])
+{
+    CMP_DWORD dwIndices[2] = { 0, 0 };
+    for (int x = 0; x < 4; x++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            int nPixel = block.nPixel[y * 4 + x];
+            int nBestIndex = 0;
+            int nBestDiff  = INT_MAX;
+            for (int i = 0; i < 8; i++)
+            {
+                int nValue = bR11 ? DecodeR11EAC(nBase, table.nModifier[i]) : DecodeAlphaEAC(nBase, table.nModifier[i]);
+                int nDiff  = abs(nValue - nPixel);
+                if (nDiff < nBestDiff)
+                {
+                    nBestDiff  = nDiff;
+                    nBestIndex = i;
+                }
+            }
+            dwIndices[x >> 1] = (dwIndices[x >> 1] << 3) | nBestIndex;
+        }
+    }
+
+    compressedBlock[0] = (CMP_BYTE)nBase;
+    compressedBlock[1] = (CMP_BYTE)((table.nMultiplier << 4) | table.nTable);
+    compressedBlock[2] = (CMP_BYTE)(dwIndices[0] >> 16);
+    compressedBlock[3] = (CMP_BYTE)(dwIndices[0] >> 8);
+    compressedBlock[4] = (CMP_BYTE)(dwIndices[0]);
+    compressedBlock[5] = (CMP_BYTE)(dwIndices[1] >> 16);
+    compressedBlock[6] = (CMP_BYTE)(dwIndices[1] >> 8);
+    compressedBlock[7] = (CMP_BYTE)(dwIndices[1]);
+}
+
+//-------------------------------------------------------------------------
+// ETC2 RGBA8 alpha
+//   ETC_QUALITY_FAST       : the 3 multipliers nearest the block range for
+//                            each table, bases in steps of 8 then refined
+//   ETC_QUALITY_MEDIUM     : every table and multiplier, bases in steps of 4
+//   ETC_QUALITY_EXHAUSTIVE : every table, multiplier and base
+// A multiplier of 0 is not tried, the flat block it decodes to can be
+// matched with multiplier 1 and a base 3 higher or 2 lower.
+//-------------------------------------------------------------------------
+void atiEncodeAlphaBlockEAC(
+    CMP_BYTE      alphaBlock[BLOCK_SIZE_4X4],
+    CMP_BYTE      compressedBlock[8],
+    ETC_QUALITY   eQuality
+    )
+{
+    EAC_BLOCK block;
+    for (int k = 0; k < BLOCK_SIZE_4X4; k++)
+        block.nPixel[k] = alphaBlock[k];
+    GetBlockRangeEAC(block);
+#ifdef USE_SSE
+    block.pixels[0] = _mm_loadu_si128((__m128i*)alphaBlock);
+#endif // USE_SSE
+
+    int nStep = (eQuality == ETC_QUALITY_EXHAUSTIVE) ? 1 : (eQuality == ETC_QUALITY_MEDIUM) ? EAC_MEDIUM_BASE_STEP : EAC_FAST_BASE_STEP;
+
+    EAC_TABLE table;
+    EAC_TABLE bestTable;
+    int nBestBase  = -1;
+    int nBestError = INT_MAX;
+    for (int nTable = 0; nTable < EAC_NUM_TABLES && nBestError > 0; nTable++)
+    {
+        int nFirst = 1;
+        int nLast  = EAC_NUM_MULTIPLIERS - 1;
+        if (eQuality == ETC_QUALITY_FAST)
+        {
+            int nMultiplier = EstimateMultiplierEAC(nTable, block.nMax - block.nMin);
+            nFirst = max(nMultiplier - 1, 1);
+            nLast  = min(nMultiplier + 1, EAC_NUM_MULTIPLIERS - 1);
+        }
+
+        for (int nMultiplier = nFirst; nMultiplier <= nLast && nBestError > 0; nMultiplier++)
+        {
+            SetupTableEAC(table, nTable, nMultiplier, false);
+            int nBase = SearchAlphaBaseEAC(block, table, nStep, nBestError);
+            if (nBase >= 0)
+            {
+                nBestBase = nBase;
+                bestTable = table;
+            }
+        }
+    }
+
+    PackBlockEAC(block, nBestBase, bestTable, false, compressedBlock);
+}
+
+//-------------------------------------------------------------------------
+// R11, one channel of RG11. The same tiers as the alpha search, multiplier
+// 0 is allowed and gives the finest steps.
+//-------------------------------------------------------------------------
+void atiEncodeR11BlockEAC(
+    CMP_WORD      redBlock[BLOCK_SIZE_4X4],
+    CMP_BYTE      compressedBlock[8],
+    ETC_QUALITY   eQuality
+    )
+{
+    EAC_BLOCK block;
+    for (int k = 0; k < BLOCK_SIZE_4X4; k++)
+        block.nPixel[k] = redBlock[k];
+    GetBlockRangeEAC(block);
+#ifdef USE_SSE
+    block.pixels[0] = _mm_loadu_si128((__m128i*)&redBlock[0]);
+    block.pixels[1] = _mm_loadu_si128((__m128i*)&redBlock[8]);
+#endif // USE_SSE
+
+    int nStep = (eQuality == ETC_QUALITY_EXHAUSTIVE) ? 1 : (eQuality == ETC_QUALITY_MEDIUM) ? EAC_MEDIUM_BASE_STEP : EAC_FAST_BASE_STEP;
+
+    EAC_TABLE table;
+    EAC_TABLE bestTable;
+    int nBestBase = -1;
+    double fBestError = DBL_MAX;
+    for (int nTable = 0; nTable < EAC_NUM_TABLES && fBestError > 0; nTable++)
+    {
+        int nFirst = 0;
+        int nLast  = EAC_NUM_MULTIPLIERS - 1;
+        if (eQuality == ETC_QUALITY_FAST)
+        {
+            // The range in 11 bit units, a multiplier step is 8 of them
+            int nMultiplier = EstimateMultiplierEAC(nTable, (block.nMax - block.nMin) >> 8);
+            nFirst = max(nMultiplier - 1, 0);
+            nLast  = min(nMultiplier + 1, EAC_NUM_MULTIPLIERS - 1);
+        }
+
+        for (int nMultiplier = nFirst; nMultiplier <= nLast && fBestError > 0; nMultiplier++)
+        {
+            SetupTableEAC(table, nTable, nMultiplier, true);
+            int nBase = SearchR11BaseEAC(block, table, nStep, fBestError);
+            if (nBase >= 0)
+            {
+                nBestBase = nBase;
+                bestTable = table;
+            }
+        }
+    }
+
+    PackBlockEAC(block, nBestBase, bestTable, true, compressedBlock);
+}
+
+void atiDecodeAlphaBlockEAC(CMP_BYTE alphaBlock[BLOCK_SIZE_4X4], CMP_BYTE compressedBlock[8])
+{
+    decompressBlockAlpha((uint8*)compressedBlock, (uint8*)alphaBlock, 4, 4, 0, 0);
+}
+
+void atiDecodeR11BlockEAC(CMP_WORD redBlock[BLOCK_SIZE_4X4], CMP_BYTE compressedBlock[8])
+{
+    // etcpack writes the 16 bit values most significant byte first
+    uint8 decoded[BLOCK_SIZE_4X4 * 2];
+    decompressBlockAlpha16bit((uint8*)compressedBlock, decoded, 4, 4, 0, 0);
+    for (int k = 0; k < BLOCK_SIZE_4X4; k++)
+        redBlock[k] = (CMP_WORD)((decoded[k * 2] << 8) | decoded[k * 2 + 1]);
+}
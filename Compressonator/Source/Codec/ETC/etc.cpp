@@ -30,18 +30,21 @@
 #pragma warning(disable:4244)
 #pragma warning(disable:4514)
 
-#if 1
-    // Set SPEED to FAST or MEDIUM
-    #define MEDIUM      2
-    #define FAST        3
-    #define SPEED       FAST
-    
-    #if SPEED != FAST && SPEED != MEDIUM
-        #error SPEED must be set to FAST or MEDIUM!
-    #endif
-#endif
-
-#include "etcpack_lib.h"
+#include "Common.h"
+#include "etcpack.h"
+#include "process.h"
+
+//-------------------------------------------------------------------------
+// Maps the codec "Quality" parameter (0.0 to 1.0) to an encoder tier
+//-------------------------------------------------------------------------
+ETC_QUALITY atiGetQualityETC(float fQuality)
+{
+    if (fQuality >= ETC_QUALITY_EXHAUSTIVE_THRESHOLD)
+        return ETC_QUALITY_EXHAUSTIVE;
+    if (fQuality >= ETC_QUALITY_MEDIUM_THRESHOLD)
+        return ETC_QUALITY_MEDIUM;
+    return ETC_QUALITY_FAST;
+}
 
 //-------------------------------------------------------------------------
 // WRAPPER ADDED AROUND FUNCTION THAT ENCODES A SINGLE 4X4 BLOCK INTO ETC
@@ -50,19 +53,19 @@
 void atiEncodeRGBBlockETC(
     unsigned char *pPixels,        //Color888_t(* pPixels)[ 4 ] [ 4 ],
     unsigned int *pCompressed1,    // Return value
-    unsigned int *pCompressed2    // Return value
+    unsigned int *pCompressed2,    // Return value
+    ETC_QUALITY   eQuality
     )
 {
     unsigned int compressed1, compressed2;    // Used to interface C's (unsigned int*) to C++'s &(unsigned int)
-#if SPEED == FAST
-    unsigned char tmp[4*4*3];                // Required just by "fast" ETC function
-    
-    compressBlockDiffFlipFastPerceptual( (uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, compressed1, compressed2 );
-#elif SPEED == MEDIUM
-    compressBlockDiffFlipMediumPerceptual( (uint8 *)pPixels, 4, 4, 0, 0, compressed1, compressed2 );
-#else
-    #error SPEED must be set to FAST or MEDIUM!
-#endif
+    unsigned char tmp[4*4*3];                 // Decoded block used by etcpack to measure the error
+
+    // ETC1 only has the individual and differential modes, so its medium tier
+    // is already the exhaustive search
+    if (eQuality == ETC_QUALITY_FAST)
+        compressBlockDiffFlipFastPerceptual( (uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, compressed1, compressed2 );
+    else
+        compressBlockETC1ExhaustivePerceptual( (uint8 *)pPixels, (uint8 *)tmp, 4, 4, 0, 0, compressed1, compressed2 );
 
     *pCompressed1 = compressed1;
     *pCompressed2 = compressed2;
@@ -81,4 +84,574 @@ void atiDecodeRGBBlockETC(
     decompressBlockDiffFlip( compressed1, compressed2, (uint8*)pPixels, 4, 4, 0, 0);
 }
 
+//-------------------------------------------------------------------------
+// Block parallel compression shared by the ETC1 and ETC2 codecs
+//-------------------------------------------------------------------------
+struct ETCCompressJobs
+{
+    CCodec*                 pCodec;
+    ETC_CompressBlockProc   pCompressBlock;
+    CMP_DWORD               dwBlockSize;    // DWORDs per compressed block
+    CCodecBuffer*           pBufferIn;
+    CCodecBuffer*           pBufferOut;
+    CMP_DWORD               dwBlocksX;
+    LONG                    nBlocks;
+    volatile LONG           nNextBlock;     // First block of the next job to hand out
+    volatile LONG           nBlocksDone;
+    volatile LONG           bAbort;
+};
+
+// Compresses the next ETC_BLOCKS_PER_JOB blocks, returns false once there are none left
+static bool CompressNextJobETC(ETCCompressJobs* pJobs, CCodecBuffer* pBufferIn)
+{
+    if (pJobs->bAbort)
+        return false;
+
+    LONG nFirst = InterlockedExchangeAdd(&pJobs->nNextBlock, ETC_BLOCKS_PER_JOB);
+    if (nFirst >= pJobs->nBlocks)
+        return false;
+    LONG nLast = min(nFirst + ETC_BLOCKS_PER_JOB, pJobs->nBlocks);
+
+    CMP_BYTE srcBlock[BLOCK_SIZE_4X4X4];
+    CMP_DWORD compressedBlock[4];
+    for (LONG n = nFirst; n < nLast; n++)
+    {
+        CMP_DWORD i = (CMP_DWORD)n % pJobs->dwBlocksX;
+        CMP_DWORD j = (CMP_DWORD)n / pJobs->dwBlocksX;
+        pBufferIn->ReadBlockRGBA(i*4, j*4, 4, 4, srcBlock);
+        pJobs->pCompressBlock(pJobs->pCodec, srcBlock, compressedBlock);
+        pJobs->pBufferOut->WriteBlock(i*4, j*4, compressedBlock, pJobs->dwBlockSize);
+    }
+
+    InterlockedExchangeAdd(&pJobs->nBlocksDone, nLast - nFirst);
+    return true;
+}
+
+static unsigned int _stdcall ETCCompressThreadProc(void* param)
+{
+    ETCCompressJobs* pJobs = (ETCCompressJobs*)param;
+
+    // Buffers that are converted to RGBA8888 as they are read keep state while
+    // reading, so each thread reads the source pixels through its own buffer
+    CCodecBuffer* pBufferIn = CreateCodecBuffer(pJobs->pBufferIn->GetBufferType(),
+                                                pJobs->pBufferIn->GetBlockWidth(), pJobs->pBufferIn->GetBlockHeight(), pJobs->pBufferIn->GetBlockDepth(),
+                                                pJobs->pBufferIn->GetWidth(), pJobs->pBufferIn->GetHeight(), pJobs->pBufferIn->GetPitch(), pJobs->pBufferIn->GetData());
+    if (pBufferIn == NULL)
+        return 0;
+
+    while (CompressNextJobETC(pJobs, pBufferIn))
+        ;
+
+    delete pBufferIn;
+    return 0;
+}
+
+CodecError atiCompressBlocksETC(
+    CCodec* pCodec,
+    ETC_CompressBlockProc pCompressBlock,
+    CMP_DWORD dwBlockSize,
+    CMP_DWORD dwNumThreads,
+    CCodecBuffer& bufferIn,
+    CCodecBuffer& bufferOut,
+    Codec_Feedback_Proc pFeedbackProc,
+    DWORD_PTR pUser1,
+    DWORD_PTR pUser2
+    )
+{
+    // etcpack's tables are shared by all the threads, set them up before any are started
+    readCompressParams();
+    setupAlphaTable();
+
+    ETCCompressJobs jobs;
+    jobs.pCodec         = pCodec;
+    jobs.pCompressBlock = pCompressBlock;
+    jobs.dwBlockSize    = dwBlockSize;
+    jobs.pBufferIn      = &bufferIn;
+    jobs.pBufferOut     = &bufferOut;
+    jobs.dwBlocksX      = ((bufferIn.GetWidth() + 3) >> 2);
+    jobs.nBlocks        = (LONG)(jobs.dwBlocksX * ((bufferIn.GetHeight() + 3) >> 2));
+    jobs.nNextBlock     = 0;
+    jobs.nBlocksDone    = 0;
+    jobs.bAbort         = FALSE;
+
+    if (dwNumThreads == 0)
+    {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        dwNumThreads = systemInfo.dwNumberOfProcessors;
+    }
+    CMP_DWORD dwNumJobs = (jobs.nBlocks + ETC_BLOCKS_PER_JOB - 1) / ETC_BLOCKS_PER_JOB;
+    dwNumThreads = min(min(dwNumThreads, (CMP_DWORD)ETC_MAX_THREADS), dwNumJobs);
+
+    // The calling thread compresses blocks as well and is the only one to report progress
+    HANDLE ahThread[ETC_MAX_THREADS];
+    DWORD  dwLiveThreads = 0;
+    for (CMP_DWORD dwThread = 1; dwThread < dwNumThreads; dwThread++)
+    {
+        HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, ETCCompressThreadProc, &jobs, 0, NULL);
+        if (hThread)
+            ahThread[dwLiveThreads++] = hThread;
+    }
+
+    CodecError err = CE_OK;
+    LONG nBlocksReported = 0;
+    while (CompressNextJobETC(&jobs, &bufferIn))
+    {
+        if (pFeedbackProc && (jobs.nBlocksDone - nBlocksReported) >= (LONG)jobs.dwBlocksX)
+        {
+            nBlocksReported = jobs.nBlocksDone;
+            float fProgress = 100.f * nBlocksReported / jobs.nBlocks;
+            if (pFeedbackProc(fProgress, pUser1, pUser2))
+            {
+                InterlockedExchange(&jobs.bAbort, TRUE);
+                err = CE_Aborted;
+            }
+        }
+    }
+
+    if (dwLiveThreads > 0)
+    {
+        WaitForMultipleObjects(dwLiveThreads, ahThread, TRUE, INFINITE);
+        for (DWORD i = 0; i < dwLiveThreads; i++)
+            CloseHandle(ahThread[i]);
+    }
+
+    return err;
+}
+
+//-------------------------------------------------------------------------
+// Direct ETC1, ETC2 RGB and ETC2 RGBA8 block decoders. They give the same
+// texels as etcdec.cxx but write them straight to the destination rows
+// instead of going through an etcpack image and the block layout.
+//-------------------------------------------------------------------------
+
+// The etcdec.cxx bit macros, startpos counts from bit 63 of the 64 bit block
+#define ETC_GETBITS(source, size, startpos)      (((source) >> ((startpos) - (size) + 1)) & ((1u << (size)) - 1))
+#define ETC_GETBITSHIGH(source, size, startpos)  ETC_GETBITS(source, size, (startpos) - 32)
+
+// EAC modifiers of each table and multiplier, etcdec.cxx
+extern int alphaTable[256][8];
+
+// Individual and differential mode modifiers in texel index order,
+// etcdec.cxx compressParams[] looked up through unscramble[]
+static const int g_nModifierETC[8][4] =
+{
+    {  2,   8,  -2,   -8 },
+    {  5,  17,  -5,  -17 },
+    {  9,  29,  -9,  -29 },
+    { 13,  42, -13,  -42 },
+    { 18,  60, -18,  -60 },
+    { 24,  80, -24,  -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 }
+};
+
+// T and H mode distances, etcdec.cxx table59T and table58H
+static const int g_nDistanceETC2[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static inline int ClampETC(int n)
+{
+    return (n < 0) ? 0 : ((n > 255) ? 255 : n);
+}
+
+// An opaque texel with red nRedOffset bytes and blue 2 - nRedOffset bytes into it
+static inline CMP_DWORD PackTexelETC(int nRed, int nGreen, int nBlue, int nRedOffset)
+{
+    return (0xFFu << 24) | ((CMP_DWORD)nRed << (nRedOffset * 8)) | ((CMP_DWORD)nGreen << 8) | ((CMP_DWORD)nBlue << ((2 - nRedOffset) * 8));
+}
+
+static inline int Expand4ETC(unsigned int n) { return (int)((n << 4) | n); }
+static inline int Expand5ETC(unsigned int n) { return (int)(((n << 3) | (n >> 2)) & 0xFF); }
+
+static void SetPaletteETC(CMP_DWORD palette[4], int nRed, int nGreen, int nBlue, unsigned int nTable, int nRedOffset)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        int nModifier = g_nModifierETC[nTable][i];
+        palette[i] = PackTexelETC(ClampETC(nRed + nModifier), ClampETC(nGreen + nModifier), ClampETC(nBlue + nModifier), nRedOffset);
+    }
+}
+
+// The two index bits of each texel are 16 bits apart in the second word, in column order.
+// Texels in the second half of the block, the right half or with bFlip the bottom half,
+// come from palette2.
+static void WriteTexelsETC(unsigned int block_part2, const CMP_DWORD palette1[4], const CMP_DWORD palette2[4], bool bFlip,
+                           CMP_BYTE* pOut, CMP_DWORD dwPitch)
+{
+    for (int y = 0; y < 4; y++)
+    {
+        CMP_DWORD* pRow = (CMP_DWORD*)(pOut + y * dwPitch);
+        for (int x = 0; x < 4; x++)
+        {
+            int nShift = x * 4 + y;
+            int nIndex = (((block_part2 >> (nShift + 16)) & 1) << 1) | ((block_part2 >> nShift) & 1);
+            bool bSecond = bFlip ? (y >= 2) : (x >= 2);
+            pRow[x] = bSecond ? palette2[nIndex] : palette1[nIndex];
+        }
+    }
+}
+
+static void DecodeTModeETC2(unsigned int block_part1, unsigned int block_part2, CMP_BYTE* pOut, CMP_DWORD dwPitch, int nRedOffset)
+{
+    int nRed0   = Expand4ETC((ETC_GETBITSHIGH(block_part1, 2, 60) << 2) | ETC_GETBITSHIGH(block_part1, 2, 57));
+    int nGreen0 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 55));
+    int nBlue0  = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 51));
+    int nRed1   = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 47));
+    int nGreen1 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 43));
+    int nBlue1  = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 39));
+    int nDistance = g_nDistanceETC2[(ETC_GETBITSHIGH(block_part1, 2, 35) << 1) | ETC_GETBITSHIGH(block_part1, 1, 32)];
+
+    CMP_DWORD palette[4];
+    palette[0] = PackTexelETC(nRed0, nGreen0, nBlue0, nRedOffset);
+    palette[1] = PackTexelETC(ClampETC(nRed1 + nDistance), ClampETC(nGreen1 + nDistance), ClampETC(nBlue1 + nDistance), nRedOffset);
+    palette[2] = PackTexelETC(nRed1, nGreen1, nBlue1, nRedOffset);
+    palette[3] = PackTexelETC(ClampETC(nRed1 - nDistance), ClampETC(nGreen1 - nDistance), ClampETC(nBlue1 - nDistance), nRedOffset);
+
+    WriteTexelsETC(block_part2, palette, palette, false, pOut, dwPitch);
+}
+
+static void DecodeHModeETC2(unsigned int block_part1, unsigned int block_part2, CMP_BYTE* pOut, CMP_DWORD dwPitch, int nRedOffset)
+{
+    unsigned int nRed0   = ETC_GETBITSHIGH(block_part1, 4, 62);
+    unsigned int nGreen0 = (ETC_GETBITSHIGH(block_part1, 3, 58) << 1) | ETC_GETBITSHIGH(block_part1, 1, 52);
+    unsigned int nBlue0  = (ETC_GETBITSHIGH(block_part1, 1, 51) << 3) | ETC_GETBITSHIGH(block_part1, 3, 49);
+    unsigned int nRed1   = ETC_GETBITSHIGH(block_part1, 4, 46);
+    unsigned int nGreen1 = ETC_GETBITSHIGH(block_part1, 4, 42);
+    unsigned int nBlue1  = ETC_GETBITSHIGH(block_part1, 4, 38);
+
+    // The lowest distance bit is implied by the order of the two colours
+    unsigned int nColor0 = (nRed0 << 8) | (nGreen0 << 4) | nBlue0;
+    unsigned int nColor1 = (nRed1 << 8) | (nGreen1 << 4) | nBlue1;
+    unsigned int nTable  = (ETC_GETBITSHIGH(block_part1, 1, 34) << 2) | (ETC_GETBITSHIGH(block_part1, 1, 32) << 1) | (nColor0 >= nColor1 ? 1 : 0);
+    int nDistance = g_nDistanceETC2[nTable];
+
+    CMP_DWORD palette[4];
+    palette[0] = PackTexelETC(ClampETC(Expand4ETC(nRed0) + nDistance), ClampETC(Expand4ETC(nGreen0) + nDistance), ClampETC(Expand4ETC(nBlue0) + nDistance), nRedOffset);
+    palette[1] = PackTexelETC(ClampETC(Expand4ETC(nRed0) - nDistance), ClampETC(Expand4ETC(nGreen0) - nDistance), ClampETC(Expand4ETC(nBlue0) - nDistance), nRedOffset);
+    palette[2] = PackTexelETC(ClampETC(Expand4ETC(nRed1) + nDistance), ClampETC(Expand4ETC(nGreen1) + nDistance), ClampETC(Expand4ETC(nBlue1) + nDistance), nRedOffset);
+    palette[3] = PackTexelETC(ClampETC(Expand4ETC(nRed1) - nDistance), ClampETC(Expand4ETC(nGreen1) - nDistance), ClampETC(Expand4ETC(nBlue1) - nDistance), nRedOffset);
+
+    WriteTexelsETC(block_part2, palette, palette, false, pOut, dwPitch);
+}
+
+static void DecodePlanarModeETC2(unsigned int block_part1, unsigned int block_part2, CMP_BYTE* pOut, CMP_DWORD dwPitch, int nRedOffset)
+{
+    unsigned int nO[3], nH[3], nV[3];
+    nO[0] = ETC_GETBITSHIGH(block_part1, 6, 62);
+    nO[1] = (ETC_GETBITSHIGH(block_part1, 1, 56) << 6) | ETC_GETBITSHIGH(block_part1, 6, 54);
+    nO[2] = (ETC_GETBITSHIGH(block_part1, 1, 48) << 5) | (ETC_GETBITSHIGH(block_part1, 2, 44) << 3) | ETC_GETBITSHIGH(block_part1, 3, 41);
+    nH[0] = (ETC_GETBITSHIGH(block_part1, 5, 38) << 1) | ETC_GETBITSHIGH(block_part1, 1, 32);
+    nH[1] = ETC_GETBITS(block_part2, 7, 31);
+    nH[2] = ETC_GETBITS(block_part2, 6, 24);
+    nV[0] = ETC_GETBITS(block_part2, 6, 18);
+    nV[1] = ETC_GETBITS(block_part2, 7, 12);
+    nV[2] = ETC_GETBITS(block_part2, 6, 5);
+
+    // Red and blue have 6 bits, green 7
+    int nOrigin[3], nDX[3], nDY[3];
+    for (int c = 0; c < 3; c++)
+    {
+        int nBits = (c == 1) ? 7 : 6;
+        int nOc = (int)((nO[c] << (8 - nBits)) | (nO[c] >> (2 * nBits - 8)));
+        int nHc = (int)((nH[c] << (8 - nBits)) | (nH[c] >> (2 * nBits - 8)));
+        int nVc = (int)((nV[c] << (8 - nBits)) | (nV[c] >> (2 * nBits - 8)));
+        nOrigin[c] = 4 * nOc + 2;
+        nDX[c] = nHc - nOc;
+        nDY[c] = nVc - nOc;
+    }
+
+    for (int y = 0; y < 4; y++)
+    {
+        CMP_DWORD* pRow = (CMP_DWORD*)(pOut + y * dwPitch);
+        for (int x = 0; x < 4; x++)
+        {
+            pRow[x] = PackTexelETC(ClampETC((x * nDX[0] + y * nDY[0] + nOrigin[0]) >> 2),
+                                   ClampETC((x * nDX[1] + y * nDY[1] + nOrigin[1]) >> 2),
+                                   ClampETC((x * nDX[2] + y * nDY[2] + nOrigin[2]) >> 2), nRedOffset);
+        }
+    }
+}
+
+// Decodes the 8 byte colour block, the T, H and planar modes are only used by ETC2
+static void DecodeRGBBlockETC(const CMP_BYTE* pBlock, bool bETC2, CMP_BYTE* pOut, CMP_DWORD dwPitch, int nRedOffset)
+{
+    unsigned int block_part1 = (pBlock[0] << 24) | (pBlock[1] << 16) | (pBlock[2] << 8) | pBlock[3];
+    unsigned int block_part2 = (pBlock[4] << 24) | (pBlock[5] << 16) | (pBlock[6] << 8) | pBlock[7];
+
+    int nRed1, nGreen1, nBlue1;
+    int nRed2, nGreen2, nBlue2;
+    if (ETC_GETBITSHIGH(block_part1, 1, 33))
+    {
+        // Differential mode, the 3 bit differences are signed
+        unsigned int nBaseRed   = ETC_GETBITSHIGH(block_part1, 5, 63);
+        unsigned int nBaseGreen = ETC_GETBITSHIGH(block_part1, 5, 55);
+        unsigned int nBaseBlue  = ETC_GETBITSHIGH(block_part1, 5, 47);
+        unsigned int nRed   = nBaseRed   + ((ETC_GETBITSHIGH(block_part1, 3, 58) ^ 4) - 4);
+        unsigned int nGreen = nBaseGreen + ((ETC_GETBITSHIGH(block_part1, 3, 50) ^ 4) - 4);
+        unsigned int nBlue  = nBaseBlue  + ((ETC_GETBITSHIGH(block_part1, 3, 42) ^ 4) - 4);
+
+        // In ETC2 a second colour outside 0 to 31 selects one of the new modes,
+        // etcdec.cxx wraps it to 8 bits in ETC1
+        if (bETC2 && (nRed > 31 || nGreen > 31 || nBlue > 31))
+        {
+            if (nRed > 31)
+                DecodeTModeETC2(block_part1, block_part2, pOut, dwPitch, nRedOffset);
+            else if (nGreen > 31)
+                DecodeHModeETC2(block_part1, block_part2, pOut, dwPitch, nRedOffset);
+            else
+                DecodePlanarModeETC2(block_part1, block_part2, pOut, dwPitch, nRedOffset);
+            return;
+        }
+
+        nRed1 = Expand5ETC(nBaseRed);
+        nGreen1 = Expand5ETC(nBaseGreen);
+        nBlue1 = Expand5ETC(nBaseBlue);
+        nRed2 = Expand5ETC(nRed & 0xFF);
+        nGreen2 = Expand5ETC(nGreen & 0xFF);
+        nBlue2 = Expand5ETC(nBlue & 0xFF);
+    }
+    else
+    {
+        // Individual mode
+        nRed1 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 63));
+        nGreen1 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 55));
+        nBlue1 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 47));
+        nRed2 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 59));
+        nGreen2 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 51));
+        nBlue2 = Expand4ETC(ETC_GETBITSHIGH(block_part1, 4, 43));
+    }
+
+    CMP_DWORD palette1[4], palette2[4];
+    SetPaletteETC(palette1, nRed1, nGreen1, nBlue1, ETC_GETBITSHIGH(block_part1, 3, 39), nRedOffset);
+    SetPaletteETC(palette2, nRed2, nGreen2, nBlue2, ETC_GETBITSHIGH(block_part1, 3, 36), nRedOffset);
+
+    WriteTexelsETC(block_part2, palette1, palette2, ETC_GETBITSHIGH(block_part1, 1, 32) != 0, pOut, dwPitch);
+}
+
+// Replaces the alpha of the decoded texels with the 8 byte EAC block,
+// 3 bit indices most significant first in column order
+static void DecodeAlphaBlockEAC(const CMP_BYTE* pBlock, CMP_BYTE* pOut, CMP_DWORD dwPitch)
+{
+    int nBase = pBlock[0];
+    const int* pModifier = alphaTable[pBlock[1]];
+
+    // 24 bits of indices for each pair of columns
+    CMP_DWORD dwIndices[2];
+    dwIndices[0] = (pBlock[2] << 16) | (pBlock[3] << 8) | pBlock[4];
+    dwIndices[1] = (pBlock[5] << 16) | (pBlock[6] << 8) | pBlock[7];
+
+    for (int x = 0; x < 4; x++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            int nIndex = (dwIndices[x >> 1] >> (21 - 3 * ((x & 1) * 4 + y))) & 7;
+            pOut[y * dwPitch + x * 4 + RGBA8888_CHANNEL_A] = (CMP_BYTE)ClampETC(nBase + pModifier[nIndex]);
+        }
+    }
+}
+
+struct ETCDecodeJobs
+{
+    CodecType           nCodecType;
+    const CMP_BYTE*     pIn;
+    CMP_DWORD           dwInPitch;
+    CMP_DWORD           dwBlocksX;
+    CMP_BYTE*           pOut;
+    CMP_DWORD           dwOutPitch;
+    int                 nRedOffset;
+    LONG                nRows;
+    volatile LONG       nNextRow;       // First block row of the next job to hand out
+    volatile LONG       nRowsDone;
+    volatile LONG       bAbort;
+};
+
+// Decodes the next ETC_DECODE_ROWS_PER_JOB block rows, returns false once there are none left
+static bool DecodeNextJobETC(ETCDecodeJobs* pJobs)
+{
+    if (pJobs->bAbort)
+        return false;
+
+    LONG nFirst = InterlockedExchangeAdd(&pJobs->nNextRow, ETC_DECODE_ROWS_PER_JOB);
+    if (nFirst >= pJobs->nRows)
+        return false;
+    LONG nLast = min(nFirst + ETC_DECODE_ROWS_PER_JOB, pJobs->nRows);
+
+    bool bETC2 = (pJobs->nCodecType != CT_ETC_RGB);
+    bool bAlpha = (pJobs->nCodecType == CT_ETC2_RGBA);
+    CMP_DWORD dwBlockBytes = bAlpha ? 16 : 8;
+
+    for (LONG j = nFirst; j < nLast; j++)
+    {
+        const CMP_BYTE* pBlock = pJobs->pIn + j * pJobs->dwInPitch;
+        CMP_BYTE* pOut = pJobs->pOut + j * 4 * pJobs->dwOutPitch;
+        for (CMP_DWORD i = 0; i < pJobs->dwBlocksX; i++)
+        {
+            // The ETC2 RGBA8 alpha block comes before the colour block
+            if (bAlpha)
+            {
+                DecodeRGBBlockETC(pBlock + 8, bETC2, pOut, pJobs->dwOutPitch, pJobs->nRedOffset);
+                DecodeAlphaBlockEAC(pBlock, pOut, pJobs->dwOutPitch);
+            }
+            else
+            {
+                DecodeRGBBlockETC(pBlock, bETC2, pOut, pJobs->dwOutPitch, pJobs->nRedOffset);
+            }
+            pBlock += dwBlockBytes;
+            pOut += 4 * sizeof(CMP_DWORD);
+        }
+    }
+
+    InterlockedExchangeAdd(&pJobs->nRowsDone, nLast - nFirst);
+    return true;
+}
+
+static unsigned int _stdcall ETCDecodeThreadProc(void* param)
+{
+    while (DecodeNextJobETC((ETCDecodeJobs*)param))
+        ;
+    return 0;
+}
+
+// atiDecodeBlocksETC with progress reported through pFeedbackProc as the rows are decoded
+static CodecError DecodeBlocksETC(
+    CodecType nCodecType,
+    const CMP_BYTE* pIn,
+    CMP_DWORD dwInPitch,
+    CMP_DWORD dwBlocksX,
+    CMP_DWORD dwBlocksY,
+    CMP_BYTE* pOut,
+    CMP_DWORD dwOutPitch,
+    int nRedOffset,
+    CMP_DWORD dwNumThreads,
+    Codec_Feedback_Proc pFeedbackProc,
+    DWORD_PTR pUser1,
+    DWORD_PTR pUser2
+    )
+{
+    assert(nCodecType == CT_ETC_RGB || nCodecType == CT_ETC2_RGB || nCodecType == CT_ETC2_RGBA);
+
+    if (dwBlocksX == 0 || dwBlocksY == 0)
+        return CE_OK;
+
+    if (nCodecType == CT_ETC2_RGBA)
+        setupAlphaTable();
+
+    ETCDecodeJobs jobs;
+    jobs.nCodecType = nCodecType;
+    jobs.pIn        = pIn;
+    jobs.dwInPitch  = dwInPitch;
+    jobs.dwBlocksX  = dwBlocksX;
+    jobs.pOut       = pOut;
+    jobs.dwOutPitch = dwOutPitch;
+    jobs.nRedOffset = nRedOffset;
+    jobs.nRows      = (LONG)dwBlocksY;
+    jobs.nNextRow   = 0;
+    jobs.nRowsDone  = 0;
+    jobs.bAbort     = FALSE;
+
+    if (dwNumThreads == 0)
+    {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        dwNumThreads = systemInfo.dwNumberOfProcessors;
+    }
+    CMP_DWORD dwNumJobs = (dwBlocksY + ETC_DECODE_ROWS_PER_JOB - 1) / ETC_DECODE_ROWS_PER_JOB;
+    dwNumThreads = min(min(dwNumThreads, (CMP_DWORD)ETC_MAX_THREADS), dwNumJobs);
+
+    // The calling thread decodes rows as well and is the only one to report progress
+    HANDLE ahThread[ETC_MAX_THREADS];
+    DWORD  dwLiveThreads = 0;
+    for (CMP_DWORD dwThread = 1; dwThread < dwNumThreads; dwThread++)
+    {
+        HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, ETCDecodeThreadProc, &jobs, 0, NULL);
+        if (hThread)
+            ahThread[dwLiveThreads++] = hThread;
+    }
+
+    CodecError err = CE_OK;
+    while (DecodeNextJobETC(&jobs))
+    {
+        if (pFeedbackProc)
+        {
+            float fProgress = 100.f * jobs.nRowsDone / jobs.nRows;
+            if (pFeedbackProc(fProgress, pUser1, pUser2))
+            {
+                InterlockedExchange(&jobs.bAbort, TRUE);
+                err = CE_Aborted;
+            }
+        }
+    }
+
+    if (dwLiveThreads > 0)
+    {
+        WaitForMultipleObjects(dwLiveThreads, ahThread, TRUE, INFINITE);
+        for (DWORD i = 0; i < dwLiveThreads; i++)
+            CloseHandle(ahThread[i]);
+    }
+
+    return err;
+}
+
+void atiDecodeBlocksETC(
+    CodecType nCodecType,
+    const CMP_BYTE* pIn,
+    CMP_DWORD dwInPitch,
+    CMP_DWORD dwBlocksX,
+    CMP_DWORD dwBlocksY,
+    CMP_BYTE* pOut,
+    CMP_DWORD dwOutPitch,
+    int nRedOffset,
+    CMP_DWORD dwNumThreads
+    )
+{
+    DecodeBlocksETC(nCodecType, pIn, dwInPitch, dwBlocksX, dwBlocksY, pOut, dwOutPitch, nRedOffset,
+                    dwNumThreads, NULL, NULL, NULL);
+}
+
+CodecError atiDecompressBlocksETC(
+    CodecType nCodecType,
+    CMP_DWORD dwNumThreads,
+    CCodecBuffer& bufferIn,
+    CCodecBuffer& bufferOut,
+    Codec_Feedback_Proc pFeedbackProc,
+    DWORD_PTR pUser1,
+    DWORD_PTR pUser2
+    )
+{
+    assert(bufferOut.GetBufferType() == CBT_RGBA8888);
+
+    const CMP_DWORD dwBlocksX = ((bufferIn.GetWidth() + 3) >> 2);
+    const CMP_DWORD dwBlocksY = ((bufferIn.GetHeight() + 3) >> 2);
+    const CMP_DWORD dwFullBlocksX = bufferOut.GetWidth() >> 2;
+    const CMP_DWORD dwFullBlocksY = bufferOut.GetHeight() >> 2;
+    const CMP_DWORD dwBlockBytes = (nCodecType == CT_ETC2_RGBA) ? 16 : 8;
+
+    CMP_BYTE* pIn  = bufferIn.GetData();
+    CMP_BYTE* pOut = bufferOut.GetData();
+    const CMP_DWORD dwInPitch  = bufferIn.GetPitch();
+    const CMP_DWORD dwOutPitch = bufferOut.GetPitch();
+
+    // Full blocks are decoded straight into the output buffer
+    CodecError err = DecodeBlocksETC(nCodecType, pIn, dwInPitch, dwFullBlocksX, dwFullBlocksY,
+                                     pOut, dwOutPitch, RGBA8888_CHANNEL_R, dwNumThreads,
+                                     pFeedbackProc, pUser1, pUser2);
+    if (err != CE_OK)
+        return err;
+
+    // Blocks on the right and bottom edges of images that are not a multiple of 4
+    // are decoded to a local block and clipped by WriteBlockRGBA
+    CMP_BYTE destBlock[BLOCK_SIZE_4X4X4];
+    for (CMP_DWORD j = 0; j < dwBlocksY; j++)
+    {
+        for (CMP_DWORD i = (j < dwFullBlocksY) ? dwFullBlocksX : 0; i < dwBlocksX; i++)
+        {
+            atiDecodeBlocksETC(nCodecType, pIn + j * dwInPitch + i * dwBlockBytes, dwInPitch, 1, 1,
+                               destBlock, 4 * sizeof(CMP_DWORD), RGBA8888_CHANNEL_R, 1);
+            bufferOut.WriteBlockRGBA(i * 4, j * 4, 4, 4, destBlock);
+        }
+    }
+
+    return CE_OK;
+}
+
 #pragma warning(pop)
@@ -53,6 +53,9 @@
 #include <time.h>
 #include <sys/timeb.h>
 #include "etcimage.h"
+#ifdef USE_SSE
+#include <emmintrin.h>
+#endif // USE_SSE
 
 // Typedefs
 typedef unsigned char uint8;
@@ -1429,10 +1432,205 @@ const unsigned int square_table_percep_blue[511] = {
                          50176*KB, 50625*KB, 51076*KB, 51529*KB, 51984*KB, 52441*KB, 52900*KB, 53361*KB, 53824*KB, 54289*KB, 54756*KB, 55225*KB, 55696*KB, 56169*KB, 56644*KB, 57121*KB, 
                          57600*KB, 58081*KB, 58564*KB, 59049*KB, 59536*KB, 60025*KB, 60516*KB, 61009*KB, 61504*KB, 62001*KB, 62500*KB, 63001*KB, 63504*KB, 64009*KB, 64516*KB, 65025*KB}; 
 
+#ifdef USE_SSE
+// SSE2 version of the table search of the individual and differential modes.
+// Each 16 bit lane holds one of the 8 intensity tables, so one pass over the 8 pixels
+// of a 2x4 or 4x2 half block scores all tables and modifiers at once. The pixels are
+// visited, and the errors of each table summed, in the same order as the
+// compressBlockWithTable functions, so the result is bit exact with the scalar search.
+enum
+{
+    TABLE_ERROR_RGB,            // Equal weights, as compressBlockWithTable2x4
+    TABLE_ERROR_PERCEP1000,     // Fixed point perceptual, as compressBlockWithTable2x4percep1000
+    TABLE_ERROR_PERCEP,         // Perceptual with the red term in double, as compressBlockWithTable2x4percep
+    TABLE_ERROR_PERCEP_FLOAT    // Single precision perceptual, as compressBlockWithTable4x2percep
+};
+
+// Error of one pixel against the color of every table for one modifier.
+// Returns the errors of tables 0-3 in err_lo and tables 4-7 in err_hi. The float
+// errors are returned as their bit patterns, which order like the integers since
+// they are never negative.
+static inline void tableErrorSSE(int metric, __m128i dr, __m128i dg, __m128i db, __m128i &err_lo, __m128i &err_hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    if(metric == TABLE_ERROR_RGB)
+    {
+        __m128i rg_lo = _mm_unpacklo_epi16(dr, dg), rg_hi = _mm_unpackhi_epi16(dr, dg);
+        __m128i b_lo = _mm_unpacklo_epi16(db, zero), b_hi = _mm_unpackhi_epi16(db, zero);
+        err_lo = _mm_add_epi32(_mm_madd_epi16(rg_lo, rg_lo), _mm_madd_epi16(b_lo, b_lo));
+        err_hi = _mm_add_epi32(_mm_madd_epi16(rg_hi, rg_hi), _mm_madd_epi16(b_hi, b_hi));
+        return;
+    }
+
+    // The squares are at most 255*255 and fit an unsigned 16 bit lane
+    __m128i sr = _mm_mullo_epi16(dr, dr);
+    __m128i sg = _mm_mullo_epi16(dg, dg);
+    __m128i sb = _mm_mullo_epi16(db, db);
+
+    if(metric == TABLE_ERROR_PERCEP1000)
+    {
+        const __m128i kr = _mm_set1_epi16(PERCEPTUAL_WEIGHT_R_SQUARED_TIMES1000);
+        const __m128i kg = _mm_set1_epi16(PERCEPTUAL_WEIGHT_G_SQUARED_TIMES1000);
+        const __m128i kb = _mm_set1_epi16(PERCEPTUAL_WEIGHT_B_SQUARED_TIMES1000);
+        __m128i lr = _mm_mullo_epi16(sr, kr), hr = _mm_mulhi_epu16(sr, kr);
+        __m128i lg = _mm_mullo_epi16(sg, kg), hg = _mm_mulhi_epu16(sg, kg);
+        __m128i lb = _mm_mullo_epi16(sb, kb), hb = _mm_mulhi_epu16(sb, kb);
+        err_lo = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lr, hr), _mm_unpacklo_epi16(lg, hg)), _mm_unpacklo_epi16(lb, hb));
+        err_hi = _mm_add_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lr, hr), _mm_unpackhi_epi16(lg, hg)), _mm_unpackhi_epi16(lb, hb));
+        return;
+    }
+
+    const __m128 wg = _mm_set1_ps((float) PERCEPTUAL_WEIGHT_G_SQUARED);
+    const __m128 wb = _mm_set1_ps((float) PERCEPTUAL_WEIGHT_B_SQUARED);
+    __m128i ir[2] = { _mm_unpacklo_epi16(sr, zero), _mm_unpackhi_epi16(sr, zero) };
+    __m128i ig[2] = { _mm_unpacklo_epi16(sg, zero), _mm_unpackhi_epi16(sg, zero) };
+    __m128i ib[2] = { _mm_unpacklo_epi16(sb, zero), _mm_unpackhi_epi16(sb, zero) };
+    __m128i err[2];
+
+    if(metric == TABLE_ERROR_PERCEP_FLOAT)
+    {
+        const __m128 wr = _mm_set1_ps((float) PERCEPTUAL_WEIGHT_R_SQUARED);
+        for(int h=0; h<2; h++)
+        {
+            __m128 fr = _mm_mul_ps(_mm_cvtepi32_ps(ir[h]), wr);
+            __m128 fg = _mm_mul_ps(_mm_cvtepi32_ps(ig[h]), wg);
+            __m128 fb = _mm_mul_ps(_mm_cvtepi32_ps(ib[h]), wb);
+            err[h] = _mm_castps_si128(_mm_add_ps(_mm_add_ps(fr, fg), fb));
+        }
+        err_lo = err[0];
+        err_hi = err[1];
+        return;
+    }
+
+    // Same evaluation as the scalar code: the red term in double, the green and
+    // blue terms in float, summed in double and rounded to float.
+    const __m128d wr = _mm_set1_pd(PERCEPTUAL_WEIGHT_R_SQUARED);
+    for(int h=0; h<2; h++)
+    {
+        __m128 fg = _mm_mul_ps(_mm_cvtepi32_ps(ig[h]), wg);
+        __m128 fb = _mm_mul_ps(_mm_cvtepi32_ps(ib[h]), wb);
+        __m128d e0 = _mm_mul_pd(_mm_cvtepi32_pd(ir[h]), wr);
+        __m128d e1 = _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(ir[h], 8)), wr);
+        e0 = _mm_add_pd(_mm_add_pd(e0, _mm_cvtps_pd(fg)), _mm_cvtps_pd(fb));
+        e1 = _mm_add_pd(_mm_add_pd(e1, _mm_cvtps_pd(_mm_movehl_ps(fg, fg))), _mm_cvtps_pd(_mm_movehl_ps(fb, fb)));
+        err[h] = _mm_castps_si128(_mm_movelh_ps(_mm_cvtpd_ps(e0), _mm_cvtpd_ps(e1)));
+    }
+    err_lo = err[0];
+    err_hi = err[1];
+}
+
+// Finds the best table and pixel indices for the sizex x sizey half block at (startx, starty).
+// Returns the error of the best table, as a float bit pattern for the floating point metrics.
+static unsigned int tryalltables_3bittableSSE(int metric, uint8 *img,int width,int startx,int starty,int sizex,int sizey,uint8 *avg_color, unsigned int &best_table,unsigned int &best_pixel_indices_MSB, unsigned int &best_pixel_indices_LSB)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i approx[4][3];
+    int16 best_q[8][8];
+    int bitpos[8];
+
+    // Color of every table for every modifier, clamped as in the scalar code
+    for(int q=0; q<4; q++)
+    {
+        __m128i mod = _mm_setr_epi16((short)compressParams[0][q], (short)compressParams[2][q], (short)compressParams[4][q], (short)compressParams[6][q],
+                                     (short)compressParams[8][q], (short)compressParams[10][q], (short)compressParams[12][q], (short)compressParams[14][q]);
+        for(int c=0; c<3; c++)
+            approx[q][c] = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(_mm_set1_epi16(avg_color[c]), mod), zero), _mm_set1_epi16(255));
+    }
+
+    __m128i sum_lo = zero, sum_hi = zero;
+    __m128 fsum_lo = _mm_setzero_ps(), fsum_hi = _mm_setzero_ps();
+    int i = 0;
+    for(int x=startx; x<startx+sizex; x++)
+    {
+        for(int y=starty; y<starty+sizey; y++)
+        {
+            __m128i orig_r = _mm_set1_epi16(RED(img,width,x,y));
+            __m128i orig_g = _mm_set1_epi16(GREEN(img,width,x,y));
+            __m128i orig_b = _mm_set1_epi16(BLUE(img,width,x,y));
+            __m128i min_lo, min_hi, q_lo = zero, q_hi = zero;
+
+            tableErrorSSE(metric, _mm_sub_epi16(approx[0][0], orig_r), _mm_sub_epi16(approx[0][1], orig_g), _mm_sub_epi16(approx[0][2], orig_b), min_lo, min_hi);
+            for(int q=1; q<4; q++)
+            {
+                __m128i err_lo, err_hi;
+                tableErrorSSE(metric, _mm_sub_epi16(approx[q][0], orig_r), _mm_sub_epi16(approx[q][1], orig_g), _mm_sub_epi16(approx[q][2], orig_b), err_lo, err_hi);
+
+                // Only a strictly smaller error replaces the best modifier, as in the scalar loop
+                __m128i less_lo = _mm_cmplt_epi32(err_lo, min_lo);
+                __m128i less_hi = _mm_cmplt_epi32(err_hi, min_hi);
+                min_lo = _mm_or_si128(_mm_and_si128(less_lo, err_lo), _mm_andnot_si128(less_lo, min_lo));
+                min_hi = _mm_or_si128(_mm_and_si128(less_hi, err_hi), _mm_andnot_si128(less_hi, min_hi));
+                q_lo = _mm_or_si128(_mm_and_si128(less_lo, _mm_set1_epi32(q)), _mm_andnot_si128(less_lo, q_lo));
+                q_hi = _mm_or_si128(_mm_and_si128(less_hi, _mm_set1_epi32(q)), _mm_andnot_si128(less_hi, q_hi));
+            }
+
+            if(metric >= TABLE_ERROR_PERCEP)
+            {
+                fsum_lo = _mm_add_ps(fsum_lo, _mm_castsi128_ps(min_lo));
+                fsum_hi = _mm_add_ps(fsum_hi, _mm_castsi128_ps(min_hi));
+            }
+            else
+            {
+                sum_lo = _mm_add_epi32(sum_lo, min_lo);
+                sum_hi = _mm_add_epi32(sum_hi, min_hi);
+            }
+
+            _mm_storeu_si128((__m128i *) best_q[i], _mm_packs_epi32(q_lo, q_hi));
+            bitpos[i] = (x-startx)*4 + (y-starty);
+            i++;
+        }
+    }
+
+    if(metric >= TABLE_ERROR_PERCEP)
+    {
+        sum_lo = _mm_castps_si128(fsum_lo);
+        sum_hi = _mm_castps_si128(fsum_hi);
+    }
+    unsigned int sum_error[8];
+    _mm_storeu_si128((__m128i *) &sum_error[0], sum_lo);
+    _mm_storeu_si128((__m128i *) &sum_error[4], sum_hi);
+
+    // Keep the first table with the lowest error
+    int t = 0;
+    for(int q=1; q<8; q++)
+    {
+        if(sum_error[q] < sum_error[t])
+            t = q;
+    }
+
+    unsigned int pixel_indices_MSB=0, pixel_indices_LSB=0, pixel_indices;
+    for(i=0; i<8; i++)
+    {
+        // In order to simplify hardware, the table {-12, -4, 4, 12} is indexed {11, 10, 00, 01}
+        pixel_indices = scramble[best_q[i][t]];
+        PUTBITS( pixel_indices_MSB, (pixel_indices >> 1), 1, bitpos[i]);
+        PUTBITS( pixel_indices_LSB, (pixel_indices & 1) , 1, bitpos[i]);
+    }
+
+    best_table = t;
+    best_pixel_indices_MSB = pixel_indices_MSB;
+    best_pixel_indices_LSB = pixel_indices_LSB;
+    return sum_error[t];
+}
+
+// Float error of tryalltables_3bittableSSE for the floating point metrics
+static inline float tableErrorFloat(unsigned int bits)
+{
+    float err;
+    memcpy(&err, &bits, sizeof(err));
+    return err;
+}
+#endif // USE_SSE
+
 // Find the best table to use for a 2x4 area by testing all.
 // NO WARRANTY --- SEE STATEMENT IN TOP OF FILE (C) Ericsson AB 2005-2013. All Rights Reserved.
 int tryalltables_3bittable2x4(uint8 *img,int width,int height,int startx,int starty,uint8 *avg_color, unsigned int &best_table,unsigned int &best_pixel_indices_MSB, unsigned int &best_pixel_indices_LSB)
 {
+#ifdef USE_SSE
+    UNREFERENCED_PARAMETER(height);
+    return (int) tryalltables_3bittableSSE(TABLE_ERROR_RGB, img, width, startx, starty, 2, 4, avg_color, best_table, best_pixel_indices_MSB, best_pixel_indices_LSB);
+#else
     int min_error = 3*255*255*16;
     int q;
     int err;
@@ -1451,6 +1649,7 @@ int tryalltables_3bittable2x4(uint8 *img,int width,int height,int startx,int sta
         }
     }
     return min_error;
+#endif // USE_SSE
 }
 
 // Find the best table to use for a 2x4 area by testing all.
@@ -1459,6 +1658,10 @@ int tryalltables_3bittable2x4(uint8 *img,int width,int height,int startx,int sta
 // NO WARRANTY --- SEE STATEMENT IN TOP OF FILE (C) Ericsson AB 2005-2013. All Rights Reserved.
 unsigned int tryalltables_3bittable2x4percep1000(uint8 *img,int width,int height,int startx,int starty,uint8 *avg_color, unsigned int &best_table,unsigned int &best_pixel_indices_MSB, unsigned int &best_pixel_indices_LSB)
 {
+#ifdef USE_SSE
+    UNREFERENCED_PARAMETER(height);
+    return tryalltables_3bittableSSE(TABLE_ERROR_PERCEP1000, img, width, startx, starty, 2, 4, avg_color, best_table, best_pixel_indices_MSB, best_pixel_indices_LSB);
+#else
     unsigned int min_error = MAXERR1000;
     int q;
     unsigned int err;
@@ -1480,6 +1683,7 @@ unsigned int tryalltables_3bittable2x4percep1000(uint8 *img,int width,int height
         }
     }
     return min_error;
+#endif // USE_SSE
 }
 
 // Find the best table to use for a 2x4 area by testing all.
@@ -1487,6 +1691,10 @@ unsigned int tryalltables_3bittable2x4percep1000(uint8 *img,int width,int height
 // NO WARRANTY --- SEE STATEMENT IN TOP OF FILE (C) Ericsson AB 2005-2013. All Rights Reserved.
 int tryalltables_3bittable2x4percep(uint8 *img,int width,int height,int startx,int starty,uint8 *avg_color, unsigned int &best_table,unsigned int &best_pixel_indices_MSB, unsigned int &best_pixel_indices_LSB)
 {
+#ifdef USE_SSE
+    UNREFERENCED_PARAMETER(height);
+    return (int) tableErrorFloat(tryalltables_3bittableSSE(TABLE_ERROR_PERCEP, img, width, startx, starty, 2, 4, avg_color, best_table, best_pixel_indices_MSB, best_pixel_indices_LSB));
+#else
     float min_error = 3*255*255*16;
     int q;
     float err;
@@ -1506,12 +1714,17 @@ int tryalltables_3bittable2x4percep(uint8 *img,int width,int height,int startx,i
         }
     }
     return (int) min_error;
+#endif // USE_SSE
 }
 
 // Find the best table to use for a 4x2 area by testing all.
 // NO WARRANTY --- SEE STATEMENT IN TOP OF FILE (C) Ericsson AB 2005-2013. All Rights Reserved.
 int tryalltables_3bittable4x2(uint8 *img,int width,int height,int startx,int starty,uint8 *avg_color, unsigned int &best_table,unsigned int &best_pixel_indices_MSB, unsigned int &best_pixel_indices_LSB)
 {
+#ifdef USE_SSE
+    UNREFERENCED_PARAMETER(height);
+    return (int) tryalltables_3bittableSSE(TABLE_ERROR_RGB, img, width, startx, starty, 4, 2, avg_color, best_table, best_pixel_indices_MSB, best_pixel_indices_LSB);
+#else
     int min_error = 3*255*255*16;
     int q;
     int err;
@@ -1531,6 +1744,7 @@ int tryalltables_3bittable4x2(uint8 *img,int width,int height,int startx,int sta
         }
     }
     return min_error;
+#endif // USE_SSE
 }
 
 // Find the best table to use for a 4x2 area by testing all.
@@ -1539,6 +1753,10 @@ int tryalltables_3bittable4x2(uint8 *img,int width,int height,int startx,int sta
 // NO WARRANTY --- SEE STATEMENT IN TOP OF FILE (C) Ericsson AB 2005-2013. All Rights Reserved.
 unsigned int tryalltables_3bittable4x2percep1000(uint8 *img,int width,int height,int startx,int starty,uint8 *avg_color, unsigned int &best_table,unsigned int &best_pixel_indices_MSB, unsigned int &best_pixel_indices_LSB)
 {
+#ifdef USE_SSE
+    UNREFERENCED_PARAMETER(height);
+    return tryalltables_3bittableSSE(TABLE_ERROR_PERCEP1000, img, width, startx, starty, 4, 2, avg_color, best_table, best_pixel_indices_MSB, best_pixel_indices_LSB);
+#else
     unsigned int min_error = MAXERR1000;
     int q;
     unsigned int err;
@@ -1557,6 +1775,7 @@ unsigned int tryalltables_3bittable4x2percep1000(uint8 *img,int width,int height
         }
     }
     return min_error;
+#endif // USE_SSE
 }
 
 // Find the best table to use for a 4x2 area by testing all.
@@ -1564,6 +1783,10 @@ unsigned int tryalltables_3bittable4x2percep1000(uint8 *img,int width,int height
 // NO WARRANTY --- SEE STATEMENT IN TOP OF FILE (C) Ericsson AB 2005-2013. All Rights Reserved.
 int tryalltables_3bittable4x2percep(uint8 *img,int width,int height,int startx,int starty,uint8 *avg_color, unsigned int &best_table,unsigned int &best_pixel_indices_MSB, unsigned int &best_pixel_indices_LSB)
 {
+#ifdef USE_SSE
+    UNREFERENCED_PARAMETER(height);
+    return (int) tableErrorFloat(tryalltables_3bittableSSE(TABLE_ERROR_PERCEP_FLOAT, img, width, startx, starty, 4, 2, avg_color, best_table, best_pixel_indices_MSB, best_pixel_indices_LSB));
+#else
     float min_error = 3*255*255*16;
     int q;
     float err;
@@ -1582,6 +1805,7 @@ int tryalltables_3bittable4x2percep(uint8 *img,int width,int height,int startx,i
         }
     }
     return (int) min_error;
+#endif // USE_SSE
 }
 
 // The below code quantizes a float RGB value to RGB444. 
@@ -5099,6 +5323,16 @@ void compressBlockDiffFlipCombined(uint8 *img,int width,int height,int startx,in
     }
 }
 
+// Random seeds for the LBG-algorithm. This is the sequence of the MSVC rand(), kept in
+// a local seed rather than the C runtime state so that blocks compressed at the same
+// time on several threads still get predictable output.
+#define LBG_RAND_MAX 0x7fff
+static inline int lbgRand(unsigned int &seed)
+{
+    seed = seed * 214013 + 2531011;
+    return (seed >> 16) & LBG_RAND_MAX;
+}
+
 // Calculation of the two block colors using the LBG-algorithm
 // The following method scales down the intensity, since this can be compensated for anyway by both the H and T mode.
 // NO WARRANTY --- SEE STATEMENT IN TOP OF FILE (C) Ericsson AB 2005-2013. All Rights Reserved.
@@ -5107,7 +5341,7 @@ void computeColorLBGHalfIntensityFast(uint8 *img,int width,int startx,int starty
     uint8 block_mask[4][4];
 
     // reset rand so that we get predictable output per block
-    srand(10000);
+    unsigned int rand_seed = 10000;
     //LBG-algorithm
     double D = 0, oldD, bestD = MAXIMUM_ERROR;
            //eps = 0.0000000001;
@@ -5177,7 +5411,7 @@ void computeColorLBGHalfIntensityFast(uint8 *img,int width,int startx,int starty
         {
             for (uint8 c = 0; c < 3; ++c) 
             { 
-                current_colors[s][c] = double((double(rand())/RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
+                current_colors[s][c] = double((double(lbgRand(rand_seed))/LBG_RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
             }
         }
         
@@ -5302,7 +5536,7 @@ void computeColorLBGNotIntensityFast(uint8 *img,int width,int startx,int starty,
     uint8 block_mask[4][4];
 
     // reset rand so that we get predictable output per block
-    srand(10000);
+    unsigned int rand_seed = 10000;
     //LBG-algorithm
     double D = 0, oldD, bestD = MAXIMUM_ERROR;
     // eps = 0.0000000001;
@@ -5372,7 +5606,7 @@ void computeColorLBGNotIntensityFast(uint8 *img,int width,int startx,int starty,
         {
             for (uint8 c = 0; c < 3; ++c) 
             { 
-                current_colors[s][c] = double((double(rand())/RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
+                current_colors[s][c] = double((double(lbgRand(rand_seed))/LBG_RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
             }
         }
         // divide into two quantization sets and calculate distortion
@@ -5495,7 +5729,7 @@ void computeColorLBGNotIntensity(uint8 *img,int width,int startx,int starty, uin
     uint8 block_mask[4][4];
 
     // reset rand so that we get predictable output per block
-    srand(10000);
+    unsigned int rand_seed = 10000;
     //LBG-algorithm
     double D = 0, oldD, bestD = MAXIMUM_ERROR;
     //, eps = 0.0000000001;
@@ -5565,7 +5799,7 @@ void computeColorLBGNotIntensity(uint8 *img,int width,int startx,int starty, uin
         {
             for (uint8 c = 0; c < 3; ++c) 
             { 
-                current_colors[s][c] = double((double(rand())/RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
+                current_colors[s][c] = double((double(lbgRand(rand_seed))/LBG_RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
             }
         }
         
@@ -5688,7 +5922,7 @@ void computeColorLBG(uint8 *img,int width,int startx,int starty, uint8 (LBG_colo
     uint8 block_mask[4][4];
 
     // reset rand so that we get predictable output per block
-    srand(10000);
+    unsigned int rand_seed = 10000;
     //LBG-algorithm
     double D = 0, oldD, bestD = MAXIMUM_ERROR;
     //, eps = 0.0000000001;
@@ -5750,7 +5984,7 @@ void computeColorLBG(uint8 *img,int width,int startx,int starty, uint8 (LBG_colo
         {
             for (uint8 c = 0; c < 3; ++c) 
             { 
-                current_colors[s][c] = double((double(rand())/RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
+                current_colors[s][c] = double((double(lbgRand(rand_seed))/LBG_RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
             }
         }
         
@@ -5869,7 +6103,7 @@ void computeColorLBGfast(uint8 *img,int width,int startx,int starty, uint8 (LBG_
     uint8 block_mask[4][4];
 
     // reset rand so that we get predictable output per block
-    srand(10000);
+    unsigned int rand_seed = 10000;
     //LBG-algorithm
     double D = 0, oldD, bestD = MAXIMUM_ERROR;
     //, eps = 0.0000000001;
@@ -5926,7 +6160,7 @@ void computeColorLBGfast(uint8 *img,int width,int startx,int starty, uint8 (LBG_
         {
             for (uint8 c = 0; c < 3; ++c) 
             { 
-                current_colors[s][c] = double((double(rand())/RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
+                current_colors[s][c] = double((double(lbgRand(rand_seed))/LBG_RAND_MAX)*(max_v[c]-min_v[c])) + min_v[c];
             }
         }
         
@@ -33,6 +33,9 @@
 #include <tchar.h>
 #include <assert.h>    
 
+// Statistics of the last compression, returned by CMP_GetCompressStats
+CMP_CompressStats g_CompressStats;
+
 CodecType GetCodecType(CMP_FORMAT format)
 {
     switch(format)
@@ -84,6 +87,9 @@ CodecType GetCodecType(CMP_FORMAT format)
         case CMP_FORMAT_ATC_RGBA_Interpolated:   return CT_ATC_RGBA_Interpolated;
         case CMP_FORMAT_ETC_RGB:                 return CT_ETC_RGB;
         case CMP_FORMAT_ETC2_RGB:                return CT_ETC2_RGB;
+        case CMP_FORMAT_ETC2_RGBA:               return CT_ETC2_RGBA;
+        case CMP_FORMAT_EAC_R11:                 return CT_EAC_R11;
+        case CMP_FORMAT_EAC_RG11:                return CT_EAC_RG11;
         case CMP_FORMAT_GT:                      return CT_GT;
         default: assert(0);                            return CT_Unknown;
     }
@@ -183,6 +189,7 @@ CMP_ERROR CompressTexture(const CMP_Texture* pSourceTexture, CMP_Texture* pDestT
                 else
 #endif
                     pCodec->SetParameter("CompressionSpeed", (CMP_DWORD)CMP_Speed_Normal);
+            pCodec->SetParameter("RefinementEffort", (CODECFLOAT)pOptions->fquality);
         }
         else
             pCodec->SetParameter("CompressionSpeed", (CMP_DWORD)pOptions->nCompressionSpeed);
@@ -206,6 +213,15 @@ CMP_ERROR CompressTexture(const CMP_Texture* pSourceTexture, CMP_Texture* pDestT
         case CT_ASTC:
                 pCodec->SetParameter("Quality", (CODECFLOAT)pOptions->fquality);
                 break;
+        case CT_ETC_RGB:
+        case CT_ETC2_RGB:
+        case CT_ETC2_RGBA:
+        case CT_EAC_R11:
+        case CT_EAC_RG11:
+                // Blocks are shared out to one thread per processor by the codec
+                pCodec->SetParameter("NumThreads", (CMP_DWORD) (pOptions->bDisableMultiThreading ? 1 : 0));
+                pCodec->SetParameter("Quality", (CODECFLOAT) pOptions->fquality);
+                break;
         case CT_GT:
         case CT_BC6H:
                 // Reserved
@@ -252,6 +268,20 @@ CMP_ERROR CompressTexture(const CMP_Texture* pSourceTexture, CMP_Texture* pDestT
     CodecError err = pCodec->Compress(*pSrcBuffer, *pDestBuffer, pFeedbackProc, pUser1, pUser2);
     RESTORE_FP_EXCEPTIONS;
 
+    CMP_DWORD   dwBlocksEncoded = 0;
+    CODECFLOAT  fWorkPerBlock   = 0;
+    if(pCodec->GetParameter("BlocksEncoded", dwBlocksEncoded))
+        g_CompressStats.dwBlocksEncoded = dwBlocksEncoded;
+    if(pCodec->GetParameter("WorkPerBlock", fWorkPerBlock))
+        g_CompressStats.fWorkPerBlock = fWorkPerBlock;
+
+    CMP_DWORD   dwModeMask         = 0;
+    CODECFLOAT  fModeMaskTimeSaved = 0;
+    if((destType == CT_BC7) && pCodec->GetParameter("ModeMask", dwModeMask))
+        g_CompressStats.dwModeMask = dwModeMask;
+    if(pCodec->GetParameter("ModeMaskTimeSaved", fModeMaskTimeSaved))
+        g_CompressStats.fModeMaskTimeSaved = fModeMaskTimeSaved;
+
     SAFE_DELETE(pCodec);
     SAFE_DELETE(pSrcBuffer);
     SAFE_DELETE(pDestBuffer);
@@ -302,6 +332,11 @@ CMP_ERROR ThreadedCompressTexture(const CMP_Texture* pSourceTexture, CMP_Texture
     if (destType == CT_BC7)  return CMP_ABORTED; 
     if (destType == CT_GT)   return CMP_ABORTED;
     if (destType == CT_ASTC) return CMP_ABORTED; 
+    if (destType == CT_ETC_RGB)  return CMP_ABORTED;
+    if (destType == CT_ETC2_RGB) return CMP_ABORTED;
+    if (destType == CT_ETC2_RGBA) return CMP_ABORTED;
+    if (destType == CT_EAC_R11)  return CMP_ABORTED;
+    if (destType == CT_EAC_RG11) return CMP_ABORTED;
 
     DWORD dwMaxThreadCount = min(f_dwProcessorCount, MAX_THREADS);
     DWORD dwLinesRemaining = pDestTexture->dwHeight;
@@ -353,6 +388,7 @@ CMP_ERROR ThreadedCompressTexture(const CMP_Texture* pSourceTexture, CMP_Texture
                         threadData.m_pCodec->SetParameter("CompressionSpeed", (CMP_DWORD)CMP_Speed_Fast);
                     else
                         threadData.m_pCodec->SetParameter("CompressionSpeed", (CMP_DWORD)CMP_Speed_Normal);
+                threadData.m_pCodec->SetParameter("RefinementEffort", (CODECFLOAT)pOptions->fquality);
             }
             else
                 threadData.m_pCodec->SetParameter("CompressionSpeed", (CMP_DWORD)pOptions->nCompressionSpeed);
@@ -40,7 +40,9 @@ extern CodecType GetCodecType(CMP_FORMAT format);
 extern CMP_ERROR GetError(CodecError err);
 extern CMP_ERROR CheckTexture(const CMP_Texture* pTexture, bool bSource);
 extern CMP_ERROR CompressTexture(const CMP_Texture* pSourceTexture, CMP_Texture* pDestTexture, const CMP_CompressOptions* pOptions, CMP_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2, CodecType destType);
+extern CMP_CompressStats g_CompressStats;
 extern CMP_ERROR ThreadedCompressTexture(const CMP_Texture* pSourceTexture, CMP_Texture* pDestTexture, const CMP_CompressOptions* pOptions, CMP_Feedback_Proc pFeedbackProc, DWORD_PTR pUser1, DWORD_PTR pUser2, CodecType destType);
+extern void atiDecodeBlocksETC(CodecType nCodecType, const CMP_BYTE* pIn, CMP_DWORD dwInPitch, CMP_DWORD dwBlocksX, CMP_DWORD dwBlocksY, CMP_BYTE* pOut, CMP_DWORD dwOutPitch, int nRedOffset, CMP_DWORD dwNumThreads);
 
 #ifdef _LOCAL_DEBUG
 char    DbgTracer::buff[MAX_DBGBUFF_SIZE];
@@ -225,6 +227,9 @@ void CMP_PrepareSourceForCMP_Destination(CMP_Texture* pTexture, CMP_FORMAT  Dest
         case CMP_FORMAT_GT:
         case CMP_FORMAT_ETC_RGB:
         case CMP_FORMAT_ETC2_RGB:
+        case CMP_FORMAT_ETC2_RGBA:
+        case CMP_FORMAT_EAC_R11:
+        case CMP_FORMAT_EAC_RG11:
         {
             newSrcFormat = CMP_FORMAT_RGBA_8888;
             CMP_Map_Bytes(pData, dwWidth, dwHeight, { 2, 1, 0, 3 },4);
@@ -269,6 +274,9 @@ void CMP_PrepareSourceForCMP_Destination(CMP_Texture* pTexture, CMP_FORMAT  Dest
         case CMP_FORMAT_BC7:
         case CMP_FORMAT_ETC_RGB:
         case CMP_FORMAT_ETC2_RGB:
+        case CMP_FORMAT_ETC2_RGBA:
+        case CMP_FORMAT_EAC_R11:
+        case CMP_FORMAT_EAC_RG11:
         case CMP_FORMAT_GT:
         {
             // format is correct
@@ -312,6 +320,9 @@ void CMP_PrepareSourceForCMP_Destination(CMP_Texture* pTexture, CMP_FORMAT  Dest
         case CMP_FORMAT_BC7:
         case CMP_FORMAT_ETC_RGB:
         case CMP_FORMAT_ETC2_RGB:
+        case CMP_FORMAT_ETC2_RGBA:
+        case CMP_FORMAT_EAC_R11:
+        case CMP_FORMAT_EAC_RG11:
         case CMP_FORMAT_GT:
         {
             newSrcFormat = CMP_FORMAT_RGBA_8888;
@@ -390,6 +401,9 @@ void CMP_PrepareCMPSourceForIMG_Destination(CMP_Texture* pDstTexture, CMP_FORMAT
     case CMP_FORMAT_GT:
     case CMP_FORMAT_ETC_RGB:
     case CMP_FORMAT_ETC2_RGB:
+    case CMP_FORMAT_ETC2_RGBA:
+    case CMP_FORMAT_EAC_R11:
+    case CMP_FORMAT_EAC_RG11:
     {
         switch (newDstFormat)
         {
@@ -482,10 +496,14 @@ CMP_ERROR CMP_API CMP_ConvertTexture(CMP_Texture* pSourceTexture, CMP_Texture* p
         CMP_PrepareSourceForCMP_Destination(pSourceTexture, pDestTexture->format);
 #endif
 
+        memset(&g_CompressStats, 0, sizeof(g_CompressStats));
+        g_CompressStats.dwSize = sizeof(g_CompressStats);
+
 #ifdef THREADED_COMPRESS
         // Note: 
         // BC7/BC6H has issues with this setting - we already set multithreading via numThreads so
         // this call is disabled for BC7/BC6H ASTC Codecs.
+        // ETC1/ETC2/EAC share their blocks out to their own threads.
         // if the use has set DiableMultiThreading then numThreads will be set to 1 (regradless of its original value)
         if(
             ((!pOptions || !pOptions->bDisableMultiThreading) && f_dwProcessorCount > 1) 
@@ -493,6 +511,11 @@ CMP_ERROR CMP_API CMP_ConvertTexture(CMP_Texture* pSourceTexture, CMP_Texture* p
             && (destType != CT_BC7)
             && (destType != CT_BC6H)
             && (destType != CT_GT)
+            && (destType != CT_ETC_RGB)
+            && (destType != CT_ETC2_RGB)
+            && (destType != CT_ETC2_RGBA)
+            && (destType != CT_EAC_R11)
+            && (destType != CT_EAC_RG11)
             )
         {
             tc_err = ThreadedCompressTexture(pSourceTexture, pDestTexture, pOptions, pFeedbackProc, pUser1, pUser2, destType);
@@ -606,3 +629,47 @@ CMP_ERROR CMP_API CMP_ConvertTexture(CMP_Texture* pSourceTexture, CMP_Texture* p
         return GetError(err2);
     }
 }
+
+CMP_ERROR CMP_API CMP_GetCompressStats(CMP_CompressStats* pStats)
+{
+    if(pStats == NULL || pStats->dwSize != sizeof(CMP_CompressStats))
+        return CMP_ERR_GENERIC;
+
+    memcpy(pStats, &g_CompressStats, sizeof(CMP_CompressStats));
+    pStats->dwSize = sizeof(CMP_CompressStats);
+
+    return CMP_OK;
+}
+
+CMP_ERROR CMP_API CMP_DecodeETCBlocks(CMP_FORMAT format, CMP_BYTE* pIn, CMP_DWORD blocksX, CMP_DWORD blocksY,
+                                      CMP_BYTE* pOut, CMP_DWORD pitch, CMP_DWORD numThreads)
+{
+    // Checked here rather than through GetCodecType, which asserts on formats without a codec
+    CodecType nCodecType;
+    switch(format)
+    {
+        case CMP_FORMAT_ETC_RGB:    nCodecType = CT_ETC_RGB;    break;
+        case CMP_FORMAT_ETC2_RGB:   nCodecType = CT_ETC2_RGB;   break;
+        case CMP_FORMAT_ETC2_RGBA:  nCodecType = CT_ETC2_RGBA;  break;
+        default:                    return CMP_ERR_UNSUPPORTED_SOURCE_FORMAT;
+    }
+
+    if(pIn == NULL || pOut == NULL || pitch < blocksX * 4 * sizeof(CMP_DWORD))
+        return CMP_ERR_GENERIC;
+
+    CMP_DWORD dwBlockBytes = (nCodecType == CT_ETC2_RGBA) ? 16 : 8;
+    atiDecodeBlocksETC(nCodecType, pIn, blocksX * dwBlockBytes, blocksX, blocksY, pOut, pitch, 0, numThreads);
+
+    return CMP_OK;
+}
+
+CMP_DWORD CMP_API CMP_GetCPUFeatures()
+{
+    return GetCPUFeatures();
+}
+
+CMP_ERROR CMP_API CMP_SetCPUFeatureMask(CMP_DWORD dwFeatureMask)
+{
+    SetCPUFeatureMask(dwFeatureMask);
+    return CMP_OK;
+}